@@ -0,0 +1,407 @@
+#pragma once
+
+// Systematic Cauchy Reed-Solomon erasure code over GF(2^16), the ALVR_FEC_CODEC_CAUCHY_GF16 FEC.
+// Header only, the client and server copies of ALVR-common must stay identical.
+//
+// rs.c works in GF(2^8) and is used with at most ALVR_FEC_SHARDS_MAX shards, so large frames
+// pack several packets per shard and each packet row is its own short codeword. Here every packet
+// is a symbol and a FEC group of up to SHARDS_MAX packets is one codeword: any dataShards of the
+// dataShards + parityShards packets rebuild the group, wherever the losses are.
+//
+// The parity rows are a Cauchy matrix 1 / (x_j + y_i) with x_j = j and y_i = parityShards + i,
+// every square submatrix of it is invertible which makes the code MDS. The columns are scaled so
+// the first parity row is all ones: with a single parity shard the code is a plain XOR.
+//
+// Bytes are taken as field elements by blocks of 32: element i of a block is byte i (low half)
+// and byte 16 + i (high half), so the SIMD paths get the halves with plain loads. A shorter tail
+// of 2h bytes pairs byte i with byte h + i. Any pairing works for a linear code as long as both
+// ends use the same one.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+// x86 picks SSSE3 or AVX2 at run time, the default builds only assume SSE2.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define ALVR_FEC16_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ALVR_FEC16_TARGET(isa)
+#else
+#define ALVR_FEC16_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ALVR_FEC16_NEON
+#endif
+
+namespace fec_cauchy16 {
+
+// x^16 + x^12 + x^3 + x + 1
+static const uint32_t POLYNOMIAL = 0x1100B;
+static const uint32_t ORDER = 65536;
+// x_j and y_i have to be distinct field elements.
+static const size_t SHARDS_MAX = ORDER;
+
+struct FieldTables {
+	uint16_t log[ORDER];
+	// Doubled so that the sum of two logs doesn't need a modulo.
+	uint16_t exp[2 * (ORDER - 1)];
+
+	FieldTables() {
+		uint32_t x = 1;
+		for (uint32_t i = 0; i < ORDER - 1; i++) {
+			exp[i] = exp[i + ORDER - 1] = (uint16_t)x;
+			log[x] = (uint16_t)i;
+			x <<= 1;
+			if (x & ORDER) {
+				x ^= POLYNOMIAL;
+			}
+		}
+		log[0] = 0;
+	}
+};
+
+inline const FieldTables &Tables() {
+	static const FieldTables tables;
+	return tables;
+}
+
+inline uint16_t Mul(uint16_t a, uint16_t b) {
+	if (a == 0 || b == 0) {
+		return 0;
+	}
+	const FieldTables &t = Tables();
+	return t.exp[t.log[a] + t.log[b]];
+}
+
+// a != 0
+inline uint16_t Inv(uint16_t a) {
+	const FieldTables &t = Tables();
+	return t.exp[ORDER - 1 - t.log[a]];
+}
+
+// Coefficient of data shard i in parity shard j.
+inline uint16_t Coefficient(size_t parityShards, size_t j, size_t i) {
+	uint16_t y = (uint16_t)(parityShards + i);
+	return Mul(y, Inv((uint16_t)(j ^ y)));
+}
+
+// Products of a constant by every nibble value at every nibble position, c * x is the xor of
+// the products of the nibbles of x. Split in low and high bytes for the byte shuffles.
+struct MulTable {
+	alignas(16) uint8_t low[4][16];
+	alignas(16) uint8_t high[4][16];
+
+	explicit MulTable(uint16_t c) {
+		// c * x is linear in x: c times the powers of two by doubling, then xor them
+		uint32_t base = c;
+		for (int k = 0; k < 4; k++) {
+			uint16_t product[16];
+			product[0] = 0;
+			for (int bit = 0; bit < 4; bit++) {
+				for (int n = 0; n < (1 << bit); n++) {
+					product[(1 << bit) + n] = product[n] ^ (uint16_t)base;
+				}
+				base <<= 1;
+				if (base & ORDER) {
+					base ^= POLYNOMIAL;
+				}
+			}
+			for (int n = 0; n < 16; n++) {
+				low[k][n] = (uint8_t)product[n];
+				high[k][n] = (uint8_t)(product[n] >> 8);
+			}
+		}
+	}
+};
+
+inline void AddRegion(uint8_t *dst, const uint8_t *src, size_t bytes) {
+	size_t i = 0;
+	for (; i + 8 <= bytes; i += 8) {
+		uint64_t a, b;
+		memcpy(&a, dst + i, 8);
+		memcpy(&b, src + i, 8);
+		a ^= b;
+		memcpy(dst + i, &a, 8);
+	}
+	for (; i < bytes; i++) {
+		dst[i] ^= src[i];
+	}
+}
+
+#if defined(ALVR_FEC16_X86)
+static const int X86_SSSE3 = 1 << 0;
+static const int X86_AVX2 = 1 << 1;
+
+inline int X86Features() {
+	static const int features = [] {
+		int result = 0;
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		if (info[2] & (1 << 9)) {
+			result |= X86_SSSE3;
+		}
+		// AVX enabled by the OS (OSXSAVE, AVX, and the YMM state in XCR0)
+		bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		if (avx && maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5)) {
+				result |= X86_AVX2;
+			}
+		}
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("ssse3")) {
+			result |= X86_SSSE3;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			result |= X86_AVX2;
+		}
+#endif
+		return result;
+	}();
+	return features;
+}
+
+// The 32 byte blocks in [offset, bytes), returns the new offset.
+ALVR_FEC16_TARGET("ssse3")
+inline size_t MulAddBlocksSsse3(uint8_t *dst, const uint8_t *src, const MulTable &table, size_t offset,
+	size_t bytes) {
+	const __m128i mask = _mm_set1_epi8(0x0f);
+	__m128i low[4], high[4];
+	for (int k = 0; k < 4; k++) {
+		low[k] = _mm_load_si128((const __m128i *)table.low[k]);
+		high[k] = _mm_load_si128((const __m128i *)table.high[k]);
+	}
+	for (; offset + 32 <= bytes; offset += 32) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(src + offset));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + offset + 16));
+		__m128i n0 = _mm_and_si128(a, mask);
+		__m128i n1 = _mm_and_si128(_mm_srli_epi64(a, 4), mask);
+		__m128i n2 = _mm_and_si128(b, mask);
+		__m128i n3 = _mm_and_si128(_mm_srli_epi64(b, 4), mask);
+		__m128i productLow = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(low[0], n0), _mm_shuffle_epi8(low[1], n1)),
+			_mm_xor_si128(_mm_shuffle_epi8(low[2], n2), _mm_shuffle_epi8(low[3], n3)));
+		__m128i productHigh = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(high[0], n0), _mm_shuffle_epi8(high[1], n1)),
+			_mm_xor_si128(_mm_shuffle_epi8(high[2], n2), _mm_shuffle_epi8(high[3], n3)));
+		_mm_storeu_si128((__m128i *)(dst + offset),
+			_mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst + offset)), productLow));
+		_mm_storeu_si128((__m128i *)(dst + offset + 16),
+			_mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst + offset + 16)), productHigh));
+	}
+	return offset;
+}
+
+// Two blocks at a time: the 128 bit lanes are regrouped as the low halves and the high halves.
+ALVR_FEC16_TARGET("avx2")
+inline size_t MulAddBlocksAvx2(uint8_t *dst, const uint8_t *src, const MulTable &table, size_t offset,
+	size_t bytes) {
+	const __m256i mask = _mm256_set1_epi8(0x0f);
+	__m256i low[4], high[4];
+	for (int k = 0; k < 4; k++) {
+		low[k] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)table.low[k]));
+		high[k] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)table.high[k]));
+	}
+	for (; offset + 64 <= bytes; offset += 64) {
+		__m256i first = _mm256_loadu_si256((const __m256i *)(src + offset));
+		__m256i second = _mm256_loadu_si256((const __m256i *)(src + offset + 32));
+		__m256i a = _mm256_permute2x128_si256(first, second, 0x20);
+		__m256i b = _mm256_permute2x128_si256(first, second, 0x31);
+		__m256i n0 = _mm256_and_si256(a, mask);
+		__m256i n1 = _mm256_and_si256(_mm256_srli_epi64(a, 4), mask);
+		__m256i n2 = _mm256_and_si256(b, mask);
+		__m256i n3 = _mm256_and_si256(_mm256_srli_epi64(b, 4), mask);
+		__m256i productLow = _mm256_xor_si256(
+			_mm256_xor_si256(_mm256_shuffle_epi8(low[0], n0), _mm256_shuffle_epi8(low[1], n1)),
+			_mm256_xor_si256(_mm256_shuffle_epi8(low[2], n2), _mm256_shuffle_epi8(low[3], n3)));
+		__m256i productHigh = _mm256_xor_si256(
+			_mm256_xor_si256(_mm256_shuffle_epi8(high[0], n0), _mm256_shuffle_epi8(high[1], n1)),
+			_mm256_xor_si256(_mm256_shuffle_epi8(high[2], n2), _mm256_shuffle_epi8(high[3], n3)));
+		_mm256_storeu_si256((__m256i *)(dst + offset),
+			_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(dst + offset)),
+				_mm256_permute2x128_si256(productLow, productHigh, 0x20)));
+		_mm256_storeu_si256((__m256i *)(dst + offset + 32),
+			_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(dst + offset + 32)),
+				_mm256_permute2x128_si256(productLow, productHigh, 0x31)));
+	}
+	return offset;
+}
+#endif
+
+#if defined(ALVR_FEC16_NEON)
+inline size_t MulAddBlocksNeon(uint8_t *dst, const uint8_t *src, const MulTable &table, size_t offset,
+	size_t bytes) {
+	const uint8x16_t mask = vdupq_n_u8(0x0f);
+	uint8x16_t low[4], high[4];
+	for (int k = 0; k < 4; k++) {
+		low[k] = vld1q_u8(table.low[k]);
+		high[k] = vld1q_u8(table.high[k]);
+	}
+	for (; offset + 32 <= bytes; offset += 32) {
+		uint8x16_t a = vld1q_u8(src + offset);
+		uint8x16_t b = vld1q_u8(src + offset + 16);
+		uint8x16_t n0 = vandq_u8(a, mask);
+		uint8x16_t n1 = vshrq_n_u8(a, 4);
+		uint8x16_t n2 = vandq_u8(b, mask);
+		uint8x16_t n3 = vshrq_n_u8(b, 4);
+		uint8x16_t productLow = veorq_u8(veorq_u8(vqtbl1q_u8(low[0], n0), vqtbl1q_u8(low[1], n1)),
+			veorq_u8(vqtbl1q_u8(low[2], n2), vqtbl1q_u8(low[3], n3)));
+		uint8x16_t productHigh = veorq_u8(veorq_u8(vqtbl1q_u8(high[0], n0), vqtbl1q_u8(high[1], n1)),
+			veorq_u8(vqtbl1q_u8(high[2], n2), vqtbl1q_u8(high[3], n3)));
+		vst1q_u8(dst + offset, veorq_u8(vld1q_u8(dst + offset), productLow));
+		vst1q_u8(dst + offset + 16, veorq_u8(vld1q_u8(dst + offset + 16), productHigh));
+	}
+	return offset;
+}
+#endif
+
+// dst += c * src over bytes (even) bytes.
+inline void MulAddRegion(uint8_t *dst, const uint8_t *src, uint16_t c, size_t bytes) {
+	if (c == 0) {
+		return;
+	}
+	if (c == 1) {
+		AddRegion(dst, src, bytes);
+		return;
+	}
+	MulTable table(c);
+
+	size_t offset = 0;
+#if defined(ALVR_FEC16_X86)
+	int features = X86Features();
+	if (features & X86_AVX2) {
+		offset = MulAddBlocksAvx2(dst, src, table, offset, bytes);
+	}
+	if (features & X86_SSSE3) {
+		offset = MulAddBlocksSsse3(dst, src, table, offset, bytes);
+	}
+#elif defined(ALVR_FEC16_NEON)
+	offset = MulAddBlocksNeon(dst, src, table, offset, bytes);
+#endif
+
+	// Scalar blocks, then the tail block
+	while (offset < bytes) {
+		size_t half = bytes - offset >= 32 ? 16 : (bytes - offset) / 2;
+		uint8_t *dstLow = dst + offset;
+		uint8_t *dstHigh = dst + offset + half;
+		const uint8_t *srcLow = src + offset;
+		const uint8_t *srcHigh = src + offset + half;
+		for (size_t i = 0; i < half; i++) {
+			uint8_t l = srcLow[i], h = srcHigh[i];
+			dstLow[i] ^= table.low[0][l & 15] ^ table.low[1][l >> 4] ^ table.low[2][h & 15] ^ table.low[3][h >> 4];
+			dstHigh[i] ^= table.high[0][l & 15] ^ table.high[1][l >> 4] ^ table.high[2][h & 15] ^ table.high[3][h >> 4];
+		}
+		offset += 2 * half;
+	}
+}
+
+// Computes the parityShards parity symbols of the dataShards data symbols, symbolBytes (even)
+// each. dataShards + parityShards <= SHARDS_MAX.
+inline void Encode(const uint8_t *const *data, size_t dataShards, uint8_t *const *parity,
+	size_t parityShards, size_t symbolBytes) {
+	for (size_t j = 0; j < parityShards; j++) {
+		memset(parity[j], 0, symbolBytes);
+	}
+	// One data symbol at a time against all the parity symbols, which stay in cache.
+	for (size_t i = 0; i < dataShards; i++) {
+		for (size_t j = 0; j < parityShards; j++) {
+			MulAddRegion(parity[j], data[i], Coefficient(parityShards, j, i), symbolBytes);
+		}
+	}
+}
+
+// Rebuilds the missing data symbols in place. shards holds the dataShards data then the
+// parityShards parity symbols, marks[i] is non zero if shard i is missing (as rs.c). The missing
+// parity symbols are not rebuilt. Returns false if fewer than dataShards shards are present.
+inline bool Reconstruct(uint8_t *const *shards, const uint8_t *marks, size_t dataShards,
+	size_t parityShards, size_t symbolBytes) {
+	std::vector<size_t> missing;
+	std::vector<size_t> rows;
+	for (size_t i = 0; i < dataShards; i++) {
+		if (marks[i]) {
+			missing.push_back(i);
+		}
+	}
+	if (missing.empty()) {
+		return true;
+	}
+	for (size_t j = 0; j < parityShards && rows.size() < missing.size(); j++) {
+		if (!marks[dataShards + j]) {
+			rows.push_back(j);
+		}
+	}
+	size_t count = missing.size();
+	if (rows.size() < count) {
+		return false;
+	}
+
+	// Parity rows minus the contribution of the received data: the products of the missing data
+	// by the square Cauchy submatrix of the rows and the missing columns.
+	std::vector<uint8_t> syndromes(count * symbolBytes);
+	for (size_t r = 0; r < count; r++) {
+		memcpy(&syndromes[r * symbolBytes], shards[dataShards + rows[r]], symbolBytes);
+	}
+	for (size_t i = 0; i < dataShards; i++) {
+		if (marks[i]) {
+			continue;
+		}
+		for (size_t r = 0; r < count; r++) {
+			MulAddRegion(&syndromes[r * symbolBytes], shards[i], Coefficient(parityShards, rows[r], i),
+				symbolBytes);
+		}
+	}
+
+	// Gauss-Jordan on [submatrix | identity], always invertible
+	std::vector<uint16_t> matrix(count * count);
+	std::vector<uint16_t> inverse(count * count, 0);
+	for (size_t r = 0; r < count; r++) {
+		for (size_t c = 0; c < count; c++) {
+			matrix[r * count + c] = Coefficient(parityShards, rows[r], missing[c]);
+		}
+		inverse[r * count + r] = 1;
+	}
+	for (size_t c = 0; c < count; c++) {
+		size_t pivot = c;
+		while (matrix[pivot * count + c] == 0) {
+			pivot++;
+		}
+		if (pivot != c) {
+			for (size_t k = 0; k < count; k++) {
+				std::swap(matrix[pivot * count + k], matrix[c * count + k]);
+				std::swap(inverse[pivot * count + k], inverse[c * count + k]);
+			}
+		}
+		uint16_t scale = Inv(matrix[c * count + c]);
+		for (size_t k = 0; k < count; k++) {
+			matrix[c * count + k] = Mul(matrix[c * count + k], scale);
+			inverse[c * count + k] = Mul(inverse[c * count + k], scale);
+		}
+		for (size_t r = 0; r < count; r++) {
+			uint16_t factor = matrix[r * count + c];
+			if (r == c || factor == 0) {
+				continue;
+			}
+			for (size_t k = 0; k < count; k++) {
+				matrix[r * count + k] ^= Mul(factor, matrix[c * count + k]);
+				inverse[r * count + k] ^= Mul(factor, inverse[c * count + k]);
+			}
+		}
+	}
+
+	for (size_t c = 0; c < count; c++) {
+		uint8_t *shard = shards[missing[c]];
+		memset(shard, 0, symbolBytes);
+		for (size_t r = 0; r < count; r++) {
+			MulAddRegion(shard, &syndromes[r * symbolBytes], inverse[c * count + r], symbolBytes);
+		}
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,377 @@
+#pragma once
+
+// Scheduling policy of the streaming threads: name, priority and CPU affinity, plus the CPU time
+// and context switches they get. Header only, it's used by the server driver, the vulkan layer
+// (in the compositor process) and the client. The client and server copies of ALVR-common must
+// stay identical.
+//
+// Nothing here is required to work: realtime scheduling needs CAP_SYS_NICE or an rtprio limit on
+// linux, an affinity mask can name CPUs which are offline. Every step falls back to the next best
+// one and ApplyToCurrentThread() tells what was actually applied.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace thread_policy {
+
+struct Policy {
+	// Try SCHED_FIFO (TIME_CRITICAL on windows), else raise the nice value.
+	bool realtime = false;
+	int realtimePriority = 10;
+	// Periodic threads can ask for SCHED_DEADLINE instead of SCHED_FIFO, with the CPU time they
+	// need (runtime) every period. Linux only, and not together with an affinity mask: the kernel
+	// refuses deadline tasks which can't run on every CPU of their root domain.
+	bool deadline = false;
+	uint64_t deadlineRuntimeNs = 0;
+	uint64_t deadlinePeriodNs = 0;
+	// Bit i allows CPU i, 0 leaves the affinity alone.
+	uint64_t cpuMask = 0;
+};
+
+enum class Scheduling { Default, Nice, Realtime, Deadline };
+
+inline const char *SchedulingName(Scheduling scheduling) {
+	switch (scheduling) {
+	case Scheduling::Nice: return "raised nice value";
+	case Scheduling::Realtime: return "realtime";
+	case Scheduling::Deadline: return "deadline";
+	default: return "default";
+	}
+}
+
+struct Applied {
+	Scheduling scheduling = Scheduling::Default;
+	bool affinity = false;
+};
+
+struct CpuStats {
+	uint64_t userUs = 0;
+	uint64_t systemUs = 0;
+	// Switches because the thread blocked / because it was preempted. Not available on windows.
+	uint64_t voluntarySwitches = 0;
+	uint64_t involuntarySwitches = 0;
+};
+
+// Parses a CPU list like "2,3" or "4-7", the format of taskset and isolcpus. Returns 0 (no
+// pinning) if the list is empty or invalid.
+inline uint64_t ParseCpuList(const std::string &list) {
+	uint64_t mask = 0;
+	size_t pos = 0;
+	while (pos < list.size()) {
+		size_t end = list.find(',', pos);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		std::string item = list.substr(pos, end - pos);
+		pos = end + 1;
+		item.erase(std::remove(item.begin(), item.end(), ' '), item.end());
+		if (item.empty()) {
+			continue;
+		}
+		unsigned first, last;
+		char trailing;
+		if (sscanf(item.c_str(), "%u-%u%c", &first, &last, &trailing) == 2) {
+		} else if (sscanf(item.c_str(), "%u%c", &first, &trailing) == 1) {
+			last = first;
+		} else {
+			return 0;
+		}
+		if (first > last || last >= 64) {
+			return 0;
+		}
+		for (unsigned cpu = first; cpu <= last; cpu++) {
+			mask |= 1ull << cpu;
+		}
+	}
+	return mask;
+}
+
+namespace detail {
+
+#ifdef _WIN32
+using ThreadId = HANDLE;
+#else
+using ThreadId = pid_t;
+#endif
+
+struct Entry {
+	std::string name;
+	ThreadId id;
+	// Unique for the process, unlike the thread ids which linux reuses.
+	uint64_t serial;
+};
+
+struct Registry {
+	std::mutex mutex;
+	std::vector<Entry> threads;
+	uint64_t nextSerial = 0;
+};
+
+inline Registry &GetRegistry() {
+	static Registry registry;
+	return registry;
+}
+
+#ifdef __linux__
+// Not exposed by every libc.
+struct SchedAttr {
+	uint32_t size;
+	uint32_t schedPolicy;
+	uint64_t schedFlags;
+	int32_t schedNice;
+	uint32_t schedPriority;
+	uint64_t schedRuntime;
+	uint64_t schedDeadline;
+	uint64_t schedPeriod;
+};
+
+// SCHED_RESET_ON_FORK, also not exposed by every libc. The threads created later by a thread
+// with a raised policy (e.g. the FFmpeg workers of the encoder and the decoder) start with the
+// default policy instead of inheriting it, and can't starve the rest of the system.
+const int RESET_ON_FORK = 0x40000000;
+
+inline bool SetDeadline(const Policy &policy) {
+#ifdef SYS_sched_setattr
+	const uint32_t SCHED_DEADLINE_POLICY = 6;
+	const uint64_t SCHED_FLAG_RESET_ON_FORK = 1;
+	SchedAttr attr = {};
+	attr.size = sizeof(attr);
+	attr.schedPolicy = SCHED_DEADLINE_POLICY;
+	attr.schedFlags = SCHED_FLAG_RESET_ON_FORK;
+	attr.schedRuntime = policy.deadlineRuntimeNs;
+	attr.schedDeadline = policy.deadlinePeriodNs;
+	attr.schedPeriod = policy.deadlinePeriodNs;
+	return syscall(SYS_sched_setattr, 0, &attr, 0) == 0;
+#else
+	(void)policy;
+	return false;
+#endif
+}
+#endif
+
+} // namespace detail
+
+// Names the calling thread, applies the policy with the fallbacks and registers the thread for
+// ForEachThread(). Call it at the start of the thread.
+inline Applied ApplyToCurrentThread(const char *name, const Policy &policy) {
+	Applied applied;
+	detail::ThreadId id;
+#ifdef _WIN32
+	if (policy.cpuMask != 0) {
+		applied.affinity = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)policy.cpuMask) != 0;
+	}
+	if (policy.realtime) {
+		if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+			applied.scheduling = Scheduling::Realtime;
+		} else if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST)) {
+			applied.scheduling = Scheduling::Nice;
+		}
+	}
+	id = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, GetCurrentThreadId());
+#else
+	// The name is limited to 15 characters.
+	pthread_setname_np(pthread_self(), std::string(name).substr(0, 15).c_str());
+	id = (pid_t)syscall(SYS_gettid);
+
+#ifdef __linux__
+	if (policy.cpuMask != 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int cpu = 0; cpu < 64; cpu++) {
+			if (policy.cpuMask & (1ull << cpu)) {
+				CPU_SET(cpu, &set);
+			}
+		}
+		applied.affinity = sched_setaffinity(0, sizeof(set), &set) == 0;
+	}
+	if (policy.realtime && policy.deadline && !applied.affinity && policy.deadlineRuntimeNs != 0 &&
+		policy.deadlinePeriodNs >= policy.deadlineRuntimeNs && detail::SetDeadline(policy)) {
+		applied.scheduling = Scheduling::Deadline;
+	}
+#endif
+	if (policy.realtime && applied.scheduling == Scheduling::Default) {
+		sched_param param = {};
+		param.sched_priority = std::clamp(policy.realtimePriority, sched_get_priority_min(SCHED_FIFO),
+			sched_get_priority_max(SCHED_FIFO));
+#ifdef __linux__
+		const int resetOnFork = detail::RESET_ON_FORK;
+		// Without the flag set first, the raised nice value would be inherited too.
+		sched_param defaultParam = {};
+		const bool nice = sched_setscheduler(0, SCHED_OTHER | resetOnFork, &defaultParam) == 0;
+#else
+		const int resetOnFork = 0;
+		const bool nice = true;
+#endif
+		if (pthread_setschedparam(pthread_self(), SCHED_FIFO | resetOnFork, &param) == 0) {
+			applied.scheduling = Scheduling::Realtime;
+		} else if (nice && setpriority(PRIO_PROCESS, id, -10) == 0) {
+			// On linux this only affects the calling thread.
+			applied.scheduling = Scheduling::Nice;
+		}
+	}
+#endif
+
+	auto &registry = detail::GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back({ name, id, registry.nextSerial++ });
+	return applied;
+}
+
+// Removes the calling thread from the registry, e.g. before it exits.
+inline void UnregisterCurrentThread() {
+	auto &registry = detail::GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+#ifdef _WIN32
+	const DWORD current = GetCurrentThreadId();
+	auto found = std::find_if(registry.threads.begin(), registry.threads.end(),
+		[&](const detail::Entry &entry) { return GetThreadId(entry.id) == current; });
+	if (found != registry.threads.end()) {
+		CloseHandle(found->id);
+		registry.threads.erase(found);
+	}
+#else
+	const pid_t current = (pid_t)syscall(SYS_gettid);
+	registry.threads.erase(std::remove_if(registry.threads.begin(), registry.threads.end(),
+		[&](const detail::Entry &entry) { return entry.id == current; }), registry.threads.end());
+#endif
+}
+
+// CPU time and context switches of a registered thread since it started, false if it's gone.
+inline bool GetCpuStats(detail::ThreadId id, CpuStats &stats) {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(id, &creation, &exit, &kernel, &user)) {
+		return false;
+	}
+	// 100 ns units
+	stats.userUs = (((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime) / 10;
+	stats.systemUs = (((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) / 10;
+	return true;
+#else
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/self/task/%d/stat", (int)id);
+	FILE *file = fopen(path, "r");
+	if (file == nullptr) {
+		return false;
+	}
+	char line[1024];
+	bool ok = fgets(line, sizeof(line), file) != nullptr;
+	fclose(file);
+	// The name field can contain spaces, the fields are counted from its closing parenthesis.
+	const char *fields = ok ? strrchr(line, ')') : nullptr;
+	unsigned long long utime, stime;
+	if (fields == nullptr ||
+		sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) != 2) {
+		return false;
+	}
+	const long ticks = sysconf(_SC_CLK_TCK);
+	stats.userUs = utime * 1000000 / ticks;
+	stats.systemUs = stime * 1000000 / ticks;
+
+	snprintf(path, sizeof(path), "/proc/self/task/%d/status", (int)id);
+	file = fopen(path, "r");
+	if (file != nullptr) {
+		unsigned long long value;
+		while (fgets(line, sizeof(line), file) != nullptr) {
+			if (sscanf(line, "voluntary_ctxt_switches: %llu", &value) == 1) {
+				stats.voluntarySwitches = value;
+			} else if (sscanf(line, "nonvoluntary_ctxt_switches: %llu", &value) == 1) {
+				stats.involuntarySwitches = value;
+			}
+		}
+		fclose(file);
+	}
+	return true;
+#endif
+}
+
+namespace detail {
+
+inline void ForEachEntry(const std::function<void(const Entry &, const CpuStats &)> &callback) {
+	auto &registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (auto entry = registry.threads.begin(); entry != registry.threads.end();) {
+		CpuStats stats;
+		if (GetCpuStats(entry->id, stats)) {
+			callback(*entry, stats);
+			++entry;
+		} else {
+#ifdef _WIN32
+			CloseHandle(entry->id);
+#endif
+			entry = registry.threads.erase(entry);
+		}
+	}
+}
+
+} // namespace detail
+
+// Calls callback with the name and stats of every registered thread which is still running.
+// The threads which are gone are dropped from the registry.
+inline void ForEachThread(const std::function<void(const std::string &, const CpuStats &)> &callback) {
+	detail::ForEachEntry([&](const detail::Entry &entry, const CpuStats &stats) { callback(entry.name, stats); });
+}
+
+// Periodic report of the registered threads: CPU usage and involuntary context switches per
+// second since the previous call. A thread which was created since, even with the name of a
+// thread which exited, is reported from the next call.
+class Reporter {
+public:
+	// callback gets the thread name, the CPU usage (1 = a whole core) and the involuntary
+	// switches per second.
+	void Report(uint64_t nowUs, const std::function<void(const std::string &, double, double)> &callback) {
+		std::vector<Sample> samples;
+		detail::ForEachEntry([&](const detail::Entry &entry, const CpuStats &stats) {
+			samples.push_back({ entry.name, entry.serial, stats });
+		});
+		if (m_lastReportUs != 0 && nowUs > m_lastReportUs) {
+			const double seconds = (nowUs - m_lastReportUs) / 1e6;
+			for (const auto &sample : samples) {
+				for (const auto &previous : m_previous) {
+					if (previous.serial == sample.serial) {
+						// A reused thread id can make an entry read another thread.
+						if (sample.stats.userUs + sample.stats.systemUs < previous.stats.userUs + previous.stats.systemUs ||
+							sample.stats.involuntarySwitches < previous.stats.involuntarySwitches) {
+							break;
+						}
+						uint64_t cpuUs = sample.stats.userUs + sample.stats.systemUs -
+							previous.stats.userUs - previous.stats.systemUs;
+						uint64_t switches = sample.stats.involuntarySwitches - previous.stats.involuntarySwitches;
+						callback(sample.name, cpuUs / 1e6 / seconds, switches / seconds);
+						break;
+					}
+				}
+			}
+		}
+		m_previous = std::move(samples);
+		m_lastReportUs = nowUs;
+	}
+
+private:
+	struct Sample {
+		std::string name;
+		uint64_t serial;
+		CpuStats stats;
+	};
+
+	std::vector<Sample> m_previous;
+	uint64_t m_lastReportUs = 0;
+};
+
+} // namespace thread_policy
@@ -49,6 +49,8 @@ void initializeSocket(void *v_env, void *v_instance, void *v_nalClass, unsigned
     g_socket.m_nalParser->setCodec(codec);
 
     LatencyCollector::Instance().resetAll();
+    // Dropped on the Rust side unless the server traces the frames.
+    LatencyCollector::Instance().setFrameTraceSend(frameTraceSend);
 }
 
 void processVideoSequence(uint32_t sequence) {
@@ -85,8 +87,12 @@ void legacyReceive(const unsigned char *packet, unsigned int packetSize) {
             }
             g_socket.m_lastFrameIndex = header->trackingFrameIndex;
         }
+        LatencyCollector::Instance().lastPacketReceived(header->trackingFrameIndex);
 
-        processVideoSequence(header->packetCounter);
+        // A retransmission is out of sequence, its loss was already counted.
+        if (!header->retransmitted) {
+            processVideoSequence(header->packetCounter);
+        }
 
         // Following packets of a video frame
         bool fecFailure = false;
@@ -154,6 +160,13 @@ void sendTimeSync() {
     timeSyncSend(timeSync);
 }
 
+unsigned long long legacyCheckVideoNack() {
+    if (!g_socket.m_nalParser) {
+        return 0;
+    }
+    return g_socket.m_nalParser->checkNack();
+}
+
 unsigned char isConnectedNative() {
     return g_socket.m_connected;
 }
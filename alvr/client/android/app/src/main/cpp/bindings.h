@@ -108,6 +108,22 @@ struct TimeSync {
     // Following value are filled by server only when mode=3.
     unsigned long long trackingRecvFrameIndex;
 };
+// Eye gaze, sampled at the eye tracker rate independently of TrackingInfo.
+// Client >----(ALVR_PACKET_TYPE_GAZE)----> Server
+struct GazeSample {
+    unsigned int type; // ALVR_PACKET_TYPE_GAZE
+    // Client clock, same as TrackingInfo::targetTimestampNs, of the eye tracker sample.
+    unsigned long long timestampNs;
+    // Combined gaze in head space, unit vector.
+    TrackingVector3 direction;
+    // 0 to 1, 0 if the eye tracker has no valid sample.
+    float confidence;
+    struct {
+        TrackingQuat orientation;
+        TrackingVector3 position;
+        unsigned int valid;
+    } eyes[2];
+};
 struct VideoFrame {
     unsigned int type; // ALVR_PACKET_TYPE_VIDEO_FRAME
     unsigned int packetCounter;
@@ -117,11 +133,50 @@ struct VideoFrame {
     // tracking rate).
     unsigned long long videoFrameIndex;
     unsigned long long sentTime;
+    // 0 for a repeat marker: no payload, show the previous frame with this tracking frame pose.
     unsigned int frameByteSize;
     unsigned int fecIndex;
     unsigned short fecPercentage;
+    // Encoded size, changes (on an IDR frame) when the server switches resolution level.
+    unsigned short frameWidth;
+    unsigned short frameHeight;
+    // The frame is split in fecGroupCount byte ranges, each protected by its own FEC with the
+    // fecPercentage of the packet. fecIndex counts from the start of the group.
+    unsigned char fecGroupIndex;
+    unsigned char fecGroupCount;
+    unsigned int fecGroupOffset;
+    unsigned int fecGroupByteSize;
+    // Position of the packet in the send order of the frame, the groups may be interleaved so
+    // packetCounter doesn't follow fecIndex. framePacketCount is the number of packets of the frame.
+    unsigned int framePacketIndex;
+    unsigned int framePacketCount;
+    unsigned char fecCodec; // ALVR_FEC_CODEC
+    // 1 if sent again on a NACK of the client, the header is the one of the first send.
+    unsigned char retransmitted;
     // char frameBuffer[];
 };
+// Packets fecIndex to fecIndex + count - 1 of a FEC group, asked again by the client.
+struct VideoNackRange {
+    unsigned char fecGroupIndex;
+    unsigned int fecIndex;
+    unsigned int count;
+};
+// Client stages of a frame for the frame trace of the server, in the clock of TimeSync::clientTime
+// (us), 0 when the frame didn't go through the stage.
+struct ClientFrameTrace {
+    unsigned long long trackingFrameIndex;
+    unsigned long long poseSent;
+    unsigned long long firstPacketReceived;
+    unsigned long long lastPacketReceived;
+    // The frame is whole, with FEC it usually is before the last packet arrives.
+    unsigned long long reconstructed;
+    unsigned long long decoderInput;
+    unsigned long long decoderOutput;
+    unsigned long long uploaded;
+    unsigned long long renderStart;
+    unsigned long long renderEnd;
+    unsigned long long submitted;
+};
 
 #ifndef ALXR_CLIENT
 struct OnCreateResult {
@@ -186,6 +241,9 @@ extern "C" GuardianData getGuardianData();
 extern "C" void
 initializeSocket(void *env, void *instance, void *nalClass, unsigned int codec, bool enableFEC);
 extern "C" void legacyReceive(const unsigned char *packet, unsigned int packetSize);
+// Call again after the returned time in us even if no packet comes, see FECQueue::nackDeadline().
+// 0 if no call is needed before the next packet.
+extern "C" unsigned long long legacyCheckVideoNack();
 extern "C" void sendTimeSync();
 extern "C" unsigned char isConnectedNative();
 extern "C" void closeSocket(void *env);
@@ -193,6 +251,10 @@ extern "C" void closeSocket(void *env);
 extern "C" void (*inputSend)(TrackingInfo data);
 extern "C" void (*timeSyncSend)(TimeSync data);
 extern "C" void (*videoErrorReportSend)();
+extern "C" void (*videoNackSend)(unsigned long long videoFrameIndex,
+                                 const VideoNackRange *ranges,
+                                 unsigned int rangeCount);
+extern "C" void (*frameTraceSend)(const ClientFrameTrace *trace);
 extern "C" void (*viewsConfigSend)(EyeFov fov[2], float ipd_m);
 extern "C" void (*batterySend)(unsigned long long device_path, float gauge_value, bool is_plugged);
 extern "C" unsigned long long (*pathStringToHash)(const char *path);
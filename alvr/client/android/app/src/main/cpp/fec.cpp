@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include "fec.h"
 #include "packet_types.h"
+#include "fec_cauchy16.h"
 #ifndef ALXR_CLIENT
 #include "utils.h"
 #else
@@ -17,7 +18,7 @@ namespace {
 
 std::once_flag FECQueue::reed_solomon_initialized{};
 
-FECQueue::FECQueue()
+FECQueue::FECQueue(std::shared_ptr<FrameBufferPool> pool)
 : m_currentFrame {
     .type = ALVR_PACKET_TYPE_VIDEO_FRAME,
     .packetCounter = 0,
@@ -28,12 +29,9 @@ FECQueue::FECQueue()
     .fecIndex = 0,
     .fecPercentage = 0
   },
-  m_shardPackets(0),
-  m_blockSize(0),
-  m_totalDataShards(0),
-  m_totalParityShards(0),
-  m_totalShards(0),
   m_firstPacketOfNextFrame(0),
+  m_firstPacketOfCurrentFrame(0),
+  m_pool(std::move(pool)),
   m_recovered(true),
   m_fecFailure(false)
 {
@@ -41,7 +39,12 @@ FECQueue::FECQueue()
 }
 
 // Add packet to queue. packet must point to buffer whose size=ALVR_MAX_PACKET_SIZE.
-void FECQueue::addVideoPacket(const VideoFrame *packet, int packetSize, bool &fecFailure) {
+void FECQueue::addVideoPacket(const VideoFrame *packet, int packetSize, bool &fecFailure,
+                              Clock::time_point now) {
+    if (packet->retransmitted && m_currentFrame.videoFrameIndex != packet->videoFrameIndex) {
+        // Too late, the frame was given up.
+        return;
+    }
     if (m_recovered && m_currentFrame.videoFrameIndex == packet->videoFrameIndex) {
         return;
     }
@@ -49,127 +52,246 @@ void FECQueue::addVideoPacket(const VideoFrame *packet, int packetSize, bool &fe
         // New frame
         if (!m_recovered) {
             FrameLog(m_currentFrame.trackingFrameIndex,
-                     "Previous frame cannot be recovered. videoFrame=%llu shards=%u:%u frameByteSize=%d"
-                     " fecPercentage=%d m_totalShards=%u m_shardPackets=%u m_blockSize=%u",
-                     m_currentFrame.videoFrameIndex,
-                     m_totalDataShards,
-                     m_totalParityShards,
-                     m_currentFrame.frameByteSize, m_currentFrame.fecPercentage, m_totalShards,
-                     m_shardPackets, m_blockSize);
-            for (size_t packet = 0; packet < m_shardPackets; packet++) {
-                FrameLog(m_currentFrame.trackingFrameIndex,
-                         "packetIndex=%d, shards=%u:%u",
-                         packet, m_receivedDataShards[packet], m_receivedParityShards[packet]);
+                     "Previous frame cannot be recovered. videoFrame=%llu frameByteSize=%d groups=%u",
+                     m_currentFrame.videoFrameIndex, m_currentFrame.frameByteSize, m_groups.size());
+            for (const auto &group : m_groups) {
+                logGroup(group);
             }
             fecFailure = m_fecFailure = true;
         }
         m_currentFrame = *packet;
         m_recovered = false;
-        m_rs.reset();
+        // The previous buffer may still be used by the decoder, it goes back to the pool once released.
+        m_frameBuffer = m_pool->acquire(m_currentFrame.frameByteSize);
+        m_lastPacketReceived = false;
+        m_nackSent = false;
+        m_firstArrivalIndex = m_lastArrivalIndex = packet->framePacketIndex;
+        m_firstArrival = m_lastArrival = now;
 
-        const uint32_t fecDataPackets = (packet->frameByteSize + ALVR_MAX_VIDEO_BUFFER_SIZE - 1) /
-                                  ALVR_MAX_VIDEO_BUFFER_SIZE;
-        m_shardPackets = CalculateFECShardPackets(m_currentFrame.frameByteSize,
-                                                  m_currentFrame.fecPercentage);
-        m_blockSize = m_shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+        // Older servers don't split frames, the whole frame is group 0.
+        m_groups.resize(std::max<size_t>(packet->fecGroupCount, 1));
+        for (auto &group : m_groups) {
+            group.started = false;
+            group.ready = false;
+            group.recovered = false;
+            group.rs.reset();
+        }
 
-        m_totalDataShards = (m_currentFrame.frameByteSize + m_blockSize - 1) / m_blockSize;
-        m_totalParityShards = CalculateParityShards(m_totalDataShards,
-                                                    m_currentFrame.fecPercentage);
-        m_totalShards = m_totalDataShards + m_totalParityShards;
+        // The end of the previous frame is checked against the start of the first group to come
+        // and set again from it, or from the last group for older servers.
+        m_firstPacketOfCurrentFrame = m_firstPacketOfNextFrame;
+        m_firstPacketOfNextFrame = 0;
 
-        m_recoveredPacket.clear();
-        m_recoveredPacket.resize(m_shardPackets);
+        FrameLog(m_currentFrame.trackingFrameIndex,
+                 "Start new frame. videoFrame=%llu frameByteSize=%d groups=%u",
+                 m_currentFrame.videoFrameIndex, m_currentFrame.frameByteSize, m_groups.size());
+    }
+    if (packet->framePacketCount != 0 && packet->framePacketIndex + 1 >= packet->framePacketCount) {
+        m_lastPacketReceived = true;
+    }
+    if (!packet->retransmitted && packet->framePacketIndex > m_lastArrivalIndex) {
+        m_lastArrivalIndex = packet->framePacketIndex;
+        m_lastArrival = now;
+    }
 
-        m_receivedDataShards.clear();
-        m_receivedDataShards.resize(m_shardPackets);
-        m_receivedParityShards.clear();
-        m_receivedParityShards.resize(m_shardPackets);
+    const size_t groupIndex = packet->fecGroupCount == 0 ? 0 : packet->fecGroupIndex;
+    if (groupIndex >= m_groups.size()) {
+        LOGE("Invalid FEC group. groupIndex=%d groupCount=%d", (int)groupIndex, (int)m_groups.size());
+        return;
+    }
+    Group &group = m_groups[groupIndex];
+    if (group.recovered) {
+        return;
+    }
+    if (!group.started) {
+        startGroup(group, packet, fecFailure);
+    }
+    if (!group.ready) {
+        return;
+    }
 
-        m_shards.resize(m_totalShards);
+    const size_t shardIndex = packet->fecIndex / group.shardPackets;
+    const size_t packetIndex = packet->fecIndex % group.shardPackets;
+    if (shardIndex >= group.totalShards) {
+        LOGE("Invalid FEC index. packetCounter=%d fecIndex=%d", packet->packetCounter, packet->fecIndex);
+        return;
+    }
+    if (group.marks[packetIndex][shardIndex] == 0) {
+        // Duplicate packet.
+        LOGI("Packet duplication. packetCounter=%d fecIndex=%d", packet->packetCounter,
+             packet->fecIndex);
+        return;
+    }
+    group.marks[packetIndex][shardIndex] = 0;
+    if (shardIndex < group.totalDataShards) {
+        group.receivedDataShards[packetIndex]++;
+    } else {
+        group.receivedParityShards[packetIndex]++;
+    }
 
-        m_rs.reset(reed_solomon_new(m_totalDataShards, m_totalParityShards));
-        if (m_rs == nullptr) {
+    std::byte *p = packetBuffer(group, packet->fecIndex);
+    char *payload = ((char *) packet) + sizeof(VideoFrame);
+    int payloadSize = packetSize - sizeof(VideoFrame);
+    memcpy(p, payload, payloadSize);
+    if (payloadSize != ALVR_MAX_VIDEO_BUFFER_SIZE) {
+        // Fill padding
+        memset(p + payloadSize, 0, ALVR_MAX_VIDEO_BUFFER_SIZE - payloadSize);
+    }
+}
+
+void FECQueue::addRepeatMarker(const VideoFrame *packet) {
+    if (m_firstPacketOfNextFrame == packet->packetCounter) {
+        m_firstPacketOfNextFrame++;
+    }
+}
+
+void FECQueue::startGroup(Group &group, const VideoFrame *packet, bool &fecFailure) {
+    group.started = true;
+    if (packet->fecGroupCount == 0) {
+        group.offset = 0;
+        group.byteSize = packet->frameByteSize;
+    } else {
+        group.offset = packet->fecGroupOffset;
+        group.byteSize = packet->fecGroupByteSize;
+    }
+    group.fecPercentage = packet->fecPercentage;
+    group.codec = packet->fecCodec;
+    if (group.byteSize == 0 || group.offset + group.byteSize > m_currentFrame.frameByteSize) {
+        LOGE("Invalid FEC group. offset=%u byteSize=%u frameByteSize=%u", group.offset,
+             group.byteSize, m_currentFrame.frameByteSize);
+        return;
+    }
+
+    const uint32_t fecDataPackets = (group.byteSize + ALVR_MAX_VIDEO_BUFFER_SIZE - 1) /
+                                    ALVR_MAX_VIDEO_BUFFER_SIZE;
+    if (group.codec == ALVR_FEC_CODEC_CAUCHY_GF16) {
+        group.shardPackets = CalculateFECCauchyShardPackets(group.byteSize, group.fecPercentage);
+    } else if (group.codec == ALVR_FEC_CODEC_REED_SOLOMON) {
+        group.shardPackets = CalculateFECShardPackets(group.byteSize, group.fecPercentage);
+    } else {
+        LOGE("Unknown FEC codec. codec=%d", group.codec);
+        return;
+    }
+    group.blockSize = group.shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+
+    group.totalDataShards = (group.byteSize + group.blockSize - 1) / group.blockSize;
+    group.totalParityShards = CalculateParityShards(group.totalDataShards, group.fecPercentage);
+    group.totalShards = group.totalDataShards + group.totalParityShards;
+
+    group.recoveredPacket.clear();
+    group.recoveredPacket.resize(group.shardPackets);
+
+    group.receivedDataShards.clear();
+    group.receivedDataShards.resize(group.shardPackets);
+    group.receivedParityShards.clear();
+    group.receivedParityShards.resize(group.shardPackets);
+
+    group.shards.resize(group.totalShards);
+
+    if (group.codec == ALVR_FEC_CODEC_CAUCHY_GF16) {
+        if (group.totalShards > fec_cauchy16::SHARDS_MAX) {
+            LOGE("Too many FEC shards. totalShards=%u", (uint32_t)group.totalShards);
             return;
         }
-
-        m_marks.resize(m_shardPackets);
-        for (size_t i = 0; i < m_shardPackets; i++) {
-            m_marks[i].resize(m_totalShards);
-            memset(&m_marks[i][0], 1, m_totalShards);
+    } else {
+        group.rs.reset(reed_solomon_new(group.totalDataShards, group.totalParityShards));
+        if (group.rs == nullptr) {
+            return;
         }
+    }
+    group.ready = true;
 
-        if (m_frameBuffer.size() < m_totalShards * m_blockSize) {
-            // Only expand buffer for performance reason.
-            m_frameBuffer.resize(m_totalShards * m_blockSize);
-        }
-        memset(&m_frameBuffer[0], 0, m_totalShards * m_blockSize);
+    group.marks.resize(group.shardPackets);
+    for (size_t i = 0; i < group.shardPackets; i++) {
+        group.marks[i].resize(group.totalShards);
+        memset(&group.marks[i][0], 1, group.totalShards);
+    }
 
-        // Padding packets are not sent, so we can fill bitmap by default.
-        const size_t padding = (m_shardPackets - fecDataPackets % m_shardPackets) % m_shardPackets;
-        for (size_t i = 0; i < padding; i++) {
-            m_marks[m_shardPackets - i - 1][m_totalDataShards - 1] = 0;
-            m_receivedDataShards[m_shardPackets - i - 1]++;
-        }
+    group.fullPackets = group.byteSize / ALVR_MAX_VIDEO_BUFFER_SIZE;
+    // Zeroed, the padding packets are not sent.
+    group.tail.assign((group.totalDataShards * group.shardPackets - group.fullPackets) * ALVR_MAX_VIDEO_BUFFER_SIZE,
+                      std::byte{0});
+    group.parity.resize(group.totalParityShards * group.blockSize);
 
-        // Calculate last packet counter of current frame to detect whole frame packet loss.
-        uint32_t startPacket;
-        uint32_t nextStartPacket;
-        if(m_currentFrame.fecIndex / m_shardPackets < m_totalDataShards) {
-            // First seen packet was data packet
-            startPacket = m_currentFrame.packetCounter - m_currentFrame.fecIndex;
-            nextStartPacket = m_currentFrame.packetCounter - m_currentFrame.fecIndex + m_totalShards * m_shardPackets - padding;
-        }else{
-            // was parity packet
-            startPacket = m_currentFrame.packetCounter - (m_currentFrame.fecIndex - padding);
-            uint64_t m_startOfParityPacket = m_currentFrame.packetCounter - (m_currentFrame.fecIndex - m_totalDataShards * m_shardPackets);
-            nextStartPacket = m_startOfParityPacket + m_totalParityShards * m_shardPackets;
-        }
-        if(m_firstPacketOfNextFrame != 0 && m_firstPacketOfNextFrame != startPacket) {
+    // Padding packets are not sent, so we can fill bitmap by default.
+    const size_t padding = (group.shardPackets - fecDataPackets % group.shardPackets) % group.shardPackets;
+    for (size_t i = 0; i < padding; i++) {
+        group.marks[group.shardPackets - i - 1][group.totalDataShards - 1] = 0;
+        group.receivedDataShards[group.shardPackets - i - 1]++;
+    }
+
+    // Calculate last packet counter of current frame to detect whole frame packet loss.
+    uint32_t startPacket;
+    uint32_t nextStartPacket;
+    if (packet->framePacketCount != 0) {
+        // The packets of the groups can be interleaved, the bounds come from the send order.
+        startPacket = packet->packetCounter - packet->framePacketIndex;
+        nextStartPacket = startPacket + packet->framePacketCount;
+    } else if(packet->fecIndex / group.shardPackets < group.totalDataShards) {
+        // Older servers send the groups in order, each one data then parity.
+        // First seen packet was data packet
+        startPacket = packet->packetCounter - packet->fecIndex;
+        nextStartPacket = packet->packetCounter - packet->fecIndex + group.totalShards * group.shardPackets - padding;
+    }else{
+        // was parity packet
+        startPacket = packet->packetCounter - (packet->fecIndex - padding);
+        uint64_t m_startOfParityPacket = packet->packetCounter - (packet->fecIndex - group.totalDataShards * group.shardPackets);
+        nextStartPacket = m_startOfParityPacket + group.totalParityShards * group.shardPackets;
+    }
+    // With framePacketCount every group knows the bounds of the frame, so they don't depend on the
+    // first or last group arriving.
+    const bool frameBounds = packet->framePacketCount != 0;
+    if (frameBounds || &group == &m_groups.front()) {
+        if (m_firstPacketOfCurrentFrame != 0 && m_firstPacketOfCurrentFrame != startPacket) {
             // Whole frame packet loss
             FrameLog(m_currentFrame.trackingFrameIndex,
-                     "Previous frame was completely lost. videoFrame=%llu shards=%u:%u frameByteSize=%d fecPercentage=%d m_totalShards=%u "
-                     "m_shardPackets=%u m_blockSize=%u m_firstPacketOfNextFrame=%u startPacket=%u currentPacket=%u",
-                     m_currentFrame.videoFrameIndex, m_totalDataShards, m_totalParityShards,
-                     m_currentFrame.frameByteSize, m_currentFrame.fecPercentage, m_totalShards,
-                     m_shardPackets, m_blockSize, m_firstPacketOfNextFrame, startPacket, m_currentFrame.packetCounter);
-            for (size_t packet = 0; packet < m_shardPackets; packet++) {
-                FrameLog(m_currentFrame.trackingFrameIndex,
-                         "packetIndex=%d, shards=%u:%u",
-                         packet, m_receivedDataShards[packet], m_receivedParityShards[packet]);
-            }
+                     "Previous frame was completely lost. videoFrame=%llu frameByteSize=%d"
+                     " m_firstPacketOfNextFrame=%u startPacket=%u currentPacket=%u",
+                     m_currentFrame.videoFrameIndex, m_currentFrame.frameByteSize,
+                     m_firstPacketOfCurrentFrame, startPacket, packet->packetCounter);
+            logGroup(group);
             fecFailure = m_fecFailure = true;
         }
+        // Checked once per frame.
+        m_firstPacketOfCurrentFrame = 0;
+    }
+    if (frameBounds || &group == &m_groups.back()) {
         m_firstPacketOfNextFrame = nextStartPacket;
+    }
 
-        FrameLog(m_currentFrame.trackingFrameIndex,
-                 "Start new frame. videoFrame=%llu frameByteSize=%d fecPercentage=%d m_totalDataShards=%u m_totalParityShards=%u"
-                 " m_totalShards=%u m_shardPackets=%u m_blockSize=%u",
-                 m_currentFrame.videoFrameIndex, m_currentFrame.frameByteSize, m_currentFrame.fecPercentage, m_totalDataShards,
-                 m_totalParityShards, m_totalShards, m_shardPackets, m_blockSize);
-    }
-    const size_t shardIndex = packet->fecIndex / m_shardPackets;
-    const size_t packetIndex = packet->fecIndex % m_shardPackets;
-    if (m_marks[packetIndex][shardIndex] == 0) {
-        // Duplicate packet.
-        LOGI("Packet duplication. packetCounter=%d fecIndex=%d", packet->packetCounter,
-             packet->fecIndex);
-        return;
+    FrameLog(m_currentFrame.trackingFrameIndex,
+             "Start new FEC group. videoFrame=%llu group=%u/%u offset=%u byteSize=%u codec=%d fecPercentage=%d"
+             " totalDataShards=%u totalParityShards=%u totalShards=%u shardPackets=%u blockSize=%u",
+             m_currentFrame.videoFrameIndex, (uint32_t)(&group - &m_groups[0]), m_groups.size(),
+             group.offset, group.byteSize, group.codec, group.fecPercentage, group.totalDataShards,
+             group.totalParityShards, group.totalShards, group.shardPackets, group.blockSize);
+}
+
+std::byte *FECQueue::packetBuffer(Group &group, size_t fecIndex) {
+    if (fecIndex < group.fullPackets) {
+        return &(*m_frameBuffer)[group.offset + fecIndex * ALVR_MAX_VIDEO_BUFFER_SIZE];
     }
-    m_marks[packetIndex][shardIndex] = 0;
-    if (shardIndex < m_totalDataShards) {
-        m_receivedDataShards[packetIndex]++;
-    } else {
-        m_receivedParityShards[packetIndex]++;
+    const size_t dataPackets = group.totalDataShards * group.shardPackets;
+    if (fecIndex < dataPackets) {
+        return &group.tail[(fecIndex - group.fullPackets) * ALVR_MAX_VIDEO_BUFFER_SIZE];
     }
+    return &group.parity[(fecIndex - dataPackets) * ALVR_MAX_VIDEO_BUFFER_SIZE];
+}
 
-    std::byte *p = &m_frameBuffer[packet->fecIndex * ALVR_MAX_VIDEO_BUFFER_SIZE];
-    char *payload = ((char *) packet) + sizeof(VideoFrame);
-    int payloadSize = packetSize - sizeof(VideoFrame);
-    memcpy(p, payload, payloadSize);
-    if (payloadSize != ALVR_MAX_VIDEO_BUFFER_SIZE) {
-        // Fill padding
-        memset(p + payloadSize, 0, ALVR_MAX_VIDEO_BUFFER_SIZE - payloadSize);
+void FECQueue::logGroup(const Group &group) const {
+    FrameLog(m_currentFrame.trackingFrameIndex,
+             "group=%u offset=%u byteSize=%u fecPercentage=%d shards=%u:%u totalShards=%u"
+             " shardPackets=%u blockSize=%u",
+             (uint32_t)(&group - &m_groups[0]), group.offset, group.byteSize, group.fecPercentage,
+             group.totalDataShards, group.totalParityShards, group.totalShards,
+             group.shardPackets, group.blockSize);
+    if (!group.ready) {
+        return;
+    }
+    for (size_t packet = 0; packet < group.shardPackets; packet++) {
+        FrameLog(m_currentFrame.trackingFrameIndex,
+                 "packetIndex=%d, shards=%u:%u",
+                 packet, group.receivedDataShards[packet], group.receivedParityShards[packet]);
     }
 }
 
@@ -178,62 +300,87 @@ bool FECQueue::reconstruct() {
         return false;
     }
 
+    bool ret = true;
+    for (auto &group : m_groups) {
+        if (!group.recovered && !(group.ready && reconstructGroup(group))) {
+            ret = false;
+        }
+    }
+    if (!ret) {
+        return false;
+    }
+
+    // Only the partial last data packet of each group is left to copy.
+    for (const auto &group : m_groups) {
+        const size_t fullBytes = group.fullPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+        if (group.byteSize > fullBytes) {
+            memcpy(&(*m_frameBuffer)[group.offset + fullBytes], &group.tail[0], group.byteSize - fullBytes);
+        }
+    }
+    FrameBufferPool::clearPadding(*m_frameBuffer, m_currentFrame.frameByteSize);
+    m_recovered = true;
+    FrameLog(m_currentFrame.trackingFrameIndex, "Frame was successfully recovered by FEC.");
+    return true;
+}
+
+bool FECQueue::reconstructGroup(Group &group) {
     bool ret = true;
     // On server side, we encoded all buffer in one call of reed_solomon_encode.
     // But client side, we should split shards for more resilient recovery.
-    for (size_t packet = 0; packet < m_shardPackets; ++packet) {
-        if (m_recoveredPacket[packet]) {
+    for (size_t packet = 0; packet < group.shardPackets; ++packet) {
+        if (group.recoveredPacket[packet]) {
             continue;
         }
-        if (m_receivedDataShards[packet] == m_totalDataShards) {
+        if (group.receivedDataShards[packet] == group.totalDataShards) {
             // We've received a full packet with no need for FEC.
-            //FrameLog(m_currentFrame.frameIndex, "No need for FEC. packetIndex=%d", packet);
-            m_recoveredPacket[packet] = true;
+            group.recoveredPacket[packet] = true;
             continue;
         }
-        m_rs->shards = m_receivedDataShards[packet] +
-                       m_receivedParityShards[packet]; //Don't let RS complain about missing parity packets
-
-        if (m_rs->shards < (int) m_totalDataShards) {
+        if (group.receivedDataShards[packet] + group.receivedParityShards[packet] < group.totalDataShards) {
             // Not enough parity data
             ret = false;
             continue;
         }
 
         FrameLog(m_currentFrame.trackingFrameIndex,
-                 "Recovering. packetIndex=%d receivedDataShards=%d/%d receivedParityShards=%d/%d",
-                 packet, m_receivedDataShards[packet], m_totalDataShards,
-                 m_receivedParityShards[packet], m_totalParityShards);
+                 "Recovering. group=%u packetIndex=%d receivedDataShards=%d/%d receivedParityShards=%d/%d",
+                 (uint32_t)(&group - &m_groups[0]), packet, group.receivedDataShards[packet],
+                 group.totalDataShards, group.receivedParityShards[packet], group.totalParityShards);
 
-        for (size_t i = 0; i < m_totalShards; ++i) {
-            m_shards[i] = &m_frameBuffer[(i * m_shardPackets + packet) * ALVR_MAX_VIDEO_BUFFER_SIZE];
+        for (size_t i = 0; i < group.totalShards; ++i) {
+            group.shards[i] = packetBuffer(group, i * group.shardPackets + packet);
         }
 
-        int result = reed_solomon_reconstruct(m_rs.get(), (unsigned char**)&m_shards[0],
-                                              &m_marks[packet][0],
-                                              m_totalShards, ALVR_MAX_VIDEO_BUFFER_SIZE);
-        m_recoveredPacket[packet] = true;
+        int result;
+        if (group.codec == ALVR_FEC_CODEC_CAUCHY_GF16) {
+            result = fec_cauchy16::Reconstruct((uint8_t **)&group.shards[0], &group.marks[packet][0],
+                                               group.totalDataShards, group.totalParityShards,
+                                               ALVR_MAX_VIDEO_BUFFER_SIZE) ? 0 : -1;
+        } else {
+            //Don't let RS complain about missing parity packets
+            group.rs->shards = group.receivedDataShards[packet] + group.receivedParityShards[packet];
+            result = reed_solomon_reconstruct(group.rs.get(), (unsigned char**)&group.shards[0],
+                                              &group.marks[packet][0],
+                                              group.totalShards, ALVR_MAX_VIDEO_BUFFER_SIZE);
+        }
+        group.recoveredPacket[packet] = true;
         // We should always provide enough parity to recover the missing data successfully.
         // If this fails, something is probably wrong with our FEC state.
         if (result != 0) {
             LOGE("reed_solomon_reconstruct failed.");
             return false;
         }
-        /*
-        for(int i = 0; i < m_totalShards * m_shardPackets; i++) {
-            char *p = &frameBuffer[ALVR_MAX_VIDEO_BUFFER_SIZE * i];
-            LOGI("Reconstructed packets. i=%d shardIndex=%d buffer=[%02X %02X %02X %02X %02X ...]", i, i / m_shardPackets, p[0], p[1], p[2], p[3], p[4]);
-        }*/
-    }
-    if (ret) {
-        m_recovered = true;
-        FrameLog(m_currentFrame.trackingFrameIndex, "Frame was successfully recovered by FEC.");
     }
+    group.recovered = ret;
     return ret;
 }
 
 const std::byte *FECQueue::getFrameBuffer() const {
-    return &m_frameBuffer[0];
+    return &(*m_frameBuffer)[0];
+}
+
+const FrameBufferPool::BufferPtr &FECQueue::getFrameBufferRef() const {
+    return m_frameBuffer;
 }
 
 int FECQueue::getFrameByteSize() const {
@@ -247,3 +394,67 @@ bool FECQueue::fecFailure() const {
 void FECQueue::clearFecFailure() {
     m_fecFailure = false;
 }
+
+std::optional<FECQueue::Clock::time_point> FECQueue::nackDeadline() const {
+    if (m_recovered || m_nackSent || m_currentFrame.framePacketCount == 0) {
+        return std::nullopt;
+    }
+    // The packets are paced at about the same rate over the frame.
+    Clock::duration interval{0};
+    if (m_lastArrivalIndex > m_firstArrivalIndex) {
+        interval = (m_lastArrival - m_firstArrival) / (m_lastArrivalIndex - m_firstArrivalIndex);
+    }
+    const auto remaining = (int64_t)m_currentFrame.framePacketCount - 1 - m_lastArrivalIndex;
+    return m_lastArrival + interval * (std::max<int64_t>(remaining, 0) + NACK_MARGIN_PACKETS) +
+           NACK_MARGIN;
+}
+
+bool FECQueue::takeNack(uint64_t &videoFrameIndex, std::vector<VideoNackRange> &ranges,
+                        Clock::time_point now) {
+    if (m_recovered || m_nackSent) {
+        return false;
+    }
+    if (!m_lastPacketReceived) {
+        const auto deadline = nackDeadline();
+        if (!deadline || now < *deadline) {
+            return false;
+        }
+    }
+    m_nackSent = true;
+
+    ranges.clear();
+    for (size_t groupIndex = 0; groupIndex < m_groups.size(); groupIndex++) {
+        const Group &group = m_groups[groupIndex];
+        if (group.recovered) {
+            continue;
+        }
+        if (!group.started) {
+            ranges.push_back({(unsigned char)groupIndex, 0, UINT32_MAX});
+            continue;
+        }
+        if (!group.ready) {
+            continue;
+        }
+        // In fecIndex order, so the packets of consecutive shards merge in one range when a shard
+        // is one packet.
+        for (size_t shard = 0; shard < group.totalDataShards; shard++) {
+            for (size_t packet = 0; packet < group.shardPackets; packet++) {
+                if (group.marks[packet][shard] == 0 || group.receivedDataShards[packet] +
+                    group.receivedParityShards[packet] >= group.totalDataShards) {
+                    continue;
+                }
+                const auto fecIndex = (uint32_t)(shard * group.shardPackets + packet);
+                if (!ranges.empty() && ranges.back().fecGroupIndex == groupIndex &&
+                    ranges.back().fecIndex + ranges.back().count == fecIndex) {
+                    ranges.back().count++;
+                } else {
+                    ranges.push_back({(unsigned char)groupIndex, fecIndex, 1});
+                }
+            }
+        }
+    }
+    videoFrameIndex = m_currentFrame.videoFrameIndex;
+    FrameLog(m_currentFrame.trackingFrameIndex, "NACK. videoFrame=%llu ranges=%u",
+             m_currentFrame.videoFrameIndex, (uint32_t)ranges.size());
+    return !ranges.empty();
+}
@@ -1,41 +1,53 @@
 #ifndef ALVRCLIENT_FEC_H
 #define ALVRCLIENT_FEC_H
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <mutex>
 #include "packet_types.h"
+#include "frame_buffer_pool.h"
 #include "reedsolomon/rs.h"
 
 class FECQueue {
 public:
-    FECQueue();
+    using Clock = std::chrono::steady_clock;
 
-    void addVideoPacket(const VideoFrame *packet, int packetSize, bool &fecFailure);
+    // Margin over the expected end of the frame before the missing packets are asked again.
+    static constexpr std::chrono::microseconds NACK_MARGIN{2000};
+    // Plus this many packet intervals, the packets are paced.
+    static constexpr int NACK_MARGIN_PACKETS = 4;
+
+    // Frame buffers come from pool, the reconstructed frame can be kept by the decoder while the
+    // queue moves on to the next frame.
+    explicit FECQueue(std::shared_ptr<FrameBufferPool> pool = FrameBufferPool::Create());
+
+    // now is the arrival time of the packet.
+    void addVideoPacket(const VideoFrame *packet, int packetSize, bool &fecFailure,
+                        Clock::time_point now = Clock::now());
+    // Repeat markers consume a packet counter without going through the queue.
+    void addRepeatMarker(const VideoFrame *packet);
     bool reconstruct();
     const std::byte *getFrameBuffer() const;
+    // Buffer holding the reconstructed frame at offset 0, followed by zeroed padding.
+    const FrameBufferPool::BufferPtr &getFrameBufferRef() const;
     int getFrameByteSize() const;
 
     bool fecFailure() const;
     void clearFecFailure();
-private:
-
-    VideoFrame m_currentFrame;
-    size_t m_shardPackets;
-    size_t m_blockSize;
-    size_t m_totalDataShards;
-    size_t m_totalParityShards;
-    size_t m_totalShards;
-    uint32_t m_firstPacketOfNextFrame = 0;
-    std::vector<std::vector<unsigned char>> m_marks;
-    std::vector<std::byte> m_frameBuffer;
-    std::vector<uint32_t> m_receivedDataShards;
-    std::vector<uint32_t> m_receivedParityShards;
-    std::vector<bool> m_recoveredPacket;
-    std::vector<std::byte *> m_shards;
-    bool m_recovered;
-    bool m_fecFailure;
 
+    // Packets of the current frame to ask the server again for, once per frame: when its last
+    // packet in send order came and reconstruct() still fails, or when the last packets are lost
+    // too, at nackDeadline(). Only the missing data packets of the packet rows short of shards, or
+    // the whole group if none of it came.
+    bool takeNack(uint64_t &videoFrameIndex, std::vector<VideoNackRange> &ranges,
+                  Clock::time_point now = Clock::now());
+    // Expected end of the current frame plus the margins, from the arrival rate of its packets
+    // so far. Empty when no NACK is pending. takeNack() has to be called again at that time even
+    // if no packet comes.
+    std::optional<Clock::time_point> nackDeadline() const;
+private:
     struct reed_solomon_deleter {
         inline void operator()(reed_solomon* rs_ptr) const {
             if (rs_ptr != nullptr) {
@@ -44,7 +56,58 @@ private:
         }
     };
     using reed_solomon_ptr = std::unique_ptr<reed_solomon, reed_solomon_deleter>;
-    reed_solomon_ptr m_rs{ nullptr };
+
+    // Byte range of the frame protected by its own FEC (unequal error protection), the whole
+    // frame when the server doesn't split it.
+    struct Group {
+        bool started = false;
+        // The layout is valid and the decoder set up.
+        bool ready = false;
+        bool recovered = false;
+        int codec = ALVR_FEC_CODEC_REED_SOLOMON;
+        uint32_t offset = 0;
+        uint32_t byteSize = 0;
+        int fecPercentage = 0;
+        size_t shardPackets = 0;
+        size_t blockSize = 0;
+        size_t totalDataShards = 0;
+        size_t totalParityShards = 0;
+        size_t totalShards = 0;
+        std::vector<std::vector<unsigned char>> marks;
+        // The data packets which are whole inside the group go straight to the frame buffer at
+        // offset, the partial last one and the padding packets to tail, the parity to parity.
+        size_t fullPackets = 0;
+        std::vector<std::byte> tail;
+        std::vector<std::byte> parity;
+        std::vector<uint32_t> receivedDataShards;
+        std::vector<uint32_t> receivedParityShards;
+        std::vector<bool> recoveredPacket;
+        std::vector<std::byte *> shards;
+        // ALVR_FEC_CODEC_REED_SOLOMON only
+        reed_solomon_ptr rs{ nullptr };
+    };
+
+    void startGroup(Group &group, const VideoFrame *packet, bool &fecFailure);
+    std::byte *packetBuffer(Group &group, size_t fecIndex);
+    bool reconstructGroup(Group &group);
+    void logGroup(const Group &group) const;
+
+    VideoFrame m_currentFrame;
+    uint32_t m_firstPacketOfNextFrame = 0;
+    uint32_t m_firstPacketOfCurrentFrame = 0;
+    std::vector<Group> m_groups;
+    std::shared_ptr<FrameBufferPool> m_pool;
+    // The current frame, every group is reassembled and reconstructed in place.
+    FrameBufferPool::BufferPtr m_frameBuffer;
+    bool m_recovered;
+    bool m_fecFailure;
+    bool m_lastPacketReceived = false;
+    bool m_nackSent = false;
+    // First and latest packets of the current frame in send order, retransmissions excluded.
+    uint32_t m_firstArrivalIndex = 0;
+    Clock::time_point m_firstArrival;
+    uint32_t m_lastArrivalIndex = 0;
+    Clock::time_point m_lastArrival;
 
     static std::once_flag reed_solomon_initialized;
 };
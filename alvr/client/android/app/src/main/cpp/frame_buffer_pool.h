@@ -0,0 +1,83 @@
+#ifndef ALVRCLIENT_FRAME_BUFFER_POOL_H
+#define ALVRCLIENT_FRAME_BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Recycled frame buffers shared by FECQueue and the decoders.
+// A buffer is refcounted with std::shared_ptr, it goes back to the pool when the last
+// reference (e.g. the decoder's AVBufferRef) is released, even if the pool was destroyed
+// in the meantime. Buffers always keep PaddingSize bytes after the requested size so they
+// can be handed to libavcodec without a copy.
+class FrameBufferPool {
+public:
+    // >= AV_INPUT_BUFFER_PADDING_SIZE, checked where the buffers are given to libavcodec.
+    static constexpr std::size_t PaddingSize = 64;
+    // Buffers kept for reuse, more are freed when released.
+    static constexpr std::size_t MaxFreeBuffers = 8;
+
+    using Buffer = std::vector<std::byte>;
+    using BufferPtr = std::shared_ptr<Buffer>;
+
+    static std::shared_ptr<FrameBufferPool> Create() {
+        return std::shared_ptr<FrameBufferPool>(new FrameBufferPool());
+    }
+
+    // Returns a buffer of at least size + PaddingSize bytes, its content is undefined.
+    BufferPtr acquire(std::size_t size) {
+        std::unique_ptr<Buffer> buffer;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            auto &freeBuffers = m_state->freeBuffers;
+            if (!freeBuffers.empty()) {
+                // Prefer a buffer which is already big enough, frame sizes vary a lot.
+                auto it = freeBuffers.end() - 1;
+                for (auto i = freeBuffers.begin(); i != freeBuffers.end(); ++i) {
+                    if ((*i)->size() >= size + PaddingSize) {
+                        it = i;
+                        break;
+                    }
+                }
+                buffer = std::move(*it);
+                freeBuffers.erase(it);
+            }
+        }
+        if (buffer == nullptr) {
+            buffer = std::make_unique<Buffer>();
+        }
+        if (buffer->size() < size + PaddingSize) {
+            buffer->resize(size + PaddingSize);
+        }
+        std::weak_ptr<State> state = m_state;
+        return BufferPtr(buffer.release(), [state](Buffer *released) {
+            if (const auto pool = state.lock()) {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                if (pool->freeBuffers.size() < MaxFreeBuffers) {
+                    pool->freeBuffers.emplace_back(released);
+                    return;
+                }
+            }
+            delete released;
+        });
+    }
+
+    // Zeroes the padding after the first size bytes of buffer.
+    static void clearPadding(Buffer &buffer, std::size_t size) {
+        memset(&buffer[size], 0, PaddingSize);
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Buffer>> freeBuffers;
+    };
+
+    FrameBufferPool() : m_state(std::make_shared<State>()) {}
+
+    std::shared_ptr<State> m_state;
+};
+
+#endif //ALVRCLIENT_FRAME_BUFFER_POOL_H
@@ -1,7 +1,14 @@
 #include "latency_collector.h"
+#include "bindings.h"
 #ifndef ALXR_CLIENT
     #include "utils.h"
-    #include "bindings.h"
+
+namespace {
+    // TimeSync is on the same clock.
+    inline int64_t getTimeSyncClockOffsetUs() {
+        return 0;
+    }
+}
 #else
 #include <chrono>
 
@@ -31,6 +38,12 @@ namespace {
         using microsecondsU64 = duration<std::uint64_t, microseconds::period>;
         return duration_cast<microsecondsU64>(ClockType::now().time_since_epoch()).count();
     }
+    // TimeSync is on the system clock.
+    inline std::int64_t getTimeSyncClockOffsetUs() {
+        using namespace std::chrono;
+        const auto systemUs = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+        return static_cast<std::int64_t>(systemUs) - static_cast<std::int64_t>(getTimestampUs());
+    }
     inline void FrameLog(...) {}
 }
 #endif
@@ -41,14 +54,29 @@ LatencyCollector::LatencyCollector()
 : m_StatisticsTime(getTimestampUs() / USECS_IN_SEC) {
 }
 
-LatencyCollector::FrameTimestamp &LatencyCollector::getFrame(uint64_t frameIndex) {
-    std::scoped_lock<std::mutex> lock(m_framesMutex);
-    if (m_Frames.size() > MAX_FRAMES) {
-        m_Frames.erase(m_Frames.cbegin());
+LatencyCollector::FrameSlot &LatencyCollector::getFrame(uint64_t frameIndex) {
+    // Fibonacci hashing, frame indices are either counters or nanosecond timestamps.
+    auto &slot = m_Frames[(frameIndex * 0x9E3779B97F4A7C15ull) >> (64 - MAX_FRAMES_LOG2)];
+    uint64_t staleIndex = slot.frameIndex.load(std::memory_order_relaxed);
+    if (staleIndex == frameIndex) {
+        return slot;
+    }
+    uint64_t staleTimestamps[std::size(FRAME_FIELDS)];
+    for (size_t i = 0; i < std::size(FRAME_FIELDS); i++) {
+        staleTimestamps[i] = (slot.*FRAME_FIELDS[i]).load(std::memory_order_relaxed);
+    }
+    // Only the thread taking over the slot clears it, and a timestamp another thread already
+    // wrote for the new frame is kept.
+    if (slot.frameIndex.compare_exchange_strong(staleIndex, frameIndex, std::memory_order_relaxed)) {
+        for (size_t i = 0; i < std::size(FRAME_FIELDS); i++) {
+            (slot.*FRAME_FIELDS[i]).compare_exchange_strong(staleTimestamps[i], 0, std::memory_order_relaxed);
+        }
     }
-    auto &frame = m_Frames[frameIndex];
-    frame.frameIndex = frameIndex;
-    return frame;
+    return slot;
+}
+
+void LatencyCollector::setTimestamp(uint64_t frameIndex, FrameField field, uint64_t timestamp) {
+    (getFrame(frameIndex).*field).store(timestamp, std::memory_order_relaxed);
 }
 
 void LatencyCollector::setTotalLatency(uint32_t latency) {
@@ -56,36 +84,56 @@ void LatencyCollector::setTotalLatency(uint32_t latency) {
         m_ServerTotalLatency.store(latency * 0.05 + m_ServerTotalLatency.load() * 0.95);
 }
 void LatencyCollector::tracking(uint64_t frameIndex) {
-    getFrame(frameIndex).tracking = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::tracking, getTimestampUs());
 }
 void LatencyCollector::estimatedSent(uint64_t frameIndex, uint64_t offset) {
-    getFrame(frameIndex).estimatedSent = getTimestampUs() + offset;
+    setTimestamp(frameIndex, &FrameSlot::estimatedSent, getTimestampUs() + offset);
 }
 void LatencyCollector::received(uint64_t frameIndex) {
-    getFrame(frameIndex).received = getTimestampUs(); // Round trip
+    setTimestamp(frameIndex, &FrameSlot::received, getTimestampUs()); // Round trip
 }
 void LatencyCollector::receivedFirst(uint64_t frameIndex) {
-    getFrame(frameIndex).receivedFirst = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::receivedFirst, getTimestampUs());
 }
 void LatencyCollector::receivedLast(uint64_t frameIndex) {
-    getFrame(frameIndex).receivedLast = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::receivedLast, getTimestampUs());
+}
+void LatencyCollector::lastPacketReceived(uint64_t frameIndex) {
+    setTimestamp(frameIndex, &FrameSlot::lastPacket, getTimestampUs());
 }
 void LatencyCollector::decoderInput(uint64_t frameIndex) {
-    getFrame(frameIndex).decoderInput = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::decoderInput, getTimestampUs());
 }
 void LatencyCollector::decoderOutput(uint64_t frameIndex) {
-    getFrame(frameIndex).decoderOutput = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::decoderOutput, getTimestampUs());
+}
+void LatencyCollector::uploaded(uint64_t frameIndex) {
+    setTimestamp(frameIndex, &FrameSlot::uploaded, getTimestampUs());
 }
 void LatencyCollector::rendered1(uint64_t frameIndex) {
-    getFrame(frameIndex).rendered1 = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::rendered1, getTimestampUs());
 }
 void LatencyCollector::rendered2(uint64_t frameIndex) {
-    getFrame(frameIndex).rendered2 = getTimestampUs();
+    setTimestamp(frameIndex, &FrameSlot::rendered2, getTimestampUs());
 }
 
 void LatencyCollector::submit(uint64_t frameIndex) {
-    FrameTimestamp timestamp = getFrame(frameIndex);
+    auto &slot = getFrame(frameIndex);
+    FrameTimestamp timestamp;
+    timestamp.frameIndex = frameIndex;
+    timestamp.tracking = slot.tracking.load(std::memory_order_relaxed);
+    timestamp.estimatedSent = slot.estimatedSent.load(std::memory_order_relaxed);
+    timestamp.received = slot.received.load(std::memory_order_relaxed);
+    timestamp.receivedFirst = slot.receivedFirst.load(std::memory_order_relaxed);
+    timestamp.receivedLast = slot.receivedLast.load(std::memory_order_relaxed);
+    timestamp.lastPacket = slot.lastPacket.load(std::memory_order_relaxed);
+    timestamp.decoderInput = slot.decoderInput.load(std::memory_order_relaxed);
+    timestamp.decoderOutput = slot.decoderOutput.load(std::memory_order_relaxed);
+    timestamp.uploaded = slot.uploaded.load(std::memory_order_relaxed);
+    timestamp.rendered1 = slot.rendered1.load(std::memory_order_relaxed);
+    timestamp.rendered2 = slot.rendered2.load(std::memory_order_relaxed);
     timestamp.submit = getTimestampUs();
+    slot.submit.store(timestamp.submit, std::memory_order_relaxed);
 
     m_Latency[0] = timestamp.submit - timestamp.tracking;
     if (timestamp.decoderInput >= timestamp.decoderOutput)
@@ -105,6 +153,7 @@ void LatencyCollector::submit(uint64_t frameIndex) {
         m_Latency[4] = timestamp.rendered2 - timestamp.decoderOutput;
 
     submitNewFrame();
+    sendFrameTrace(timestamp);
 
     m_FramesInSecond = 1000000.0 / (timestamp.submit - m_LastSubmit);
     m_LastSubmit = timestamp.submit;
@@ -116,6 +165,35 @@ void LatencyCollector::submit(uint64_t frameIndex) {
 #endif
 }
 
+void LatencyCollector::setFrameTraceSend(FrameTraceSendFn fn) {
+    m_FrameTraceSend.store(fn, std::memory_order_relaxed);
+}
+
+void LatencyCollector::sendFrameTrace(const FrameTimestamp &timestamp) {
+    const auto send = m_FrameTraceSend.load(std::memory_order_relaxed);
+    if (send == nullptr || timestamp.frameIndex == m_LastTracedFrame)
+        return;
+    m_LastTracedFrame = timestamp.frameIndex;
+
+    const int64_t offset = getTimeSyncClockOffsetUs();
+    const auto toTimeSyncClock = [offset](uint64_t t) -> unsigned long long {
+        return t != 0 ? (unsigned long long)((int64_t)t + offset) : 0;
+    };
+    ClientFrameTrace trace = {};
+    trace.trackingFrameIndex = timestamp.frameIndex;
+    trace.poseSent = toTimeSyncClock(timestamp.tracking);
+    trace.firstPacketReceived = toTimeSyncClock(timestamp.receivedFirst);
+    trace.lastPacketReceived = toTimeSyncClock(timestamp.lastPacket);
+    trace.reconstructed = toTimeSyncClock(timestamp.receivedLast);
+    trace.decoderInput = toTimeSyncClock(timestamp.decoderInput);
+    trace.decoderOutput = toTimeSyncClock(timestamp.decoderOutput);
+    trace.uploaded = toTimeSyncClock(timestamp.uploaded);
+    trace.renderStart = toTimeSyncClock(timestamp.rendered1);
+    trace.renderEnd = toTimeSyncClock(timestamp.rendered2);
+    trace.submitted = toTimeSyncClock(timestamp.submit);
+    send(&trace);
+}
+
 void LatencyCollector::resetAll() {
     m_PacketsLostTotal = 0;
     m_PacketsLostInSecond = 0;
@@ -125,16 +203,24 @@ void LatencyCollector::resetAll() {
     m_FecFailureInSecond = 0;
     m_FecFailurePrevious = 0;
 
+    m_DecoderDroppedTotal = 0;
+    m_DecoderDroppedInSecond = 0;
+    m_DecoderDroppedPrevious = 0;
+    m_DecoderQueueDepth = 0;
+
     m_FramesInSecond = 0;
     m_LastSubmit = 0;
+    m_LastTracedFrame = 0;
 
     for(int i = 0; i < 5; i++) {
         m_Latency[i] = 0;
     }
 
-    {
-        std::scoped_lock l(m_framesMutex);
-        m_Frames.clear();
+    for (auto &slot : m_Frames) {
+        for (auto field : FRAME_FIELDS) {
+            (slot.*field).store(0, std::memory_order_relaxed);
+        }
+        slot.frameIndex.store(0, std::memory_order_relaxed);
     }
     m_ServerTotalLatency.store(0);
 
@@ -147,6 +233,9 @@ void LatencyCollector::resetSecond(){
 
     m_FecFailurePrevious = m_FecFailureInSecond;
     m_FecFailureInSecond = 0;
+
+    m_DecoderDroppedPrevious = m_DecoderDroppedInSecond;
+    m_DecoderDroppedInSecond = 0;
 }
 
 void LatencyCollector::checkAndResetSecond() {
@@ -171,6 +260,17 @@ void LatencyCollector::fecFailure() {
     m_FecFailureInSecond++;
 }
 
+void LatencyCollector::decoderQueueDepth(uint32_t depth) {
+    m_DecoderQueueDepth = depth;
+}
+
+void LatencyCollector::decoderDropped(uint64_t dropped) {
+    checkAndResetSecond();
+
+    m_DecoderDroppedTotal += dropped;
+    m_DecoderDroppedInSecond += dropped;
+}
+
 void LatencyCollector::submitNewFrame() {
     checkAndResetSecond();
 }
@@ -195,6 +295,15 @@ uint64_t LatencyCollector::getFecFailureTotal() const {
 uint64_t LatencyCollector::getFecFailureInSecond() const {
     return m_FecFailurePrevious;
 }
+uint32_t LatencyCollector::getDecoderQueueDepth() const {
+    return m_DecoderQueueDepth;
+}
+uint64_t LatencyCollector::getDecoderDroppedTotal() const {
+    return m_DecoderDroppedTotal;
+}
+uint64_t LatencyCollector::getDecoderDroppedInSecond() const {
+    return m_DecoderDroppedPrevious;
+}
 float LatencyCollector::getFramesInSecond() const {
     return m_FramesInSecond;
 }
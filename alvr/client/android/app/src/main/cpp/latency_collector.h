@@ -3,24 +3,36 @@
 
 #include <memory>
 #include <vector>
-#include <map>
+#include <array>
 #include <atomic>
-#include <mutex>
+#include <cstdint>
+
+struct ClientFrameTrace;
 
 class LatencyCollector {
 public:
     static LatencyCollector &Instance();
 
+    // Receives the stages of every submitted frame (see ClientFrameTrace), null to stop.
+    using FrameTraceSendFn = void (*)(const ClientFrameTrace *trace);
+    void setFrameTraceSend(FrameTraceSendFn fn);
+
     uint64_t getTrackingPredictionLatency() const;
     uint64_t getLatency(uint32_t i) const;
     uint64_t getPacketsLostTotal() const;
     uint64_t getPacketsLostInSecond() const;
     uint64_t getFecFailureTotal() const;
     uint64_t getFecFailureInSecond() const;
+    uint32_t getDecoderQueueDepth() const;
+    uint64_t getDecoderDroppedTotal() const;
+    uint64_t getDecoderDroppedInSecond() const;
     float getFramesInSecond() const;
 
     void packetLoss(int64_t lost);
     void fecFailure();
+    // Frames waiting for the decoder, and frames skipped because they were late.
+    void decoderQueueDepth(uint32_t depth);
+    void decoderDropped(uint64_t dropped);
 
     void setTotalLatency(uint32_t latency);
 
@@ -29,8 +41,11 @@ public:
     void received(uint64_t frameIndex);
     void receivedFirst(uint64_t frameIndex);
     void receivedLast(uint64_t frameIndex);
+    // Every packet of the frame, the last one sets the time.
+    void lastPacketReceived(uint64_t frameIndex);
     void decoderInput(uint64_t frameIndex);
     void decoderOutput(uint64_t frameIndex);
+    void uploaded(uint64_t frameIndex);
     void rendered1(uint64_t frameIndex);
     void rendered2(uint64_t frameIndex);
     void submit(uint64_t frameIndex);
@@ -55,15 +70,43 @@ private:
         uint64_t received;
         uint64_t receivedFirst;
         uint64_t receivedLast;
+        uint64_t lastPacket;
         uint64_t decoderInput;
         uint64_t decoderOutput;
+        uint64_t uploaded;
         uint64_t rendered1;
         uint64_t rendered2;
         uint64_t submit;
     };
-    constexpr static const int MAX_FRAMES = 1024;
-    std::map<uint64_t, FrameTimestamp> m_Frames = std::map<uint64_t, FrameTimestamp>();
-    std::mutex m_framesMutex;
+    // Timestamps are written from the network, decoder and render threads at packet rate, the
+    // table is a fixed array of slots with relaxed atomic fields, without locks or allocations.
+    // frameIndex is the tag of a slot: a slot holding another frame is stale and is taken over.
+    struct alignas(64) FrameSlot {
+        std::atomic<uint64_t> frameIndex { 0 };
+
+        std::atomic<uint64_t> tracking { 0 };
+        std::atomic<uint64_t> estimatedSent { 0 };
+        std::atomic<uint64_t> received { 0 };
+        std::atomic<uint64_t> receivedFirst { 0 };
+        std::atomic<uint64_t> receivedLast { 0 };
+        std::atomic<uint64_t> lastPacket { 0 };
+        std::atomic<uint64_t> decoderInput { 0 };
+        std::atomic<uint64_t> decoderOutput { 0 };
+        std::atomic<uint64_t> uploaded { 0 };
+        std::atomic<uint64_t> rendered1 { 0 };
+        std::atomic<uint64_t> rendered2 { 0 };
+        std::atomic<uint64_t> submit { 0 };
+    };
+    using FrameField = std::atomic<uint64_t> FrameSlot::*;
+    constexpr static const FrameField FRAME_FIELDS[] = {
+        &FrameSlot::tracking, &FrameSlot::estimatedSent, &FrameSlot::received,
+        &FrameSlot::receivedFirst, &FrameSlot::receivedLast, &FrameSlot::lastPacket,
+        &FrameSlot::decoderInput, &FrameSlot::decoderOutput, &FrameSlot::uploaded,
+        &FrameSlot::rendered1, &FrameSlot::rendered2, &FrameSlot::submit
+    };
+    constexpr static const int MAX_FRAMES_LOG2 = 10;
+    constexpr static const int MAX_FRAMES = 1 << MAX_FRAMES_LOG2;
+    std::array<FrameSlot, MAX_FRAMES> m_Frames;
 
     uint64_t m_StatisticsTime;
     uint64_t m_PacketsLostTotal = 0;
@@ -72,6 +115,11 @@ private:
     uint64_t m_FecFailureTotal = 0;
     uint64_t m_FecFailureInSecond = 0;
     uint64_t m_FecFailurePrevious = 0;
+    uint64_t m_DecoderDroppedTotal = 0;
+    uint64_t m_DecoderDroppedInSecond = 0;
+    uint64_t m_DecoderDroppedPrevious = 0;
+
+    std::atomic<uint32_t> m_DecoderQueueDepth { 0 };
 
     std::atomic<uint32_t> m_ServerTotalLatency { 0 };
 
@@ -81,7 +129,13 @@ private:
     uint64_t m_LastSubmit = 0;
     float m_FramesInSecond = 0;
 
-    FrameTimestamp & getFrame(uint64_t frameIndex);
+    std::atomic<FrameTraceSendFn> m_FrameTraceSend { nullptr };
+    // A frame shown again is traced once.
+    uint64_t m_LastTracedFrame = 0;
+
+    FrameSlot &getFrame(uint64_t frameIndex);
+    void setTimestamp(uint64_t frameIndex, FrameField field, uint64_t timestamp);
+    void sendFrameTrace(const FrameTimestamp &timestamp);
 };
 
 #endif //ALVRCLIENT_LATENCY_COLLECTOR_H
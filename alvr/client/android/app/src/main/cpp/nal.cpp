@@ -2,12 +2,14 @@
 // Extract NAL Units from packet by UDP/SRT socket.
 ////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <string>
 #include <stdlib.h>
 #include <android/log.h>
 #include <pthread.h>
 #include "nal.h"
 #include "packet_types.h"
+#include "nal_scan.h"
 
 static const std::byte NAL_TYPE_SPS = static_cast<const std::byte>(7);
 
@@ -45,11 +47,22 @@ void NALParser::setCodec(int codec)
 
 bool NALParser::processPacket(VideoFrame *packet, int packetSize, bool &fecFailure)
 {
+    // Repeat marker (unchanged frame on the server), nothing to decode.
+    if (packet->frameByteSize == 0) {
+        if (m_enableFEC) {
+            m_queue.addRepeatMarker(packet);
+        }
+        return false;
+    }
+
     if (m_enableFEC) {
         m_queue.addVideoPacket(packet, packetSize, fecFailure);
     }
 
     bool result = m_queue.reconstruct() || !m_enableFEC;
+    if (!result) {
+        checkNack();
+    }
     if (result)
     {
         const std::byte *frameBuffer;
@@ -128,36 +141,27 @@ bool NALParser::fecFailure()
     return m_queue.fecFailure();
 }
 
-int NALParser::findVPSSPS(const std::byte *frameBuffer, int frameByteSize)
+uint64_t NALParser::checkNack()
 {
-    int zeroes = 0;
-    int foundNals = 0;
-    for (int i = 0; i < frameByteSize; i++)
-    {
-        if (frameBuffer[i] == std::byte(0))
-        {
-            zeroes++;
-        }
-        else if (frameBuffer[i] == std::byte(1))
-        {
-            if (zeroes >= 2)
-            {
-                foundNals++;
-                if (m_codec == ALVR_CODEC_H264 && foundNals >= 3)
-                {
-                    // Find end of SPS+PPS on H.264.
-                    return i - 3;
-                } else if (m_codec == ALVR_CODEC_H265 && foundNals >= 4)
-                {
-                    // Find end of VPS+SPS+PPS on H.264.
-                    return i - 3;
-                }
-            }
-            zeroes = 0;
-        } else
-        {
-            zeroes = 0;
-        }
+    if (!m_enableFEC) {
+        return 0;
+    }
+    uint64_t videoFrameIndex;
+    if (m_queue.takeNack(videoFrameIndex, m_nackRanges)) {
+        videoNackSend(videoFrameIndex, m_nackRanges.data(), m_nackRanges.size());
     }
-    return -1;
+    auto deadline = m_queue.nackDeadline();
+    if (!deadline) {
+        return 0;
+    }
+    auto leftUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            *deadline - FECQueue::Clock::now()).count();
+    return std::max<int64_t>(leftUs, 1);
+}
+
+int NALParser::findVPSSPS(const std::byte *frameBuffer, int frameByteSize)
+{
+    // End of SPS+PPS on H.264, VPS+SPS+PPS on H.265.
+    return FindConfigNalUnitsEnd(reinterpret_cast<const uint8_t *>(frameBuffer), frameByteSize,
+                                 static_cast<ALVR_CODEC>(m_codec));
 }
@@ -14,6 +14,9 @@ public:
 
     void setCodec(int codec);
     bool processPacket(VideoFrame *packet, int packetSize, bool &fecFailure);
+    // Asks the server again for the missing packets of the current frame when they are due.
+    // Returns the time until the next check in us, 0 if none is needed.
+    uint64_t checkNack();
 
     bool fecFailure();
 private:
@@ -23,6 +26,7 @@ private:
     bool m_enableFEC;
 
     FECQueue m_queue;
+    std::vector<VideoNackRange> m_nackRanges;
 
     int m_codec = 1;
 
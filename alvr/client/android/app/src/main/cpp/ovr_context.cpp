@@ -35,6 +35,9 @@ using namespace gl_render_utils;
 void (*inputSend)(TrackingInfo data);
 void (*timeSyncSend)(TimeSync data);
 void (*videoErrorReportSend)();
+void (*videoNackSend)(unsigned long long videoFrameIndex, const VideoNackRange *ranges,
+                      unsigned int rangeCount);
+void (*frameTraceSend)(const ClientFrameTrace *trace);
 void (*viewsConfigSend)(EyeFov fov[2], float ipd_m);
 void (*batterySend)(unsigned long long device_path, float gauge_value, bool is_plugged);
 unsigned long long (*pathStringToHash)(const char *path);
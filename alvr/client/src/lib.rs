@@ -17,8 +17,8 @@ use alvr_common::{
 };
 use alvr_session::Fov;
 use alvr_sockets::{
-    BatteryPacket, HeadsetInfoPacket, Input, LegacyController, LegacyInput, MotionData,
-    PrivateIdentity, TimeSyncPacket, ViewsConfig,
+    BatteryPacket, FrameTracePacket, HeadsetInfoPacket, Input, LegacyController, LegacyInput,
+    MotionData, PrivateIdentity, TimeSyncPacket, VideoNackPacket, ViewsConfig,
 };
 use jni::{
     objects::{JClass, JObject, JString},
@@ -46,6 +46,10 @@ lazy_static! {
         Mutex::new(None);
     static ref VIDEO_ERROR_REPORT_SENDER: Mutex<Option<mpsc::UnboundedSender<()>>> =
         Mutex::new(None);
+    static ref VIDEO_NACK_SENDER: Mutex<Option<mpsc::UnboundedSender<VideoNackPacket>>> =
+        Mutex::new(None);
+    static ref FRAME_TRACE_SENDER: Mutex<Option<mpsc::UnboundedSender<FrameTracePacket>>> =
+        Mutex::new(None);
     static ref VIEWS_CONFIG_SENDER: Mutex<Option<mpsc::UnboundedSender<ViewsConfig>>> =
         Mutex::new(None);
     static ref BATTERY_SENDER: Mutex<Option<mpsc::UnboundedSender<BatteryPacket>>> =
@@ -312,6 +316,50 @@ pub unsafe extern "system" fn Java_com_polygraphene_alvr_OvrActivity_onCreateNat
         }
     }
 
+    extern "C" fn video_nack_send(
+        video_frame_index: u64,
+        ranges_ptr: *const VideoNackRange,
+        range_count: u32,
+    ) {
+        if let Some(sender) = &*VIDEO_NACK_SENDER.lock() {
+            let ranges = unsafe { slice::from_raw_parts(ranges_ptr, range_count as _) };
+            sender
+                .send(VideoNackPacket {
+                    video_frame_index,
+                    ranges: ranges
+                        .iter()
+                        .map(|range| alvr_sockets::VideoNackRange {
+                            fec_group_index: range.fecGroupIndex,
+                            fec_index: range.fecIndex,
+                            count: range.count,
+                        })
+                        .collect(),
+                })
+                .ok();
+        }
+    }
+
+    extern "C" fn frame_trace_send(trace: *const ClientFrameTrace) {
+        if let Some(sender) = &*FRAME_TRACE_SENDER.lock() {
+            let trace = unsafe { &*trace };
+            sender
+                .send(FrameTracePacket {
+                    tracking_frame_index: trace.trackingFrameIndex,
+                    pose_sent: trace.poseSent,
+                    first_packet_received: trace.firstPacketReceived,
+                    last_packet_received: trace.lastPacketReceived,
+                    reconstructed: trace.reconstructed,
+                    decoder_input: trace.decoderInput,
+                    decoder_output: trace.decoderOutput,
+                    uploaded: trace.uploaded,
+                    render_start: trace.renderStart,
+                    render_end: trace.renderEnd,
+                    submitted: trace.submitted,
+                })
+                .ok();
+        }
+    }
+
     extern "C" fn views_config_send(fov: *mut EyeFov, ipd_m: f32) {
         let fov = unsafe { slice::from_raw_parts(fov, 2) };
         if let Some(sender) = &*VIEWS_CONFIG_SENDER.lock() {
@@ -353,6 +401,8 @@ pub unsafe extern "system" fn Java_com_polygraphene_alvr_OvrActivity_onCreateNat
     inputSend = Some(input_send);
     timeSyncSend = Some(time_sync_send);
     videoErrorReportSend = Some(video_error_report_send);
+    videoNackSend = Some(video_nack_send);
+    frameTraceSend = Some(frame_trace_send);
     viewsConfigSend = Some(views_config_send);
     batterySend = Some(battery_send);
 
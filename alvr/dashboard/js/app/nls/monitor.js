@@ -36,16 +36,22 @@ define({
         sentRate: "Sent rate",
         bitrate: "Bitrate",
         ping: "Ping",
+        clockSyncError: "Clock sync error",
         totalLatency: "Total latency",
         encodeLatency: "Encoder Latency",
         encodeLatencyMax: "Encode latency max",
         transportLatency: "Transport latency",
         decodeLatency: "Decoder latency",
+        pacingDelay: "Pacing delay",
         fecPercentage: "Fec percentage",
         fecFailureTotal: "Fec failure total",
         fecFailureInSecond: "Fec failure / s",
         clientFPS: "Client FPS",
         serverFPS: "Server FPS",
+        psnr: "PSNR",
+        foveatedPsnr: "Foveated PSNR",
+        ssim: "SSIM",
+        foveatedSsim: "Foveated SSIM",
         packets: "Packets",
         packetss: "Packets / s",
         batteries: "Batteries",
@@ -77,6 +77,9 @@ define({
         "_root_video_swThreadCount.name": "Number of threads (software encoding)",
         "_root_video_swThreadCount.description":
             "Sets the amount of threads to use when using software encoding. Setting to 0 will use the max amount available.",
+        "_root_video_skipStaticFrames.name": "Skip static frames", // adv
+        "_root_video_skipStaticFrames.description":
+            "When the game presents the same image again, send a small repeat message instead of encoding it. Linux only", // adv
         "_root_video_encodeBitrateMbs.name": "Video Bitrate",
         "_root_video_encodeBitrateMbs.description":
             "Bitrate of video streaming. 30Mbps is recommended. \nHigher bitrates result in better image but also higher latency and network traffic ",
@@ -113,6 +116,53 @@ define({
             "Bitrate light load threshold", // adv
         "_root_video_adaptiveBitrate_content_bitrateLightLoadThreshold.description":
             "Limit increasing bitrate if sent rate is below threshold percentage of bitrate. Prevents stutters caused when switching from simple scenes to complex scenes", // adv
+        "_root_video_dynamicResolution.name": "Dynamic resolution",
+        "_root_video_dynamicResolution_enabled.description":
+            "Lower the encode resolution when the encoder is overloaded or the bitrate drops, the client upscales the received image. Linux only",
+        "_root_video_dynamicResolution_content_levelCount.name": "Resolution levels",
+        "_root_video_dynamicResolution_content_levelCount.description":
+            "Number of encode resolutions prepared at stream start, from full resolution down to the minimum scale",
+        "_root_video_dynamicResolution_content_minimumScale.name": "Minimum scale",
+        "_root_video_dynamicResolution_content_minimumScale.description":
+            "Scale of the lowest resolution level, relative to the render resolution",
+        "_root_video_dynamicResolution_content_encodeLoadHighThreshold.name":
+            "Encoder high load threshold", // adv
+        "_root_video_dynamicResolution_content_encodeLoadHighThreshold.description":
+            "Step down a level when the encode time exceeds this fraction of the frame time", // adv
+        "_root_video_dynamicResolution_content_encodeLoadLowThreshold.name":
+            "Encoder low load threshold", // adv
+        "_root_video_dynamicResolution_content_encodeLoadLowThreshold.description":
+            "Step up a level when the encode time is below this fraction of the frame time", // adv
+        "_root_video_dynamicResolution_content_bitrateLowThreshold.name": "Bitrate low threshold", // adv
+        "_root_video_dynamicResolution_content_bitrateLowThreshold.description":
+            "Step down a level when the adaptive bitrate falls below this fraction of the video bitrate", // adv
+        "_root_video_dynamicResolution_content_switchIntervalMs.name": "Switch interval (ms)", // adv
+        "_root_video_dynamicResolution_content_switchIntervalMs.description":
+            "Minimum time between two resolution changes. Each change forces an IDR frame", // adv
+        "_root_video_qualityProbe.name": "Quality probe", // adv
+        "_root_video_qualityProbe_enabled.description":
+            "Decode the stream again on the server and report PSNR/SSIM, plain and weighted around the gaze point, in the statistics. Costs CPU. Linux software encoder only", // adv
+        "_root_video_qualityProbe_content_frameInterval.name": "Frame interval", // adv
+        "_root_video_qualityProbe_content_frameInterval.description":
+            "Measure one frame out of this many", // adv
+        "_root_video_qualityProbe_content_sampleStep.name": "Sample step", // adv
+        "_root_video_qualityProbe_content_sampleStep.description":
+            "Only one 8x8 block out of this many, in each direction, is compared", // adv
+        "_root_video_qualityProbe_content_gazeRadius.name": "Gaze radius", // adv
+        "_root_video_qualityProbe_content_gazeRadius.description":
+            "Radius of the high weight area around the gaze point, as a fraction of the eye view", // adv
+        "_root_video_threadPolicy.name": "Streaming thread policy", // adv
+        "_root_video_threadPolicy_enabled.description":
+            "Run the encoder and vsync threads with realtime priority. Falls back to a raised priority when realtime scheduling is not permitted (on Linux it needs CAP_SYS_NICE or an rtprio limit)", // adv
+        "_root_video_threadPolicy_content_realtimePriority.name": "Realtime priority", // adv
+        "_root_video_threadPolicy_content_realtimePriority.description":
+            "SCHED_FIFO priority on Linux", // adv
+        "_root_video_threadPolicy_content_deadlineScheduler.name": "Deadline scheduler", // adv
+        "_root_video_threadPolicy_content_deadlineScheduler.description":
+            "Linux only: schedule the vsync threads with SCHED_DEADLINE instead of SCHED_FIFO. Not used together with the CPU affinity", // adv
+        "_root_video_threadPolicy_content_cpuAffinity.name": "CPU affinity", // adv
+        "_root_video_threadPolicy_content_cpuAffinity.description":
+            "Pin the streaming threads to these CPUs, e.g. \"2,3\" or \"6-7\", to keep them off the cores the game uses. Empty to not pin", // adv
         // Audio tab
         "_root_audio_tab.name": "Audio",
         "_root_audio_linuxBackend-choice-.name": "Linux backend",
@@ -313,6 +363,47 @@ define({
         "_root_connection_onDisconnectScript.name": "On disconnect script",
         "_root_connection_onDisconnectScript.description":
             "This script/executable will be run asynchronously when headset disconnects and on SteamVR shutdown.\nEnvironment variable ACTION will be set to &#34;disconnect&#34; (without quotes).",
+        "_root_connection_fecCodec-choice-.name": "FEC codec", // adv
+        "_root_connection_fecCodec-choice-.description":
+            "Reed-Solomon splits large frames in packet rows of at most 20 packets, each row recovers separately. Cauchy GF(2^16) protects each frame (each group with unequal error protection) as a whole: any lost packets up to the parity count are recovered. Its encoding time is capped at about 2 ms per group: groups over 256 KB, large keyframes mostly, are split in packet rows with fewer parity packets each, which recover separately", // adv
+        "_root_connection_fecCodec_reedSolomon-choice-.name": "Reed-Solomon", // adv
+        "_root_connection_fecCodec_cauchyGf16-choice-.name": "Cauchy GF(2^16)", // adv
+        "_root_connection_unequalErrorProtection_enabled.description":
+            "Split each frame in groups protected by separate FEC: parameter sets and keyframes get more parity, slices away from the center of the image less. Requires FEC", // adv
+        "_root_connection_unequalErrorProtection_content_criticalFecPercentage.name": "Critical FEC percentage", // adv
+        "_root_connection_unequalErrorProtection_content_criticalFecPercentage.description":
+            "Parity for parameter sets and keyframe slices", // adv
+        "_root_connection_unequalErrorProtection_content_peripheralFecPercentage.name": "Peripheral FEC percentage", // adv
+        "_root_connection_unequalErrorProtection_content_peripheralFecPercentage.description":
+            "Parity for slices outside the foveal band and non-reference slices", // adv
+        "_root_connection_unequalErrorProtection_content_fovealBand.name": "Foveal band", // adv
+        "_root_connection_unequalErrorProtection_content_fovealBand.description":
+            "Height of the band around the vertical center of the image whose slices keep the normal FEC percentage", // adv
+        "_root_connection_unequalErrorProtection_content_interleaveGroups.name": "Interleave groups", // adv
+        "_root_connection_unequalErrorProtection_content_interleaveGroups.description":
+            "Send the packets of the groups mixed in proportion to their size, a burst of lost packets takes a share of each group instead of all of one", // adv
+        "_root_connection_videoPacing.name": "Video pacing", // adv
+        "_root_connection_videoPacing_enabled.description":
+            "Spread the packets of each frame over part of the frame interval instead of sending them in one burst, which overflows the access point queues", // adv
+        "_root_connection_videoPacing_content_frameBudget.name": "Frame budget", // adv
+        "_root_connection_videoPacing_content_frameBudget.description":
+            "Part of the frame interval a frame is spread over. Small frames are sent at once", // adv
+        "_root_connection_videoNack.name": "Video retransmission", // adv
+        "_root_connection_videoNack_enabled.description":
+            "Send again the packets of a frame FEC couldn't recover when the client asks for them. Helps on links with a short round trip", // adv
+        "_root_connection_videoNack_content_historyFrames.name": "History frames", // adv
+        "_root_connection_videoNack_content_historyFrames.description":
+            "Number of the last frames kept to send again", // adv
+        "_root_connection_videoNack_content_deadline.name": "Deadline", // adv
+        "_root_connection_videoNack_content_deadline.description":
+            "Time after a frame is sent, in frame intervals, past which its packets are not sent again. At one frame interval the next frame has already replaced it", // adv
+        "_root_connection_spectators.name": "Spectators", // adv
+        "_root_connection_spectators_enabled.description":
+            "Stream the same video to other trusted clients while a client is connected. They only watch: their input, audio and haptics are not used. Requires the TCP stream protocol", // adv
+        "_root_connection_spectators_content_maxSpectators.name": "Maximum spectators", // adv
+        "_root_connection_frameTrace.name": "Frame trace", // adv
+        "_root_connection_frameTrace.description":
+            "Write the stages of every frame, on the server and on the client, to frame_trace.perfetto-trace in the log folder. Open it in ui.perfetto.dev", // adv
         // Extra tab
         "_root_extra_tab.name": "Extra",
         "_root_extra_theme-choice-.name": "Theme",
@@ -237,6 +237,10 @@ impl Layout {
         self.log_dir.join("crash_log.txt")
     }
 
+    pub fn frame_trace(&self) -> PathBuf {
+        self.log_dir.join("frame_trace.perfetto-trace")
+    }
+
     pub fn openvr_driver_lib_dir(&self) -> PathBuf {
         let platform = if cfg!(windows) {
             "win64"
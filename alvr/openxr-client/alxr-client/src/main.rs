@@ -2,8 +2,9 @@
 
 use alxr_common::{
     alxr_destroy, alxr_init, alxr_is_session_running, alxr_process_frame, battery_send,
-    init_connections, input_send, path_string_to_hash, request_idr, set_waiting_next_idr, shutdown,
-    time_sync_send, video_error_report_send, views_config_send, ALXRColorSpace, ALXRDecoderType,
+    frame_trace_send, gaze_send, init_connections, input_send, input_send_compact,
+    path_string_to_hash, request_idr, set_waiting_next_idr, shutdown, time_sync_send,
+    video_error_report_send, video_nack_send, views_config_send, ALXRColorSpace, ALXRDecoderType,
     ALXRGraphicsApi, ALXRRustCtx, ALXRSystemProperties, ALXRVersion, APP_CONFIG,
 };
 use std::{thread, time};
@@ -43,10 +44,14 @@ fn main() {
         loop {
             let ctx = ALXRRustCtx {
                 inputSend: Some(input_send),
+                inputSendCompact: Some(input_send_compact),
+                gazeSend: Some(gaze_send),
                 viewsConfigSend: Some(views_config_send),
                 pathStringToHash: Some(path_string_to_hash),
                 timeSyncSend: Some(time_sync_send),
                 videoErrorReportSend: Some(video_error_report_send),
+                videoNackSend: Some(video_nack_send),
+                frameTraceSend: Some(frame_trace_send),
                 batterySend: Some(battery_send),
                 setWaitingNextIDR: Some(set_waiting_next_idr),
                 requestIDR: Some(request_idr),
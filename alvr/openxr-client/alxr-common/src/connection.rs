@@ -1,7 +1,8 @@
 use crate::{
     connection_utils::{self, ConnectionError},
     ALXRTrackingSpace_StageRefSpace, TimeSync, VideoFrame, APP_CONFIG, BATTERY_SENDER,
-    INPUT_SENDER, TIME_SYNC_SENDER, VIDEO_ERROR_REPORT_SENDER, VIEWS_CONFIG_SENDER,
+    COMPACT_INPUT_SENDER, FRAME_TRACE_SENDER, GAZE_SENDER, INPUT_SENDER, TIME_SYNC_SENDER,
+    VIDEO_ERROR_REPORT_SENDER, VIDEO_NACK_SENDER, VIEWS_CONFIG_SENDER,
 };
 use alvr_common::{prelude::*, ALVR_NAME, ALVR_VERSION};
 use alvr_session::SessionDesc;
@@ -10,7 +11,8 @@ use alvr_sockets::AUDIO;
 use alvr_sockets::{
     spawn_cancelable, ClientConfigPacket, ClientControlPacket, ClientHandshakePacket, Haptics,
     HeadsetInfoPacket, PeerType, PrivateIdentity, ProtoControlSocket, ServerControlPacket,
-    ServerHandshakePacket, StreamSocketBuilder, VideoFrameHeaderPacket, HAPTICS, INPUT, VIDEO,
+    ServerHandshakePacket, StreamSocketBuilder, VideoFrameHeaderPacket, COMPACT_INPUT, GAZE,
+    HAPTICS, INPUT, VIDEO,
 };
 
 use futures::future::BoxFuture;
@@ -377,6 +379,36 @@ async fn connection_pipeline(
         }
     };
 
+    let compact_input_send_loop = {
+        let mut socket_sender = stream_socket.request_stream(COMPACT_INPUT).await?;
+        async move {
+            let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
+            *COMPACT_INPUT_SENDER.lock() = Some(data_sender);
+            while let Some(data) = data_receiver.recv().await {
+                let mut buffer = socket_sender.new_buffer(&(), data.len())?;
+                buffer.get_mut().extend(data);
+                socket_sender.send_buffer(buffer).await.ok();
+            }
+
+            Ok(())
+        }
+    };
+
+    let gaze_send_loop = {
+        let mut socket_sender = stream_socket.request_stream(GAZE).await?;
+        async move {
+            let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
+            *GAZE_SENDER.lock() = Some(data_sender);
+            while let Some(data) = data_receiver.recv().await {
+                let mut buffer = socket_sender.new_buffer(&(), data.len())?;
+                buffer.get_mut().extend(data);
+                socket_sender.send_buffer(buffer).await.ok();
+            }
+
+            Ok(())
+        }
+    };
+
     let time_sync_send_loop = {
         let control_sender = Arc::clone(&control_sender);
         async move {
@@ -415,6 +447,48 @@ async fn connection_pipeline(
         }
     };
 
+    let video_nack_send_loop = {
+        let control_sender = Arc::clone(&control_sender);
+        async move {
+            let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
+            *VIDEO_NACK_SENDER.lock() = Some(data_sender);
+
+            while let Some(nack) = data_receiver.recv().await {
+                control_sender
+                    .lock()
+                    .await
+                    .send(&ClientControlPacket::VideoNack(nack))
+                    .await
+                    .ok();
+            }
+
+            Ok(())
+        }
+    };
+
+    // Only when the server traces the frames
+    let frame_trace_send_loop: BoxFuture<_> = if settings.connection.frame_trace {
+        let control_sender = Arc::clone(&control_sender);
+        Box::pin(async move {
+            let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
+            *FRAME_TRACE_SENDER.lock() = Some(data_sender);
+
+            while let Some(trace) = data_receiver.recv().await {
+                control_sender
+                    .lock()
+                    .await
+                    .send(&ClientControlPacket::FrameTrace(trace))
+                    .await
+                    .ok();
+            }
+
+            Ok(())
+        })
+    } else {
+        *FRAME_TRACE_SENDER.lock() = None;
+        Box::pin(future::pending())
+    };
+
     let views_config_send_loop = {
         let control_sender = Arc::clone(&control_sender);
         async move {
@@ -483,6 +557,16 @@ async fn connection_pipeline(
                     frameByteSize: packet.header.frame_byte_size,
                     fecIndex: packet.header.fec_index,
                     fecPercentage: packet.header.fec_percentage,
+                    frameWidth: packet.header.frame_width,
+                    frameHeight: packet.header.frame_height,
+                    fecGroupIndex: packet.header.fec_group_index,
+                    fecGroupCount: packet.header.fec_group_count,
+                    fecGroupOffset: packet.header.fec_group_offset,
+                    fecGroupByteSize: packet.header.fec_group_byte_size,
+                    framePacketIndex: packet.header.frame_packet_index,
+                    framePacketCount: packet.header.frame_packet_count,
+                    fecCodec: packet.header.fec_codec,
+                    retransmitted: packet.header.retransmitted,
                 };
 
                 buffer[..std::mem::size_of::<VideoFrame>()].copy_from_slice(unsafe {
@@ -540,24 +624,43 @@ async fn connection_pipeline(
                 // );
 
                 let mut idr_request_deadline = None;
-
-                while let Ok(data) = legacy_receive_data_receiver.recv() {
-                    // Send again IDR packet every 2s in case it is missed
-                    // (due to dropped burst of packets at the start of the stream or otherwise).
-                    if !crate::IDR_PARSED.load(Ordering::Relaxed) {
-                        if let Some(deadline) = idr_request_deadline {
-                            if deadline < Instant::now() {
-                                println!("IDR_PARSED sending IDR request");
-                                crate::IDR_REQUEST_NOTIFIER.notify_waiters();
-                                idr_request_deadline = None;
+                // Set while the end of the current video frame is awaited: its last packets may
+                // be lost too, the missing ones are asked again without waiting for the next frame
+                let mut nack_check_timeout = None;
+
+                loop {
+                    let received = match nack_check_timeout {
+                        Some(timeout) => legacy_receive_data_receiver.recv_timeout(timeout),
+                        None => legacy_receive_data_receiver
+                            .recv()
+                            .map_err(|_| smpsc::RecvTimeoutError::Disconnected),
+                    };
+                    match received {
+                        Ok(data) => {
+                            // Send again IDR packet every 2s in case it is missed
+                            // (due to dropped burst of packets at the start of the stream or otherwise).
+                            if !crate::IDR_PARSED.load(Ordering::Relaxed) {
+                                if let Some(deadline) = idr_request_deadline {
+                                    if deadline < Instant::now() {
+                                        println!("IDR_PARSED sending IDR request");
+                                        crate::IDR_REQUEST_NOTIFIER.notify_waiters();
+                                        idr_request_deadline = None;
+                                    }
+                                } else {
+                                    idr_request_deadline =
+                                        Some(Instant::now() + Duration::from_secs(2));
+                                }
                             }
-                        } else {
-                            idr_request_deadline = Some(Instant::now() + Duration::from_secs(2));
+
+                            //println!("Receiving data...");
+                            crate::alxr_on_receive(data.as_ptr(), data.len() as _);
                         }
+                        Err(smpsc::RecvTimeoutError::Timeout) => (),
+                        Err(smpsc::RecvTimeoutError::Disconnected) => break,
                     }
 
-                    //println!("Receiving data...");
-                    crate::alxr_on_receive(data.as_ptr(), data.len() as _);
+                    let wait_us = crate::alxr_check_video_nack();
+                    nack_check_timeout = (wait_us > 0).then(|| Duration::from_micros(wait_us));
                 }
 
                 //crate::closeSocket(env_ptr);
@@ -762,8 +865,12 @@ async fn connection_pipeline(
         res = spawn_cancelable(tracking_loop) => res,
         res = spawn_cancelable(playspace_sync_loop) => res,
         res = spawn_cancelable(input_send_loop) => res,
+        res = spawn_cancelable(compact_input_send_loop) => res,
+        res = spawn_cancelable(gaze_send_loop) => res,
         res = spawn_cancelable(time_sync_send_loop) => res,
         res = spawn_cancelable(video_error_report_send_loop) => res,
+        res = spawn_cancelable(video_nack_send_loop) => res,
+        res = spawn_cancelable(frame_trace_send_loop) => res,
         res = spawn_cancelable(views_config_send_loop) => res,
         res = spawn_cancelable(battery_send_loop) => res,
         res = spawn_cancelable(video_receive_loop) => res,
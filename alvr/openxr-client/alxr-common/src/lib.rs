@@ -7,8 +7,8 @@ mod audio;
 use alvr_common::{prelude::*, ALVR_VERSION, HEAD_ID, EYE_GAZE_ID,LEFT_HAND_ID, RIGHT_HAND_ID};
 use alvr_session::Fov;
 use alvr_sockets::{
-    BatteryPacket, HeadsetInfoPacket, Input, LegacyController, LegacyInput, MotionData,
-    TimeSyncPacket, ViewsConfig,
+    BatteryPacket, FrameTracePacket, HeadsetInfoPacket, Input, LegacyController, LegacyInput,
+    MotionData, TimeSyncPacket, VideoNackPacket, ViewsConfig, CLIENT_FEATURE_DYNAMIC_RESOLUTION,
 };
 pub use alxr_engine_sys::*;
 use lazy_static::lazy_static;
@@ -231,6 +231,9 @@ lazy_static! {
     static ref IDR_REQUEST_NOTIFIER: Notify = Notify::new();
     static ref IDR_PARSED: AtomicBool = AtomicBool::new(false);
     static ref INPUT_SENDER: Mutex<Option<mpsc::UnboundedSender<Input>>> = Mutex::new(None);
+    static ref COMPACT_INPUT_SENDER: Mutex<Option<mpsc::UnboundedSender<Vec<u8>>>> =
+        Mutex::new(None);
+    static ref GAZE_SENDER: Mutex<Option<mpsc::UnboundedSender<Vec<u8>>>> = Mutex::new(None);
     static ref VIEWS_CONFIG_SENDER: Mutex<Option<mpsc::UnboundedSender<ViewsConfig>>> =
         Mutex::new(None);
     static ref BATTERY_SENDER: Mutex<Option<mpsc::UnboundedSender<BatteryPacket>>> =
@@ -239,6 +242,10 @@ lazy_static! {
         Mutex::new(None);
     static ref VIDEO_ERROR_REPORT_SENDER: Mutex<Option<mpsc::UnboundedSender<()>>> =
         Mutex::new(None);
+    static ref VIDEO_NACK_SENDER: Mutex<Option<mpsc::UnboundedSender<VideoNackPacket>>> =
+        Mutex::new(None);
+    static ref FRAME_TRACE_SENDER: Mutex<Option<mpsc::UnboundedSender<FrameTracePacket>>> =
+        Mutex::new(None);
     pub static ref ON_PAUSE_NOTIFIER: Notify = Notify::new();
 }
 
@@ -271,7 +278,8 @@ pub fn init_connections(sys_properties: &ALXRSystemProperties) {
             recommended_eye_height: sys_properties.recommendedEyeHeight as _,
             available_refresh_rates,
             preferred_refresh_rate,
-            reserved: format!("{}", *ALVR_VERSION),
+            // Both decoder plugins resize the video textures to the decoded frames.
+            reserved: format!("{} {}", *ALVR_VERSION, CLIENT_FEATURE_DYNAMIC_RESOLUTION),
         };
 
         println!(
@@ -484,6 +492,24 @@ pub extern "C" fn input_send(data_ptr: *const TrackingInfo) {
     }
 }
 
+// Tracking already encoded by the engine (ALVR-common/tracking_codec.h)
+pub extern "C" fn input_send_compact(data_ptr: *const u8, size: u32) {
+    if let Some(sender) = &*COMPACT_INPUT_SENDER.lock() {
+        let data = unsafe { std::slice::from_raw_parts(data_ptr, size as usize) };
+        sender.send(data.to_vec()).ok();
+    }
+}
+
+// Sent as is, the server checks the size and the packet type
+pub extern "C" fn gaze_send(data_ptr: *const GazeSample) {
+    if let Some(sender) = &*GAZE_SENDER.lock() {
+        let data = unsafe {
+            std::slice::from_raw_parts(data_ptr as *const u8, std::mem::size_of::<GazeSample>())
+        };
+        sender.send(data.to_vec()).ok();
+    }
+}
+
 pub extern "C" fn views_config_send(eye_info_ptr: *const ALXREyeInfo) {
     let eye_info: &ALXREyeInfo = unsafe { &*eye_info_ptr };
     let fov = &eye_info.eyeFov;
@@ -552,6 +578,50 @@ pub extern "C" fn video_error_report_send() {
     }
 }
 
+pub extern "C" fn video_nack_send(
+    video_frame_index: u64,
+    ranges_ptr: *const VideoNackRange,
+    range_count: u32,
+) {
+    if let Some(sender) = &*VIDEO_NACK_SENDER.lock() {
+        let ranges = unsafe { std::slice::from_raw_parts(ranges_ptr, range_count as _) };
+        sender
+            .send(VideoNackPacket {
+                video_frame_index,
+                ranges: ranges
+                    .iter()
+                    .map(|range| alvr_sockets::VideoNackRange {
+                        fec_group_index: range.fecGroupIndex,
+                        fec_index: range.fecIndex,
+                        count: range.count,
+                    })
+                    .collect(),
+            })
+            .ok();
+    }
+}
+
+pub extern "C" fn frame_trace_send(trace: *const ClientFrameTrace) {
+    if let Some(sender) = &*FRAME_TRACE_SENDER.lock() {
+        let trace = unsafe { &*trace };
+        sender
+            .send(FrameTracePacket {
+                tracking_frame_index: trace.trackingFrameIndex,
+                pose_sent: trace.poseSent,
+                first_packet_received: trace.firstPacketReceived,
+                last_packet_received: trace.lastPacketReceived,
+                reconstructed: trace.reconstructed,
+                decoder_input: trace.decoderInput,
+                decoder_output: trace.decoderOutput,
+                uploaded: trace.uploaded,
+                render_start: trace.renderStart,
+                render_end: trace.renderEnd,
+                submitted: trace.submitted,
+            })
+            .ok();
+    }
+}
+
 pub extern "C" fn set_waiting_next_idr(waiting: bool) {
     IDR_PARSED.store(!waiting, Ordering::Relaxed);
 }
@@ -84,10 +84,18 @@ struct ALXRVersion {
 struct ALXRRustCtx
 {
     void (*inputSend)(const TrackingInfo* data);
+    // Optional, sends the tracking in the compact format (ALVR-common/tracking_codec.h).
+    void (*inputSendCompact)(const unsigned char* data, unsigned int size);
+    // Optional, eye gaze at the eye tracker rate.
+    void (*gazeSend)(const GazeSample* data);
     void (*viewsConfigSend)(const ALXREyeInfo* eyeInfo);
     unsigned long long (*pathStringToHash)(const char* path);
     void (*timeSyncSend)(const TimeSync* data);
     void (*videoErrorReportSend)();
+    // Optional, packets of a frame FEC can't recover without.
+    void (*videoNackSend)(unsigned long long videoFrameIndex, const VideoNackRange* ranges, unsigned int rangeCount);
+    // Optional, stages of the submitted frames for the frame trace of the server.
+    void (*frameTraceSend)(const ClientFrameTrace* trace);
     void (*batterySend)(unsigned long long device_path, float gauge_value, bool is_plugged);
     void (*setWaitingNextIDR)(const bool);
     void (*requestIDR)();
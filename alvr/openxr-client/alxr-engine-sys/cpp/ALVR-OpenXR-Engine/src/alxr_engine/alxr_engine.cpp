@@ -24,7 +24,9 @@
 #include "interaction_manager.h"
 #include "latency_manager.h"
 #include "decoder_thread.h"
+#include "gaze_thread.h"
 #include "foveation.h"
+#include "ALVR-common/tracking_codec.h"
 
 #if defined(XR_USE_PLATFORM_WIN32) && defined(XR_EXPORT_HIGH_PERF_GPU_SELECTION_SYMBOLS)
 #pragma message("Enabling Symbols to select high-perf GPUs first")
@@ -49,8 +51,11 @@ using RustCtxPtr = std::shared_ptr<const ALXRRustCtx>;
 RustCtxPtr        gRustCtx{ nullptr };
 IOpenXrProgramPtr gProgram{ nullptr };
 XrDecoderThread   gDecoderThread{};
+XrGazeThread      gGazeThread{};
 std::mutex        gRenderMutex{};
 ALXREyeInfo       gLastEyeInfo = EyeInfoZero;
+tracking_codec::Encoder<TrackingInfo> gTrackingEncoder{};
+std::vector<std::uint8_t> gTrackingPacket{};
 
 namespace ALXRStrings {
     constexpr inline const char* const HeadPath         = "/user/head";
@@ -99,13 +104,16 @@ bool alxr_init(const ALXRRustCtx* rCtx, /*[out]*/ ALXRSystemProperties* systemPr
         
         gRustCtx = std::make_shared<ALXRRustCtx>(*rCtx);
         const auto &ctx = *gRustCtx;
+        gTrackingEncoder.Reset();
         if (ctx.verbose)
             Log::SetLevel(Log::Level::Verbose);
         
         LatencyManager::Instance().Init(LatencyManager::CallbackCtx {
             .sendFn = ctx.inputSend,
             .timeSyncSendFn = ctx.timeSyncSend,
-            .videoErrorReportSendFn = ctx.videoErrorReportSend
+            .videoErrorReportSendFn = ctx.videoErrorReportSend,
+            .videoNackSendFn = ctx.videoNackSend,
+            .frameTraceSendFn = ctx.frameTraceSend
         });
 
         const auto options = std::make_shared<Options>();
@@ -198,6 +206,7 @@ void alxr_destroy() {
         }
     }
     alxr_stop_decoder_thread();
+    gGazeThread.Stop();
     gProgram.reset();
     gRustCtx.reset();
 }
@@ -259,7 +268,8 @@ void alxr_set_stream_config(const ALXRStreamConfig config)
         const XrDecoderThread::StartCtx startCtx{
             .decoderConfig = config.decoderConfig,
             .programPtr = programPtr,
-            .rustCtx = gRustCtx
+            .rustCtx = gRustCtx,
+            .renderMutex = &gRenderMutex
         };
         gDecoderThread.Start(startCtx);
         Log::Write(Log::Level::Info, "Decoder Thread started.");
@@ -280,11 +290,17 @@ void alxr_set_stream_config(const ALXRStreamConfig config)
         rCtx->batterySend(right_hand_path, 1.0f, true);
     };
     SendDummyBatteryLevels();
+    gGazeThread.Start({
+        .programPtr = programPtr,
+        .rustCtx = gRustCtx
+    });
     programPtr->SetStreamConfig(config);
 }
 
 void alxr_on_server_disconnect()
 {
+    // The next server has no reference sample, start over with a full one.
+    gTrackingEncoder.Acknowledge(0);
     if (const auto programPtr = gProgram) {
         programPtr->SetRenderMode(IOpenXrProgram::RenderMode::Lobby);
     }
@@ -363,7 +379,21 @@ void alxr_on_tracking_update(const bool clientsidePrediction)
     TrackingInfo newInfo;
     if (!xrProgram->GetTrackingInfo(newInfo, clientsidePrediction))
         return;
-    rustCtx->inputSend(&newInfo);
+    if (rustCtx->inputSendCompact != nullptr) {
+        gTrackingPacket.clear();
+        gTrackingEncoder.Encode(newInfo, gTrackingPacket);
+        rustCtx->inputSendCompact(gTrackingPacket.data(), static_cast<unsigned int>(gTrackingPacket.size()));
+    } else
+        rustCtx->inputSend(&newInfo);
+}
+
+unsigned long long alxr_check_video_nack()
+{
+#ifndef XR_DISABLE_DECODER_THREAD
+    return gDecoderThread.CheckVideoNack();
+#else
+    return 0;
+#endif
 }
 
 void alxr_on_receive(const unsigned char* packet, unsigned int packetSize)
@@ -382,7 +412,11 @@ void alxr_on_receive(const unsigned char* packet, unsigned int packetSize)
         } break;        
         case ALVR_PACKET_TYPE_TIME_SYNC: {
             assert(packetSize >= sizeof(TimeSync));
-            LatencyManager::Instance().OnTimeSyncRecieved(*(TimeSync*)packet);
+            const auto& timeSync = *(TimeSync*)packet;
+            // mode 3 is sent when the server has received (and decoded) the tracking sample.
+            if (timeSync.mode == 3)
+                gTrackingEncoder.Acknowledge(timeSync.trackingRecvFrameIndex);
+            LatencyManager::Instance().OnTimeSyncRecieved(timeSync);
         } break;
     }
 }
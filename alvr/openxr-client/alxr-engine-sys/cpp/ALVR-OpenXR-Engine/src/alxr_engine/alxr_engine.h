@@ -27,6 +27,9 @@ DLLEXPORT void alxr_set_stream_config(const ALXRStreamConfig config);
 DLLEXPORT ALXRGuardianData alxr_get_guardian_data();
 
 DLLEXPORT void alxr_on_receive(const unsigned char* packet, unsigned int packetSize);
+// Call again after the returned time in us even if no packet comes, see FECQueue::nackDeadline().
+// 0 if no call is needed before the next packet.
+DLLEXPORT unsigned long long alxr_check_video_nack();
 DLLEXPORT void alxr_on_tracking_update(const bool clientsidePrediction);
 DLLEXPORT void alxr_on_haptics_feedback(unsigned long long path, float duration_s, float frequency, float amplitude);
 DLLEXPORT void alxr_on_server_disconnect();
@@ -1,6 +1,206 @@
 #pragma once
-#if defined(_MSC_VER)
 #include <memory>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace xrconcurrency
+{
+    // Indices written by different threads are kept on separate cache lines.
+    inline constexpr const std::size_t CacheLineSize = 64;
+
+    // Bounded lock-free single-producer/single-consumer ring, Capacity must be a power of two.
+    // try_push/try_pop never block, push/pop wait (futex backed on linux) while the ring is full/empty.
+    template < typename Tp, std::size_t Capacity >
+    class spsc_ring
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(std::is_default_constructible_v<Tp> && std::is_move_assignable_v<Tp>);
+        constexpr static const std::uint32_t Mask = Capacity - 1;
+
+        // Free running counts, each side keeps a cached copy of the other side's count so it
+        // only reads the other cache line when the ring looks full/empty.
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_tail{ 0 };
+        std::uint32_t m_cachedHead = 0;
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_head{ 0 };
+        std::uint32_t m_cachedTail = 0;
+        alignas(CacheLineSize) std::array<Tp, Capacity> m_slots{};
+
+    public:
+        spsc_ring() = default;
+        spsc_ring(const spsc_ring&) = delete;
+        spsc_ring& operator=(const spsc_ring&) = delete;
+
+        // x is left untouched when the ring is full.
+        bool try_push(Tp&& x)
+        {
+            const auto tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead == Capacity) {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead == Capacity)
+                    return false;
+            }
+            m_slots[tail & Mask] = std::move(x);
+            m_tail.store(tail + 1, std::memory_order_release);
+            m_tail.notify_one();
+            return true;
+        }
+
+        bool try_push(const Tp& x)
+        {
+            Tp copy = x;
+            return try_push(std::move(copy));
+        }
+
+        void push(Tp&& x)
+        {
+            while (!try_push(std::move(x)))
+                m_head.wait(m_tail.load(std::memory_order_relaxed) - Capacity, std::memory_order_acquire);
+        }
+
+        void push(const Tp& x)
+        {
+            Tp copy = x;
+            push(std::move(copy));
+        }
+
+        bool try_pop(Tp& x)
+        {
+            const auto head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail) {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                    return false;
+            }
+            x = std::move(m_slots[head & Mask]);
+            m_head.store(head + 1, std::memory_order_release);
+            m_head.notify_one();
+            return true;
+        }
+
+        void pop(Tp& x)
+        {
+            while (!try_pop(x))
+                m_tail.wait(m_head.load(std::memory_order_relaxed), std::memory_order_acquire);
+        }
+    };
+
+    // Bounded lock-free multi-producer/multi-consumer ring (Dmitry Vyukov's design): each cell
+    // has a sequence number telling whether it's ready to be written or read at a given position,
+    // producers and consumers only contend on the position they claim with a CAS.
+    template < typename Tp, std::size_t Capacity >
+    class mpmc_ring
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(Capacity <= (std::size_t(1) << 30));
+        static_assert(std::is_default_constructible_v<Tp> && std::is_move_assignable_v<Tp>);
+        constexpr static const std::uint32_t Mask = Capacity - 1;
+
+        struct alignas(CacheLineSize) Cell {
+            std::atomic<std::uint32_t> sequence{ 0 };
+            Tp value{};
+        };
+
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_enqueuePos{ 0 };
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_dequeuePos{ 0 };
+        // Bumped on every push/pop, the blocking variants wait on them.
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_pushCount{ 0 };
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_popCount{ 0 };
+        std::array<Cell, Capacity> m_cells;
+
+    public:
+        mpmc_ring()
+        {
+            for (std::uint32_t i = 0; i < Capacity; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mpmc_ring(const mpmc_ring&) = delete;
+        mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+        // x is left untouched when the ring is full.
+        bool try_push(Tp&& x)
+        {
+            auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = m_cells[pos & Mask];
+                const auto seq = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int32_t>(seq - pos);
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(x);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        m_pushCount.fetch_add(1, std::memory_order_release);
+                        m_pushCount.notify_one();
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool try_push(const Tp& x)
+        {
+            Tp copy = x;
+            return try_push(std::move(copy));
+        }
+
+        void push(Tp&& x)
+        {
+            for (;;) {
+                const auto popCount = m_popCount.load(std::memory_order_acquire);
+                if (try_push(std::move(x)))
+                    return;
+                m_popCount.wait(popCount, std::memory_order_acquire);
+            }
+        }
+
+        void push(const Tp& x)
+        {
+            Tp copy = x;
+            push(std::move(copy));
+        }
+
+        bool try_pop(Tp& x)
+        {
+            auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = m_cells[pos & Mask];
+                const auto seq = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int32_t>(seq - (pos + 1));
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        x = std::move(cell.value);
+                        cell.sequence.store(pos + Capacity, std::memory_order_release);
+                        m_popCount.fetch_add(1, std::memory_order_release);
+                        m_popCount.notify_one();
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void pop(Tp& x)
+        {
+            for (;;) {
+                const auto pushCount = m_pushCount.load(std::memory_order_acquire);
+                if (try_pop(x))
+                    return;
+                m_pushCount.wait(pushCount, std::memory_order_acquire);
+            }
+        }
+    };
+}
+
+#if defined(_MSC_VER)
 #include <concurrent_queue.h>
 namespace xrconcurrency
 {
@@ -8,22 +208,23 @@ namespace xrconcurrency
     using concurrent_queue = concurrency::concurrent_queue<Tp, Alloc>;
 }
 #else
-#include <memory>
-#include <queue>
+#include <deque>
 #include <mutex>
-#include <shared_mutex>
+#include <queue>
 namespace xrconcurrency
 {
-	template < typename Tp, typename Alloc = std::allocator<Tp> >
-	class concurrent_queue
-	{
-		using QueueT = std::queue<Tp, std::deque<Tp,Alloc> >;
-		mutable std::shared_mutex m_mutex;
-		QueueT m_queue;
-	public:
+    // Unbounded like concurrency::concurrent_queue, push never waits. Code that wants a bound and
+    // no allocations uses spsc_ring/mpmc_ring explicitly. The short critical sections keep it ahead
+    // of the blocking rings between two threads, see the threaded cases of alvr_bench
+    // (alvr/server/cpp/tests).
+    template < typename Tp, typename Alloc = std::allocator<Tp> >
+    class concurrent_queue
+    {
+        using QueueT = std::queue<Tp, std::deque<Tp, Alloc> >;
+        std::mutex m_mutex;
+        QueueT m_queue;
+    public:
         concurrent_queue() = default;
-
-        // TODO: Implement these deleted functions.
         concurrent_queue(const concurrent_queue&) = delete;
         concurrent_queue(concurrent_queue&&) = delete;
         concurrent_queue& operator=(const concurrent_queue&) = delete;
@@ -31,26 +232,26 @@ namespace xrconcurrency
 
         void push(const Tp& x)
         {
-            std::unique_lock l(m_mutex);
-            m_queue.push(std::move(x));
+            std::scoped_lock l(m_mutex);
+            m_queue.push(x);
         }
 
         void push(Tp&& x)
         {
-            std::unique_lock l(m_mutex);
+            std::scoped_lock l(m_mutex);
             m_queue.push(std::move(x));
         }
 
+        // Only fails when the queue is empty, a contended lock is waited for.
         bool try_pop(Tp& x)
         {
-            std::unique_lock l(m_mutex, std::try_to_lock_t{});
-            if (!l.owns_lock())
+            std::scoped_lock l(m_mutex);
+            if (m_queue.empty())
                 return false;
-            if (m_queue.empty()) return false;
             x = std::move(m_queue.front());
             m_queue.pop();
             return true;
         }
-	};
+    };
 }
 #endif
@@ -1,7 +1,11 @@
+#include "pch.h"
+#include "common.h"
 #include "decoder_thread.h"
+#include <cstring>
 #include "logger.h"
 #include "decoderplugin.h"
 #include "latency_manager.h"
+#include "ALVR-common/thread_policy.h"
 
 bool XrDecoderThread::QueuePacket(const VideoFrame& header, const std::size_t packetSize)
 {
@@ -10,25 +14,64 @@ bool XrDecoderThread::QueuePacket(const VideoFrame& header, const std::size_t pa
 		return false;
 	LatencyManager::Instance().OnPreVideoPacketRecieved(header);
 
+	if (header.frameWidth != m_frameWidth || header.frameHeight != m_frameHeight) {
+		// The server changed its encode resolution level, the decoder picks the new size up
+		// from the next IDR and the video textures get resized (and upscaled at render).
+		Log::Write(Log::Level::Info, Fmt("Video frame size changed from %ux%u to %ux%u",
+			m_frameWidth, m_frameHeight, header.frameWidth, header.frameHeight));
+		m_frameWidth = header.frameWidth;
+		m_frameHeight = header.frameHeight;
+	}
+
+	if (header.frameByteSize == 0) {
+		// Repeat marker, the server skipped encoding an unchanged frame: an empty packet tells
+		// the decoder to show its last frame again with this tracking frame's pose.
+		decoderPlugin->QueuePacket({}, header.trackingFrameIndex);
+		if (const auto fecQueue = m_fecQueue)
+			fecQueue->addRepeatMarker(&header);
+		LatencyManager::Instance().OnPostVideoPacketRecieved(header, { true, false });
+		return true;
+	}
+
 	bool fecFailure = false, isComplete = true;
 	if (const auto fecQueue = m_fecQueue) {
 		fecQueue->addVideoPacket(&header, static_cast<int>(packetSize), fecFailure);
 		if (isComplete = fecQueue->reconstruct()) {
 			const size_t frameBufferSize = fecQueue->getFrameByteSize();
-			const auto frameBufferPtr = reinterpret_cast<const std::uint8_t*>(fecQueue->getFrameBuffer());
-			decoderPlugin->QueuePacket({ frameBufferPtr, frameBufferSize }, header.trackingFrameIndex);
+			decoderPlugin->QueueFrameBuffer(fecQueue->getFrameBufferRef(), frameBufferSize, header.trackingFrameIndex);
 			fecQueue->clearFecFailure();
+		} else {
+			CheckVideoNack();
 		}
 	} else { // then FEC is disabled
+		// The packet buffer is only valid during this call, copy it once into a pooled buffer.
 		const size_t frameBufferSize = packetSize - sizeof(VideoFrame);
-		const auto frameBufferPtr = reinterpret_cast<const std::uint8_t*>(&header) + sizeof(VideoFrame);
-		decoderPlugin->QueuePacket({ frameBufferPtr, frameBufferSize }, header.trackingFrameIndex);
+		const auto frameBuffer = m_frameBufferPool->acquire(frameBufferSize);
+		std::memcpy(frameBuffer->data(), reinterpret_cast<const std::byte*>(&header) + sizeof(VideoFrame), frameBufferSize);
+		FrameBufferPool::clearPadding(*frameBuffer, frameBufferSize);
+		decoderPlugin->QueueFrameBuffer(frameBuffer, frameBufferSize, header.trackingFrameIndex);
 	}
 
 	LatencyManager::Instance().OnPostVideoPacketRecieved(header, { isComplete, fecFailure });
 	return true;
 }
 
+std::uint64_t XrDecoderThread::CheckVideoNack()
+{
+	const auto fecQueue = m_fecQueue;
+	if (fecQueue == nullptr)
+		return 0;
+	std::uint64_t videoFrameIndex = 0;
+	if (fecQueue->takeNack(videoFrameIndex, m_nackRanges))
+		LatencyManager::Instance().SendVideoNack(videoFrameIndex, m_nackRanges.data(), m_nackRanges.size());
+	const auto deadline = fecQueue->nackDeadline();
+	if (!deadline)
+		return 0;
+	const auto leftUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		*deadline - FECQueue::Clock::now()).count();
+	return static_cast<std::uint64_t>(std::max<std::int64_t>(leftUs, 1));
+}
+
 void XrDecoderThread::Stop()
 {
 	Log::Write(Log::Level::Info, "shutting down decoder thread");
@@ -53,8 +96,9 @@ void XrDecoderThread::Start(const XrDecoderThread::StartCtx& ctx)
 
 	Log::Write(Log::Level::Info, "Starting decoder thread.");
 	m_fecQueue = ctx.decoderConfig.enableFEC ?
-		std::make_shared<FECQueue>() : nullptr;
-	m_decoderPlugin = CreateDecoderPlugin();
+		std::make_shared<FECQueue>(m_frameBufferPool) : nullptr;
+	m_frameWidth = m_frameHeight = 0;
+	m_decoderPlugin = CreateDecoderPlugin(ctx.decoderConfig.codecType);
 	LatencyManager::Instance().ResetAll();
 #ifdef XR_USE_PLATFORM_WIN32
 	auto decoderType = ALXRDecoderType::D311VA;
@@ -74,6 +118,15 @@ void XrDecoderThread::Start(const XrDecoderThread::StartCtx& ctx)
 	{
 		[=, startCtx = ctx]()
 		{
+			// Realtime when permitted (Android doesn't let apps use SCHED_FIFO, it gets a raised
+			// nice value instead). Not pinned: the runtime and the compositor have their own
+			// placement on standalone headsets.
+			thread_policy::Policy policy{};
+			policy.realtime = true;
+			policy.realtimePriority = 2;
+			const auto applied = thread_policy::ApplyToCurrentThread("alxr-decoder", policy);
+			Log::Write(Log::Level::Info, Fmt("Decoder thread: %s scheduling", thread_policy::SchedulingName(applied.scheduling)));
+
 			OptionMap optionMap{};
 #ifdef XR_USE_PLATFORM_ANDROID
 			//// Exynos
@@ -89,9 +142,11 @@ void XrDecoderThread::Start(const XrDecoderThread::StartCtx& ctx)
 				.config		 = startCtx.decoderConfig,
 				.rustCtx	 = startCtx.rustCtx,
 				.programPtr	 = startCtx.programPtr,
-				.decoderType = decoderType
+				.decoderType = decoderType,
+				.renderMutex = startCtx.renderMutex
 			};
 			m_decoderPlugin->Run(runCtx, m_isRuningToken);
+			thread_policy::UnregisterCurrentThread();
 
 			Log::Write(Log::Level::Info, "Decoder thread exiting.");
 		}
@@ -4,7 +4,9 @@
 
 #include <memory>
 #include <atomic>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "alxr_ctypes.h"
 #include "ALVR-common/packet_types.h"
@@ -20,8 +22,13 @@ class XrDecoderThread {
 
 	DecoderPluginPtr  m_decoderPlugin{ nullptr };
 	FECQueuePtr		  m_fecQueue{ nullptr };
+	// Frame buffers handed to the decoder, shared with m_fecQueue.
+	std::shared_ptr<FrameBufferPool> m_frameBufferPool{ FrameBufferPool::Create() };
 	std::atomic<bool> m_isRuningToken{ false };
 	std::thread		  m_decoderThread;
+	std::uint32_t	  m_frameWidth = 0;
+	std::uint32_t	  m_frameHeight = 0;
+	std::vector<VideoNackRange> m_nackRanges;
 
 public:
 
@@ -44,9 +51,13 @@ public:
 		ALXRDecoderConfig decoderConfig;
 		IOpenXrProgramPtr programPtr;
 		ALXRRustCtxPtr	  rustCtx;
+		std::mutex*		  renderMutex = nullptr;
 	};
 	void Start(const StartCtx& ctx);
 	void Stop();
 	bool QueuePacket(const VideoFrame& header, const std::size_t packetSize);
+	// Asks the server again for the missing packets of the current frame when they are due, on
+	// the thread of QueuePacket. Returns the time until the next check in us, 0 if none is needed.
+	std::uint64_t CheckVideoNack();
 };
 #endif
@@ -5,11 +5,13 @@
 #include <cstdint>
 #include <memory>
 #include <atomic>
+#include <mutex>
 #include <span>
 #include <string>
 #include <unordered_map>
 
 #include "alxr_ctypes.h"
+#include "frame_buffer_pool.h"
 
 struct OptionMap {
     template < typename Tp >
@@ -75,6 +77,18 @@ struct IDecoderPlugin {
 		const std::uint64_t /*trackingFrameIndex*/
 	) = 0;
 
+    // Same as QueuePacket with the first frameSize bytes of a pooled buffer, decoders which
+    // can keep a reference on the buffer avoid copying the frame.
+    virtual bool QueueFrameBuffer
+    (
+        const FrameBufferPool::BufferPtr& frameBuffer,
+        const std::size_t frameSize,
+        const std::uint64_t trackingFrameIndex
+    )
+    {
+        return QueuePacket({ reinterpret_cast<const std::uint8_t*>(frameBuffer->data()), frameSize }, trackingFrameIndex);
+    }
+
     using shared_bool = std::atomic<bool>;
     struct RunCtx {
         using IOpenXrProgramPtr = std::shared_ptr<IOpenXrProgram>;
@@ -85,6 +99,8 @@ struct IDecoderPlugin {
         RustCtxPtr        rustCtx;
         IOpenXrProgramPtr programPtr;
         ALXRDecoderType   decoderType;
+        // held while the video textures are re-created on a resolution change.
+        std::mutex*       renderMutex = nullptr;
     };
     virtual bool Run(const RunCtx& /*ctx*/, shared_bool& /*isRunningToken*/) = 0;
 
@@ -96,6 +112,8 @@ struct IDecoderPlugin {
 	IDecoderPlugin& operator=(IDecoderPlugin&&) noexcept = delete;
 };
 
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin();
+// The codec is fixed for the lifetime of the plugin: QueuePacket reads it on the network thread
+// while Run sets up the decoder.
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin(const ALXRCodecType codecType);
 
 #endif
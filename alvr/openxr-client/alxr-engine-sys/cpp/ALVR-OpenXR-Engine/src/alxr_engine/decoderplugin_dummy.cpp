@@ -16,6 +16,6 @@ namespace {
     };
 }
 
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_Dummy() {
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_Dummy(const ALXRCodecType /*codecType*/) {
     return std::make_shared<DummyDecoderPlugin>();
 }
@@ -1,19 +1,19 @@
 #include "decoderplugin.h"
 
 #ifdef XR_USE_PLATFORM_ANDROID
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_MediaCodec();
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_MediaCodec(const ALXRCodecType codecType);
 #elif 1
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_FFMPEG();
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_FFMPEG(const ALXRCodecType codecType);
 #else
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_Dummy();
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_Dummy(const ALXRCodecType codecType);
 #endif
 
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin() {
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin(const ALXRCodecType codecType) {
 #ifdef XR_USE_PLATFORM_ANDROID
-	return CreateDecoderPlugin_MediaCodec();
+	return CreateDecoderPlugin_MediaCodec(codecType);
 #elif 1
-	return CreateDecoderPlugin_FFMPEG();
+	return CreateDecoderPlugin_FFMPEG(codecType);
 #else
-	return CreateDecoderPlugin_Dummy();
+	return CreateDecoderPlugin_Dummy(codecType);
 #endif
 }
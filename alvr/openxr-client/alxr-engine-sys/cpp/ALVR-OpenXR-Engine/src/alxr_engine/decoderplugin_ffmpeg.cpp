@@ -10,8 +10,10 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
-
-#include <readerwritercircularbuffer.h>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <array>
 
 extern "C" {
 #include <libavutil/log.h>
@@ -83,10 +85,17 @@ using AVPacketPtr = std::unique_ptr<AVPacket, AVPacketDeleter>;
 struct NALPacket
 {
     AVPacketPtr data;
+    // trackingFrameIndex, the target display time of the frame in steady clock ns.
     std::uint64_t frameIndex;
+    bool isIDR;
+    bool isReference;
 
-    /*constexpr*/ inline NALPacket(AVPacket* p = nullptr, const std::uint64_t fi = std::uint64_t(-1)) noexcept
-        : data(p), frameIndex(fi) {}
+    /*constexpr*/ inline NALPacket
+    (
+        AVPacket* p = nullptr, const std::uint64_t fi = std::uint64_t(-1),
+        const bool idr = false, const bool reference = false
+    ) noexcept
+        : data(p), frameIndex(fi), isIDR(idr), isReference(reference) {}
     /*constexpr*/ inline NALPacket(NALPacket&&) noexcept = default;
     /*constexpr*/ inline NALPacket& operator=(NALPacket&&) noexcept = default;
 
@@ -94,6 +103,119 @@ struct NALPacket
     constexpr inline NALPacket& operator=(const NALPacket&) noexcept = delete;
 };
 
+// Packets waiting for the decoder, pushing never blocks the network thread.
+// When the decoder falls behind, frames which can't make their display time anymore are skipped
+// at the next point which keeps the reference chain intact: everything before a queued IDR, or
+// non-reference frames. Skipping a late reference frame is the last resort, the frames after it
+// are dropped until the next IDR, which the decoder has to request.
+// The newest frame is never skipped for being late, there would be nothing left to show.
+class DecodeQueue
+{
+public:
+    // Beyond this the oldest frames are dropped to make room, the latest frame always wins.
+    constexpr static const std::size_t Capacity = 16;
+    // Decoding a short backlog of late reference frames is cheaper than an IDR round trip.
+    constexpr static const std::size_t ReferenceSkipBacklog = 4;
+
+    struct PopResult {
+        std::size_t dropped = 0;
+        std::size_t queueDepth = 0;
+        // The reference chain was broken, a new IDR is needed.
+        bool requestIDR = false;
+        // The IDR asked for with requestIDR is being decoded.
+        bool idrRecovered = false;
+    };
+
+    void push(NALPacket&& packet)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_packets.push_back(std::move(packet));
+            if (m_packets.size() > Capacity && !SkipToLastIDR()) {
+                if (m_packets.front().isReference)
+                    BreakReferenceChain();
+                m_packets.pop_front();
+                ++m_dropped;
+            }
+        }
+        m_cv.notify_one();
+    }
+
+    bool pop(NALPacket& packet, const std::chrono::milliseconds timeout, PopResult& result)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, timeout, [this]() { return !m_packets.empty(); });
+
+        const std::uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (XrSteadyClock::now().time_since_epoch()).count();
+        while (m_packets.size() > 1 && IsLate(m_packets.front(), now)) {
+            if (SkipToLastIDR())
+                continue;
+            if (m_packets.front().isReference && !m_waitingIDR) {
+                if (m_packets.size() < ReferenceSkipBacklog)
+                    break;
+                BreakReferenceChain();
+            }
+            m_packets.pop_front();
+            ++m_dropped;
+        }
+        // Nothing decodes correctly without its references.
+        while (m_waitingIDR && !m_packets.empty() && !m_packets.front().isIDR) {
+            m_packets.pop_front();
+            ++m_dropped;
+        }
+
+        result.dropped = std::exchange(m_dropped, 0);
+        result.queueDepth = 0;
+        const bool popped = !m_packets.empty();
+        if (popped) {
+            packet = std::move(m_packets.front());
+            m_packets.pop_front();
+            result.queueDepth = m_packets.size();
+            if (packet.isIDR) {
+                m_waitingIDR = m_requestIDR = false;
+                result.idrRecovered = std::exchange(m_idrRequested, false);
+            }
+        }
+        result.requestIDR = std::exchange(m_requestIDR, false);
+        m_idrRequested = m_idrRequested || result.requestIDR;
+        return popped;
+    }
+
+private:
+    static inline bool IsLate(const NALPacket& packet, const std::uint64_t now) {
+        return packet.frameIndex != std::uint64_t(-1) && packet.frameIndex < now;
+    }
+
+    inline void BreakReferenceChain() {
+        if (!m_waitingIDR)
+            m_requestIDR = true;
+        m_waitingIDR = true;
+    }
+
+    // Drops everything before the last queued IDR, returns false if there is nothing to drop.
+    bool SkipToLastIDR()
+    {
+        const auto lastIDR = std::find_if(m_packets.rbegin(), m_packets.rend(),
+            [](const NALPacket& p) { return p.isIDR; });
+        if (lastIDR == m_packets.rend() || std::next(lastIDR) == m_packets.rend())
+            return false;
+        const auto skipEnd = std::next(lastIDR).base();
+        m_dropped += std::distance(m_packets.begin(), skipEnd);
+        m_packets.erase(m_packets.begin(), skipEnd);
+        m_waitingIDR = m_requestIDR = false;
+        return true;
+    }
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::deque<NALPacket>   m_packets;
+    std::size_t             m_dropped = 0;
+    bool                    m_waitingIDR = false;
+    bool                    m_requestIDR = false;
+    bool                    m_idrRequested = false;
+};
+
 inline auto AverrorToCodeStr(const int errnum)
 {
     thread_local char buf[AV_ERROR_MAX_STRING_SIZE];
@@ -233,18 +355,29 @@ constexpr inline auto GetVideoTextureMemFuns(const ALXRDecoderType decoderType)
 
 struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
     
-    using AVPacketQueue = moodycamel::BlockingReaderWriterCircularBuffer<NALPacket>;
     using GraphicsPluginPtr = std::shared_ptr<IGraphicsPlugin>;
     using IOpenXrProgramPtr = std::shared_ptr<IOpenXrProgram>;
     using RustCtxPtr = std::shared_ptr<const ALXRRustCtx>;
 
-    AVPacketQueue/*Ptr*/ m_avPacketQueue;
-    AVPixelFormat        m_hwPixFmt = AV_PIX_FMT_NONE;
+    DecodeQueue             m_decodeQueue;
+    const ALVR_CODEC        m_selectedCodecType;
+    AVPixelFormat           m_hwPixFmt = AV_PIX_FMT_NONE;
+
+    // The sw-decoder decodes directly into the graphics plugin's staging buffers when it has
+    // some, see get_staging_buffer. A tag per buffer identifies such frames in UploadFrame.
+    struct StagingBufferTag {
+        IGraphicsPlugin* graphicsPlugin = nullptr;
+        std::size_t      index = std::size_t(-1);
+    };
+    constexpr static const std::size_t MaxStagingBuffers = 32;
+    constexpr static const int StagingAlignment = 64;
+    GraphicsPluginPtr                                   m_stagingGraphicsPlugin{ nullptr };
+    std::array<StagingBufferTag, MaxStagingBuffers>     m_stagingBufferTags{};
     
     virtual ~FFMPEGDecoderPlugin() override {}
 
-    FFMPEGDecoderPlugin()
-    : m_avPacketQueue(360) //std::make_shared<AVPacketQueue>(360))
+    explicit FFMPEGDecoderPlugin(const ALXRCodecType codecType)
+    : m_selectedCodecType{ static_cast<ALVR_CODEC>(codecType) }
     {
         static std::once_flag reg_devices_once{};
         std::call_once(reg_devices_once, []()
@@ -266,20 +399,68 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
         const std::uint64_t trackingFrameIndex
     ) override
     {
+        if (newPacketData.empty()) {
+            // repeat marker, see Run.
+            if (const auto pkt = av_packet_alloc())
+                m_decodeQueue.push({ pkt, trackingFrameIndex });
+            return true;
+        }
         if (const auto pkt = av_packet_alloc()) {
             const std::size_t packetSize = newPacketData.size();
             if (const auto pktBuffer = static_cast<std::uint8_t*>(av_malloc(packetSize))) {
                 std::memcpy(pktBuffer, newPacketData.data(), packetSize);
-                if (av_packet_from_data(pkt, pktBuffer, static_cast<int>(packetSize)) == 0) {
-                    using namespace std::literals::chrono_literals;
-                    constexpr static const auto QueueWaitTimeout = 500ms;
-                    m_avPacketQueue.wait_enqueue_timed({ pkt, trackingFrameIndex }, QueueWaitTimeout);
-                } else av_free(pktBuffer);
+                if (av_packet_from_data(pkt, pktBuffer, static_cast<int>(packetSize)) == 0)
+                    QueueNALPacket(pkt, trackingFrameIndex);
+                else av_free(pktBuffer);
             }
         }
         return true;
     }
 
+    static_assert(FrameBufferPool::PaddingSize >= AV_INPUT_BUFFER_PADDING_SIZE);
+
+    static void ReleaseFrameBuffer(void* opaque, std::uint8_t* /*data*/)
+    {
+        delete static_cast<FrameBufferPool::BufferPtr*>(opaque);
+    }
+
+    virtual bool QueueFrameBuffer
+    (
+        const FrameBufferPool::BufferPtr& frameBuffer,
+        const std::size_t frameSize,
+        const std::uint64_t trackingFrameIndex
+    ) override
+    {
+        if (frameSize == 0)
+            return QueuePacket({}, trackingFrameIndex);
+        // The packet keeps a reference on the pooled buffer, it goes back to the pool when
+        // libavcodec releases the packet: no copy of the frame and no allocation of its data.
+        auto pkt = av_packet_alloc();
+        if (pkt == nullptr)
+            return true;
+        const auto bufferRef = new FrameBufferPool::BufferPtr(frameBuffer);
+        const auto data = reinterpret_cast<std::uint8_t*>(frameBuffer->data());
+        pkt->buf = av_buffer_create(data, static_cast<int>(frameSize + FrameBufferPool::PaddingSize),
+            ReleaseFrameBuffer, bufferRef, 0);
+        if (pkt->buf == nullptr) {
+            delete bufferRef;
+            av_packet_free(&pkt);
+            return true;
+        }
+        pkt->data = data;
+        pkt->size = static_cast<int>(frameSize);
+        QueueNALPacket(pkt, trackingFrameIndex);
+        return true;
+    }
+
+    inline void QueueNALPacket(AVPacket* pkt, const std::uint64_t trackingFrameIndex)
+    {
+        const auto selectedCodec = m_selectedCodecType;
+        const ConstPacketType packet{ pkt->data, static_cast<std::size_t>(pkt->size) };
+        const bool isIDR = is_config(packet, selectedCodec) || is_idr(packet, selectedCodec);
+        m_decodeQueue.push({ pkt, trackingFrameIndex, isIDR, isIDR || is_reference(packet, selectedCodec) });
+    }
+
     virtual bool Run(const IDecoderPlugin::RunCtx& ctx, IDecoderPlugin::shared_bool& isRunningToken) override
     {
         using AVCodecContextPtr = make_av_ptr_type2<AVCodecContext, avcodec_free_context>;
@@ -362,6 +543,8 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
         }
         else {
             codecCtx->thread_count = std::max(1u, ctx.config.cpuThreadCount);
+            m_stagingGraphicsPlugin = graphicsPluginPtr;
+            codecCtx->get_buffer2 = get_staging_buffer;
         }
         Log::Write(Log::Level::Info, Fmt("Decoder thread count: %d", codecCtx->thread_count));
 
@@ -420,11 +603,54 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
         using namespace std::literals::chrono_literals;
         static constexpr const auto QueueWaitTimeout = 500ms;
         std::size_t planeCount = 0;
-        std::once_flag once_flag{};
+        int videoWidth = 0, videoHeight = 0;
+        const AVFrame* lastFrame = nullptr;
+        const auto UploadFrame = [&](const AVFrame& frame, const std::uint64_t frameIndex)
+        {
+            const std::size_t uvHeight = static_cast<std::size_t>(frame.height / 2);
+            IGraphicsPlugin::YUVBuffer buffer{
+                .luma {
+                    .data = frame.data[0],
+                    .pitch = static_cast<std::size_t>(frame.linesize[0]),
+                    .height = static_cast<std::size_t>(frame.height)
+                },
+                .chroma {
+                    .data = frame.data[1],
+                    .pitch = static_cast<std::size_t>(frame.linesize[1]),
+                    .height = uvHeight
+                },
+                .frameIndex = frameIndex,
+                .stagingBufferIndex = StagingBufferIndex(frame)
+            };
+            if (planeCount > 2) {
+                buffer.chroma2 = {
+                    .data = frame.data[2],
+                    .pitch = static_cast<std::size_t>(frame.linesize[2]),
+                    .height = uvHeight
+                };
+            }
+            std::invoke(UpdateVideoTextures, graphicsPluginPtr, buffer);
+            LatencyCollector::Instance().uploaded(frameIndex);
+        };
         while (isRunningToken)
         {
             NALPacket nalPacket{};
-            if (!m_avPacketQueue.wait_dequeue_timed(nalPacket, QueueWaitTimeout))
+            DecodeQueue::PopResult popResult{};
+            const bool popped = m_decodeQueue.pop(nalPacket, QueueWaitTimeout, popResult);
+            auto& latencyCollector = LatencyCollector::Instance();
+            latencyCollector.decoderQueueDepth(static_cast<std::uint32_t>(popResult.queueDepth));
+            if (popResult.dropped > 0)
+                latencyCollector.decoderDropped(popResult.dropped);
+            if (const auto rustCtx = ctx.rustCtx) {
+                if (popResult.requestIDR) {
+                    Log::Write(Log::Level::Verbose, "Decoder dropped a reference frame, sending IDR request");
+                    rustCtx->setWaitingNextIDR(true);
+                    rustCtx->requestIDR();
+                }
+                if (popResult.idrRecovered)
+                    rustCtx->setWaitingNextIDR(false);
+            }
+            if (!popped)
                 continue;
 
             assert(nalPacket.data != nullptr);
@@ -436,12 +662,25 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
             using microseconds64 = duration<std::uint64_t, std::chrono::seconds::period>;
             pkt->pts = duration_cast<microseconds64>(ClockType::now().time_since_epoch()).count();
 
+            if (pkt->size == 0) {
+                // Repeat marker: the server skipped an unchanged frame, nothing to decode.
+                // Upload the last decoded frame again so it is shown with the new frame's pose.
+                if (lastFrame == nullptr)
+                    continue;
+                LatencyCollector::Instance().decoderInput(nalPacket.frameIndex);
+                LatencyCollector::Instance().decoderOutput(nalPacket.frameIndex);
+                UploadFrame(*lastFrame, nalPacket.frameIndex);
+                continue;
+            }
+
             LatencyCollector::Instance().decoderInput(nalPacket.frameIndex);
             const auto result = decode_packet(pkt.get(), codecCtx.get(), hwFrame.get());
             LatencyCollector::Instance().decoderOutput(nalPacket.frameIndex);
             //av_packet_unref(pkt.get());
             if (result < 0)
             {
+                // the output frame was reset by the decoder, there is nothing left to repeat.
+                lastFrame = nullptr;
                 LogLibAV(Log::Level::Warning, result, "Failed to decode packet");
                 continue;
             }
@@ -455,8 +694,20 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
             }();
             assert(avFrame != nullptr);
 
-            std::call_once(once_flag, [&/*, cvt = CreateVideoTextures*/]()
+            if (avFrame->width != videoWidth || avFrame->height != videoHeight)
             {
+                // The server may switch its encode resolution at runtime (dynamic resolution),
+                // the new textures are sampled over the same quad so a smaller frame is upscaled.
+                std::unique_lock<std::mutex> renderLock{};
+                if (videoWidth != 0) {
+                    Log::Write(Log::Level::Info, Fmt("Video frame resized from %dx%d to %dx%d, re-creating video textures",
+                        videoWidth, videoHeight, avFrame->width, avFrame->height));
+                    if (ctx.renderMutex != nullptr)
+                        renderLock = std::unique_lock<std::mutex>(*ctx.renderMutex);
+                    graphicsPluginPtr->ClearVideoTextures();
+                }
+                videoWidth = avFrame->width;
+                videoHeight = avFrame->height;
                 Log::Write(Log::Level::Verbose, Fmt("Creating video textures, width=%d, height=%d, pitch-0=%d, pitch-1=%d, type=%d sw-type=%d",
                     avFrame->width, avFrame->height, avFrame->linesize[0], avFrame->linesize[1], avFrame->format, codecCtx->sw_pix_fmt));
                 const auto pixFmt = GetXrPixelFormat(*avFrame, *codecCtx);
@@ -472,30 +723,10 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
                         programPtr->SetRenderMode(IOpenXrProgram::RenderMode::VideoStream);
                     }
                 }
-            });
-
-            const std::size_t uvHeight = static_cast<std::size_t>(avFrame->height / 2);
-            IGraphicsPlugin::YUVBuffer buffer{
-                .luma {
-                    .data = avFrame->data[0],
-                    .pitch = static_cast<std::size_t>(avFrame->linesize[0]),
-                    .height = static_cast<std::size_t>(avFrame->height)
-                },
-                .chroma {
-                    .data = avFrame->data[1],
-                    .pitch = static_cast<std::size_t>(avFrame->linesize[1]),
-                    .height = uvHeight
-                },
-                .frameIndex = nalPacket.frameIndex
-            };
-            if (planeCount > 2) {
-                buffer.chroma2 = {
-                    .data = avFrame->data[2],
-                    .pitch = static_cast<std::size_t>(avFrame->linesize[2]),
-                    .height = uvHeight
-                };
             }
-            std::invoke(UpdateVideoTextures, graphicsPluginPtr, buffer);
+
+            UploadFrame(*avFrame, nalPacket.frameIndex);
+            lastFrame = avFrame.get();
         }
         return true;
     }
@@ -615,6 +846,71 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
     }
 #endif
 
+    inline std::size_t StagingBufferIndex(const AVFrame& frame) const
+    {
+        if (frame.buf[0] == nullptr)
+            return std::size_t(-1);
+        const auto tag = static_cast<const StagingBufferTag*>(av_buffer_get_opaque(frame.buf[0]));
+        const std::less<const StagingBufferTag*> less{};
+        if (less(tag, m_stagingBufferTags.data()) || !less(tag, m_stagingBufferTags.data() + m_stagingBufferTags.size()))
+            return std::size_t(-1);
+        return tag->index;
+    }
+
+    static void release_staging_buffer(void* opaque, std::uint8_t* /*data*/)
+    {
+        const auto tag = static_cast<const StagingBufferTag*>(opaque);
+        tag->graphicsPlugin->ReleaseVideoStagingBuffer(tag->index);
+    }
+
+    // get_buffer2 of the sw-decoder: planes are allocated in a staging buffer of the graphics
+    // plugin so uploading the frame is a single GPU copy, falls back to the default allocator
+    // if there is no free staging buffer.
+    static int get_staging_buffer(AVCodecContext* avctx, AVFrame* frame, int flags)
+    {
+        const auto this_ = reinterpret_cast<FFMPEGDecoderPlugin*>(avctx->opaque);
+        const auto format = static_cast<AVPixelFormat>(frame->format);
+        if (this_ == nullptr || this_->m_stagingGraphicsPlugin == nullptr || ToXrPixelFormat(format) == XrPixelFormat::Uknown)
+            return avcodec_default_get_buffer2(avctx, frame, flags);
+
+        int width = frame->width, height = frame->height;
+        int linesizeAlign[AV_NUM_DATA_POINTERS];
+        avcodec_align_dimensions2(avctx, &width, &height, linesizeAlign);
+        int linesizes[4] = { 0, 0, 0, 0 };
+        if (av_image_fill_linesizes(linesizes, format, width) < 0)
+            return avcodec_default_get_buffer2(avctx, frame, flags);
+        // Keeps every plane offset and pitch a multiple of the texel size for the GPU copy.
+        for (auto& linesize : linesizes)
+            linesize = FFALIGN(linesize, StagingAlignment);
+        std::uint8_t* planes[4] = {};
+        const int size = av_image_fill_pointers(planes, format, height, nullptr, linesizes);
+        if (size < 0)
+            return avcodec_default_get_buffer2(avctx, frame, flags);
+
+        IGraphicsPlugin::StagingBuffer stagingBuffer{};
+        const auto graphicsPlugin = this_->m_stagingGraphicsPlugin.get();
+        if (!graphicsPlugin->AcquireVideoStagingBuffer(size + StagingAlignment, stagingBuffer))
+            return avcodec_default_get_buffer2(avctx, frame, flags);
+        if (stagingBuffer.index >= this_->m_stagingBufferTags.size()) {
+            graphicsPlugin->ReleaseVideoStagingBuffer(stagingBuffer.index);
+            return avcodec_default_get_buffer2(avctx, frame, flags);
+        }
+
+        auto& tag = this_->m_stagingBufferTags[stagingBuffer.index];
+        tag = { graphicsPlugin, stagingBuffer.index };
+        const auto base = reinterpret_cast<std::uint8_t*>(FFALIGN(reinterpret_cast<std::uintptr_t>(stagingBuffer.data), StagingAlignment));
+        frame->buf[0] = av_buffer_create(base, size, release_staging_buffer, &tag, 0);
+        if (frame->buf[0] == nullptr) {
+            graphicsPlugin->ReleaseVideoStagingBuffer(stagingBuffer.index);
+            return AVERROR(ENOMEM);
+        }
+        av_image_fill_pointers(frame->data, format, height, base, linesizes);
+        for (std::size_t plane = 0; plane < 4; ++plane)
+            frame->linesize[plane] = linesizes[plane];
+        frame->extended_data = frame->data;
+        return 0;
+    }
+
     static AVPixelFormat get_hw_format(AVCodecContext* avctx, const AVPixelFormat* pix_fmts)
     {
         if (pix_fmts == nullptr || avctx == nullptr) {
@@ -638,8 +934,8 @@ struct FFMPEGDecoderPlugin final : public IDecoderPlugin {
 };
 }
 
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_FFMPEG() {
-    return std::make_shared<FFMPEGDecoderPlugin>();
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_FFMPEG(const ALXRCodecType codecType) {
+    return std::make_shared<FFMPEGDecoderPlugin>(codecType);
 }
 
 #endif
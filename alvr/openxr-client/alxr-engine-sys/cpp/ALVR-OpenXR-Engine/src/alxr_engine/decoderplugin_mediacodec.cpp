@@ -320,6 +320,10 @@ public:
                     LatencyCollector::Instance().decoderOutput(frameIndex);
                 }
                 AMediaCodec_releaseOutputBuffer(codec.get(), outputBufferId, true);
+                // Rendered to the surface of the video texture
+                if (frameIndex != FrameIndexMap::NullIndex) {
+                    LatencyCollector::Instance().uploaded(frameIndex);
+                }
             }
             else if (outputBufferId == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED)
             {
@@ -340,7 +344,10 @@ struct MediaCodecDecoderPlugin final : IDecoderPlugin
     using GraphicsPluginPtr = std::shared_ptr<IGraphicsPlugin>;
 
     AVPacketQueue           m_packetQueue { 360 };
-    std::atomic<ALVR_CODEC> m_selectedCodecType { ALVR_CODEC_H265 };
+    const ALVR_CODEC        m_selectedCodecType;
+
+    explicit MediaCodecDecoderPlugin(const ALXRCodecType codecType)
+    : m_selectedCodecType{ static_cast<ALVR_CODEC>(codecType) } {}
 
     virtual ~MediaCodecDecoderPlugin() override {
         Log::Write(Log::Level::Info, "MediaCodecDecoderPlugin destroyed");
@@ -354,8 +361,12 @@ struct MediaCodecDecoderPlugin final : IDecoderPlugin
     {
         using namespace std::literals::chrono_literals;
         constexpr static const auto QueueWaitTimeout = 500ms;
-        
-        const auto selectedCodec = m_selectedCodecType.load();
+
+        // Repeat marker, MediaCodec keeps presenting its last output buffer.
+        if (newPacketData.empty())
+            return true;
+
+        const auto selectedCodec = m_selectedCodecType;
         const auto vpssps = find_vpssps(newPacketData, selectedCodec);
         if (is_config(vpssps, selectedCodec))
         {
@@ -422,7 +433,6 @@ struct MediaCodecDecoderPlugin final : IDecoderPlugin
             Log::Write(Log::Level::Error, "Decoder run parameters not valid.");
             return false;
         }
-        m_selectedCodecType.store(static_cast<ALVR_CODEC>(ctx.config.codecType));
         
         XrImageListener imgListener { ctx.programPtr };
         if (!imgListener.IsValid()) {
@@ -548,7 +558,7 @@ struct MediaCodecDecoderPlugin final : IDecoderPlugin
 };
 }
 
-std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_MediaCodec() {
-    return std::make_shared<MediaCodecDecoderPlugin>();
+std::shared_ptr<IDecoderPlugin> CreateDecoderPlugin_MediaCodec(const ALXRCodecType codecType) {
+    return std::make_shared<MediaCodecDecoderPlugin>(codecType);
 }
 #endif
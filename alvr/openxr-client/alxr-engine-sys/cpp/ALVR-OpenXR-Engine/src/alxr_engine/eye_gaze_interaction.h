@@ -21,10 +21,12 @@ struct EyeGazeInteraction {
 
 	void PollActions();
 
+	// sampleTime, if not null, gets the time of the eye tracker sample located.
 	inline std::optional<XrSpaceLocation> GetSpaceLocation
 	(
 		const XrSpace& baseSpace,
-		const XrTime& time
+		const XrTime& time,
+		XrTime* sampleTime = nullptr
 	) const;
 
 private:
@@ -158,7 +160,8 @@ inline void EyeGazeInteraction::PollActions() {
 inline std::optional<XrSpaceLocation> EyeGazeInteraction::GetSpaceLocation
 (
 	const XrSpace& baseSpace,
-	const XrTime& time
+	const XrTime& time,
+	XrTime* sampleTime /*= nullptr*/
 ) const {
 	if (m_eyeGazeActive == XR_FALSE)
 		return {};
@@ -174,6 +177,9 @@ inline std::optional<XrSpaceLocation> EyeGazeInteraction::GetSpaceLocation
 	};
 	if (XR_FAILED(xrLocateSpace(m_eyeGazeSpace, baseSpace, time, &gazeLocation)))
 		return {};
+	if (sampleTime != nullptr)
+		*sampleTime = eyeGazeSampleTime.time;
+	gazeLocation.next = nullptr;
 	return gazeLocation;
 }
 
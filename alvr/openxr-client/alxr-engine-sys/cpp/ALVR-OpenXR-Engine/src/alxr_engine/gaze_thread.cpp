@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "common.h"
+#include "gaze_thread.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "logger.h"
+#include "openxr_program.h"
+#include "ALVR-common/thread_policy.h"
+
+void XrGazeThread::Stop()
+{
+	m_isRuningToken = false;
+	if (m_gazeThread.joinable()) {
+		Log::Write(Log::Level::Info, "Waiting for gaze thread to shutdown...");
+		m_gazeThread.join();
+	}
+}
+
+void XrGazeThread::Start(const XrGazeThread::StartCtx& ctx)
+{
+	if (m_isRuningToken || ctx.programPtr == nullptr || ctx.rustCtx == nullptr ||
+		ctx.rustCtx->gazeSend == nullptr)
+		return;
+
+	m_isRuningToken = true;
+	m_gazeThread = std::thread
+	{
+		[this, startCtx = ctx]()
+		{
+			// Above the normal threads but below the decoder, the work is a few us per sample.
+			thread_policy::Policy policy{};
+			policy.realtime = true;
+			policy.realtimePriority = 1;
+			const auto applied = thread_policy::ApplyToCurrentThread("alxr-gaze", policy);
+			Log::Write(Log::Level::Info, Fmt("Gaze thread: %s scheduling", thread_policy::SchedulingName(applied.scheduling)));
+
+			using namespace std::chrono;
+			GazeSample lastSample{};
+			// starts assuming a 120Hz eye tracker
+			double samplePeriodNs = 8333333.0;
+			while (m_isRuningToken) {
+				const auto pollPeriod = nanoseconds(std::clamp
+				(
+					static_cast<std::int64_t>(samplePeriodNs / 2),
+					MinPollPeriodNs, MaxPollPeriodNs
+				));
+				const auto nextPoll = steady_clock::now() + pollPeriod;
+
+				GazeSample sample{};
+				if (!startCtx.programPtr->IsSessionRunning() || !startCtx.programPtr->GetGazeSample(sample)) {
+					// no eye tracking (yet)
+					std::this_thread::sleep_for(nanoseconds(MaxPollPeriodNs));
+					continue;
+				}
+				// The runtimes which don't give the sample time get the poll time as timestamp, a
+				// new sample is told by its values then. Real eye trackers never repeat them.
+				const bool isNew = sample.timestampNs != lastSample.timestampNs &&
+					(std::memcmp(&sample.direction, &lastSample.direction, sizeof(sample.direction)) != 0 ||
+					 std::memcmp(sample.eyes, lastSample.eyes, sizeof(sample.eyes)) != 0);
+				if (isNew) {
+					if (lastSample.timestampNs != 0 && sample.timestampNs > lastSample.timestampNs) {
+						const double period = static_cast<double>(sample.timestampNs - lastSample.timestampNs);
+						samplePeriodNs += (std::min(period, 4.0 * samplePeriodNs) - samplePeriodNs) * 0.05;
+					}
+					lastSample = sample;
+					startCtx.rustCtx->gazeSend(&sample);
+				}
+				std::this_thread::sleep_until(nextPoll);
+			}
+			thread_policy::UnregisterCurrentThread();
+			Log::Write(Log::Level::Info, "Gaze thread exiting.");
+		}
+	};
+	Log::Write(Log::Level::Info, "Gaze thread started.");
+}
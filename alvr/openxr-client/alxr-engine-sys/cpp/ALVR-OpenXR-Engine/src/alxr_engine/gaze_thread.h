@@ -0,0 +1,44 @@
+#pragma once
+#ifndef ALXR_GAZE_THREAD_H
+#define ALXR_GAZE_THREAD_H
+
+#include <memory>
+#include <atomic>
+#include <thread>
+
+#include "alxr_ctypes.h"
+
+struct IOpenXrProgram;
+
+// Sends the eye gaze on its own stream at the eye tracker rate, instead of once per tracking
+// update in TrackingInfo. OpenXR doesn't give the eye tracker rate: the thread polls faster
+// than the estimated rate and only sends the samples it hasn't seen yet.
+class XrGazeThread {
+	std::atomic<bool> m_isRuningToken{ false };
+	std::thread		  m_gazeThread;
+
+public:
+	// Bounds of the polling period, half of the estimated sample period.
+	static constexpr const std::int64_t MinPollPeriodNs = 1000000;
+	static constexpr const std::int64_t MaxPollPeriodNs = 8000000;
+
+	inline XrGazeThread() = default;
+
+	inline XrGazeThread(const XrGazeThread&) = delete;
+	inline XrGazeThread& operator=(const XrGazeThread&) = delete;
+
+	inline ~XrGazeThread() {
+		Stop();
+	}
+
+	struct StartCtx {
+		using IOpenXrProgramPtr = std::shared_ptr<IOpenXrProgram>;
+		using ALXRRustCtxPtr	= std::shared_ptr<const ALXRRustCtx>;
+
+		IOpenXrProgramPtr programPtr;
+		ALXRRustCtxPtr	  rustCtx;
+	};
+	void Start(const StartCtx& ctx);
+	void Stop();
+};
+#endif
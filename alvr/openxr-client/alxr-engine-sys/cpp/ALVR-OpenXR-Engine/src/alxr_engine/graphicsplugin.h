@@ -136,7 +136,20 @@ struct IGraphicsPlugin {
         Buffer chroma{};
         Buffer chroma2{};
         std::uint64_t frameIndex = std::uint64_t(-1);
+        // Index of the staging buffer holding the planes, see AcquireVideoStagingBuffer.
+        std::size_t stagingBufferIndex = std::size_t(-1);
     };
+
+    // Persistently mapped upload memory the CPU decoder can decode into, UpdateVideoTexture
+    // then only records a copy to the video texture. Returns false if not supported or if
+    // every buffer is still used by the decoder or by a copy in flight.
+    struct StagingBuffer {
+        void* data = nullptr;
+        std::size_t size = 0;
+        std::size_t index = std::size_t(-1);
+    };
+    virtual bool AcquireVideoStagingBuffer(const std::size_t /*size*/, StagingBuffer& /*buffer*/) { return false; }
+    virtual void ReleaseVideoStagingBuffer(const std::size_t /*index*/) {}
     virtual void UpdateVideoTexture(const YUVBuffer& /*yuvBuffer*/) {}
     virtual void UpdateVideoTextureCUDA(const YUVBuffer& /*yuvBuffer*/) {}
     virtual void UpdateVideoTextureD3D11VA(const YUVBuffer& /*yuvBuffer*/) {}
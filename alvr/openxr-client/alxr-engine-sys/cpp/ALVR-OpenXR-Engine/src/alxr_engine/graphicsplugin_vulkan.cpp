@@ -2833,6 +2833,15 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             .multiview = m_isMultiViewSupported ? VK_TRUE : VK_FALSE,
             .samplerYcbcrConversion = VK_TRUE,
         };
+#ifndef XR_USE_PLATFORM_ANDROID
+        // m_texCopy synchronizes the video uploads with rendering.
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+            .pNext = nullptr,
+            .timelineSemaphore = VK_TRUE
+        };
+        features11.pNext = &timelineFeatures;
+#endif
         const VkPhysicalDeviceFeatures2 features2{
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
             .pNext = &features11,
@@ -2974,6 +2983,8 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
 #ifndef XR_USE_PLATFORM_ANDROID
         m_texRendereComplete.Create(m_vkDevice, true);
         m_texCopy.Create(m_vkDevice, true);
+        m_fpGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)
+            vkGetInstanceProcAddr(m_vkInstance, "vkGetSemaphoreCounterValueKHR");
 #endif
 #ifdef XR_ENABLE_CUDA_INTEROP
         InitCuda();
@@ -3058,7 +3069,9 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             }
         }
 
-        if (!m_videoCpyCmdBuffer.Init(m_vkDevice, m_queueFamilyIndexVideoCpy)) THROW("Failed to create command buffer");
+        for (auto& videoCpyCmdBuffer : m_videoCpyCmdBuffers) {
+            if (!videoCpyCmdBuffer.Init(m_vkDevice, m_queueFamilyIndexVideoCpy)) THROW("Failed to create command buffer");
+        }
 
         m_quadBuffer.Init(m_vkDevice, &m_memAllocator,
             { {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Geometry::QuadVertex, position)},
@@ -3215,7 +3228,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         renderFun(imageIndex, *swapchainContextPtr);
 
         m_cmdBuffer.End();
-#if 1 //#ifdef XR_USE_PLATFORM_ANDROID
+#ifdef XR_USE_PLATFORM_ANDROID
         m_cmdBuffer.Exec(m_vkQueue);
 #else
         m_cmdBuffer.Exec<1, 1>(m_vkQueue, { &m_texRendereComplete }, { &m_texCopy }, { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT });
@@ -3733,6 +3746,13 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         m_renderTex = std::size_t(-1);
         m_currentVideoTex = 0;
         
+#ifndef XR_USE_PLATFORM_ANDROID
+        // uploads are not waited on by UpdateVideoTexture.
+        for (auto& videoCpyCmdBuffer : m_videoCpyCmdBuffers) {
+            videoCpyCmdBuffer.Wait();
+            videoCpyCmdBuffer.Reset();
+        }
+#endif
         //m_texRendereComplete.WaitForGpu();
         m_videoTextures = { VideoTexture {}, VideoTexture {} };
 #ifdef XR_USE_PLATFORM_ANDROID
@@ -3766,6 +3786,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
                 vidTex.stagingBuffer,
                 vidTex.stagingBufferMemory
             );
+            CHECK_VKCMD(vkMapMemory(m_vkDevice, vidTex.stagingBufferMemory, 0, vidTex.stagingBufferSize, 0, &vidTex.stagingBufferPtr));
             vidTex.texture.Create
             (
                 m_vkDevice, &m_memAllocator,
@@ -3940,10 +3961,101 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         return true;
     }
 
+    virtual bool AcquireVideoStagingBuffer(const std::size_t size, StagingBuffer& stagingBuffer) override
+    {
+#ifndef XR_USE_PLATFORM_ANDROID
+        if (m_fpGetSemaphoreCounterValue == nullptr || m_texCopy.fence == VK_NULL_HANDLE)
+            return false;
+        std::uint64_t completedCopy = 0;
+        if (m_fpGetSemaphoreCounterValue(m_vkDevice, m_texCopy.fence, &completedCopy) != VK_SUCCESS)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_videoStagingMutex);
+        // Prefer a free buffer which is already big enough, otherwise grow one.
+        std::size_t slotIndex = std::size_t(-1);
+        for (std::size_t index = 0; index < m_videoStagingSlots.size(); ++index) {
+            const auto& slot = m_videoStagingSlots[index];
+            if (slot.inUse || slot.copyValue > completedCopy)
+                continue;
+            if (slot.size >= size) {
+                slotIndex = index;
+                break;
+            }
+            if (slotIndex == std::size_t(-1))
+                slotIndex = index;
+        }
+        if (slotIndex == std::size_t(-1))
+            return false;
+
+        auto& slot = m_videoStagingSlots[slotIndex];
+        if (slot.size < size) {
+            DestroyVideoStagingSlot(slot);
+            slot.size = createStaggingBuffer
+            (
+                size,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                slot.buffer,
+                slot.memory
+            );
+            void* mapped = nullptr;
+            CHECK_VKCMD(vkMapMemory(m_vkDevice, slot.memory, 0, slot.size, 0, &mapped));
+            slot.mapped = reinterpret_cast<std::uint8_t*>(mapped);
+        }
+        slot.inUse = true;
+        stagingBuffer = {
+            .data = slot.mapped,
+            .size = static_cast<std::size_t>(slot.size),
+            .index = slotIndex
+        };
+        return true;
+#else
+        (void)size; (void)stagingBuffer;
+        return false;
+#endif
+    }
+
+    virtual void ReleaseVideoStagingBuffer(const std::size_t index) override
+    {
+#ifndef XR_USE_PLATFORM_ANDROID
+        std::lock_guard<std::mutex> lock(m_videoStagingMutex);
+        if (index < m_videoStagingSlots.size())
+            m_videoStagingSlots[index].inUse = false;
+#else
+        (void)index;
+#endif
+    }
+
+    // The copy command buffer of video texture index, reset for recording. The previous upload
+    // into the texture, VideoTexCount frames ago, is checked on m_texCopy instead of waited on:
+    // false if it is still running, the texture and its staging buffer are still being read.
+    // Only waits when the timeline semaphores are not available.
+    bool AcquireVideoCpyCmdBuffer(const std::size_t index)
+    {
+        auto& cmdBuffer = m_videoCpyCmdBuffers[index];
+#ifndef XR_USE_PLATFORM_ANDROID
+        if (m_fpGetSemaphoreCounterValue != nullptr && m_texCopy.fence != VK_NULL_HANDLE) {
+            std::uint64_t completedCopy = 0;
+            if (m_fpGetSemaphoreCounterValue(m_vkDevice, m_texCopy.fence, &completedCopy) != VK_SUCCESS ||
+                completedCopy < m_videoCpyValues[index])
+                return false;
+        }
+#endif
+        // The fence is already signaled.
+        if (cmdBuffer.state == CmdBuffer::CmdBufferState::Executing && !cmdBuffer.Wait())
+            return false;
+        return cmdBuffer.Reset();
+    }
+
     virtual void UpdateVideoTexture(const YUVBuffer& yuvBuffer) override
     {
         const std::size_t freeIndex = m_currentVideoTex.load();
         auto& videoTex = m_videoTextures[freeIndex];
+        auto& videoCpyCmdBuffer = m_videoCpyCmdBuffers[freeIndex];
+        if (!AcquireVideoCpyCmdBuffer(freeIndex)) {
+            // The GPU is VideoTexCount uploads behind, drop the frame rather than stall the decoder.
+            return;
+        }
 
         const bool has3Planes = yuvBuffer.chroma2.data != nullptr;
         const std::size_t lumaSize    = LumaSize(videoTex.format);
@@ -3952,11 +4064,34 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         const std::size_t chromaVSize = has3Planes ? chromaUSize : 0;
 
         const std::size_t textureSize = videoTex.width * videoTex.height;
-        const VkDeviceSize uPlaneOffset = textureSize * lumaSize;
-        const VkDeviceSize vPlaneOffset = has3Planes ? uPlaneOffset + ((textureSize / 2) * chromaUSize) : 0;
+        VkDeviceSize yPlaneOffset = 0;
+        VkDeviceSize uPlaneOffset = textureSize * lumaSize;
+        VkDeviceSize vPlaneOffset = has3Planes ? uPlaneOffset + ((textureSize / 2) * chromaUSize) : 0;
+        // in texels, 0 when tightly packed.
+        std::array<std::uint32_t, 3> rowLengths{ 0, 0, 0 };
+        VkBuffer srcBuffer = videoTex.stagingBuffer;
 
-        void* data = nullptr;
-        vkMapMemory(m_vkDevice, videoTex.stagingBufferMemory, 0, videoTex.stagingBufferSize, 0, &data);
+#ifndef XR_USE_PLATFORM_ANDROID
+        VideoStagingSlot* stagingSlot = nullptr;
+        if (yuvBuffer.stagingBufferIndex < m_videoStagingSlots.size())
+            stagingSlot = &m_videoStagingSlots[yuvBuffer.stagingBufferIndex];
+        if (stagingSlot != nullptr) {
+            // The decoder wrote the planes in the staging buffer, upload them in place.
+            const auto planeOffset = [&](const Buffer& plane) {
+                return static_cast<VkDeviceSize>(reinterpret_cast<const std::uint8_t*>(plane.data) - stagingSlot->mapped);
+            };
+            srcBuffer = stagingSlot->buffer;
+            yPlaneOffset = planeOffset(yuvBuffer.luma);
+            uPlaneOffset = planeOffset(yuvBuffer.chroma);
+            rowLengths[0] = static_cast<std::uint32_t>(yuvBuffer.luma.pitch / lumaSize);
+            rowLengths[1] = static_cast<std::uint32_t>(yuvBuffer.chroma.pitch / chromaUSize);
+            if (has3Planes) {
+                vPlaneOffset = planeOffset(yuvBuffer.chroma2);
+                rowLengths[2] = static_cast<std::uint32_t>(yuvBuffer.chroma2.pitch / chromaVSize);
+            }
+        }
+        else
+#endif
         {
             constexpr const auto copy2d = []
             (
@@ -3981,7 +4116,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             };
 
             const auto& luma = yuvBuffer.luma;
-            const auto yPlanePtr = reinterpret_cast<std::uint8_t*>(data);               
+            const auto yPlanePtr = reinterpret_cast<std::uint8_t*>(videoTex.stagingBufferPtr);
             copy2d
             (
                 yPlanePtr, reinterpret_cast<const std::uint8_t*>(luma.data),
@@ -4007,16 +4142,14 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
                 );
             }
         }
-        vkUnmapMemory(m_vkDevice, videoTex.stagingBufferMemory);
 
-        m_videoCpyCmdBuffer.Reset();
-        m_videoCpyCmdBuffer.Begin();
+        videoCpyCmdBuffer.Begin();
 
-        videoTex.texture.TransitionLayout(m_videoCpyCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        videoTex.texture.TransitionLayout(videoCpyCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
         {
             const VkBufferImageCopy buffImgCopy{
-                .bufferOffset = 0,
-                .bufferRowLength = 0,
+                .bufferOffset = yPlaneOffset,
+                .bufferRowLength = rowLengths[0],
                 .bufferImageHeight = 0,
                 .imageSubresource {
                     .aspectMask = VK_IMAGE_ASPECT_PLANE_0_BIT,
@@ -4033,6 +4166,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             };
             std::array<VkBufferImageCopy, 3> region{ buffImgCopy, buffImgCopy, buffImgCopy };
             region[1].bufferOffset = uPlaneOffset;
+            region[1].bufferRowLength = rowLengths[1];
             region[1].imageSubresource.aspectMask = VK_IMAGE_ASPECT_PLANE_1_BIT;
             region[1].imageExtent = {
                 static_cast<std::uint32_t>(videoTex.width / 2),
@@ -4041,16 +4175,27 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             };
             region[2] = region[1];
             region[2].bufferOffset = vPlaneOffset;
+            region[2].bufferRowLength = rowLengths[2];
             region[2].imageSubresource.aspectMask = VK_IMAGE_ASPECT_PLANE_2_BIT;
             const auto regionCount = static_cast<std::uint32_t>(has3Planes ? region.size() : 2);
             const auto texImage = videoTex.texture.texImage;
-            vkCmdCopyBufferToImage(m_videoCpyCmdBuffer.buf, videoTex.stagingBuffer, texImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, region.data());
+            vkCmdCopyBufferToImage(videoCpyCmdBuffer.buf, srcBuffer, texImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, region.data());
         }
-        videoTex.texture.TransitionLayout(m_videoCpyCmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        videoTex.texture.TransitionLayout(videoCpyCmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-        m_videoCpyCmdBuffer.End();
-        m_videoCpyCmdBuffer.Exec(m_VideoCpyQueue);//ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy }); //Exec(m_VideoCpyQueue);
-        m_videoCpyCmdBuffer.Wait();
+        videoCpyCmdBuffer.End();
+#ifndef XR_USE_PLATFORM_ANDROID
+        // Rendering waits on m_texCopy instead of blocking the decoder until the copy is done.
+        videoCpyCmdBuffer.ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy });
+        m_videoCpyValues[freeIndex] = m_texCopy.fenceValue.load();
+        if (stagingSlot != nullptr) {
+            std::lock_guard<std::mutex> lock(m_videoStagingMutex);
+            stagingSlot->copyValue = m_texCopy.fenceValue.load();
+        }
+#else
+        videoCpyCmdBuffer.Exec(m_VideoCpyQueue);
+        videoCpyCmdBuffer.Wait();
+#endif
         
         videoTex.frameIndex = yuvBuffer.frameIndex;
         m_currentVideoTex.store((freeIndex + 1) % VideoTexCount);
@@ -4287,20 +4432,22 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
                 .bottom = desc.Height,                
                 .back = 1,
             };
-            m_videoCpyCmdBuffer.Wait();
-            m_videoCpyCmdBuffer.Reset();
-            m_videoCpyCmdBuffer.Begin();
+            auto& videoCpyCmdBuffer = m_videoCpyCmdBuffers[freeIndex];
+            if (!AcquireVideoCpyCmdBuffer(freeIndex))
+                return;
+            videoCpyCmdBuffer.Begin();
 
-            videoTex.texture.TransitionLayout(m_videoCpyCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            videoTex.texture.TransitionLayout(videoCpyCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
             devCtx->CopySubresourceRegion(dstVideoTexture.Get(), 0, 0, 0, 0, src_texture.Get(), texture_index, &sourceRegion);
             // Flush to submit the 11 command list to the shared command queue.
             devCtx->Flush();
 
-            videoTex.texture.TransitionLayout(m_videoCpyCmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            videoTex.texture.TransitionLayout(videoCpyCmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-            m_videoCpyCmdBuffer.End();
-            m_videoCpyCmdBuffer.ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy });//Exec(m_VideoCpyQueue);//ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy }); //Exec(m_VideoCpyQueue);
+            videoCpyCmdBuffer.End();
+            videoCpyCmdBuffer.ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy });//Exec(m_VideoCpyQueue);//ExecSignalers<1>(m_VideoCpyQueue, { &m_texCopy }); //Exec(m_VideoCpyQueue);
+            m_videoCpyValues[freeIndex] = m_texCopy.fenceValue.load();
         }
 
         m_currentVideoTex.store((freeIndex + 1) % m_videoTextures.size());
@@ -4410,6 +4557,10 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
     
     virtual ~VulkanGraphicsPlugin() override {
         ClearImageDescriptorSetLayouts();
+#ifndef XR_USE_PLATFORM_ANDROID
+        for (auto& slot : m_videoStagingSlots)
+            DestroyVideoStagingSlot(slot);
+#endif
         Log::Write(Log::Level::Verbose, "VulkanGraphicsPlugin destroyed.");
     }
 
@@ -4456,8 +4607,6 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
     VkDescriptorPool m_descriptorPool{ VK_NULL_HANDLE };
     std::vector<VkDescriptorSet> m_descriptorSets{};
 
-    CmdBuffer m_videoCpyCmdBuffer{};
-    
     using VideoShaderList = std::array<ShaderProgram, size_t(PassthroughMode::TypeCount)>;
     using VideoShaderMap  = std::array<VideoShaderList, size_t(VideoFragShaderType::TypeCount)>;
     VideoShaderMap m_videoShaders {};
@@ -4479,9 +4628,39 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
 
     constexpr static const std::size_t VideoTexCount = 2;
 
+    // One per video texture: the upload of a texture reuses the command buffer of its previous one.
+    std::array<CmdBuffer, VideoTexCount> m_videoCpyCmdBuffers{};
+
 #ifndef XR_USE_PLATFORM_ANDROID
     SemaphoreTimeline m_texRendereComplete{};
     SemaphoreTimeline m_texCopy{};
+    // m_texCopy value signaled by the last upload of each video texture.
+    std::array<std::uint64_t, VideoTexCount> m_videoCpyValues{};
+    PFN_vkGetSemaphoreCounterValueKHR m_fpGetSemaphoreCounterValue = nullptr;
+
+    // Upload buffers the CPU decoder decodes into, see AcquireVideoStagingBuffer.
+    // A few more than the decoder's reference frames plus the frames being uploaded.
+    struct VideoStagingSlot {
+        VkBuffer       buffer{ VK_NULL_HANDLE };
+        VkDeviceMemory memory{ VK_NULL_HANDLE };
+        VkDeviceSize   size{ 0 };
+        std::uint8_t*  mapped = nullptr;
+        // m_texCopy value of the last upload reading the buffer.
+        std::uint64_t  copyValue = 0;
+        bool           inUse = false;
+    };
+    constexpr static const std::size_t VideoStagingSlotCount = 8;
+    std::array<VideoStagingSlot, VideoStagingSlotCount> m_videoStagingSlots{};
+    std::mutex m_videoStagingMutex{};
+
+    void DestroyVideoStagingSlot(VideoStagingSlot& slot)
+    {
+        if (slot.buffer != VK_NULL_HANDLE)
+            vkDestroyBuffer(m_vkDevice, slot.buffer, nullptr);
+        if (slot.memory != VK_NULL_HANDLE)
+            vkFreeMemory(m_vkDevice, slot.memory, nullptr);
+        slot = VideoStagingSlot{};
+    }
 #endif
 
 #if defined(XR_USE_GRAPHICS_API_D3D11)
@@ -4495,6 +4674,8 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         VkBuffer stagingBuffer{ VK_NULL_HANDLE };
         VkDeviceMemory stagingBufferMemory{ VK_NULL_HANDLE };
         VkDeviceSize stagingBufferSize {0};
+        // stagingBufferMemory stays mapped.
+        void* stagingBufferPtr = nullptr;
 
         VkImageView imageView{ VK_NULL_HANDLE };
 
@@ -4523,6 +4704,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             std::swap(stagingBuffer, other.stagingBuffer);
             std::swap(stagingBufferMemory, other.stagingBufferMemory);
             std::swap(stagingBufferSize, other.stagingBufferSize);
+            std::swap(stagingBufferPtr, other.stagingBufferPtr);
             std::swap(imageView, other.imageView);
             std::swap(frameIndex, other.frameIndex);
             std::swap(width, other.width);
@@ -4546,6 +4728,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             std::swap(stagingBuffer, other.stagingBuffer);
             std::swap(stagingBufferMemory, other.stagingBufferMemory);
             std::swap(stagingBufferSize, other.stagingBufferSize);
+            std::swap(stagingBufferPtr, other.stagingBufferPtr);
             std::swap(imageView, other.imageView);
             std::swap(frameIndex, other.frameIndex);
             std::swap(width, other.width);
@@ -4586,6 +4769,7 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
             stagingBuffer = VK_NULL_HANDLE;
             stagingBufferMemory = VK_NULL_HANDLE;
             stagingBufferSize = 0;
+            stagingBufferPtr = nullptr;
             imageView = VK_NULL_HANDLE;
             texture.Clear();
             frameIndex = std::uint64_t(-1);
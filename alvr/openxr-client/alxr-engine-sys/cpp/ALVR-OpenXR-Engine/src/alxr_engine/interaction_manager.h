@@ -107,7 +107,8 @@ struct InteractionManager {
     inline std::optional<XrSpaceLocation> GetEyeGazeSpaceLocation
     (
         const XrSpace& baseSpace,
-        const XrTime& time
+        const XrTime& time,
+        XrTime* sampleTime = nullptr
     ) const;
 
     void LogActions() const;
@@ -348,11 +349,12 @@ inline ALXR::SpaceLoc InteractionManager::GetSpaceLocation
 inline std::optional<XrSpaceLocation> InteractionManager::GetEyeGazeSpaceLocation
 (
     const XrSpace& baseSpace,
-    const XrTime& time
+    const XrTime& time,
+    XrTime* sampleTime /*= nullptr*/
 ) const {
     if (m_eyeGazeInteraction == nullptr)
         return {};
-    return m_eyeGazeInteraction->GetSpaceLocation(baseSpace, time);
+    return m_eyeGazeInteraction->GetSpaceLocation(baseSpace, time, sampleTime);
 }
 
 inline InteractionManager::SuggestedBindingList
@@ -14,9 +14,11 @@ void LatencyManager::OnTimeSyncRecieved(const TimeSync& timeSync)
         LatencyCollector::Instance().setTotalLatency(timeSync.serverTotalLatency);
         const std::uint64_t Current = GetSystemTimestampUs();
         const std::uint64_t RTT = Current - timeSync.clientTime;
-        m_rt_state.timeDiff =
+        const std::int64_t timeDiff =
             ((std::int64_t)timeSync.serverTime + (std::int64_t)RTT / 2) - (std::int64_t)Current;
-        //LOG("TimeSync: server - client = %ld us RTT = %lu us", m_rt_state.timeDiff, RTT);
+        m_clockSync.AddSample(Current, timeDiff, RTT);
+        m_rt_state.timeDiff = m_clockSync.GetOffset(Current);
+        //LOG("TimeSync: server - client = %ld us error = %.0f us RTT = %lu us", m_rt_state.timeDiff, m_clockSync.GetEstimate().error, RTT);
         if (m_callbackCtx.timeSyncSendFn) {
             TimeSync sendBuf = timeSync;
             sendBuf.mode = 2;
@@ -39,6 +41,10 @@ void LatencyManager::OnPreVideoPacketRecieved(const VideoFrame& header)
         LatencyCollector::Instance().estimatedSent(header.trackingFrameIndex, offset);
         m_rt_state.lastFrameIndex = header.trackingFrameIndex;
     }
+    LatencyCollector::Instance().lastPacketReceived(header.trackingFrameIndex);
+    // A retransmission is out of sequence, its loss was already counted.
+    if (header.retransmitted)
+        return;
     if (const auto lostCount = ProcessVideoSeq(header))
         LatencyCollector::Instance().packetLoss(lostCount);
 }
@@ -76,6 +82,17 @@ void LatencyManager::SendPacketLossReport
         m_callbackCtx.videoErrorReportSendFn();
 }
 
+void LatencyManager::SendVideoNack
+(
+    const std::uint64_t videoFrameIndex,
+    const VideoNackRange* ranges,
+    const std::size_t rangeCount
+)
+{
+    if (m_callbackCtx.videoNackSendFn)
+        m_callbackCtx.videoNackSendFn(videoFrameIndex, ranges, static_cast<unsigned int>(rangeCount));
+}
+
 void LatencyManager::SendTimeSync() {
     if (m_callbackCtx.timeSyncSendFn == nullptr)
         return;
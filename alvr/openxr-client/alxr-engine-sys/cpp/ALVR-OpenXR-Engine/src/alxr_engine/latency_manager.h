@@ -3,6 +3,7 @@
 #define ALXR_LATENCY_MANAGER_H
 
 #include "latency_collector.h"
+#include "ALVR-common/clock_sync.h"
 #include <cstdint>
 #include <atomic>
 #include <mutex>
@@ -11,6 +12,7 @@
 struct VideoFrame;
 struct TimeSync;
 struct TrackingInfo;
+struct VideoNackRange;
 
 struct LatencyManager
 {
@@ -27,6 +29,8 @@ struct LatencyManager
 		const PacketRecievedStatus& status
 	);
 	void OnTimeSyncRecieved(const TimeSync& timeSync);
+	// Asks the server again for the packets FEC can't recover the frame without.
+	void SendVideoNack(const std::uint64_t videoFrameIndex, const VideoNackRange* ranges, const std::size_t rangeCount);
 
 	inline void SubmitAndSync(const std::uint64_t frameIndex, const bool reRenderOnly = false)
 	{
@@ -44,6 +48,7 @@ struct LatencyManager
 		m_rt_state.prevVideoSequence = 0;
 		m_rt_state.lastFrameIndex = 0;
 		m_rt_state.timeDiff = 0;
+		m_clockSync.Reset();
 		m_timeSyncSequence = uint64_t(-1);
 		LatencyCollector::Instance().resetAll();
 	}
@@ -51,15 +56,20 @@ struct LatencyManager
 	using SendFn = void (*)(const TrackingInfo* data);
 	using TimeSyncSendFn = void (*)(const TimeSync* data);
 	using VideoErrorReportSendFn = void (*)();
+	using VideoNackSendFn = void (*)(unsigned long long videoFrameIndex, const VideoNackRange* ranges, unsigned int rangeCount);
+	using FrameTraceSendFn = LatencyCollector::FrameTraceSendFn;
 	struct CallbackCtx {
 		SendFn					sendFn;
 		TimeSyncSendFn			timeSyncSendFn;
 		VideoErrorReportSendFn	videoErrorReportSendFn;
+		VideoNackSendFn			videoNackSendFn;
+		FrameTraceSendFn		frameTraceSendFn;
 	};
 	void Init(const CallbackCtx& ctx)
 	{
 		m_callbackCtx = ctx;
 		ResetAll();
+		LatencyCollector::Instance().setFrameTraceSend(ctx.frameTraceSendFn);
 	}
 	static LatencyManager& Instance() { return m_instance; }
 
@@ -87,6 +97,8 @@ private:
 		std::atomic<bool> isFecFailed{ false };
 	};
 	RecieveThreadState m_rt_state{};
+	// server - client clock, filters the TimeSync round trips into m_rt_state.timeDiff
+	ClockSyncEstimator m_clockSync{};
 
 	static LatencyManager m_instance;
 };
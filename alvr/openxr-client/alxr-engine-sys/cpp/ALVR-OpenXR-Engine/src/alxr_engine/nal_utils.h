@@ -4,6 +4,7 @@
 
 #include <span>
 #include "ALVR-common/packet_types.h"
+#include "ALVR-common/nal_scan.h"
 
 enum class NalType : std::uint8_t
 {
@@ -50,6 +51,16 @@ constexpr inline bool is_idr(const ConstPacketType& packet, const ALVR_CODEC cod
     return is_idr(get_nal_type(packet, codec), codec);
 }
 
+// False for pictures no other picture predicts from, they can be dropped without breaking the stream.
+constexpr inline bool is_reference(const ConstPacketType& packet, const ALVR_CODEC codec)
+{
+    if (packet.size() < 5) return true;
+    if (codec == ALVR_CODEC_H264)
+        return ((packet[4] >> 5) & std::uint8_t(0x3)) != 0; // nal_ref_idc
+    const auto t = static_cast<std::uint8_t>(get_nal_type(packet, codec));
+    return t > 14 || t % 2 != 0; // sub-layer non-reference slice types are even, up to RSV_VCL_N14
+}
+
 // This frame contains (VPS + )SPS + PPS + IDR on NVENC H.264 (H.265) stream.
  // (VPS + )SPS + PPS has short size (8bytes + 28bytes in some environment), so we can assume SPS + PPS is contained in first fragment.
 inline ConstPacketType find_vpssps(const ConstPacketType& packet, const ALVR_CODEC codec)
@@ -58,34 +69,10 @@ inline ConstPacketType find_vpssps(const ConstPacketType& packet, const ALVR_COD
     if (!is_config(nalType, codec))
         return PacketType{};
 
-    const std::size_t nalCount = [&]() -> std::size_t
-    {
-        switch (codec)
-        {
-        case ALVR_CODEC_H264: return 3;
-        case ALVR_CODEC_H265: return 4;
-        }
-        return std::size_t(-1);
-    }();
-    std::size_t zeroes = 0, foundNals = 0;
-    for (std::size_t i = 0; i < packet.size(); ++i)
-    {
-        if (packet[i] == 0)
-            ++zeroes;
-        else if (packet[i] == 1)
-        {
-            if (zeroes >= 2)
-            {
-                ++foundNals;
-                if (foundNals >= nalCount)
-                    return packet.subspan(0, i - 3);
-            }
-            zeroes = 0;
-        }
-        else
-            zeroes = 0;
-    }
-    return PacketType{};
+    const int end = FindConfigNalUnitsEnd(packet.data(), packet.size(), codec);
+    if (end < 0)
+        return PacketType{};
+    return packet.subspan(0, end);
 }
 
 #endif
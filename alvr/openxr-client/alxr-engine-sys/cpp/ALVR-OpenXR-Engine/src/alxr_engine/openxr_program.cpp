@@ -30,7 +30,6 @@
 #include <chrono>
 #include <algorithm>
 #include <mutex>
-#include <shared_mutex>
 #ifdef XR_USE_PLATFORM_ANDROID
     #include <unistd.h>
 #endif
@@ -39,6 +38,7 @@
 
 #include "xr_utils.h"
 #include "concurrent_queue.h"
+#include "seqlock_ring.h"
 //#include "alxr_engine.h"
 #include "alxr_ctypes.h"
 #include "ALVR-common/packet_types.h"
@@ -2395,6 +2395,8 @@ struct OpenXrProgram final : IOpenXrProgram {
         const bool timeRender = videoFrameDisplayTime != std::uint64_t(-1) &&
                                 videoFrameDisplayTime != m_lastVideoFrameIndex;
         m_lastVideoFrameIndex = videoFrameDisplayTime;
+        if (timeRender)
+            LatencyCollector::Instance().rendered1(videoFrameDisplayTime);
         
         XrTime predictedDisplayTime;
         const auto predictedViews = GetPredicatedViews(frameState, renderMode, videoFrameDisplayTime, /*out*/ predictedDisplayTime);
@@ -2941,20 +2943,15 @@ struct OpenXrProgram final : IOpenXrProgram {
         if (renderMode == RenderMode::Lobby)
             return GetDefaultViews();
 
-        std::shared_lock<std::shared_mutex> l(m_trackingFrameMapMutex);
-        if (videoTimeStampNs != std::uint64_t(-1))
-        {
-            const auto trackingFrameItr = m_trackingFrameMap.find(videoTimeStampNs);
-            if (trackingFrameItr != m_trackingFrameMap.cend()) {
-                predicateDisplayTime = trackingFrameItr->second.displayTime;
-                return trackingFrameItr->second.views;
-            }
-        }
-        const auto result = m_trackingFrameMap.rbegin();
-        if (result == m_trackingFrameMap.rend())
+        // A frame whose tracking entry was already overwritten reprojects with the closest pose.
+        TrackingFrame trackingFrame;
+        const bool found = videoTimeStampNs != std::uint64_t(-1) ?
+            m_trackingFrames.find_nearest(videoTimeStampNs, trackingFrame) :
+            m_trackingFrames.latest(trackingFrame);
+        if (!found)
             return GetDefaultViews();
-        predicateDisplayTime = result->second.displayTime;
-        return result->second.views;
+        predicateDisplayTime = trackingFrame.displayTime;
+        return trackingFrame.views;
     }
 
     static inline ALXREyeInfo GetEyeInfo(const XrView& left_view, const XrView& right_view)
@@ -3021,15 +3018,10 @@ struct OpenXrProgram final : IOpenXrProgram {
 
         std::array<XrView, 2> newViews { IdentityView, IdentityView };
         LocateViews(predicatedDisplayTimeXR, (const std::uint32_t)newViews.size(), newViews.data());
-        {
-            std::unique_lock<std::shared_mutex> lock(m_trackingFrameMapMutex);
-            m_trackingFrameMap[predicatedDisplayTimeNs] = {
-                .views       = newViews,
-                .displayTime = predicatedDisplayTimeXR
-            };
-            if (m_trackingFrameMap.size() > MaxTrackingFrameCount)
-                m_trackingFrameMap.erase(m_trackingFrameMap.begin());
-        }
+        m_trackingFrames.push(predicatedDisplayTimeNs, {
+            .views       = newViews,
+            .displayTime = predicatedDisplayTimeXR
+        });
         info.targetTimestampNs = predicatedDisplayTimeNs;
         //head/controler Tracking
         const auto hmdSpaceLoc = GetSpaceLocation(m_viewSpace, predicatedDisplayTimeXR);
@@ -3097,6 +3089,75 @@ struct OpenXrProgram final : IOpenXrProgram {
         return true;
     }
 
+    virtual bool GetGazeSample(GazeSample& sample) const override
+    {
+        const auto [xrTimeNow, timeStampUs] = XrTimeNow();
+        if (timeStampUs == std::uint64_t(-1) || xrTimeNow < 0)
+            return false;
+
+        sample = { .type = ALVR_PACKET_TYPE_GAZE };
+        XrTime sampleTime = 0;
+        bool hasSample = false;
+#ifdef XR_USE_OXR_OCULUS
+        if (eyeTracker_ != XR_NULL_HANDLE) {
+            const XrEyeGazesInfoFB gazesInfo{
+                .type = XR_TYPE_EYE_GAZES_INFO_FB,
+                .next = nullptr,
+                .baseSpace = m_viewSpace,
+                .time = xrTimeNow
+            };
+            XrEyeGazesFB eyeGazes{
+                .type = XR_TYPE_EYE_GAZES_FB,
+                .next = nullptr
+            };
+            if (XR_SUCCEEDED(m_xrGetEyeGazesFB_(eyeTracker_, &gazesInfo, &eyeGazes))) {
+                hasSample = true;
+                sampleTime = eyeGazes.time;
+                sample.confidence = 1.0f;
+                for (std::size_t idx = 0; idx < MaxEyeCount; ++idx) {
+                    const auto& gaze = eyeGazes.gaze[idx];
+                    auto& eye = sample.eyes[idx];
+                    eye.valid = gaze.isValid;
+                    eye.orientation = ToTrackingQuat(gaze.gazePose.orientation);
+                    eye.position = ToTrackingVector3(gaze.gazePose.position);
+                    sample.confidence = gaze.isValid ? std::min(sample.confidence, gaze.gazeConfidence) : 0.0f;
+                }
+            }
+        }
+#endif
+        if (!hasSample) {
+            const auto spaceLocOption = m_interactionManager->GetEyeGazeSpaceLocation(m_viewSpace, xrTimeNow, &sampleTime);
+            if (!spaceLocOption || !Math::Pose::IsPoseValid(spaceLocOption.value()))
+                return false;
+            // One combined gaze, no confidence: tracked or not.
+            const auto& spaceLoc = spaceLocOption.value();
+            for (auto& eye : sample.eyes) {
+                eye.valid = true;
+                eye.orientation = ToTrackingQuat(spaceLoc.pose.orientation);
+                eye.position = ToTrackingVector3(spaceLoc.pose.position);
+            }
+            sample.confidence = (spaceLoc.locationFlags & XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT) != 0 ? 1.0f : 0.0f;
+        }
+
+        // Average of the valid eyes, -Z is forward.
+        OVR::Vector3f direction{ 0.0f, 0.0f, 0.0f };
+        for (const auto& eye : sample.eyes) {
+            if (eye.valid) {
+                const OVR::Quatf rot(eye.orientation.x, eye.orientation.y, eye.orientation.z, eye.orientation.w);
+                direction += rot.Rotate(OVR::Vector3f(0.0f, 0.0f, -1.0f));
+            }
+        }
+        if (direction.LengthSq() == 0.0f)
+            direction = OVR::Vector3f(0.0f, 0.0f, -1.0f);
+        direction.Normalize();
+        sample.direction = { direction.x, direction.y, direction.z };
+
+        // The sample time is in the past of xrTimeNow, the timestamp in the tracking clock.
+        const XrDuration sampleAgeNs = (sampleTime > 0 && sampleTime <= xrTimeNow) ? xrTimeNow - sampleTime : 0;
+        sample.timestampNs = timeStampUs * 1000 - static_cast<std::uint64_t>(sampleAgeNs);
+        return true;
+    }
+
     virtual inline void ApplyHapticFeedback(const ALXR::HapticsFeedback& hapticFeedback) override
     {
         assert(m_interactionManager != nullptr);
@@ -3105,7 +3166,8 @@ struct OpenXrProgram final : IOpenXrProgram {
 
     virtual inline void SetStreamConfig(const ALXRStreamConfig& config) override
     {
-        m_streamConfigQueue.push(config);
+        if (!m_streamConfigQueue.try_push(config))
+            Log::Write(Log::Level::Warning, "Stream config queue is full, dropping stream config.");
     }
 
     virtual inline bool GetStreamConfig(ALXRStreamConfig& config) const override
@@ -3500,8 +3562,12 @@ struct OpenXrProgram final : IOpenXrProgram {
         };
         if (!GetBoundingStageSpace(time, gd))
             return false;
+        // The render loop must not wait on the runtime polling for guardian changes.
+        if (!m_guardianChangedQueue.try_push(gd)) {
+            Log::Write(Log::Level::Warning, "Guardian changed queue is full, dropping guardian change.");
+            return false;
+        }
         Log::Write(Log::Level::Verbose, "Guardian changed enqueud successfully.");
-        m_guardianChangedQueue.push(gd);
         return true;
     }
 
@@ -3687,12 +3753,12 @@ struct OpenXrProgram final : IOpenXrProgram {
         std::array<XrView, 2> views;
         XrTime                displayTime;
     };
-    using TrackingFrameMap = std::map<std::uint64_t, TrackingFrame>;
-    mutable std::shared_mutex m_trackingFrameMapMutex;        
-    TrackingFrameMap          m_trackingFrameMap{};
+    static constexpr const std::size_t MaxTrackingFrameCount = 1024;
+    // Keyed by predicted display time (ns), written by the tracking thread only.
+    using TrackingFrameRing = xrconcurrency::seqlock_ring<TrackingFrame, MaxTrackingFrameCount>;
+    TrackingFrameRing         m_trackingFrames{};
     std::atomic<XrDuration>   m_PredicatedLatencyOffset{ 0 };
     std::uint64_t             m_lastVideoFrameIndex = std::uint64_t(-1);
-    static constexpr const std::size_t MaxTrackingFrameCount = 360 * 3;
 /// End Tracking Thread State ////////////////////////////////////////////////////
 
     std::vector<float> m_displayRefreshRates;
@@ -3704,8 +3770,9 @@ struct OpenXrProgram final : IOpenXrProgram {
         }
     };
 
-    using StreamConfigQueue     = xrconcurrency::concurrent_queue<ALXRStreamConfig>;
-    using GuardianChangedQueue  = xrconcurrency::concurrent_queue<ALXRGuardianData>;
+    // Single producer (connection callback / render loop) and single consumer each.
+    using StreamConfigQueue     = xrconcurrency::spsc_ring<ALXRStreamConfig, 16>;
+    using GuardianChangedQueue  = xrconcurrency::spsc_ring<ALXRGuardianData, 16>;
     StreamConfigQueue    m_streamConfigQueue;
     GuardianChangedQueue m_guardianChangedQueue;
     bool                 m_delayOnGuardianChanged = false;
@@ -105,6 +105,9 @@ struct IOpenXrProgram {
 
     virtual bool GetTrackingInfo(TrackingInfo& info, const bool clientPredict) /*const*/ = 0;
 
+    // Latest eye tracker sample, false without eye tracking. Callable from any thread.
+    virtual bool GetGazeSample(GazeSample& sample) const = 0;
+
     virtual void ApplyHapticFeedback(const ALXR::HapticsFeedback&) = 0;
 
     virtual void SetStreamConfig(const ALXRStreamConfig& config) = 0;
@@ -0,0 +1,132 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace xrconcurrency
+{
+    // Fixed-capacity ring of timestamped values, written by a single thread and read by any
+    // number of threads without locks. Entries are indexed by their push sequence, the oldest
+    // ones are overwritten. Each slot is a seqlock: readers retry while the writer is on it,
+    // the value is stored as relaxed atomic words so concurrent reads are not data races.
+    // Timestamps are expected to roughly increase with the push sequence.
+    template < typename Tp, std::size_t Capacity >
+    class seqlock_ring
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<Tp>);
+        constexpr static const std::uint64_t Mask = Capacity - 1;
+        constexpr static const std::size_t WordCount = (sizeof(Tp) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        struct Slot {
+            // odd while the writer is updating the slot.
+            std::atomic<std::uint32_t> sequence{ 0 };
+            std::atomic<std::uint64_t> index{ std::numeric_limits<std::uint64_t>::max() };
+            std::atomic<std::uint64_t> timestamp{ 0 };
+            std::array<std::atomic<std::uint64_t>, WordCount> words{};
+        };
+
+        std::array<Slot, Capacity>  m_slots{};
+        std::atomic<std::uint64_t>  m_count{ 0 };
+
+        // Returns false if the slot doesn't hold the entry at index anymore.
+        bool read(const std::uint64_t index, std::uint64_t& timestamp, Tp* value) const
+        {
+            const auto& slot = m_slots[index & Mask];
+            for (;;) {
+                const auto sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence & 1)
+                    continue;
+                const auto slotIndex = slot.index.load(std::memory_order_relaxed);
+                timestamp = slot.timestamp.load(std::memory_order_relaxed);
+                std::uint64_t words[WordCount];
+                if (value != nullptr) {
+                    for (std::size_t i = 0; i < WordCount; ++i)
+                        words[i] = slot.words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+                    continue;
+                if (slotIndex != index)
+                    return false;
+                if (value != nullptr)
+                    std::memcpy(value, words, sizeof(Tp));
+                return true;
+            }
+        }
+
+    public:
+        seqlock_ring() = default;
+        seqlock_ring(const seqlock_ring&) = delete;
+        seqlock_ring& operator=(const seqlock_ring&) = delete;
+
+        // Writer thread only.
+        void push(const std::uint64_t timestamp, const Tp& value)
+        {
+            std::uint64_t words[WordCount]{};
+            std::memcpy(words, &value, sizeof(Tp));
+
+            const auto index = m_count.load(std::memory_order_relaxed);
+            auto& slot = m_slots[index & Mask];
+            const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.index.store(index, std::memory_order_relaxed);
+            slot.timestamp.store(timestamp, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < WordCount; ++i)
+                slot.words[i].store(words[i], std::memory_order_relaxed);
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+            m_count.store(index + 1, std::memory_order_release);
+        }
+
+        // Most recently pushed value, false if the ring is empty.
+        bool latest(Tp& value, std::uint64_t* timestamp = nullptr) const
+        {
+            for (;;) {
+                const auto count = m_count.load(std::memory_order_acquire);
+                if (count == 0)
+                    return false;
+                std::uint64_t ts;
+                if (read(count - 1, ts, &value)) {
+                    if (timestamp != nullptr)
+                        *timestamp = ts;
+                    return true;
+                }
+            }
+        }
+
+        // Value with the exact timestamp if it's still in the ring, otherwise the one with the
+        // closest timestamp. False if the ring is empty.
+        bool find_nearest(const std::uint64_t timestamp, Tp& value, std::uint64_t* foundTimestamp = nullptr) const
+        {
+            const auto count = m_count.load(std::memory_order_acquire);
+            const auto oldest = count > Capacity ? count - Capacity : 0;
+            std::uint64_t bestIndex = std::numeric_limits<std::uint64_t>::max();
+            std::uint64_t bestDistance = std::numeric_limits<std::uint64_t>::max();
+            // Newest first, stop once the timestamps went past the requested one.
+            for (auto index = count; index > oldest; --index) {
+                std::uint64_t ts;
+                if (!read(index - 1, ts, nullptr))
+                    break;
+                const auto distance = ts > timestamp ? ts - timestamp : timestamp - ts;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = index - 1;
+                }
+                if (ts <= timestamp)
+                    break;
+            }
+            std::uint64_t ts;
+            if (bestIndex != std::numeric_limits<std::uint64_t>::max() && read(bestIndex, ts, &value)) {
+                if (foundTimestamp != nullptr)
+                    *foundTimestamp = ts;
+                return true;
+            }
+            // Overwritten while searching, only possible when the ring is tiny for the push rate.
+            return latest(value, foundTimestamp);
+        }
+    };
+}
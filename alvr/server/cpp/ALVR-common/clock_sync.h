@@ -0,0 +1,173 @@
+#pragma once
+
+// Server/client clock offset estimation from the TimeSync round trips.
+// Header only, the client and server copies of ALVR-common must stay identical.
+//
+// A single round trip gives offset = remote + RTT / 2 - local, which is off by up to RTT / 2
+// when the two directions have different delays and moves with every delayed packet.
+// Like NTP, only the samples with the smallest RTT are used: they are the ones least affected by
+// queuing. The best sample of every BUCKET_US is kept in a window, the fit uses the samples of
+// the window close to its minimum RTT. The offset and the clock drift are fitted on them with a
+// linear regression, the error bound is half the RTT of the best sample plus the fit residual.
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+class ClockSyncEstimator {
+public:
+	// TimeSync runs every frame, the window spans about half a minute.
+	static const size_t WINDOW_SIZE = 64;
+	static const uint64_t BUCKET_US = 500000;
+	// Samples whose RTT is within this much of the window's minimum are used for the fit.
+	static constexpr double RTT_TOLERANCE_US = 1000.;
+	// A fit over a shorter span can't tell drift from noise.
+	static constexpr double MIN_DRIFT_SPAN_US = 2e6;
+	// Quartz oscillators are within a few tens of ppm, anything above is noise.
+	static constexpr double MAX_DRIFT = 200e-6;
+	// A sample this far outside the error bound means a clock jump or a reconnection to
+	// another peer, the window is restarted.
+	static constexpr double MAX_JUMP_US = 50000.;
+
+	struct Estimate {
+		// clock offset in us (as passed to AddSample), at the time of the newest sample
+		double offset = 0;
+		// d(offset)/d(local time)
+		double drift = 0;
+		// the true offset is within offset +- error (us)
+		double error = 0;
+		// RTT of the best sample in the window (us)
+		double minRtt = 0;
+		size_t usedSamples = 0;
+	};
+
+	// localTime and rtt in us, offset is the difference between the clocks measured by this
+	// round trip, either remote - local or local - remote as long as the caller is consistent.
+	void AddSample(uint64_t localTime, int64_t offset, uint64_t rtt) {
+		if (IsValid() && std::abs((double)(offset - GetOffset(localTime))) > rtt / 2. + m_estimate.error + MAX_JUMP_US) {
+			Reset();
+		}
+		Sample sample = { localTime, offset, rtt };
+		if (!m_hasBucket || localTime - m_bucketStart >= BUCKET_US) {
+			if (m_hasBucket) {
+				m_samples[m_next] = m_bucket;
+				m_next = (m_next + 1) % WINDOW_SIZE;
+				m_count = std::min(m_count + 1, WINDOW_SIZE);
+			}
+			m_bucket = sample;
+			m_bucketStart = localTime;
+			m_hasBucket = true;
+		} else if (rtt <= m_bucket.rtt) {
+			m_bucket = sample;
+		}
+		Update();
+	}
+
+	bool IsValid() const {
+		return m_hasBucket;
+	}
+
+	const Estimate &GetEstimate() const {
+		return m_estimate;
+	}
+
+	// Filtered offset at localTime (us).
+	int64_t GetOffset(uint64_t localTime) const {
+		double dt = (double)(int64_t)(localTime - m_referenceTime);
+		return (int64_t)llround(m_estimate.offset + m_estimate.drift * dt);
+	}
+
+	void Reset() {
+		m_next = 0;
+		m_count = 0;
+		m_hasBucket = false;
+		m_referenceTime = 0;
+		m_estimate = {};
+	}
+
+private:
+	struct Sample {
+		uint64_t localTime;
+		int64_t offset;
+		uint64_t rtt;
+	};
+
+	void Update() {
+		// The window and the bucket being filled.
+		std::array<Sample, WINDOW_SIZE + 1> samples;
+		size_t count = m_count;
+		std::copy(m_samples.begin(), m_samples.begin() + m_count, samples.begin());
+		samples[count++] = m_bucket;
+
+		uint64_t minRtt = UINT64_MAX;
+		uint64_t newest = 0;
+		for (size_t i = 0; i < count; i++) {
+			minRtt = std::min(minRtt, samples[i].rtt);
+			newest = std::max(newest, samples[i].localTime);
+		}
+
+		// Offsets relative to the best sample so the sums stay small.
+		const Sample *best = nullptr;
+		for (size_t i = 0; i < count; i++) {
+			if (samples[i].rtt == minRtt && (best == nullptr || samples[i].localTime > best->localTime)) {
+				best = &samples[i];
+			}
+		}
+		const double base = (double)best->offset;
+
+		double n = 0, sumT = 0, sumO = 0, sumTT = 0, sumTO = 0;
+		double minT = 0, maxT = 0;
+		for (size_t i = 0; i < count; i++) {
+			const auto &sample = samples[i];
+			if ((double)(sample.rtt - minRtt) > RTT_TOLERANCE_US) {
+				continue;
+			}
+			double t = (double)(int64_t)(sample.localTime - newest);
+			double o = (double)sample.offset - base;
+			if (n == 0 || t < minT) minT = t;
+			if (n == 0 || t > maxT) maxT = t;
+			n++;
+			sumT += t;
+			sumO += o;
+			sumTT += t * t;
+			sumTO += t * o;
+		}
+
+		double meanT = sumT / n;
+		double meanO = sumO / n;
+		double drift = 0;
+		double varT = sumTT / n - meanT * meanT;
+		if (maxT - minT >= MIN_DRIFT_SPAN_US && varT > 0) {
+			drift = std::clamp((sumTO / n - meanT * meanO) / varT, -MAX_DRIFT, MAX_DRIFT);
+		}
+		double offsetAtNewest = meanO - drift * meanT;
+
+		double residual = 0;
+		for (size_t i = 0; i < count; i++) {
+			const auto &sample = samples[i];
+			if ((double)(sample.rtt - minRtt) > RTT_TOLERANCE_US) {
+				continue;
+			}
+			double t = (double)(int64_t)(sample.localTime - newest);
+			double e = (double)sample.offset - base - (offsetAtNewest + drift * t);
+			residual += e * e;
+		}
+
+		m_referenceTime = newest;
+		m_estimate.offset = base + offsetAtNewest;
+		m_estimate.drift = drift;
+		m_estimate.minRtt = (double)minRtt;
+		m_estimate.error = (double)minRtt / 2 + std::sqrt(residual / n);
+		m_estimate.usedSamples = (size_t)n;
+	}
+
+	std::array<Sample, WINDOW_SIZE> m_samples = {};
+	size_t m_next = 0;
+	size_t m_count = 0;
+	Sample m_bucket = {};
+	uint64_t m_bucketStart = 0;
+	bool m_hasBucket = false;
+	uint64_t m_referenceTime = 0;
+	Estimate m_estimate;
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+// Annex B start code scanning shared by the encoders and the clients.
+// Header only, the client and server copies of ALVR-common must stay identical.
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "packet_types.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ALVR_NAL_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ALVR_NAL_SCAN_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ALVR_NAL_SCAN_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline unsigned NalScanCountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+// Returns the position of the first 00 00 01 sequence in [begin, end), or end.
+// A four byte start code is found at its second byte, see NalUnitBegin.
+inline const uint8_t *FindStartCode(const uint8_t *begin, const uint8_t *end) {
+	const uint8_t *p = begin;
+
+	// Compare three shifted loads at once: byte i matches when i and i + 1 are zero and i + 2 is one.
+#if defined(ALVR_NAL_SCAN_AVX2)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi8(1);
+	for (; end - p >= 34; p += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)p);
+		__m256i b = _mm256_loadu_si256((const __m256i *)(p + 1));
+		__m256i c = _mm256_loadu_si256((const __m256i *)(p + 2));
+		__m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(a, zero), _mm256_cmpeq_epi8(b, zero)),
+			_mm256_cmpeq_epi8(c, one));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(match);
+		if (mask) {
+			return p + NalScanCountTrailingZeros(mask);
+		}
+	}
+#elif defined(ALVR_NAL_SCAN_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	for (; end - p >= 18; p += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *)p);
+		__m128i b = _mm_loadu_si128((const __m128i *)(p + 1));
+		__m128i c = _mm_loadu_si128((const __m128i *)(p + 2));
+		__m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(a, zero), _mm_cmpeq_epi8(b, zero)),
+			_mm_cmpeq_epi8(c, one));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+		if (mask) {
+			return p + NalScanCountTrailingZeros(mask);
+		}
+	}
+#elif defined(ALVR_NAL_SCAN_NEON)
+	const uint8x16_t one = vdupq_n_u8(1);
+	for (; end - p >= 18; p += 16) {
+		uint8x16_t a = vld1q_u8(p);
+		uint8x16_t b = vld1q_u8(p + 1);
+		uint8x16_t c = vld1q_u8(p + 2);
+		uint8x16_t match = vandq_u8(vandq_u8(vceqzq_u8(a), vceqzq_u8(b)), vceqq_u8(c, one));
+		if (vmaxvq_u8(match)) {
+			uint64_t low = vgetq_lane_u64(vreinterpretq_u64_u8(match), 0);
+			if (low) {
+				return p + NalScanCountTrailingZeros(low) / 8;
+			}
+			uint64_t high = vgetq_lane_u64(vreinterpretq_u64_u8(match), 1);
+			return p + 8 + NalScanCountTrailingZeros(high) / 8;
+		}
+	}
+#endif
+
+	// memchr is vectorized by the C library, look for the 01 and check the two bytes before it.
+	if (end - p < 3) {
+		return end;
+	}
+	const uint8_t *one_pos = p + 2;
+	while (one_pos < end) {
+		one_pos = (const uint8_t *)memchr(one_pos, 1, end - one_pos);
+		if (one_pos == nullptr) {
+			return end;
+		}
+		if (one_pos[-1] == 0 && one_pos[-2] == 0) {
+			return one_pos - 2;
+		}
+		one_pos++;
+	}
+	return end;
+}
+
+// Start of the NAL unit whose 00 00 01 was found at start_code, including the leading zero
+// of a four byte start code.
+inline const uint8_t *NalUnitBegin(const uint8_t *begin, const uint8_t *start_code) {
+	return (start_code != begin && start_code[-1] == 0) ? start_code - 1 : start_code;
+}
+
+// Calls f(nal_begin, nal_end) for every NAL unit, start code included.
+// Bytes before the first start code are reported as a unit of their own.
+template <typename F>
+inline void ForEachNalUnit(const uint8_t *data, size_t size, F &&f) {
+	const uint8_t *end = data + size;
+	const uint8_t *nal_begin = data;
+	const uint8_t *start_code = FindStartCode(data, end);
+	if (start_code != end && NalUnitBegin(data, start_code) != data) {
+		nal_begin = NalUnitBegin(data, start_code);
+		f(data, nal_begin);
+	}
+	while (nal_begin != end) {
+		const uint8_t *next = start_code == end ? end : FindStartCode(start_code + 3, end);
+		const uint8_t *nal_end = next == end ? end : NalUnitBegin(start_code + 3, next);
+		f(nal_begin, nal_end);
+		nal_begin = nal_end;
+		start_code = next;
+	}
+}
+
+// First byte of the NAL unit header of a unit given by ForEachNalUnit (start code included),
+// or nullptr if the unit does not start with a start code or is truncated.
+inline const uint8_t *GetNalUnitHeader(const uint8_t *nal_begin, const uint8_t *nal_end) {
+	if (nal_end - nal_begin < 4 || nal_begin[0] != 0 || nal_begin[1] != 0) {
+		return nullptr;
+	}
+	const uint8_t *header = nal_begin + (nal_begin[2] == 0 ? 4 : 3);
+	return header < nal_end ? header : nullptr;
+}
+
+// NAL unit type, or -1 if the unit does not start with a start code or is truncated.
+inline int GetNalUnitType(const uint8_t *nal_begin, const uint8_t *nal_end, ALVR_CODEC codec) {
+	const uint8_t *header = GetNalUnitHeader(nal_begin, nal_end);
+	if (header == nullptr) {
+		return -1;
+	}
+	return codec == ALVR_CODEC_H264 ? (header[0] & 0x1F) : ((header[0] >> 1) & 0x3F);
+}
+
+// SEI and access unit delimiters are not needed by the clients' decoders.
+inline bool IsDroppableNalUnit(const uint8_t *nal_begin, const uint8_t *nal_end, ALVR_CODEC codec) {
+	int type = GetNalUnitType(nal_begin, nal_end, codec);
+	if (codec == ALVR_CODEC_H264) {
+		return type == 6 || type == 9;
+	}
+	return type == 35 || type == 39;
+}
+
+// Copies the input to out without SEI and AUD units, out must hold size bytes.
+// Returns the number of bytes written.
+inline size_t FilterNalUnits(const uint8_t *data, size_t size, uint8_t *out, ALVR_CODEC codec) {
+	uint8_t *write = out;
+	ForEachNalUnit(data, size, [&](const uint8_t *nal_begin, const uint8_t *nal_end) {
+		if (!IsDroppableNalUnit(nal_begin, nal_end, codec)) {
+			memcpy(write, nal_begin, nal_end - nal_begin);
+			write += nal_end - nal_begin;
+		}
+	});
+	return write - out;
+}
+
+// Drops SEI and AUD units without copying the frame: units before the first kept one are
+// skipped by moving the returned start forward, later units are moved only if something
+// in front of them was dropped. size is updated to the filtered size.
+inline uint8_t *FilterNalUnitsInPlace(uint8_t *data, size_t &size, ALVR_CODEC codec) {
+	uint8_t *out_begin = nullptr;
+	uint8_t *write = nullptr;
+	ForEachNalUnit(data, size, [&](const uint8_t *nal_begin, const uint8_t *nal_end) {
+		if (IsDroppableNalUnit(nal_begin, nal_end, codec)) {
+			return;
+		}
+		uint8_t *begin = data + (nal_begin - data);
+		size_t length = nal_end - nal_begin;
+		if (out_begin == nullptr) {
+			out_begin = begin;
+			write = begin;
+		} else if (write != begin) {
+			memmove(write, begin, length);
+		}
+		write += length;
+	});
+	if (out_begin == nullptr) {
+		size = 0;
+		return data;
+	}
+	size = write - out_begin;
+	return out_begin;
+}
+
+// Finds the end of the (VPS + )SPS + PPS prefix of a config frame: the start of the unit
+// after them. Returns -1 if the frame has fewer units.
+inline int FindConfigNalUnitsEnd(const uint8_t *data, size_t size, ALVR_CODEC codec) {
+	int config_units = codec == ALVR_CODEC_H264 ? 2 : 3;
+	const uint8_t *end = data + size;
+	const uint8_t *start_code = FindStartCode(data, end);
+	for (int found = 0; start_code != end; found++) {
+		if (found == config_units) {
+			return (int)(NalUnitBegin(data, start_code) - data);
+		}
+		start_code = FindStartCode(start_code + 3, end);
+	}
+	return -1;
+}
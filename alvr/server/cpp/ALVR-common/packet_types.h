@@ -11,6 +11,7 @@ enum ALVR_PACKET_TYPE {
 	ALVR_PACKET_TYPE_VIDEO_FRAME = 9,
 	ALVR_PACKET_TYPE_PACKET_ERROR_REPORT = 12,
 	ALVR_PACKET_TYPE_HAPTICS = 13,
+	ALVR_PACKET_TYPE_GAZE = 14,
 };
 
 enum ALVR_CODEC {
@@ -130,6 +131,21 @@ static const int ALVR_MAX_VIDEO_BUFFER_SIZE = 1400;
 
 static const int ALVR_FEC_SHARDS_MAX = 20;
 
+enum ALVR_FEC_CODEC {
+	// reedsolomon/rs.c in GF(2^8), at most ALVR_FEC_SHARDS_MAX shards of one or more packets
+	ALVR_FEC_CODEC_REED_SOLOMON = 0,
+	// fec_cauchy16.h, one packet per shard up to ALVR_FEC_CAUCHY_PARITY_MAX parity shards
+	ALVR_FEC_CODEC_CAUCHY_GF16 = 1,
+};
+
+// Encoding costs a multiply-add per byte of the frame and per parity shard of the codeword. A
+// larger group is split in packet rows like with rs.c, each row a codeword of its own.
+static const int ALVR_FEC_CAUCHY_PARITY_MAX = 32;
+// The rows of a group are also cut so that its encoding costs at most this many multiply-added
+// bytes (group size * parity shards per row), about 2 ms on one core with AVX2: the parity
+// shards per row go down as the group grows, to 1 from 8 MB.
+static const int ALVR_FEC_CAUCHY_ENCODE_BUDGET = 8 << 20;
+
 inline int CalculateParityShards(int dataShards, int fecPercentage) {
 	int totalParityShards = (dataShards * fecPercentage + 99) / 100;
 	return totalParityShards;
@@ -148,4 +164,22 @@ inline int CalculateFECShardPackets(int len, int fecPercentage) {
 	return shardPackets;
 }
 
+// Same for ALVR_FEC_CODEC_CAUCHY_GF16, 1 unless the group needs more than
+// ALVR_FEC_CAUCHY_PARITY_MAX parity shards or the encoding would go over
+// ALVR_FEC_CAUCHY_ENCODE_BUDGET.
+inline int CalculateFECCauchyShardPackets(int len, int fecPercentage) {
+	int maxParityShards = len > 0 ? ALVR_FEC_CAUCHY_ENCODE_BUDGET / len : ALVR_FEC_CAUCHY_PARITY_MAX;
+	if (maxParityShards > ALVR_FEC_CAUCHY_PARITY_MAX) {
+		maxParityShards = ALVR_FEC_CAUCHY_PARITY_MAX;
+	} else if (maxParityShards < 1) {
+		maxParityShards = 1;
+	}
+	int maxDataShards = fecPercentage > 0 ? maxParityShards * 100 / fecPercentage : 0;
+	if (maxDataShards < 1) {
+		maxDataShards = 1;
+	}
+	int packets = (len + ALVR_MAX_VIDEO_BUFFER_SIZE - 1) / ALVR_MAX_VIDEO_BUFFER_SIZE;
+	return (packets + maxDataShards - 1) / maxDataShards;
+}
+
 #endif //ALVRCLIENT_PACKETTYPES_H
@@ -0,0 +1,596 @@
+#pragma once
+
+// Compact wire format of TrackingInfo (bindings.h), sent on its own stream instead of the full
+// struct. Header only, the client and server copies of ALVR-common must stay identical. The
+// codec is templated on the TrackingInfo type so it doesn't depend on which bindings.h the
+// includer uses.
+//
+// Packet, version 1:
+//   u8 version, u8 flags (DELTA, MOUNTED), u8 presence (gaze, controller enabled, is hand)
+//   varint targetTimestampNs, DELTA: zigzag varint targetTimestampNs - reference timestamp
+//   DELTA: one bit per element, set if it changed from the reference
+//   the elements (all of them, or the changed ones)
+// Elements are quantized:
+// - orientations with the smallest three: the largest component is dropped (2 bit index),
+//   the others are in [-1/sqrt(2), 1/sqrt(2)]. 15 bit each for the poses, 10 bit for the
+//   finger bones.
+// - positions and vectors in fixed point, as zigzag varints. In delta packets they are sent
+//   as the difference with the reference.
+//
+// Delta packets reference the last sample the server acknowledged (TimeSync mode 3), which it
+// has decoded for sure. The decoder keeps more samples than the encoder can reference.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+namespace tracking_codec {
+
+static const uint8_t VERSION = 1;
+
+static const uint8_t FLAG_DELTA = 1 << 0;
+static const uint8_t FLAG_MOUNTED = 1 << 1;
+
+static const uint8_t PRESENCE_GAZE = 1 << 0;
+// << controller index
+static const uint8_t PRESENCE_CONTROLLER = 1 << 1;
+static const uint8_t PRESENCE_HAND = 1 << 3;
+
+static const int BONE_COUNT = 19;
+// Smallest three components are within +-1/sqrt(2).
+static constexpr double SQRT2 = 1.4142135623730951;
+static const int HIGH_QUAT_BITS = 15;
+static const int LOW_QUAT_BITS = 10;
+// Fixed point scales
+static constexpr double POSITION_SCALE = 10000.;  // 0.1 mm
+static constexpr double VELOCITY_SCALE = 1000.;   // 1 mm/s, 1 mrad/s
+static constexpr double UNIT_SCALE = 32767.;      // directions, trackpad, trigger, grip
+
+// Elements of a sample with the gaze and two hands: head and gaze, then per controller 9 and
+// per hand 2 per bone plus 3. Bounds the changed bits of delta packets.
+static const size_t MAX_ELEMENTS = 4 + 2 * (9 + 2 * BONE_COUNT + 3);
+using ChangedBits = std::array<uint8_t, (MAX_ELEMENTS + 7) / 8>;
+
+// Samples the encoder can reference, and the decoder keeps.
+static const size_t ENCODER_HISTORY = 32;
+static const size_t DECODER_HISTORY = 64;
+
+// Quantized sample, the state delta coding works on.
+struct Quantized {
+	struct Controller {
+		uint64_t buttons;
+		int32_t trackpad[2];
+		int32_t trigger;
+		int32_t grip;
+		uint64_t orientation;
+		int32_t position[3];
+		int32_t angularVelocity[3];
+		int32_t linearVelocity[3];
+		uint64_t boneRotations[BONE_COUNT];
+		int32_t bonePositionsBase[BONE_COUNT][3];
+		uint64_t boneRootOrientation;
+		int32_t boneRootPosition[3];
+		uint64_t handFingerConfidences;
+	};
+
+	uint64_t targetTimestampNs;
+	uint8_t flags;
+	uint8_t presence;
+	uint64_t headOrientation;
+	int32_t headPosition[3];
+	uint64_t gazeOrientation;
+	int32_t gazeDirection[3];
+	Controller controller[2];
+};
+
+enum class ElementType { HighQuat, LowQuat, Vector, Scalar, Bits };
+
+// Calls f(type, pointer) for each element present in sample, in wire order. The pointer is a
+// uint64_t* for the quaternions and Bits, int32_t* (3 for Vector, 1 for Scalar) otherwise.
+template <typename F>
+void ForEachElement(Quantized &sample, F f) {
+	f(ElementType::HighQuat, &sample.headOrientation);
+	f(ElementType::Vector, sample.headPosition);
+	if (sample.presence & PRESENCE_GAZE) {
+		f(ElementType::HighQuat, &sample.gazeOrientation);
+		f(ElementType::Vector, sample.gazeDirection);
+	}
+	for (int i = 0; i < 2; i++) {
+		if (!(sample.presence & (PRESENCE_CONTROLLER << i))) {
+			continue;
+		}
+		auto &c = sample.controller[i];
+		f(ElementType::Bits, &c.buttons);
+		f(ElementType::Scalar, &c.trackpad[0]);
+		f(ElementType::Scalar, &c.trackpad[1]);
+		f(ElementType::Scalar, &c.trigger);
+		f(ElementType::Scalar, &c.grip);
+		f(ElementType::HighQuat, &c.orientation);
+		f(ElementType::Vector, c.position);
+		f(ElementType::Vector, c.angularVelocity);
+		f(ElementType::Vector, c.linearVelocity);
+		if (sample.presence & (PRESENCE_HAND << i)) {
+			for (int b = 0; b < BONE_COUNT; b++) {
+				f(ElementType::LowQuat, &c.boneRotations[b]);
+			}
+			for (int b = 0; b < BONE_COUNT; b++) {
+				f(ElementType::Vector, c.bonePositionsBase[b]);
+			}
+			f(ElementType::HighQuat, &c.boneRootOrientation);
+			f(ElementType::Vector, c.boneRootPosition);
+			f(ElementType::Bits, &c.handFingerConfidences);
+		}
+	}
+}
+
+inline int32_t ToFixed(float value, double scale) {
+	double scaled = std::round((double)value * scale);
+	return (int32_t)std::clamp(scaled, (double)INT32_MIN, (double)INT32_MAX);
+}
+
+inline float FromFixed(int32_t value, double scale) {
+	return (float)(value / scale);
+}
+
+template <typename Quat>
+uint64_t PackQuat(const Quat &quat, int bits) {
+	float q[4] = { quat.x, quat.y, quat.z, quat.w };
+	float norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	if (!(norm > 0)) {
+		// Uninitialized (zero) quaternion, sent as identity.
+		q[0] = q[1] = q[2] = 0;
+		q[3] = norm = 1;
+	}
+	int largest = 0;
+	for (int i = 1; i < 4; i++) {
+		if (std::abs(q[i]) > std::abs(q[largest])) {
+			largest = i;
+		}
+	}
+	// q and -q are the same rotation, make the dropped component positive.
+	const float sign = q[largest] < 0 ? -1.f : 1.f;
+	const uint32_t maxValue = (1u << bits) - 1;
+	uint64_t packed = (uint64_t)largest;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest) {
+			continue;
+		}
+		double v = sign * q[i] / norm * SQRT2; // [-1, 1]
+		uint32_t quantized = (uint32_t)std::clamp(std::round((v * 0.5 + 0.5) * maxValue), 0., (double)maxValue);
+		packed = (packed << bits) | quantized;
+	}
+	return packed;
+}
+
+template <typename Quat>
+void UnpackQuat(uint64_t packed, int bits, Quat &quat) {
+	const uint32_t maxValue = (1u << bits) - 1;
+	const int largest = (int)(packed >> (3 * bits)) & 3;
+	float q[4];
+	float sum = 0;
+	int shift = 2 * bits;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest) {
+			continue;
+		}
+		uint32_t quantized = (uint32_t)(packed >> shift) & maxValue;
+		shift -= bits;
+		q[i] = (float)(((double)quantized / maxValue * 2. - 1.) / SQRT2);
+		sum += q[i] * q[i];
+	}
+	q[largest] = std::sqrt(std::max(1.f - sum, 0.f));
+	quat.x = q[0];
+	quat.y = q[1];
+	quat.z = q[2];
+	quat.w = q[3];
+}
+
+inline uint64_t ZigZag(int64_t value) {
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t value) {
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+class Writer {
+public:
+	explicit Writer(std::vector<uint8_t> &out) : m_out(out) {}
+
+	void Byte(uint8_t value) {
+		m_out.push_back(value);
+	}
+	void Varint(uint64_t value) {
+		while (value >= 0x80) {
+			m_out.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		m_out.push_back((uint8_t)value);
+	}
+	void Fixed(uint64_t value, int bytes) {
+		for (int i = 0; i < bytes; i++) {
+			m_out.push_back((uint8_t)(value >> (8 * i)));
+		}
+	}
+
+private:
+	std::vector<uint8_t> &m_out;
+};
+
+class Reader {
+public:
+	Reader(const uint8_t *data, size_t size) : m_data(data), m_end(data + size) {}
+
+	bool Byte(uint8_t &value) {
+		if (m_data == m_end) {
+			return false;
+		}
+		value = *m_data++;
+		return true;
+	}
+	bool Varint(uint64_t &value) {
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			uint8_t byte;
+			if (!Byte(byte)) {
+				return false;
+			}
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	bool Fixed(uint64_t &value, int bytes) {
+		if (m_end - m_data < bytes) {
+			return false;
+		}
+		value = 0;
+		for (int i = 0; i < bytes; i++) {
+			value |= (uint64_t)m_data[i] << (8 * i);
+		}
+		m_data += bytes;
+		return true;
+	}
+
+private:
+	const uint8_t *m_data;
+	const uint8_t *m_end;
+};
+
+inline int QuatBytes(ElementType type) {
+	return ((type == ElementType::HighQuat ? HIGH_QUAT_BITS : LOW_QUAT_BITS) * 3 + 2 + 7) / 8;
+}
+
+inline int ElementComponents(ElementType type) {
+	return type == ElementType::Vector ? 3 : 1;
+}
+
+// Writes one element. With a reference, vectors and scalars are written as the difference.
+inline void WriteElement(Writer &writer, ElementType type, const void *value, const void *reference) {
+	switch (type) {
+	case ElementType::HighQuat:
+	case ElementType::LowQuat:
+		writer.Fixed(*(const uint64_t *)value, QuatBytes(type));
+		break;
+	case ElementType::Bits:
+		writer.Varint(*(const uint64_t *)value);
+		break;
+	default:
+		for (int i = 0; i < ElementComponents(type); i++) {
+			int64_t v = ((const int32_t *)value)[i];
+			if (reference != nullptr) {
+				v -= ((const int32_t *)reference)[i];
+			}
+			writer.Varint(ZigZag(v));
+		}
+	}
+}
+
+inline bool ReadElement(Reader &reader, ElementType type, void *value, const void *reference) {
+	switch (type) {
+	case ElementType::HighQuat:
+	case ElementType::LowQuat:
+		return reader.Fixed(*(uint64_t *)value, QuatBytes(type));
+	case ElementType::Bits:
+		return reader.Varint(*(uint64_t *)value);
+	default:
+		for (int i = 0; i < ElementComponents(type); i++) {
+			uint64_t encoded;
+			if (!reader.Varint(encoded)) {
+				return false;
+			}
+			int64_t v = UnZigZag(encoded);
+			if (reference != nullptr) {
+				v += ((const int32_t *)reference)[i];
+			}
+			((int32_t *)value)[i] = (int32_t)v;
+		}
+		return true;
+	}
+}
+
+inline bool ElementEquals(ElementType type, const void *a, const void *b) {
+	if (type == ElementType::HighQuat || type == ElementType::LowQuat || type == ElementType::Bits) {
+		return *(const uint64_t *)a == *(const uint64_t *)b;
+	}
+	return memcmp(a, b, ElementComponents(type) * sizeof(int32_t)) == 0;
+}
+
+// Pointer to the same element in other, given its pointer in sample.
+inline const void *SameElement(const Quantized &sample, const void *element, const Quantized &other) {
+	return (const uint8_t *)&other + ((const uint8_t *)element - (const uint8_t *)&sample);
+}
+
+template <typename TrackingInfo>
+Quantized Quantize(const TrackingInfo &info) {
+	Quantized q = {};
+	q.targetTimestampNs = info.targetTimestampNs;
+	q.flags = info.mounted ? FLAG_MOUNTED : 0;
+	q.headOrientation = PackQuat(info.HeadPose_Pose_Orientation, HIGH_QUAT_BITS);
+	q.headPosition[0] = ToFixed(info.HeadPose_Pose_Position.x, POSITION_SCALE);
+	q.headPosition[1] = ToFixed(info.HeadPose_Pose_Position.y, POSITION_SCALE);
+	q.headPosition[2] = ToFixed(info.HeadPose_Pose_Position.z, POSITION_SCALE);
+
+	const auto &gazeQuat = info.EyeGaze_Pose_Orientation;
+	const auto &gazeDirection = info.EyeGaze_Direction;
+	if (gazeQuat.x != 0 || gazeQuat.y != 0 || gazeQuat.z != 0 || gazeQuat.w != 0 ||
+		gazeDirection.x != 0 || gazeDirection.y != 0 || gazeDirection.z != 0) {
+		q.presence |= PRESENCE_GAZE;
+		q.gazeOrientation = PackQuat(gazeQuat, HIGH_QUAT_BITS);
+		q.gazeDirection[0] = ToFixed(gazeDirection.x, UNIT_SCALE);
+		q.gazeDirection[1] = ToFixed(gazeDirection.y, UNIT_SCALE);
+		q.gazeDirection[2] = ToFixed(gazeDirection.z, UNIT_SCALE);
+	}
+
+	auto vector = [](int32_t (&out)[3], const auto &v, double scale) {
+		out[0] = ToFixed(v.x, scale);
+		out[1] = ToFixed(v.y, scale);
+		out[2] = ToFixed(v.z, scale);
+	};
+	for (int i = 0; i < 2; i++) {
+		const auto &in = info.controller[i];
+		auto &c = q.controller[i];
+		if (!in.enabled) {
+			continue;
+		}
+		q.presence |= PRESENCE_CONTROLLER << i;
+		c.buttons = in.buttons;
+		c.trackpad[0] = ToFixed(in.trackpadPosition.x, UNIT_SCALE);
+		c.trackpad[1] = ToFixed(in.trackpadPosition.y, UNIT_SCALE);
+		c.trigger = ToFixed(in.triggerValue, UNIT_SCALE);
+		c.grip = ToFixed(in.gripValue, UNIT_SCALE);
+		c.orientation = PackQuat(in.orientation, HIGH_QUAT_BITS);
+		vector(c.position, in.position, POSITION_SCALE);
+		vector(c.angularVelocity, in.angularVelocity, VELOCITY_SCALE);
+		vector(c.linearVelocity, in.linearVelocity, VELOCITY_SCALE);
+		if (!in.isHand) {
+			continue;
+		}
+		q.presence |= PRESENCE_HAND << i;
+		for (int b = 0; b < BONE_COUNT; b++) {
+			c.boneRotations[b] = PackQuat(in.boneRotations[b], LOW_QUAT_BITS);
+			vector(c.bonePositionsBase[b], in.bonePositionsBase[b], POSITION_SCALE);
+		}
+		c.boneRootOrientation = PackQuat(in.boneRootOrientation, HIGH_QUAT_BITS);
+		vector(c.boneRootPosition, in.boneRootPosition, POSITION_SCALE);
+		c.handFingerConfidences = in.handFingerConfidences;
+	}
+	return q;
+}
+
+// Absent elements are zeroed, like the client sends them.
+template <typename TrackingInfo>
+void Dequantize(const Quantized &q, TrackingInfo &info) {
+	memset(&info, 0, sizeof(info));
+	info.targetTimestampNs = q.targetTimestampNs;
+	info.mounted = (q.flags & FLAG_MOUNTED) ? 1 : 0;
+	UnpackQuat(q.headOrientation, HIGH_QUAT_BITS, info.HeadPose_Pose_Orientation);
+	info.HeadPose_Pose_Position.x = FromFixed(q.headPosition[0], POSITION_SCALE);
+	info.HeadPose_Pose_Position.y = FromFixed(q.headPosition[1], POSITION_SCALE);
+	info.HeadPose_Pose_Position.z = FromFixed(q.headPosition[2], POSITION_SCALE);
+	if (q.presence & PRESENCE_GAZE) {
+		UnpackQuat(q.gazeOrientation, HIGH_QUAT_BITS, info.EyeGaze_Pose_Orientation);
+		info.EyeGaze_Direction.x = FromFixed(q.gazeDirection[0], UNIT_SCALE);
+		info.EyeGaze_Direction.y = FromFixed(q.gazeDirection[1], UNIT_SCALE);
+		info.EyeGaze_Direction.z = FromFixed(q.gazeDirection[2], UNIT_SCALE);
+	}
+
+	auto vector = [](auto &out, const int32_t (&v)[3], double scale) {
+		out.x = FromFixed(v[0], scale);
+		out.y = FromFixed(v[1], scale);
+		out.z = FromFixed(v[2], scale);
+	};
+	for (int i = 0; i < 2; i++) {
+		auto &out = info.controller[i];
+		const auto &c = q.controller[i];
+		if (!(q.presence & (PRESENCE_CONTROLLER << i))) {
+			continue;
+		}
+		out.enabled = true;
+		out.buttons = c.buttons;
+		out.trackpadPosition.x = FromFixed(c.trackpad[0], UNIT_SCALE);
+		out.trackpadPosition.y = FromFixed(c.trackpad[1], UNIT_SCALE);
+		out.triggerValue = FromFixed(c.trigger, UNIT_SCALE);
+		out.gripValue = FromFixed(c.grip, UNIT_SCALE);
+		UnpackQuat(c.orientation, HIGH_QUAT_BITS, out.orientation);
+		vector(out.position, c.position, POSITION_SCALE);
+		vector(out.angularVelocity, c.angularVelocity, VELOCITY_SCALE);
+		vector(out.linearVelocity, c.linearVelocity, VELOCITY_SCALE);
+		if (!(q.presence & (PRESENCE_HAND << i))) {
+			continue;
+		}
+		out.isHand = true;
+		for (int b = 0; b < BONE_COUNT; b++) {
+			UnpackQuat(c.boneRotations[b], LOW_QUAT_BITS, out.boneRotations[b]);
+			vector(out.bonePositionsBase[b], c.bonePositionsBase[b], POSITION_SCALE);
+		}
+		UnpackQuat(c.boneRootOrientation, HIGH_QUAT_BITS, out.boneRootOrientation);
+		vector(out.boneRootPosition, c.boneRootPosition, POSITION_SCALE);
+		out.handFingerConfidences = (uint32_t)c.handFingerConfidences;
+	}
+}
+
+// Client side. Encode and Acknowledge can be called from different threads as long as each
+// one is only called from one thread at a time: the acknowledged timestamp is the only state
+// they share.
+template <typename TrackingInfo>
+class Encoder {
+public:
+	// Appends the packet for info to out.
+	void Encode(const TrackingInfo &info, std::vector<uint8_t> &out) {
+		Quantized sample = Quantize(info);
+
+		const Quantized *reference = nullptr;
+		const uint64_t acknowledged = m_acknowledged.load(std::memory_order_relaxed);
+		if (m_useDelta && acknowledged != 0) {
+			for (const auto &entry : m_history) {
+				if (entry.targetTimestampNs == acknowledged && entry.presence == sample.presence) {
+					reference = &entry;
+					break;
+				}
+			}
+		}
+
+		Writer writer(out);
+		writer.Byte(VERSION);
+		writer.Byte(sample.flags | (reference != nullptr ? FLAG_DELTA : 0));
+		writer.Byte(sample.presence);
+		writer.Varint(sample.targetTimestampNs);
+		if (reference == nullptr) {
+			ForEachElement(sample, [&](ElementType type, void *value) {
+				WriteElement(writer, type, value, nullptr);
+			});
+		} else {
+			writer.Varint(ZigZag((int64_t)(sample.targetTimestampNs - reference->targetTimestampNs)));
+			ChangedBits changedBits = {};
+			size_t index = 0;
+			ForEachElement(sample, [&](ElementType type, void *value) {
+				if (!ElementEquals(type, value, SameElement(sample, value, *reference))) {
+					changedBits[index / 8] |= 1 << (index % 8);
+				}
+				index++;
+			});
+			out.insert(out.end(), changedBits.begin(), changedBits.begin() + (index + 7) / 8);
+			index = 0;
+			ForEachElement(sample, [&](ElementType type, void *value) {
+				if (changedBits[index / 8] & (1 << (index % 8))) {
+					WriteElement(writer, type, value, SameElement(sample, value, *reference));
+				}
+				index++;
+			});
+		}
+
+		m_history[m_next] = sample;
+		m_next = (m_next + 1) % ENCODER_HISTORY;
+	}
+
+	// The server decoded the sample with this timestamp, it can be used as a reference.
+	void Acknowledge(uint64_t targetTimestampNs) {
+		m_acknowledged.store(targetTimestampNs, std::memory_order_relaxed);
+	}
+
+	void SetUseDelta(bool useDelta) {
+		m_useDelta = useDelta;
+	}
+
+	// New connection: the server has no reference anymore.
+	void Reset() {
+		m_acknowledged.store(0, std::memory_order_relaxed);
+		m_history = {};
+		m_next = 0;
+	}
+
+private:
+	std::array<Quantized, ENCODER_HISTORY> m_history = {};
+	size_t m_next = 0;
+	std::atomic<uint64_t> m_acknowledged{ 0 };
+	bool m_useDelta = true;
+};
+
+// Server side.
+template <typename TrackingInfo>
+class Decoder {
+public:
+	// False if the packet is malformed, of an unknown version, or references a sample which
+	// isn't known (anymore).
+	bool Decode(const uint8_t *data, size_t size, TrackingInfo &info) {
+		Reader reader(data, size);
+		uint8_t version, flags;
+		Quantized sample = {};
+		if (!reader.Byte(version) || version != VERSION || !reader.Byte(flags) ||
+			!reader.Byte(sample.presence) || !reader.Varint(sample.targetTimestampNs)) {
+			return false;
+		}
+		sample.flags = flags & FLAG_MOUNTED;
+
+		bool ok = true;
+		if (!(flags & FLAG_DELTA)) {
+			ForEachElement(sample, [&](ElementType type, void *value) {
+				ok = ok && ReadElement(reader, type, value, nullptr);
+			});
+		} else {
+			uint64_t encodedOffset;
+			if (!reader.Varint(encodedOffset)) {
+				return false;
+			}
+			const uint64_t referenceTimestamp = sample.targetTimestampNs - (uint64_t)UnZigZag(encodedOffset);
+			const Quantized *reference = nullptr;
+			for (const auto &entry : m_history) {
+				if (entry.targetTimestampNs == referenceTimestamp && entry.presence == sample.presence) {
+					reference = &entry;
+					break;
+				}
+			}
+			if (reference == nullptr) {
+				return false;
+			}
+			// Start from the reference, the changed bits tell which elements to read.
+			const uint8_t presence = sample.presence;
+			const uint64_t timestamp = sample.targetTimestampNs;
+			sample = *reference;
+			sample.presence = presence;
+			sample.targetTimestampNs = timestamp;
+			sample.flags = flags & FLAG_MOUNTED;
+
+			size_t count = 0;
+			ForEachElement(sample, [&](ElementType, void *) { count++; });
+			ChangedBits changedBits = {};
+			for (size_t i = 0; i < (count + 7) / 8; i++) {
+				ok = ok && reader.Byte(changedBits[i]);
+			}
+			size_t index = 0;
+			ForEachElement(sample, [&](ElementType type, void *value) {
+				if (ok && (changedBits[index / 8] & (1 << (index % 8)))) {
+					ok = ReadElement(reader, type, value, SameElement(sample, value, *reference));
+				}
+				index++;
+			});
+		}
+		if (!ok) {
+			return false;
+		}
+
+		m_history[m_next] = sample;
+		m_next = (m_next + 1) % DECODER_HISTORY;
+		Dequantize(sample, info);
+		return true;
+	}
+
+	void Reset() {
+		m_history = {};
+		m_next = 0;
+	}
+
+private:
+	std::array<Quantized, DECODER_HISTORY> m_history = {};
+	size_t m_next = 0;
+};
+
+} // namespace tracking_codec
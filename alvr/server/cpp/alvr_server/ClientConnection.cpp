@@ -7,8 +7,10 @@
 #include "bindings.h"
 #include "Utils.h"
 #include "Settings.h"
+#include "FrameTracer.h"
 
 const int64_t STATISTICS_TIMEOUT_US = 100 * 1000;
+const int64_t THREAD_REPORT_INTERVAL_US = 10 * 1000 * 1000;
 
 ClientConnection::ClientConnection() : m_LastStatisticsUpdate(0) {
 
@@ -16,118 +18,99 @@ ClientConnection::ClientConnection() : m_LastStatisticsUpdate(0) {
 
 	reed_solomon_init();
 	
-	videoPacketCounter = 0;
-	m_fecPercentage = INITIAL_FEC_PERCENTAGE;
+	if (Settings::Instance().m_enableVideoPacing) {
+		m_pacer = std::make_shared<VideoPacer>();
+		m_pacer->Start();
+	}
+	m_sinks.push_back(std::make_shared<VideoSink>(CLIENT_VIDEO_SINK, m_Statistics, m_pacer));
+	SetVideoFrameSize(Settings::Instance().m_renderWidth, Settings::Instance().m_renderHeight);
 	memset(&m_reportedStatistics, 0, sizeof(m_reportedStatistics));
 	m_Statistics->ResetAll();
 }
 
-void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t targetTimestampNs, uint64_t videoFrameIndex) {
-	int shardPackets = CalculateFECShardPackets(len, m_fecPercentage);
-
-	int blockSize = shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
-
-	int dataShards = (len + blockSize - 1) / blockSize;
-	int totalParityShards = CalculateParityShards(dataShards, m_fecPercentage);
-	int totalShards = dataShards + totalParityShards;
-
-	assert(totalShards <= DATA_SHARDS_MAX);
-
-	Debug("reed_solomon_new. dataShards=%d totalParityShards=%d totalShards=%d blockSize=%d shardPackets=%d\n"
-		, dataShards, totalParityShards, totalShards, blockSize, shardPackets);
-
-	reed_solomon *rs = reed_solomon_new(dataShards, totalParityShards);
+void ClientConnection::SendVideo(uint8_t *buf, int len, uint64_t targetTimestampNs) {
+	if (m_pacer || (Settings::Instance().m_enableVideoNack && Settings::Instance().m_enableFec)) {
+		// buf is only valid during the call, the pacer and the retransmissions keep the frame.
+		SendVideo(std::make_shared<std::vector<uint8_t>>(buf, buf + len), targetTimestampNs);
+	} else {
+		SendVideo(buf, len, targetTimestampNs, nullptr);
+	}
+}
 
-	std::vector<uint8_t *> shards(totalShards);
+void ClientConnection::SendVideo(std::shared_ptr<std::vector<uint8_t>> frame, uint64_t targetTimestampNs) {
+	uint8_t *buf = frame->data();
+	int len = (int)frame->size();
+	SendVideo(buf, len, targetTimestampNs, std::move(frame));
+}
 
-	for (int i = 0; i < dataShards; i++) {
-		shards[i] = buf + i * blockSize;
-	}
-	if (len % blockSize != 0) {
-		// Padding
-		shards[dataShards - 1] = new uint8_t[blockSize];
-		memset(shards[dataShards - 1], 0, blockSize);
-		memcpy(shards[dataShards - 1], buf + (dataShards - 1) * blockSize, len % blockSize);
+void ClientConnection::SendVideo(uint8_t *buf, int len, uint64_t targetTimestampNs,
+	std::shared_ptr<std::vector<uint8_t>> frame) {
+	VideoFrameStamp stamp = {targetTimestampNs, mVideoFrameIndex, mVideoFrameWidth, mVideoFrameHeight};
+	FrameTracer::Instance().OnEncoded(targetTimestampNs, mVideoFrameIndex);
+	{
+		std::unique_lock lock(m_sinksMutex);
+		for (auto &sink : m_sinks) {
+			sink->SendVideo(buf, len, stamp, frame);
+		}
 	}
-	for (int i = 0; i < totalParityShards; i++) {
-		shards[dataShards + i] = new uint8_t[blockSize];
+	if (m_pacer) {
+		m_pacer->CommitFrame(m_Statistics->GetBitrate());
 	}
 
-	int ret = reed_solomon_encode(rs, &shards[0], totalShards, blockSize);
-	assert(ret == 0);
-
-	reed_solomon_release(rs);
-
-	uint8_t packetBuffer[2000];
-	VideoFrame *header = (VideoFrame *)packetBuffer;
-	uint8_t *payload = packetBuffer + sizeof(VideoFrame);
-	int dataRemain = len;
-
-	header->type = ALVR_PACKET_TYPE_VIDEO_FRAME;
-	header->trackingFrameIndex = targetTimestampNs;
-	header->videoFrameIndex = videoFrameIndex;
-	header->sentTime = GetTimestampUs();
-	header->frameByteSize = len;
-	header->fecIndex = 0;
-	header->fecPercentage = (uint16_t)m_fecPercentage;
-	for (int i = 0; i < dataShards; i++) {
-		for (int j = 0; j < shardPackets; j++) {
-			int copyLength = std::min(ALVR_MAX_VIDEO_BUFFER_SIZE, dataRemain);
-			if (copyLength <= 0) {
-				break;
-			}
-			memcpy(payload, shards[i] + j * ALVR_MAX_VIDEO_BUFFER_SIZE, copyLength);
-			dataRemain -= ALVR_MAX_VIDEO_BUFFER_SIZE;
-
-			header->packetCounter = videoPacketCounter;
-			videoPacketCounter++;
-			VideoSend(*header, (unsigned char *)packetBuffer + sizeof(VideoFrame), copyLength);
-			m_Statistics->CountPacket(sizeof(VideoFrame) + copyLength);
-			header->fecIndex++;
+	mVideoFrameIndex++;
+}
+
+void ClientConnection::SendRepeatFrame(uint64_t targetTimestampNs) {
+	VideoFrameStamp stamp = {targetTimestampNs, mVideoFrameIndex, mVideoFrameWidth, mVideoFrameHeight};
+	FrameTracer::Instance().OnEncoded(targetTimestampNs, 0);
+	{
+		std::unique_lock lock(m_sinksMutex);
+		for (auto &sink : m_sinks) {
+			sink->SendRepeatFrame(stamp);
 		}
 	}
-	header->fecIndex = dataShards * shardPackets;
-	for (int i = 0; i < totalParityShards; i++) {
-		for (int j = 0; j < shardPackets; j++) {
-			int copyLength = ALVR_MAX_VIDEO_BUFFER_SIZE;
-			memcpy(payload, shards[dataShards + i] + j * ALVR_MAX_VIDEO_BUFFER_SIZE, copyLength);
-
-			header->packetCounter = videoPacketCounter;
-			videoPacketCounter++;
-			
-			VideoSend(*header, (unsigned char *)packetBuffer + sizeof(VideoFrame), copyLength);
-			m_Statistics->CountPacket(sizeof(VideoFrame) + copyLength);
-			header->fecIndex++;
+	if (m_pacer) {
+		m_pacer->CommitFrame(m_Statistics->GetBitrate());
+	}
+}
+
+void ClientConnection::SetVideoFrameSize(uint32_t width, uint32_t height) {
+	mVideoFrameWidth = (uint16_t)width;
+	mVideoFrameHeight = (uint16_t)height;
+}
+
+void ClientConnection::AddVideoSink(uint32_t sinkId) {
+	std::unique_lock lock(m_sinksMutex);
+	for (auto &sink : m_sinks) {
+		if (sink->GetId() == sinkId) {
+			return;
 		}
 	}
+	m_sinks.push_back(std::make_shared<VideoSink>(sinkId, std::make_shared<Statistics>(), m_pacer));
+	Info("Video sink %u added, %d sinks\n", sinkId, (int)m_sinks.size());
+}
 
-	if (len % blockSize != 0) {
-		delete[] shards[dataShards - 1];
+void ClientConnection::RemoveVideoSink(uint32_t sinkId) {
+	if (sinkId == CLIENT_VIDEO_SINK) {
+		return;
 	}
-	for (int i = 0; i < totalParityShards; i++) {
-		delete[] shards[dataShards + i];
+	std::unique_lock lock(m_sinksMutex);
+	for (auto it = m_sinks.begin(); it != m_sinks.end(); ++it) {
+		if ((*it)->GetId() == sinkId) {
+			m_sinks.erase(it);
+			Info("Video sink %u removed, %d sinks\n", sinkId, (int)m_sinks.size());
+			return;
+		}
 	}
 }
 
-void ClientConnection::SendVideo(uint8_t *buf, int len, uint64_t targetTimestampNs) {
-	if (Settings::Instance().m_enableFec) {
-		FECSend(buf, len, targetTimestampNs, mVideoFrameIndex);
-	} else {
-		VideoFrame header = {};
-		header.packetCounter = this->videoPacketCounter;
-		header.trackingFrameIndex = targetTimestampNs;
-		header.videoFrameIndex = mVideoFrameIndex;
-		header.sentTime = GetTimestampUs();
-		header.frameByteSize = len;
-
-		VideoSend(header, buf, len);
-
-		m_Statistics->CountPacket(sizeof(VideoFrame) + len);
-
-		this->videoPacketCounter++;
+std::shared_ptr<VideoSink> ClientConnection::FindVideoSink(uint32_t sinkId) {
+	for (auto &sink : m_sinks) {
+		if (sink->GetId() == sinkId) {
+			return sink;
+		}
 	}
-
-	mVideoFrameIndex++;
+	return nullptr;
 }
 
 void ClientConnection::ProcessTimeSync(TimeSync data) {
@@ -151,6 +134,11 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 		TimeSyncSend(sendBuf);
 
 		m_Statistics->NetworkTotal(sendBuf.serverTotalLatency);
+		m_framePacer.OnClientTiming(m_Statistics->GetEncodeLatencyAverage(),
+			m_reportedStatistics.averageTransportLatency,
+			m_reportedStatistics.averageDecodeLatency,
+			m_reportedStatistics.idleTime,
+			sendBuf.serverTotalLatency);
 		m_Statistics->NetworkSend(m_reportedStatistics.averageTransportLatency);
 
 		float renderTime = timing[0].m_flPreSubmitGpuMs + timing[0].m_flPostSubmitGpuMs + timing[0].m_flTotalRenderGpuMs + timing[0].m_flCompositorRenderGpuMs + timing[0].m_flCompositorRenderCpuMs;
@@ -158,7 +146,7 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 		float waitTime = timing[0].m_flClientFrameIntervalMs + timing[0].m_flPresentCallCpuMs + timing[0].m_flWaitForPresentCpuMs + timing[0].m_flSubmitFrameMs;
 
 		if (timeSync->fecFailure) {
-			OnFecFailure();
+			OnFecFailure(CLIENT_VIDEO_SINK);
 		}
 
 		m_Statistics->Add(sendBuf.serverTotalLatency / 1000.0, 
@@ -171,6 +159,16 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 		uint64_t now = GetTimestampUs();
 		if (now - m_LastStatisticsUpdate > STATISTICS_TIMEOUT_US)
 		{
+			int fecPercentage;
+			{
+				std::unique_lock lock(m_sinksMutex);
+				fecPercentage = m_sinks[0]->GetFecPercentage();
+			}
+			uint64_t pacingDelayUs = 0;
+			uint64_t pacingDelayMaxUs = 0;
+			if (m_pacer) {
+				m_pacer->TakeDelayStats(pacingDelayUs, pacingDelayMaxUs);
+			}
 			// Text statistics only, some values averaged
 			Info("#{ \"id\": \"Statistics\", \"data\": {"
 				"\"totalPackets\": %llu, "
@@ -181,15 +179,22 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 				"\"sentRate\": %.3f, "
 				"\"bitrate\": %llu, "
 				"\"ping\": %.3f, "
+				"\"clockSyncError\": %.3f, "
 				"\"totalLatency\": %.3f, "
 				"\"encodeLatency\": %.3f, "
 				"\"sendLatency\": %.3f, "
 				"\"decodeLatency\": %.3f, "
+				"\"pacingDelay\": %.3f, "
+				"\"pacingDelayMax\": %.3f, "
 				"\"fecPercentage\": %d, "
 				"\"fecFailureTotal\": %llu, "
 				"\"fecFailureInSecond\": %llu, "
 				"\"clientFPS\": %.3f, "
 				"\"serverFPS\": %.3f, "
+				"\"psnr\": %.2f, "
+				"\"foveatedPsnr\": %.2f, "
+				"\"ssim\": %.4f, "
+				"\"foveatedSsim\": %.4f, "
 				"\"batteryHMD\": %d, "
 				"\"batteryLeft\": %d, "
 				"\"batteryRight\": %d"
@@ -202,15 +207,22 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 				m_Statistics->GetBitsSentInSecond() / 1000. / 1000.0,
 				m_Statistics->GetBitrate(),
 				m_Statistics->Get(5),  //ping
+				m_clockSync.GetEstimate().error / 1000.,
 				m_Statistics->Get(0),  //totalLatency
 				m_Statistics->Get(1),  //encodeLatency
 				m_Statistics->Get(2),  //sendLatency
 				m_Statistics->Get(3),  //decodeLatency
-				m_fecPercentage,
+				pacingDelayUs / 1000.,
+				pacingDelayMaxUs / 1000.,
+				fecPercentage,
 				m_reportedStatistics.fecFailureTotal,
 				m_reportedStatistics.fecFailureInSecond,
 				m_Statistics->Get(4),  //clientFPS
 				m_Statistics->GetFPS(),
+				m_Statistics->GetPsnr(),
+				m_Statistics->GetFoveatedPsnr(),
+				m_Statistics->GetSsim(),
+				m_Statistics->GetFoveatedSsim(),
 				(int)(m_Statistics->m_hmdBattery * 100),
 				(int)(m_Statistics->m_leftControllerBattery * 100),
 				(int)(m_Statistics->m_rightControllerBattery * 100));
@@ -219,6 +231,24 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 			m_Statistics->Reset();
 		};
 
+		if (now - m_lastThreadReport > THREAD_REPORT_INTERVAL_US) {
+			m_threadReporter.Report(now, [](const std::string &name, double cpuUsage, double involuntarySwitches) {
+				Info("Thread %s: %.1f%% CPU, %.0f involuntary context switches/s\n",
+					name.c_str(), cpuUsage * 100, involuntarySwitches);
+			});
+			m_lastThreadReport = now;
+
+			std::unique_lock lock(m_sinksMutex);
+			for (auto &sink : m_sinks) {
+				if (sink->GetId() != CLIENT_VIDEO_SINK) {
+					auto stats = sink->GetStatistics();
+					Info("Spectator %u: %llu packets, %.3f MB/s, FEC %d%%\n", sink->GetId(),
+						stats->GetPacketsSentTotal(), stats->GetBitsSentInSecond() / 8. / 1000. / 1000.,
+						sink->GetFecPercentage());
+				}
+			}
+		}
+
 		// Continously send statistics info for updating graphs
 		Info("#{ \"id\": \"GraphStatistics\", \"data\": [%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f] }#\n",
 			Current / 1000,                                                //time
@@ -241,23 +271,57 @@ void ClientConnection::ProcessTimeSync(TimeSync data) {
 		m_RTT = RTT;
 		// Estimated difference between server and client clock
 		int64_t TimeDiff = Current - (timeSync->clientTime + RTT / 2);
-		m_TimeDiff = TimeDiff;
-		Debug("TimeSync: server - client = %lld us RTT = %lld us\n", TimeDiff, RTT);
+		m_clockSync.AddSample(Current, TimeDiff, RTT);
+		m_TimeDiff = m_clockSync.GetOffset(Current);
+		Debug("TimeSync: server - client = %lld us (sample %lld us, error %.0f us) RTT = %lld us\n",
+			m_TimeDiff, TimeDiff, m_clockSync.GetEstimate().error, RTT);
 	}
 }
 
 float ClientConnection::GetPoseTimeOffset() {
-	return -(double)(m_Statistics->GetTotalLatencyAverage()) / 1000.0 / 1000.0;
+	return m_framePacer.GetPoseTimeOffset();
 }
 
-void ClientConnection::OnFecFailure() {
-	Debug("Listener::OnFecFailure()\n");
-	if (GetTimestampUs() - m_lastFecFailure < CONTINUOUS_FEC_FAILURE) {
-		if (m_fecPercentage < MAX_FEC_PERCENTAGE) {
-			m_fecPercentage += 5;
-		}
+void ClientConnection::OnFecFailure(uint32_t sinkId) {
+	std::unique_lock lock(m_sinksMutex);
+	auto sink = FindVideoSink(sinkId);
+	if (sink) {
+		sink->OnFecFailure();
+	}
+}
+
+void ClientConnection::OnVideoNack(uint32_t sinkId, uint64_t videoFrameIndex, const VideoNackRange *ranges, int rangeCount) {
+	if (!Settings::Instance().m_enableVideoNack) {
+		return;
+	}
+	std::shared_ptr<VideoSink> sink;
+	{
+		std::unique_lock lock(m_sinksMutex);
+		sink = FindVideoSink(sinkId);
+	}
+	if (sink) {
+		sink->Retransmit(videoFrameIndex, ranges, rangeCount);
+	}
+}
+
+bool ClientConnection::OnIDRRequest(uint32_t sinkId) {
+	std::unique_lock lock(m_sinksMutex);
+	if (!FindVideoSink(sinkId)) {
+		return false;
+	}
+
+	// A sink repeating its own request still gets it, as with a single client. Only the requests
+	// of the other sinks, which lost the same frames, are merged into the pending IDR.
+	uint64_t now = GetTimestampUs();
+	uint64_t frameIntervalUs = 1000000 / std::max(Settings::Instance().m_refreshRate, 1);
+	uint64_t window = m_RTT + IDR_COALESCE_FRAMES * frameIntervalUs;
+	if (sinkId != m_lastIDRSink && now - m_lastIDRRequest < window) {
+		Debug("IDR request of sink %u coalesced with sink %u\n", sinkId, m_lastIDRSink);
+		return false;
 	}
-	m_lastFecFailure = GetTimestampUs();
+	m_lastIDRSink = sinkId;
+	m_lastIDRRequest = now;
+	return true;
 }
 
 std::shared_ptr<Statistics> ClientConnection::GetStatistics() {
@@ -4,41 +4,80 @@
 #include <memory>
 #include <fstream>
 #include <mutex>
+#include <vector>
 
+#include "ALVR-common/clock_sync.h"
 #include "ALVR-common/packet_types.h"
+#include "FramePacer.h"
+#include "GazeHistory.h"
 #include "Settings.h"
+#include "VideoPacer.h"
+#include "VideoSink.h"
 
 #include "openvr_driver.h"
 
 class Statistics;
 
+// The video goes to the client and to the spectators, see VideoSink.h
 class ClientConnection {
 public:
 
 	ClientConnection();
 
-	void FECSend(uint8_t *buf, int len, uint64_t targetTimestampNs, uint64_t videoFrameIndex);
+	// Sends the encoded frame to every sink. buf is copied once if the pacing or the retransmissions
+	// are enabled, the sinks keep the frame.
 	void SendVideo(uint8_t *buf, int len, uint64_t targetTimestampNs);
+	// Same without any copy, the encoder gives the frame away.
+	void SendVideo(std::shared_ptr<std::vector<uint8_t>> frame, uint64_t targetTimestampNs);
+	// Tell the client to show the previous frame again with the pose of targetTimestampNs.
+	void SendRepeatFrame(uint64_t targetTimestampNs);
+	// Size of the encoded frames, stamped in the video headers. Defaults to the render size.
+	void SetVideoFrameSize(uint32_t width, uint32_t height);
  	void ProcessTimeSync(TimeSync data);
 	float GetPoseTimeOffset();
-	void OnFecFailure();
+	void OnFecFailure(uint32_t sinkId);
+	void OnVideoNack(uint32_t sinkId, uint64_t videoFrameIndex, const VideoNackRange *ranges, int rangeCount);
+	// False when the request is covered by an IDR another sink requested less than a round trip
+	// (plus a couple of frames) ago: the encoder doesn't need to insert one more.
+	bool OnIDRRequest(uint32_t sinkId);
 	std::shared_ptr<Statistics> GetStatistics();
 
-	std::shared_ptr<Statistics> m_Statistics;
+	// Spectators, CLIENT_VIDEO_SINK is always there.
+	void AddVideoSink(uint32_t sinkId);
+	void RemoveVideoSink(uint32_t sinkId);
 
-	uint32_t videoPacketCounter = 0;
+	std::shared_ptr<Statistics> m_Statistics;
 
 	uint64_t m_RTT = 0;
+	// server - client clock, filtered by m_clockSync
 	int64_t m_TimeDiff = 0;
+	ClockSyncEstimator m_clockSync;
+	FramePacer m_framePacer;
+	GazeHistory m_gazeHistory;
 
 	TimeSync m_reportedStatistics;
-	uint64_t m_lastFecFailure = 0;
-	static const uint64_t CONTINUOUS_FEC_FAILURE = 60 * 1000 * 1000;
-	static const int INITIAL_FEC_PERCENTAGE = 5;
-	static const int MAX_FEC_PERCENTAGE = 10;
-	int m_fecPercentage = INITIAL_FEC_PERCENTAGE;
 
 	uint64_t mVideoFrameIndex = 1;
+	uint16_t mVideoFrameWidth = 0;
+	uint16_t mVideoFrameHeight = 0;
 
 	uint64_t m_LastStatisticsUpdate;
+	// CPU time of the streaming threads, see ALVR-common/thread_policy.h
+	thread_policy::Reporter m_threadReporter;
+	uint64_t m_lastThreadReport = 0;
+
+private:
+	static const int IDR_COALESCE_FRAMES = 2;
+
+	std::shared_ptr<VideoSink> FindVideoSink(uint32_t sinkId);
+	// frame, if not null, holds buf.
+	void SendVideo(uint8_t *buf, int len, uint64_t targetTimestampNs,
+		std::shared_ptr<std::vector<uint8_t>> frame);
+
+	// Shared by the sinks, null if pacing is disabled.
+	std::shared_ptr<VideoPacer> m_pacer;
+	std::mutex m_sinksMutex;
+	std::vector<std::shared_ptr<VideoSink>> m_sinks;
+	uint32_t m_lastIDRSink = CLIENT_VIDEO_SINK;
+	uint64_t m_lastIDRRequest = 0;
 };
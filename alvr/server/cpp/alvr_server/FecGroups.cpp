@@ -0,0 +1,151 @@
+#include "FecGroups.h"
+
+#include <algorithm>
+
+#include "ALVR-common/nal_scan.h"
+#include "Settings.h"
+
+namespace {
+
+// Ordered from the most important, merged groups keep the most important class.
+enum NalClass {
+	NAL_CLASS_CRITICAL = 0,
+	NAL_CLASS_FOVEAL = 1,
+	NAL_CLASS_PERIPHERAL = 2,
+};
+
+// Every group ends with a partially filled shard, keep the layout coarse.
+const size_t MAX_FEC_GROUPS = 4;
+
+struct NalUnit {
+	int offset;
+	int size;
+	int nalClass;
+	bool positional;
+};
+
+bool IsSlice(int type, ALVR_CODEC codec) {
+	if (codec == ALVR_CODEC_H264) {
+		return type >= 1 && type <= 5;
+	}
+	// VCL types, without the reserved ones
+	return (type >= 0 && type <= 9) || (type >= 16 && type <= 21);
+}
+
+bool IsKeyframeSlice(int type, ALVR_CODEC codec) {
+	if (codec == ALVR_CODEC_H264) {
+		return type == 5;
+	}
+	return type >= 16 && type <= 21; // IRAP
+}
+
+// header is the first byte of the NAL unit header, after the start code.
+bool IsNonReferenceSlice(const uint8_t *header, int type, ALVR_CODEC codec) {
+	if (codec == ALVR_CODEC_H264) {
+		return ((header[0] >> 5) & 3) == 0; // nal_ref_idc
+	}
+	return type <= 8 && type % 2 == 0; // sub-layer non-reference types
+}
+
+}
+
+std::vector<FecGroup> BuildFecGroups(const uint8_t *buf, int len, int fecPercentage) {
+	auto &settings = Settings::Instance();
+	if (!settings.m_enableUnequalErrorProtection) {
+		return { { 0, len, fecPercentage } };
+	}
+	auto codec = ALVR_CODEC(settings.m_codec);
+
+	std::vector<NalUnit> units;
+	int positionalCount = 0;
+	ForEachNalUnit(buf, len, [&](const uint8_t *nalBegin, const uint8_t *nalEnd) {
+		NalUnit unit = { (int)(nalBegin - buf), (int)(nalEnd - nalBegin), NAL_CLASS_CRITICAL, false };
+		int type = GetNalUnitType(nalBegin, nalEnd, codec);
+		if (type >= 0 && IsSlice(type, codec) && !IsKeyframeSlice(type, codec)) {
+			if (IsNonReferenceSlice(GetNalUnitHeader(nalBegin, nalEnd), type, codec)) {
+				unit.nalClass = NAL_CLASS_PERIPHERAL;
+			} else {
+				unit.positional = true;
+				positionalCount++;
+			}
+		}
+		units.push_back(unit);
+	});
+
+	// Slices are assumed to be evenly spread from top to bottom, in order.
+	float bandTop = 0.5f - settings.m_uepFovealBand / 2;
+	float bandBottom = 0.5f + settings.m_uepFovealBand / 2;
+	int sliceIndex = 0;
+	std::vector<FecGroup> groups;
+	std::vector<int> groupClasses;
+	for (auto &unit : units) {
+		if (unit.positional) {
+			float top = (float)sliceIndex / positionalCount;
+			float bottom = (float)(sliceIndex + 1) / positionalCount;
+			unit.nalClass = (bottom > bandTop && top < bandBottom) ? NAL_CLASS_FOVEAL : NAL_CLASS_PERIPHERAL;
+			sliceIndex++;
+		}
+		if (!groups.empty() && groupClasses.back() == unit.nalClass) {
+			groups.back().size += unit.size;
+		} else {
+			groups.push_back({ unit.offset, unit.size, 0 });
+			groupClasses.push_back(unit.nalClass);
+		}
+	}
+
+	while (groups.size() > MAX_FEC_GROUPS) {
+		size_t smallest = 0;
+		for (size_t i = 1; i + 1 < groups.size(); i++) {
+			if (groups[i].size + groups[i + 1].size < groups[smallest].size + groups[smallest + 1].size) {
+				smallest = i;
+			}
+		}
+		groups[smallest].size += groups[smallest + 1].size;
+		groupClasses[smallest] = std::min(groupClasses[smallest], groupClasses[smallest + 1]);
+		groups.erase(groups.begin() + smallest + 1);
+		groupClasses.erase(groupClasses.begin() + smallest + 1);
+	}
+
+	for (size_t i = 0; i < groups.size(); i++) {
+		switch (groupClasses[i]) {
+		case NAL_CLASS_CRITICAL:
+			groups[i].fecPercentage = std::max((int)settings.m_uepCriticalFecPercentage, fecPercentage);
+			break;
+		case NAL_CLASS_FOVEAL:
+			groups[i].fecPercentage = fecPercentage;
+			break;
+		default:
+			groups[i].fecPercentage = std::max(std::min((int)settings.m_uepPeripheralFecPercentage, fecPercentage), 1);
+			break;
+		}
+	}
+	return groups;
+}
+
+std::vector<uint8_t> InterleaveFecGroups(const std::vector<size_t> &packetCounts) {
+	size_t total = 0;
+	for (size_t count : packetCounts) {
+		total += count;
+	}
+	std::vector<size_t> sent(packetCounts.size());
+	std::vector<uint8_t> order;
+	order.reserve(total);
+	for (size_t slot = 0; slot < total; slot++) {
+		// The group whose next packet is the most overdue at its own pace
+		size_t next = 0;
+		double nextDue = 2;
+		for (size_t g = 0; g < packetCounts.size(); g++) {
+			size_t count = packetCounts[g];
+			if (sent[g] < count) {
+				double due = (sent[g] + 0.5) / count;
+				if (due < nextDue) {
+					next = g;
+					nextDue = due;
+				}
+			}
+		}
+		order.push_back((uint8_t)next);
+		sent[next]++;
+	}
+	return order;
+}
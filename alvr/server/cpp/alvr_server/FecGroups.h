@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Unequal error protection: the frame is cut in byte ranges of similar importance and each
+// range gets its own FEC strength.
+// Parameter sets and IDR slices are critical, slices around the vertical center of the frame
+// (where the user usually looks) keep the base strength, other slices and non-reference
+// slices get the peripheral strength.
+struct FecGroup {
+	int offset;
+	int size;
+	int fecPercentage;
+};
+
+// fecPercentage is the base strength, raised on FEC failures.
+// Returns a single group covering the whole frame when unequal error protection is disabled.
+std::vector<FecGroup> BuildFecGroups(const uint8_t *buf, int len, int fecPercentage);
+
+// Group index of each packet of the frame in send order. The groups are merged in proportion to
+// their packet counts, so a burst of lost packets takes about the same share of every group instead
+// of all of one group, and within a group it still spreads over the packet rows.
+std::vector<uint8_t> InterleaveFecGroups(const std::vector<size_t> &packetCounts);
@@ -0,0 +1,69 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+#include "Settings.h"
+
+FramePacer::FramePacer()
+{
+	m_framePeriodUs = 1000000 / std::max(Settings::Instance().m_refreshRate, 1);
+	m_pipeline.resize(WINDOW_FRAMES);
+	m_sorted.reserve(WINDOW_FRAMES);
+}
+
+void FramePacer::SetPhaseControlled(bool phaseControlled)
+{
+	m_phaseControlled = phaseControlled;
+}
+
+void FramePacer::OnClientTiming(uint64_t encodeLatencyUs, uint64_t transportLatencyUs, uint64_t decodeLatencyUs,
+	uint64_t idleTimeUs, uint64_t totalLatencyUs)
+{
+	uint64_t pipeline = encodeLatencyUs + transportLatencyUs + decodeLatencyUs;
+	double total = (double)std::min(totalLatencyUs, MAX_TOTAL_LATENCY_US);
+
+	if (m_pipelineCount == WINDOW_FRAMES) {
+		m_pipelineSum -= m_pipeline[m_pipelineNext];
+	} else {
+		m_pipelineCount++;
+	}
+	m_pipeline[m_pipelineNext] = pipeline;
+	m_pipelineNext = (m_pipelineNext + 1) % WINDOW_FRAMES;
+	m_pipelineSum += pipeline;
+
+	// On a copy, the window stays in arrival order. A few us per client frame.
+	m_sorted.assign(m_pipeline.begin(), m_pipeline.begin() + m_pipelineCount);
+	auto quantile = m_sorted.begin() + (size_t)(ON_TIME_QUANTILE * (m_pipelineCount - 1));
+	std::nth_element(m_sorted.begin(), quantile, m_sorted.end());
+	m_margin = *quantile - std::min(*quantile, m_pipelineSum / m_pipelineCount);
+
+	if (!m_hasSamples) {
+		m_idleAverage = (double)idleTimeUs;
+		m_totalAverage = total;
+		m_hasSamples = true;
+		return;
+	}
+	m_idleAverage += AVERAGE_WEIGHT * ((double)idleTimeUs - m_idleAverage);
+	m_totalAverage += AVERAGE_WEIGHT * (total - m_totalAverage);
+}
+
+uint64_t FramePacer::GetTargetIdleTime() const
+{
+	// More than half a frame of margin means the client displays the frame before the
+	// previous one half the time anyway, keeping the latency low matters more.
+	return std::clamp(m_margin, MIN_TARGET_IDLE_US, std::max(m_framePeriodUs / 2, MIN_TARGET_IDLE_US));
+}
+
+float FramePacer::GetPoseTimeOffset() const
+{
+	if (!m_hasSamples) {
+		return 0;
+	}
+	double total = m_totalAverage;
+	if (m_phaseControlled) {
+		// The idle time is being steered to the target, predict for where it converges to
+		// rather than where it comes from.
+		total += (double)GetTargetIdleTime() - m_idleAverage;
+	}
+	return -(float)(std::max(total, 0.) / 1000.0 / 1000.0);
+}
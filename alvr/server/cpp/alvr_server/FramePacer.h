@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Paces the server frames against the client display from the TimeSync reports.
+// A frame that is decoded long before its display deadline waits on the client (idleTime),
+// that wait is latency for nothing. A frame decoded after the deadline misses the display.
+// The pacer keeps a margin against the jitter of the pipeline (encode + transport + decode):
+// the distance from its average to its ON_TIME_QUANTILE over the last WINDOW_FRAMES frames.
+// A window rather than a smoothed variance, Wi-Fi jitter comes in bursts with a long tail and
+// the margin has to hold from one burst to the next. The pacer gives:
+// - the idle time the virtual vsync phase should converge to, see VSyncGenerator
+// - the pose time offset, the time from the pose sample to the display of the frame rendered
+//   with it, for the SteamVR pose prediction.
+class FramePacer
+{
+public:
+	// Smoothing of the per frame samples.
+	static constexpr double AVERAGE_WEIGHT = 0.05;
+	// About ten seconds of frames.
+	static constexpr size_t WINDOW_FRAMES = 1024;
+	// Share of the frames the margin gets on time.
+	static constexpr double ON_TIME_QUANTILE = 0.98;
+	static constexpr uint64_t MIN_TARGET_IDLE_US = 1000;
+	// Same bound as Statistics::NetworkTotal.
+	static constexpr uint64_t MAX_TOTAL_LATENCY_US = 500000;
+
+	FramePacer();
+
+	// Whether the vsync phase follows GetTargetIdleTime(). Without it the client idle time is
+	// whatever the SteamVR frame timing gives and the pose offset has to include it as is.
+	void SetPhaseControlled(bool phaseControlled);
+
+	// One sample per client frame, all in us. totalLatencyUs is the whole motion-to-photon
+	// latency, including the client idle time.
+	void OnClientTiming(uint64_t encodeLatencyUs, uint64_t transportLatencyUs, uint64_t decodeLatencyUs,
+		uint64_t idleTimeUs, uint64_t totalLatencyUs);
+
+	// Client idle time the vsync phase should converge to (us).
+	uint64_t GetTargetIdleTime() const;
+
+	// Pose time offset in seconds, negative: the pose is predicted forward.
+	float GetPoseTimeOffset() const;
+
+private:
+	uint64_t m_framePeriodUs;
+	bool m_phaseControlled = false;
+
+	bool m_hasSamples = false;
+	// Pipeline latencies of the last frames, m_pipelineCount of them from m_pipelineNext back.
+	std::vector<uint64_t> m_pipeline;
+	size_t m_pipelineNext = 0;
+	size_t m_pipelineCount = 0;
+	uint64_t m_pipelineSum = 0;
+	std::vector<uint64_t> m_sorted;
+	uint64_t m_margin = 0;
+	double m_idleAverage = 0;
+	double m_totalAverage = 0;
+};
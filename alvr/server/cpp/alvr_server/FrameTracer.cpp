@@ -0,0 +1,431 @@
+#include "FrameTracer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Logger.h"
+#include "Settings.h"
+#include "Utils.h"
+#include "bindings.h"
+
+FrameTracer FrameTracer::m_Instance;
+
+namespace {
+	// Protobuf wire format of the Perfetto trace, only the fields written here.
+	// https://perfetto.dev/docs/reference/trace-packet-proto
+	enum Field {
+		TRACE_PACKET = 1,
+
+		PACKET_TIMESTAMP = 8,
+		PACKET_SEQUENCE_ID = 10,
+		PACKET_TRACK_EVENT = 11,
+		PACKET_TRACK_DESCRIPTOR = 60,
+
+		TRACK_UUID = 1,
+		TRACK_NAME = 2,
+		TRACK_PARENT_UUID = 5,
+
+		EVENT_DEBUG_ANNOTATIONS = 4,
+		EVENT_TYPE = 9,
+		EVENT_TRACK_UUID = 11,
+		EVENT_NAME = 23,
+
+		ANNOTATION_UINT_VALUE = 3,
+		ANNOTATION_NAME = 10,
+	};
+	enum EventType {
+		EVENT_SLICE_BEGIN = 1,
+		EVENT_SLICE_END = 2,
+		EVENT_INSTANT = 3,
+	};
+	const uint64_t SEQUENCE_ID = 1;
+	const uint64_t SERVER_TRACK = 1;
+	const uint64_t CLIENT_TRACK = 2;
+	const uint64_t SERVER_LANE_TRACK = 100;
+	const uint64_t CLIENT_LANE_TRACK = 200;
+	const uint64_t FLUSH_INTERVAL_US = 1000000;
+
+	void PutVarint(std::string &out, uint64_t value) {
+		while (value >= 0x80) {
+			out.push_back((char)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((char)value);
+	}
+
+	void PutUint(std::string &out, int field, uint64_t value) {
+		PutVarint(out, (uint64_t)field << 3);
+		PutVarint(out, value);
+	}
+
+	void PutBytes(std::string &out, int field, const std::string &bytes) {
+		PutVarint(out, ((uint64_t)field << 3) | 2);
+		PutVarint(out, bytes.size());
+		out += bytes;
+	}
+
+	void PutAnnotation(std::string &event, const char *name, uint64_t value) {
+		std::string annotation;
+		PutBytes(annotation, ANNOTATION_NAME, name);
+		PutUint(annotation, ANNOTATION_UINT_VALUE, value);
+		PutBytes(event, EVENT_DEBUG_ANNOTATIONS, annotation);
+	}
+
+	void PutPacket(std::string &out, uint64_t timeUs, const std::string &event) {
+		std::string packet;
+		PutUint(packet, PACKET_TIMESTAMP, timeUs * 1000);
+		PutUint(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+		PutBytes(packet, PACKET_TRACK_EVENT, event);
+		PutBytes(out, TRACE_PACKET, packet);
+	}
+
+	void PutTrack(std::string &out, uint64_t uuid, const std::string &name, uint64_t parentUuid) {
+		std::string track;
+		PutUint(track, TRACK_UUID, uuid);
+		PutBytes(track, TRACK_NAME, name);
+		if (parentUuid != 0) {
+			PutUint(track, TRACK_PARENT_UUID, parentUuid);
+		}
+		std::string packet;
+		PutUint(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+		PutBytes(packet, PACKET_TRACK_DESCRIPTOR, track);
+		PutBytes(out, TRACE_PACKET, packet);
+	}
+
+	struct Slice {
+		FrameTracer::Stage end;
+		// of the slice from the previous stamped stage to end, nullptr for the first stage
+		const char *name;
+	};
+	const Slice SERVER_SLICES[] = {
+		{ FrameTracer::STAGE_POSE_RECEIVED, nullptr },
+		{ FrameTracer::STAGE_PRESENT, "Game render" },
+		{ FrameTracer::STAGE_ENCODE_START, "Encode queue" },
+		{ FrameTracer::STAGE_ENCODE_END, "Encode" },
+		{ FrameTracer::STAGE_FEC_END, "FEC" },
+		{ FrameTracer::STAGE_FIRST_PACKET_SENT, "Pacing" },
+		{ FrameTracer::STAGE_LAST_PACKET_SENT, "Send" },
+	};
+	const Slice CLIENT_SLICES[] = {
+		{ FrameTracer::STAGE_FIRST_PACKET_RECEIVED, nullptr },
+		{ FrameTracer::STAGE_RECONSTRUCTED, "Receive" },
+		{ FrameTracer::STAGE_DECODER_INPUT, "Decode queue" },
+		{ FrameTracer::STAGE_DECODER_OUTPUT, "Decode" },
+		{ FrameTracer::STAGE_UPLOADED, "Upload" },
+		{ FrameTracer::STAGE_RENDER_START, "Render queue" },
+		{ FrameTracer::STAGE_RENDER_END, "Render" },
+		{ FrameTracer::STAGE_SUBMITTED, "Submit" },
+	};
+	const Slice SERVER_INSTANTS[] = {
+		{ FrameTracer::STAGE_VSYNC, "VSync" },
+	};
+	const Slice CLIENT_INSTANTS[] = {
+		{ FrameTracer::STAGE_POSE_SENT, "Pose sent" },
+		{ FrameTracer::STAGE_LAST_PACKET_RECEIVED, "Last packet" },
+	};
+
+	struct Event {
+		uint64_t timeUs;
+		std::string data;
+	};
+
+	// Events of one side of the frame, server or client, on the track of its lane: a "Frame"
+	// slice over all the stages, with one slice per step in it.
+	template<size_t SLICES, size_t INSTANTS>
+	void AddSide(std::vector<Event> &events, const uint64_t *stamps, int firstStage, int lastStage,
+		const Slice (&slices)[SLICES], const Slice (&instants)[INSTANTS], uint64_t track,
+		uint64_t videoFrameIndex, uint64_t trackingFrameIndex, const uint64_t *clockErrorUs) {
+		uint64_t begin = UINT64_MAX;
+		uint64_t end = 0;
+		for (int stage = firstStage; stage <= lastStage; stage++) {
+			if (stamps[stage] != 0) {
+				begin = std::min(begin, stamps[stage]);
+				end = std::max(end, stamps[stage]);
+			}
+		}
+		if (end == 0) {
+			return;
+		}
+
+		std::string data;
+		PutUint(data, EVENT_TYPE, EVENT_SLICE_BEGIN);
+		PutUint(data, EVENT_TRACK_UUID, track);
+		PutBytes(data, EVENT_NAME, "Frame");
+		PutAnnotation(data, "video_frame", videoFrameIndex);
+		PutAnnotation(data, "tracking_frame", trackingFrameIndex);
+		if (clockErrorUs) {
+			PutAnnotation(data, "clock_error_us", *clockErrorUs);
+		}
+		events.push_back({ begin, data });
+
+		uint64_t previous = 0;
+		for (auto &slice : slices) {
+			uint64_t time = stamps[slice.end];
+			if (time == 0 || time < previous) {
+				continue;
+			}
+			if (previous != 0 && time > previous) {
+				data.clear();
+				PutUint(data, EVENT_TYPE, EVENT_SLICE_BEGIN);
+				PutUint(data, EVENT_TRACK_UUID, track);
+				PutBytes(data, EVENT_NAME, slice.name);
+				events.push_back({ previous, data });
+
+				data.clear();
+				PutUint(data, EVENT_TYPE, EVENT_SLICE_END);
+				PutUint(data, EVENT_TRACK_UUID, track);
+				events.push_back({ time, data });
+			}
+			previous = time;
+		}
+
+		for (auto &instant : instants) {
+			if (stamps[instant.end] != 0) {
+				data.clear();
+				PutUint(data, EVENT_TYPE, EVENT_INSTANT);
+				PutUint(data, EVENT_TRACK_UUID, track);
+				PutBytes(data, EVENT_NAME, instant.name);
+				events.push_back({ stamps[instant.end], data });
+			}
+		}
+
+		data.clear();
+		PutUint(data, EVENT_TYPE, EVENT_SLICE_END);
+		PutUint(data, EVENT_TRACK_UUID, track);
+		events.push_back({ end, data });
+	}
+}
+
+FrameTracer::~FrameTracer()
+{
+	if (m_file) {
+		fclose(m_file);
+	}
+}
+
+void FrameTracer::OnPoseReceived(uint64_t trackingFrameIndex)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	m_poses[m_poseCount % HISTORY_FRAMES] = { trackingFrameIndex, GetTimestampUs() };
+	m_poseCount++;
+}
+
+void FrameTracer::OnVSync()
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	m_lastVSyncUs = GetTimestampUs();
+}
+
+void FrameTracer::OnPresent(uint64_t trackingFrameIndex)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	// the compositor can present the same frame again
+	if (Find(trackingFrameIndex)) {
+		return;
+	}
+	if (m_presented - m_written >= HISTORY_FRAMES) {
+		WritePending(m_presented - HISTORY_FRAMES + 1);
+	}
+
+	Frame &frame = m_frames[m_presented % HISTORY_FRAMES];
+	frame = {};
+	frame.number = m_presented;
+	frame.trackingFrameIndex = trackingFrameIndex;
+	frame.stamps[STAGE_PRESENT] = GetTimestampUs();
+	frame.stamps[STAGE_VSYNC] = m_lastVSyncUs;
+	for (auto &pose : m_poses) {
+		if (pose.trackingFrameIndex == trackingFrameIndex && pose.receivedUs != 0) {
+			frame.stamps[STAGE_POSE_RECEIVED] = pose.receivedUs;
+			break;
+		}
+	}
+	m_presented++;
+}
+
+void FrameTracer::Stamp(uint64_t trackingFrameIndex, Stage stage)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	Frame *frame = Find(trackingFrameIndex);
+	if (frame && frame->stamps[stage] == 0) {
+		frame->stamps[stage] = GetTimestampUs();
+	}
+}
+
+void FrameTracer::OnEncoded(uint64_t trackingFrameIndex, uint64_t videoFrameIndex)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	Frame *frame = Find(trackingFrameIndex);
+	if (frame && frame->stamps[STAGE_ENCODE_END] == 0) {
+		frame->stamps[STAGE_ENCODE_END] = GetTimestampUs();
+		frame->videoFrameIndex = videoFrameIndex;
+	}
+}
+
+void FrameTracer::OnPacketSent(const VideoFrame &header)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	Frame *frame = Find(header.trackingFrameIndex);
+	if (!frame) {
+		return;
+	}
+	uint64_t now = GetTimestampUs();
+	if (header.framePacketIndex == 0 && frame->stamps[STAGE_FIRST_PACKET_SENT] == 0) {
+		frame->stamps[STAGE_FIRST_PACKET_SENT] = now;
+	}
+	if (header.framePacketIndex + 1 >= header.framePacketCount) {
+		frame->stamps[STAGE_LAST_PACKET_SENT] = now;
+	}
+}
+
+void FrameTracer::OnClientTrace(const ClientFrameTrace &trace, int64_t serverMinusClientUs, uint64_t clockErrorUs)
+{
+	if (!Settings::Instance().m_enableFrameTrace) {
+		return;
+	}
+	std::unique_lock lock(m_mutex);
+	Frame *frame = Find(trace.trackingFrameIndex);
+	if (!frame) {
+		return;
+	}
+
+	auto toServer = [&](uint64_t clientUs) {
+		return clientUs != 0 ? (uint64_t)((int64_t)clientUs + serverMinusClientUs) : 0;
+	};
+	frame->stamps[STAGE_POSE_SENT] = toServer(trace.poseSent);
+	frame->stamps[STAGE_FIRST_PACKET_RECEIVED] = toServer(trace.firstPacketReceived);
+	frame->stamps[STAGE_LAST_PACKET_RECEIVED] = toServer(trace.lastPacketReceived);
+	frame->stamps[STAGE_RECONSTRUCTED] = toServer(trace.reconstructed);
+	frame->stamps[STAGE_DECODER_INPUT] = toServer(trace.decoderInput);
+	frame->stamps[STAGE_DECODER_OUTPUT] = toServer(trace.decoderOutput);
+	frame->stamps[STAGE_UPLOADED] = toServer(trace.uploaded);
+	frame->stamps[STAGE_RENDER_START] = toServer(trace.renderStart);
+	frame->stamps[STAGE_RENDER_END] = toServer(trace.renderEnd);
+	frame->stamps[STAGE_SUBMITTED] = toServer(trace.submitted);
+	frame->clockErrorUs = clockErrorUs;
+
+	// The client submits the frames in order, the ones before it it didn't submit are written
+	// with their server stages.
+	WritePending(frame->number + 1);
+}
+
+void FrameTracer::Reset()
+{
+	std::unique_lock lock(m_mutex);
+	WritePending(m_presented);
+	m_poseCount = 0;
+	std::fill(std::begin(m_poses), std::end(m_poses), Pose{});
+	m_lastVSyncUs = 0;
+	if (m_file) {
+		fflush(m_file);
+	}
+}
+
+FrameTracer::Frame *FrameTracer::Find(uint64_t trackingFrameIndex)
+{
+	for (uint64_t number = m_presented; number > m_written; number--) {
+		Frame &frame = m_frames[(number - 1) % HISTORY_FRAMES];
+		if (frame.trackingFrameIndex == trackingFrameIndex) {
+			return &frame;
+		}
+	}
+	return nullptr;
+}
+
+void FrameTracer::WritePending(uint64_t end)
+{
+	for (; m_written < end; m_written++) {
+		Write(m_frames[m_written % HISTORY_FRAMES]);
+	}
+}
+
+void FrameTracer::Write(const Frame &frame)
+{
+	if (!Open()) {
+		return;
+	}
+
+	uint64_t begin = UINT64_MAX;
+	uint64_t end = 0;
+	for (uint64_t stamp : frame.stamps) {
+		if (stamp != 0) {
+			begin = std::min(begin, stamp);
+			end = std::max(end, stamp);
+		}
+	}
+	int lane = 0;
+	while (lane < LANES && m_laneEndUs[lane] > begin) {
+		lane++;
+	}
+	if (lane == LANES) {
+		Debug("Frame trace: no free lane. trackingFrame=%llu\n", frame.trackingFrameIndex);
+		return;
+	}
+	m_laneEndUs[lane] = end;
+
+	std::vector<Event> events;
+	AddSide(events, frame.stamps, STAGE_POSE_RECEIVED, STAGE_LAST_PACKET_SENT, SERVER_SLICES, SERVER_INSTANTS,
+		SERVER_LANE_TRACK + lane, frame.videoFrameIndex, frame.trackingFrameIndex, nullptr);
+	AddSide(events, frame.stamps, STAGE_POSE_SENT, STAGE_SUBMITTED, CLIENT_SLICES, CLIENT_INSTANTS,
+		CLIENT_LANE_TRACK + lane, frame.videoFrameIndex, frame.trackingFrameIndex, &frame.clockErrorUs);
+	// Stable: an end and the next begin at the same time stay in order.
+	std::stable_sort(events.begin(), events.end(),
+		[](const Event &a, const Event &b) { return a.timeUs < b.timeUs; });
+
+	std::string out;
+	for (auto &event : events) {
+		PutPacket(out, event.timeUs, event.data);
+	}
+	fwrite(out.data(), 1, out.size(), m_file);
+
+	uint64_t now = GetTimestampUs();
+	if (now - m_lastFlushUs >= FLUSH_INTERVAL_US) {
+		fflush(m_file);
+		m_lastFlushUs = now;
+	}
+}
+
+bool FrameTracer::Open()
+{
+	if (m_file) {
+		return true;
+	}
+	if (m_failed) {
+		return false;
+	}
+	const std::string &path = Settings::Instance().m_frameTracePath;
+	m_file = fopen(path.c_str(), "wb");
+	if (!m_file) {
+		Error("Failed to open the frame trace %s\n", path.c_str());
+		m_failed = true;
+		return false;
+	}
+	Info("Writing the frame trace to %s\n", path.c_str());
+
+	std::string out;
+	PutTrack(out, SERVER_TRACK, "Server", 0);
+	PutTrack(out, CLIENT_TRACK, "Client", 0);
+	for (int lane = 0; lane < LANES; lane++) {
+		PutTrack(out, SERVER_LANE_TRACK + lane, "Server " + std::to_string(lane), SERVER_TRACK);
+		PutTrack(out, CLIENT_LANE_TRACK + lane, "Client " + std::to_string(lane), CLIENT_TRACK);
+	}
+	fwrite(out.data(), 1, out.size(), m_file);
+	return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+
+struct VideoFrame;
+struct ClientFrameTrace;
+
+// Timeline of every frame through the server and the client, written in the Perfetto trace format
+// to Settings::m_frameTracePath (open it in ui.perfetto.dev). The frames are keyed by their
+// tracking frame index, the target timestamp of their pose, which the video headers carry to the
+// client. The client sends back the times of its stages when it submits a frame, they are moved to
+// the server clock with the filtered TimeSync offset.
+// A frame is written when the client stages arrive, or with the server stages only when a later
+// frame is submitted or it leaves the history. The frames in flight at once are spread over LANES
+// tracks, the same lane on the server and the client.
+// Does nothing unless Settings::m_enableFrameTrace.
+class FrameTracer
+{
+	static FrameTracer m_Instance;
+
+	FrameTracer() = default;
+	~FrameTracer();
+
+public:
+	enum Stage {
+		// server
+		STAGE_POSE_RECEIVED,
+		STAGE_VSYNC,
+		STAGE_PRESENT,
+		STAGE_ENCODE_START,
+		STAGE_ENCODE_END,
+		STAGE_FEC_END,
+		STAGE_FIRST_PACKET_SENT,
+		STAGE_LAST_PACKET_SENT,
+		// client
+		STAGE_POSE_SENT,
+		STAGE_FIRST_PACKET_RECEIVED,
+		STAGE_LAST_PACKET_RECEIVED,
+		STAGE_RECONSTRUCTED,
+		STAGE_DECODER_INPUT,
+		STAGE_DECODER_OUTPUT,
+		STAGE_UPLOADED,
+		STAGE_RENDER_START,
+		STAGE_RENDER_END,
+		STAGE_SUBMITTED,
+		STAGE_COUNT
+	};
+
+	static FrameTracer &Instance() {
+		return m_Instance;
+	}
+
+	static const int HISTORY_FRAMES = 64;
+	static const int LANES = 8;
+
+	void OnPoseReceived(uint64_t trackingFrameIndex);
+	void OnVSync();
+	// The game frame rendered with the pose trackingFrameIndex goes to the encoder.
+	void OnPresent(uint64_t trackingFrameIndex);
+	// Server stages after the present, the first stamp of a stage is kept.
+	void Stamp(uint64_t trackingFrameIndex, Stage stage);
+	// videoFrameIndex is 0 for a repeat marker.
+	void OnEncoded(uint64_t trackingFrameIndex, uint64_t videoFrameIndex);
+	// A packet of the client sink left the server.
+	void OnPacketSent(const VideoFrame &header);
+	// serverMinusClientUs moves the client stamps to the server clock, clockErrorUs is its error
+	// bound.
+	void OnClientTrace(const ClientFrameTrace &trace, int64_t serverMinusClientUs, uint64_t clockErrorUs);
+	// New stream, writes the pending frames.
+	void Reset();
+
+private:
+	struct Frame {
+		uint64_t number;
+		uint64_t trackingFrameIndex;
+		uint64_t videoFrameIndex;
+		uint64_t clockErrorUs;
+		// us in the server clock, 0 when the frame didn't go through the stage
+		uint64_t stamps[STAGE_COUNT];
+	};
+	struct Pose {
+		uint64_t trackingFrameIndex;
+		uint64_t receivedUs;
+	};
+
+	Frame *Find(uint64_t trackingFrameIndex);
+	// Writes the frames presented before the frame number end.
+	void WritePending(uint64_t end);
+	void Write(const Frame &frame);
+	bool Open();
+
+	std::mutex m_mutex;
+
+	Pose m_poses[HISTORY_FRAMES] = {};
+	uint64_t m_poseCount = 0;
+	uint64_t m_lastVSyncUs = 0;
+
+	// Frame number n is m_frames[n % HISTORY_FRAMES]. The frames from m_written to m_presented
+	// are not written yet.
+	Frame m_frames[HISTORY_FRAMES] = {};
+	uint64_t m_presented = 0;
+	uint64_t m_written = 0;
+
+	uint64_t m_laneEndUs[LANES] = {};
+
+	FILE *m_file = nullptr;
+	bool m_failed = false;
+	uint64_t m_lastFlushUs = 0;
+};
@@ -0,0 +1,101 @@
+#include "GazeHistory.h"
+#include <cmath>
+
+namespace {
+	TrackingVector3 Lerp(const TrackingVector3 &a, const TrackingVector3 &b, float t) {
+		return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t };
+	}
+
+	TrackingVector3 Normalize(const TrackingVector3 &v) {
+		float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+		if (length <= 0) {
+			return v;
+		}
+		return { v.x / length, v.y / length, v.z / length };
+	}
+
+	// Normalized lerp, the samples are a few ms apart so it is as good as a slerp.
+	TrackingQuat Nlerp(const TrackingQuat &a, TrackingQuat b, float t) {
+		if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0) {
+			b = { -b.x, -b.y, -b.z, -b.w };
+		}
+		TrackingQuat q = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+			a.w + (b.w - a.w) * t };
+		float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		if (length <= 0) {
+			return a;
+		}
+		return { q.x / length, q.y / length, q.z / length, q.w / length };
+	}
+
+	GazeSample Interpolate(const GazeSample &a, const GazeSample &b, uint64_t timestampNs) {
+		const float t = (float)((double)(timestampNs - a.timestampNs) / (double)(b.timestampNs - a.timestampNs));
+		GazeSample result = a;
+		result.timestampNs = timestampNs;
+		result.direction = Normalize(Lerp(a.direction, b.direction, t));
+		result.confidence = a.confidence + (b.confidence - a.confidence) * t;
+		for (int eye = 0; eye < 2; eye++) {
+			auto &out = result.eyes[eye];
+			out.valid = a.eyes[eye].valid && b.eyes[eye].valid;
+			if (out.valid) {
+				out.orientation = Nlerp(a.eyes[eye].orientation, b.eyes[eye].orientation, t);
+				out.position = Lerp(a.eyes[eye].position, b.eyes[eye].position, t);
+			} else if (b.eyes[eye].valid) {
+				out = b.eyes[eye];
+			}
+		}
+		return result;
+	}
+}
+
+void GazeHistory::OnGazeSample(const GazeSample &sample) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	// Packets can arrive out of order, the ring stays sorted.
+	if (m_count > 0 && sample.timestampNs <= At(m_count - 1).timestampNs) {
+		return;
+	}
+	m_samples[m_next] = sample;
+	m_next = (m_next + 1) % CAPACITY;
+	if (m_count < CAPACITY) {
+		m_count++;
+	}
+}
+
+std::optional<GazeSample> GazeHistory::GetGazeAt(uint64_t clientTimestampNs) const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_count == 0) {
+		return {};
+	}
+	const auto &newest = At(m_count - 1);
+	if (clientTimestampNs >= newest.timestampNs) {
+		if (clientTimestampNs - newest.timestampNs > MAX_HOLD_NS) {
+			return {};
+		}
+		return newest;
+	}
+	if (clientTimestampNs <= At(0).timestampNs) {
+		return At(0);
+	}
+	// first sample after clientTimestampNs
+	size_t low = 0, high = m_count - 1;
+	while (low < high) {
+		size_t middle = (low + high) / 2;
+		if (At(middle).timestampNs <= clientTimestampNs) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return Interpolate(At(low - 1), At(low), clientTimestampNs);
+}
+
+void GazeHistory::Reset() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_next = 0;
+	m_count = 0;
+}
+
+// index 0 is the oldest sample
+const GazeSample &GazeHistory::At(size_t index) const {
+	return m_samples[(m_next + CAPACITY - m_count + index) % CAPACITY];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <optional>
+#include <stdint.h>
+#include "ALVR-common/packet_types.h"
+
+// Gaze samples received on their own stream (GazeSample), at the eye tracker rate. The encoder
+// asks for the gaze at the timestamp of the frame it encodes, in the client clock like the
+// TrackingInfo timestamps.
+class GazeHistory
+{
+public:
+	// About two seconds at 250 Hz.
+	static constexpr size_t CAPACITY = 512;
+	// Queries past the newest sample get the newest one, as long as it isn't older than this.
+	// Gaze is not extrapolated: saccades would make the prediction worse than holding.
+	static constexpr uint64_t MAX_HOLD_NS = 50000000;
+
+	void OnGazeSample(const GazeSample &sample);
+
+	// Gaze at clientTimestampNs, interpolated between the samples around it. Empty if there is no
+	// sample, or only stale ones.
+	std::optional<GazeSample> GetGazeAt(uint64_t clientTimestampNs) const;
+
+	void Reset();
+
+private:
+	const GazeSample &At(size_t index) const;
+
+	mutable std::mutex m_mutex;
+	std::array<GazeSample, CAPACITY> m_samples = {};
+	// index of the next sample to write, m_count samples before it are valid
+	size_t m_next = 0;
+	size_t m_count = 0;
+};
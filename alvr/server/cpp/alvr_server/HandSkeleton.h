@@ -0,0 +1,38 @@
+#pragma once
+
+#include "openvr_driver.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Canned hand skeleton poses of the controllers, blended by the touch, trigger and grip state into
+// the SteamVR skeletal input.
+// The poses are constant tables in structure of arrays layout: one array per component over all
+// the bones, so that a blend is a flat loop over the bones the compiler can vectorize.
+
+static constexpr size_t HAND_BONE_COUNT = 31;
+
+struct HandBonePoses {
+    float px[HAND_BONE_COUNT], py[HAND_BONE_COUNT], pz[HAND_BONE_COUNT];
+    float qw[HAND_BONE_COUNT], qx[HAND_BONE_COUNT], qy[HAND_BONE_COUNT], qz[HAND_BONE_COUNT];
+};
+
+// Root and wrist, the other bones at rest.
+const HandBonePoses &GetHandBasePose(bool isLeftHand);
+// Thumb pose for the touched buttons: Y/B touch first, then X/A then the joystick.
+const HandBonePoses &GetThumbPose(bool withController, bool isLeftHand, uint64_t buttons);
+// Index to pinky pose for the trigger click or touch in buttons.
+const HandBonePoses &GetTriggerPose(bool withController, bool isLeftHand, uint64_t buttons);
+const HandBonePoses &GetGripPose(bool withController, bool isLeftHand);
+
+// Blends the bones in [first, last) of a and b into out: lerp for the positions, shortest path
+// slerp for the orientations. out can be a or b.
+void BlendHandBones(const HandBonePoses &a,
+                    const HandBonePoses &b,
+                    float t,
+                    size_t first,
+                    size_t last,
+                    HandBonePoses &out);
+
+vr::HmdVector4_t GetHandBonePosition(const HandBonePoses &poses, size_t bone);
+vr::HmdQuaternionf_t GetHandBoneOrientation(const HandBonePoses &poses, size_t bone);
+void HandBonesToTransforms(const HandBonePoses &poses, vr::VRBoneTransform_t out[]);
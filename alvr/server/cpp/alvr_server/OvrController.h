@@ -51,7 +51,17 @@ class OvrController : public TrackedDevice, public vr::ITrackedDeviceServerDrive
 
     float *m_poseTimeOffset;
 
+    // SteamVR keeps the value of the input components, they are only updated when the value
+    // changes.
+    void UpdateBooleanInput(int input, bool value);
+    void UpdateScalarInput(int input, float value);
+
     vr::VRInputComponentHandle_t m_handles[ALVR_INPUT_COUNT];
+    struct InputValue {
+        bool sent;
+        float value;
+    };
+    InputValue m_inputValues[ALVR_INPUT_COUNT] = {};
     vr::VRInputComponentHandle_t m_compHaptic;
     vr::VRInputComponentHandle_t m_compSkeleton = vr::k_ulInvalidInputComponentHandle;
     enum HandSkeletonBone : size_t {
@@ -376,6 +376,12 @@ void OvrHmd::OnPoseUpdated(TrackingInfo info) {
     }
 }
 
+void OvrHmd::OnClientIdleTime(uint32_t idleTimeUs) {
+    if (m_VSyncThread && m_Listener) {
+        m_VSyncThread->OnClientIdleTime(idleTimeUs, m_Listener->m_framePacer.GetTargetIdleTime());
+    }
+}
+
 void OvrHmd::StartStreaming() {
     if (m_streamComponentsInitialized) {
         return;
@@ -383,6 +389,7 @@ void OvrHmd::StartStreaming() {
 
     // create listener
     m_Listener.reset(new ClientConnection());
+    m_Listener->m_framePacer.SetPhaseControlled(m_VSyncThread != nullptr);
 
     // Spin up a separate thread to handle the overlapped encoding/transmit step.
     if (IsHMD()) {
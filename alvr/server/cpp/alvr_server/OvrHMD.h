@@ -40,6 +40,9 @@ class OvrHmd : public TrackedDevice,
 
     void OnPoseUpdated(TrackingInfo info);
 
+    // Client timing feedback for the virtual vsync, see VSyncThread.
+    void OnClientIdleTime(uint32_t idleTimeUs);
+
     void StartStreaming();
 
     void OnStreamStart();
@@ -0,0 +1,103 @@
+#include "ResolutionController.h"
+
+#include <algorithm>
+
+#include "Logger.h"
+#include "Settings.h"
+#include "Utils.h"
+
+ResolutionController::ResolutionController()
+{
+	auto &settings = Settings::Instance();
+
+	m_enabled = settings.m_enableDynamicResolution;
+	m_framePeriodUs = 1000000 / std::max(settings.m_refreshRate, 1);
+	m_bitrateBudgetMbs = settings.m_enableAdaptiveBitrate ? settings.m_adaptiveBitrateMaximum : settings.mEncodeBitrateMBs;
+	m_loadHigh = settings.m_dynamicResolutionLoadHigh;
+	m_loadLow = settings.m_dynamicResolutionLoadLow;
+	m_bitrateLow = settings.m_dynamicResolutionBitrateLow;
+	m_switchIntervalUs = settings.m_dynamicResolutionIntervalMs * 1000;
+
+	m_levels.push_back({ settings.m_renderWidth, settings.m_renderHeight });
+	if (!m_enabled) {
+		return;
+	}
+
+	uint32_t levelCount = std::clamp(settings.m_dynamicResolutionLevels, 2u, 4u);
+	float minScale = std::clamp(settings.m_dynamicResolutionMinScale, 0.25f, 1.f);
+	for (uint32_t i = 1; i < levelCount; i++) {
+		float scale = 1.f - (1.f - minScale) * i / (levelCount - 1);
+		Level level = MakeLevel(scale);
+		if (level.width != m_levels.back().width || level.height != m_levels.back().height) {
+			m_levels.push_back(level);
+		}
+	}
+	for (size_t i = 0; i < m_levels.size(); i++) {
+		Info("Dynamic resolution level %zu: %ux%u\n", i, m_levels[i].width, m_levels[i].height);
+	}
+}
+
+ResolutionController::Level ResolutionController::MakeLevel(float scale)
+{
+	auto &settings = Settings::Instance();
+
+	// The frame holds both eyes side by side: keep each eye 16 pixel aligned for the encoders.
+	uint32_t width = (uint32_t)(settings.m_renderWidth * scale) & ~31u;
+	uint32_t height = (uint32_t)(settings.m_renderHeight * scale) & ~15u;
+	return { std::max(width, 32u), std::max(height, 16u) };
+}
+
+void ResolutionController::LimitLevels(size_t levelCount)
+{
+	levelCount = std::max(levelCount, (size_t)1);
+	if (levelCount < m_levels.size()) {
+		m_levels.resize(levelCount);
+	}
+	m_currentLevel = std::min(m_currentLevel, m_levels.size() - 1);
+}
+
+size_t ResolutionController::Update(uint64_t encodeLatencyUs, uint64_t bitrateMbs)
+{
+	if (!m_enabled || m_levels.size() < 2) {
+		return m_currentLevel;
+	}
+
+	if (m_encodeLatencyAverage == 0) {
+		m_encodeLatencyAverage = encodeLatencyUs;
+	} else {
+		m_encodeLatencyAverage = encodeLatencyUs * 0.1 + m_encodeLatencyAverage * 0.9;
+	}
+
+	uint64_t now = GetTimestampUs();
+	if (now - m_lastSwitchTime < m_switchIntervalUs) {
+		return m_currentLevel;
+	}
+
+	bool bitrateCollapsed = bitrateMbs < m_bitrateBudgetMbs * m_bitrateLow;
+	size_t level = m_currentLevel;
+
+	if (level + 1 < m_levels.size() && (m_encodeLatencyAverage > m_framePeriodUs * m_loadHigh || bitrateCollapsed)) {
+		level++;
+	} else if (level > 0 && !bitrateCollapsed) {
+		// Encode time scales roughly with the pixel count: only step up if the larger level
+		// is expected to stay below the high load threshold.
+		const Level &current = m_levels[level];
+		const Level &larger = m_levels[level - 1];
+		double pixelRatio = (double)larger.width * larger.height / ((double)current.width * current.height);
+		if (m_encodeLatencyAverage < m_framePeriodUs * m_loadLow &&
+			m_encodeLatencyAverage * pixelRatio < m_framePeriodUs * m_loadHigh) {
+			level--;
+		}
+	}
+
+	if (level != m_currentLevel) {
+		Info("Dynamic resolution: level %zu -> %zu (%ux%u), encode %.0fus, bitrate %lluMbps\n",
+			m_currentLevel, level, m_levels[level].width, m_levels[level].height,
+			m_encodeLatencyAverage, (unsigned long long)bitrateMbs);
+		m_currentLevel = level;
+		m_lastSwitchTime = now;
+		// The new encoder starts cold, don't judge it on the previous level history.
+		m_encodeLatencyAverage = 0;
+	}
+	return m_currentLevel;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Picks the encode resolution among a fixed set of levels, prepared once at stream start.
+// Level 0 is the full render resolution, higher levels are progressively downscaled.
+// The controller steps down when the encoder gets close to the frame period or when the
+// adaptive bitrate collapses, and steps back up when the encoder has enough headroom.
+class ResolutionController
+{
+public:
+	struct Level {
+		uint32_t width;
+		uint32_t height;
+	};
+
+	ResolutionController();
+
+	const std::vector<Level> &GetLevels() const { return m_levels; }
+	size_t GetCurrentLevel() const { return m_currentLevel; }
+
+	// Drop the levels above levelCount, e.g. when the encoder for them could not be created.
+	void LimitLevels(size_t levelCount);
+
+	// Feed the encode time of the last frame and the current bitrate (Mbps).
+	// Returns the level that should be used for the next frame.
+	size_t Update(uint64_t encodeLatencyUs, uint64_t bitrateMbs);
+
+private:
+	static Level MakeLevel(float scale);
+
+	std::vector<Level> m_levels;
+	size_t m_currentLevel = 0;
+
+	bool m_enabled;
+	uint64_t m_framePeriodUs;
+	uint64_t m_bitrateBudgetMbs;
+	float m_loadHigh;
+	float m_loadLow;
+	float m_bitrateLow;
+	uint64_t m_switchIntervalUs;
+
+	double m_encodeLatencyAverage = 0;
+	uint64_t m_lastSwitchTime = 0;
+};
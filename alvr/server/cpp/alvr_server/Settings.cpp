@@ -100,8 +100,24 @@ void Settings::Load()
 		m_adaptiveBitrateUpRate = (int)config.get("bitrate_up_rate").get<int64_t>();
 		m_adaptiveBitrateDownRate = (int)config.get("bitrate_down_rate").get<int64_t>();
 		m_adaptiveBitrateLightLoadThreshold = config.get("bitrate_light_load_threshold").get<double>();
+		m_enableDynamicResolution = config.get("enable_dynamic_resolution").get<bool>();
+		m_dynamicResolutionLevels = (uint32_t)config.get("dynamic_resolution_levels").get<int64_t>();
+		m_dynamicResolutionMinScale = (float)config.get("dynamic_resolution_min_scale").get<double>();
+		m_dynamicResolutionLoadHigh = (float)config.get("dynamic_resolution_load_high").get<double>();
+		m_dynamicResolutionLoadLow = (float)config.get("dynamic_resolution_load_low").get<double>();
+		m_dynamicResolutionBitrateLow = (float)config.get("dynamic_resolution_bitrate_low").get<double>();
+		m_dynamicResolutionIntervalMs = (uint64_t)config.get("dynamic_resolution_interval_ms").get<int64_t>();
+		m_enableQualityProbe = config.get("enable_quality_probe").get<bool>();
+		m_qualityProbeInterval = (uint32_t)config.get("quality_probe_interval").get<int64_t>();
+		m_qualityProbeSampleStep = (uint32_t)config.get("quality_probe_sample_step").get<int64_t>();
+		m_qualityProbeGazeRadius = (float)config.get("quality_probe_gaze_radius").get<double>();
+		m_threadPolicy.realtime = config.get("enable_thread_policy").get<bool>();
+		m_threadPolicy.realtimePriority = (int)config.get("thread_realtime_priority").get<int64_t>();
+		m_threadPolicy.deadline = config.get("thread_deadline_scheduler").get<bool>();
+		m_threadPolicy.cpuMask = thread_policy::ParseCpuList(config.get("thread_cpu_affinity").get<std::string>());
 		m_use10bitEncoder = config.get("use_10bit_encoder").get<bool>();
 		m_swThreadCount = (int32_t)config.get("sw_thread_count").get<int64_t>();
+		m_skipStaticFrames = config.get("skip_static_frames").get<bool>();
 
 		m_controllerTrackingSystemName = config.get("controllers_tracking_system_name").get<std::string>();
 		m_controllerManufacturerName = config.get("controllers_manufacturer_name").get<std::string>();
@@ -166,6 +182,19 @@ void Settings::Load()
 		m_sharpening = (float)config.get("sharpening").get<double>();
 
 		m_enableFec = config.get("enable_fec").get<bool>();
+		m_fecCodec = (int32_t)config.get("fec_codec").get<int64_t>();
+		m_enableUnequalErrorProtection = config.get("enable_unequal_error_protection").get<bool>();
+		m_uepCriticalFecPercentage = (uint32_t)config.get("uep_critical_fec_percentage").get<int64_t>();
+		m_uepPeripheralFecPercentage = (uint32_t)config.get("uep_peripheral_fec_percentage").get<int64_t>();
+		m_uepFovealBand = (float)config.get("uep_foveal_band").get<double>();
+		m_uepInterleaveGroups = config.get("uep_interleave_groups").get<bool>();
+		m_enableVideoPacing = config.get("enable_video_pacing").get<bool>();
+		m_videoPacingFrameBudget = (float)config.get("video_pacing_frame_budget").get<double>();
+		m_enableVideoNack = config.get("enable_video_nack").get<bool>();
+		m_videoNackHistoryFrames = (uint32_t)config.get("video_nack_history_frames").get<int64_t>();
+		m_videoNackDeadline = (float)config.get("video_nack_deadline").get<double>();
+		m_enableFrameTrace = config.get("enable_frame_trace").get<bool>();
+		m_frameTracePath = config.get("frame_trace_path").get<std::string>();
 
 		m_enableLinuxVulkanAsync = config.get("linux_async_reprojection").get<bool>();
 		
@@ -2,6 +2,7 @@
 
 #include <string>
 #include "ALVR-common/packet_types.h"
+#include "ALVR-common/thread_policy.h"
 
 class Settings
 {
@@ -73,8 +74,22 @@ public:
 	uint64_t m_adaptiveBitrateUpRate;
 	uint64_t m_adaptiveBitrateDownRate;
 	float m_adaptiveBitrateLightLoadThreshold;
+	bool m_enableDynamicResolution;
+	uint32_t m_dynamicResolutionLevels;
+	float m_dynamicResolutionMinScale;
+	float m_dynamicResolutionLoadHigh;
+	float m_dynamicResolutionLoadLow;
+	float m_dynamicResolutionBitrateLow;
+	uint64_t m_dynamicResolutionIntervalMs;
+	bool m_enableQualityProbe;
+	uint32_t m_qualityProbeInterval;
+	uint32_t m_qualityProbeSampleStep;
+	float m_qualityProbeGazeRadius;
+	// Encoder and vsync threads, see ALVR-common/thread_policy.h
+	thread_policy::Policy m_threadPolicy;
 	bool m_use10bitEncoder;
 	uint32_t m_swThreadCount;
+	bool m_skipStaticFrames;
 
 	// Controller configs
 	std::string m_controllerTrackingSystemName;
@@ -127,6 +142,19 @@ public:
 	bool m_useHeadsetTrackingSystem = false;
 	
 	bool m_enableFec;
+	int m_fecCodec;
+	bool m_enableUnequalErrorProtection;
+	uint32_t m_uepCriticalFecPercentage;
+	uint32_t m_uepPeripheralFecPercentage;
+	float m_uepFovealBand;
+	bool m_uepInterleaveGroups;
+	bool m_enableVideoPacing;
+	float m_videoPacingFrameBudget;
+	bool m_enableVideoNack;
+	uint32_t m_videoNackHistoryFrames;
+	float m_videoNackDeadline;
+	bool m_enableFrameTrace;
+	std::string m_frameTracePath;
 
 	bool m_enableLinuxVulkanAsync;
 };
@@ -36,13 +36,27 @@ public:
 		m_encodeLatencyMaxPrev = 0;
 
 		m_sendLatency = 0;
+
+		m_qualitySampleCount = 0;
+		m_psnrTotal = 0;
+		m_foveatedPsnrTotal = 0;
+		m_ssimTotal = 0;
+		m_foveatedSsimTotal = 0;
+		m_psnrPrev = 0;
+		m_foveatedPsnrPrev = 0;
+		m_ssimPrev = 0;
+		m_foveatedSsimPrev = 0;
 	}
 
 	void CountPacket(int bytes) {
+		CountPackets(1, bytes);
+	}
+
+	void CountPackets(uint64_t packets, uint64_t bytes) {
 		CheckAndResetSecond();
 
-		m_packetsSentTotal++;
-		m_packetsSentInSecond++;
+		m_packetsSentTotal += packets;
+		m_packetsSentInSecond += packets;
 		m_bitsSentTotal += bytes * 8;
 		m_bitsSentInSecond += bytes * 8;
 	}
@@ -58,6 +72,16 @@ public:
 		m_encodeSampleCount++;
 	}
 
+	void QualityOutput(float psnr, float foveatedPsnr, float ssim, float foveatedSsim) {
+		CheckAndResetSecond();
+
+		m_psnrTotal += psnr;
+		m_foveatedPsnrTotal += foveatedPsnr;
+		m_ssimTotal += ssim;
+		m_foveatedSsimTotal += foveatedSsim;
+		m_qualitySampleCount++;
+	}
+
 	void NetworkTotal(uint64_t latencyUs) {
 		if (latencyUs > 5e5)
 			latencyUs = 5e5;
@@ -105,6 +129,19 @@ public:
 	uint64_t GetSendLatencyAverage() {
 		return m_sendLatency;
 	}
+	// Quality probe scores averaged over the previous second, 0 if the probe is off
+	float GetPsnr() {
+		return m_psnrPrev;
+	}
+	float GetFoveatedPsnr() {
+		return m_foveatedPsnrPrev;
+	}
+	float GetSsim() {
+		return m_ssimPrev;
+	}
+	float GetFoveatedSsim() {
+		return m_foveatedSsimPrev;
+	}
 
 	bool CheckBitrateUpdated() {
 		if (m_enableAdaptiveBitrate) {
@@ -171,6 +208,19 @@ private:
 		m_encodeLatencyMin = UINT64_MAX;
 		m_encodeLatencyMax = 0;
 
+		// keep the last scores if the probe had nothing to measure (static frames)
+		if (m_qualitySampleCount > 0) {
+			m_psnrPrev = m_psnrTotal / m_qualitySampleCount;
+			m_foveatedPsnrPrev = m_foveatedPsnrTotal / m_qualitySampleCount;
+			m_ssimPrev = m_ssimTotal / m_qualitySampleCount;
+			m_foveatedSsimPrev = m_foveatedSsimTotal / m_qualitySampleCount;
+		}
+		m_psnrTotal = 0;
+		m_foveatedPsnrTotal = 0;
+		m_ssimTotal = 0;
+		m_foveatedSsimTotal = 0;
+		m_qualitySampleCount = 0;
+
 		if (m_adaptiveBitrateUseFrametime) {
 			if (m_framesPrevious > 0) {
 				m_adaptiveBitrateTarget = 1e6 / m_framesPrevious + m_adaptiveBitrateTargetOffset;
@@ -212,6 +262,16 @@ private:
 	
 	uint64_t m_sendLatency = 0;
 
+	uint32_t m_qualitySampleCount;
+	float m_psnrTotal;
+	float m_foveatedPsnrTotal;
+	float m_ssimTotal;
+	float m_foveatedSsimTotal;
+	float m_psnrPrev;
+	float m_foveatedPsnrPrev;
+	float m_ssimPrev;
+	float m_foveatedSsimPrev;
+
 	uint64_t m_bitrate = Settings::Instance().mEncodeBitrateMBs;
 	uint64_t m_bitrateUpdated = Settings::Instance().mEncodeBitrateMBs;
 
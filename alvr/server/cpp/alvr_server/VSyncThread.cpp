@@ -1,36 +1,26 @@
 #include "VSyncThread.h"
 
-#include <chrono>
-#include <thread>
-
 #include "Utils.h"
 #include "Logger.h"
+#include "Settings.h"
+#include "FrameTracer.h"
 
 VSyncThread::VSyncThread(int refreshRate)
 	: m_bExit(false)
-	, m_refreshRate(refreshRate) {}
+	, m_vsync(refreshRate) {
+	auto policy = Settings::Instance().m_threadPolicy;
+	// A late vsync delays the whole frame, it goes before the encoder.
+	policy.realtimePriority += 1;
+	policy.deadlineRuntimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(VSyncGenerator::SPIN_DURATION).count() + 200000;
+	policy.deadlinePeriodNs = 1000000000 / std::max(refreshRate, 1);
+	SetThreadPolicy("alvr-vsync", policy);
+}
 
-// Trigger VSync if elapsed time from previous VSync is larger than 30ms.
+// Trigger VSync events on the phase locked grid of m_vsync.
 void VSyncThread::Run() {
-	m_PreviousVsync = 0;
-
 	while (!m_bExit) {
-		uint64_t current = GetTimestampUs();
-		uint64_t interval = 1000 * 1000 / m_refreshRate;
-
-		if (m_PreviousVsync + interval > current) {
-			uint64_t sleepTimeMs = (m_PreviousVsync + interval - current) / 1000;
-
-			if (sleepTimeMs > 0) {
-				Debug("Sleep %llu ms for next VSync.\n", sleepTimeMs);
-				std::this_thread::sleep_for(std::chrono::milliseconds(sleepTimeMs));
-			}
-
-			m_PreviousVsync += interval;
-		}
-		else {
-			m_PreviousVsync = current;
-		}
+		m_vsync.WaitNextVSync();
+		FrameTracer::Instance().OnVSync();
 		Debug("Generate VSync Event by VSyncThread\n");
 		vr::VRServerDriverHost()->VsyncEvent(0);
 	}
@@ -41,5 +31,9 @@ void VSyncThread::Shutdown() {
 }
 
 void VSyncThread::SetRefreshRate(int refreshRate) {
-	m_refreshRate = refreshRate;
+	m_vsync.SetRefreshRate(refreshRate);
+}
+
+void VSyncThread::OnClientIdleTime(uint32_t idleTimeUs, uint64_t targetIdleTimeUs) {
+	m_vsync.OnClientIdleTime(idleTimeUs, (int64_t)targetIdleTimeUs);
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "shared/threadtools.h"
+#include "shared/vsync_generator.h"
 
 // VSync Event Thread
 
@@ -15,8 +16,11 @@ public:
 
 	void SetRefreshRate(int refreshRate);
 
+	// Client timing feedback, see VSyncGenerator::OnClientIdleTime.
+	// targetIdleTimeUs is the margin for the network and decoder jitter, see FramePacer.
+	void OnClientIdleTime(uint32_t idleTimeUs, uint64_t targetIdleTimeUs);
+
 private:
 	bool m_bExit;
-	uint64_t m_PreviousVsync;
-	int m_refreshRate = 60;
+	VSyncGenerator m_vsync;
 };
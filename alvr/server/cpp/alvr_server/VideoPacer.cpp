@@ -0,0 +1,161 @@
+#include "VideoPacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "FrameTracer.h"
+#include "Logger.h"
+#include "Settings.h"
+#include "bindings.h"
+
+VideoPacer::VideoPacer() {
+	SetThreadPolicy("alvr-pacer", Settings::Instance().m_threadPolicy);
+}
+
+VideoPacer::~VideoPacer() {
+	Shutdown();
+	Join();
+}
+
+void VideoPacer::Shutdown() {
+	std::unique_lock lock(m_mutex);
+	m_exit = true;
+	m_condition.notify_all();
+}
+
+void VideoPacer::Queue(uint32_t sinkId, const VideoFrame &header, std::shared_ptr<const uint8_t> payload, int len) {
+	Packet packet;
+	packet.sinkId = sinkId;
+	packet.header = header;
+	packet.payload = std::move(payload);
+	packet.len = len;
+	m_stagingBytes += sizeof(VideoFrame) + len;
+	m_staging.push_back(std::move(packet));
+}
+
+void VideoPacer::CommitFrame(uint64_t bitrateMbs) {
+	if (m_staging.empty()) {
+		return;
+	}
+
+	Frame frame;
+	frame.committed = Clock::now();
+	if (m_stagingBytes <= BURST_BYTES) {
+		frame.deadline = frame.committed;
+	} else {
+		auto budgetUs = (int64_t)(Settings::Instance().m_videoPacingFrameBudget * 1e6 /
+			std::max(Settings::Instance().m_refreshRate, 1));
+		frame.deadline = frame.committed + std::chrono::microseconds(budgetUs);
+	}
+	frame.remainingBytes = m_stagingBytes;
+	frame.remainingPackets = m_staging.size();
+
+	{
+		std::unique_lock lock(m_mutex);
+		m_bitrateBytesPerUs = bitrateMbs / 8.;
+		for (auto &packet : m_staging) {
+			m_packets.push_back(std::move(packet));
+		}
+		m_frames.push_back(frame);
+		m_condition.notify_all();
+	}
+
+	m_staging.clear();
+	m_stagingBytes = 0;
+}
+
+void VideoPacer::QueueRetransmission(uint32_t sinkId, const VideoFrame &header,
+	std::shared_ptr<const uint8_t> payload, int len) {
+	Packet packet;
+	packet.sinkId = sinkId;
+	packet.header = header;
+	packet.payload = std::move(payload);
+	packet.len = len;
+
+	std::unique_lock lock(m_mutex);
+	m_retransmissions.push_back(std::move(packet));
+	m_condition.notify_all();
+}
+
+double VideoPacer::GetRate(Clock::time_point now) const {
+	double rate = m_bitrateBytesPerUs * BITRATE_HEADROOM;
+	size_t bytes = 0;
+	for (auto &frame : m_frames) {
+		bytes += frame.remainingBytes;
+		double leftUs = (double)std::chrono::duration_cast<std::chrono::microseconds>(frame.deadline - now).count();
+		// past the deadline, send everything up to this frame at once
+		rate = std::max(rate, bytes / std::max(leftUs, 1.));
+	}
+	return rate;
+}
+
+void VideoPacer::Run() {
+	std::unique_lock lock(m_mutex);
+	auto lastRefill = Clock::now();
+	while (!m_exit) {
+		if (m_packets.empty() && m_retransmissions.empty()) {
+			m_condition.wait(lock, [&] { return m_exit || !m_packets.empty() || !m_retransmissions.empty(); });
+			// the bucket filled up while idle
+			m_tokens = BURST_BYTES;
+			lastRefill = Clock::now();
+			continue;
+		}
+
+		auto now = Clock::now();
+		double rate = GetRate(now);
+		double elapsedUs = (double)std::chrono::duration_cast<std::chrono::microseconds>(now - lastRefill).count();
+		m_tokens = std::min((double)BURST_BYTES, m_tokens + rate * elapsedUs);
+		lastRefill = now;
+
+		// The bucket can go below zero: the packets are not split, a large one (FEC disabled)
+		// is paid for afterwards.
+		if (m_tokens <= 0) {
+			auto waitUs = (int64_t)std::ceil(-m_tokens / std::max(rate, 1e-3));
+			m_condition.wait_for(lock, std::chrono::microseconds(std::max(waitUs, (int64_t)1)));
+			continue;
+		}
+
+		Packet packet;
+		if (!m_retransmissions.empty()) {
+			// not part of the queued frames
+			packet = std::move(m_retransmissions.front());
+			m_retransmissions.pop_front();
+			m_tokens -= sizeof(VideoFrame) + packet.len;
+		} else {
+			packet = std::move(m_packets.front());
+			m_packets.pop_front();
+			size_t size = sizeof(VideoFrame) + packet.len;
+			m_tokens -= size;
+
+			Frame &frame = m_frames.front();
+			frame.remainingBytes -= std::min(size, frame.remainingBytes);
+			frame.remainingPackets--;
+			if (frame.remainingPackets == 0) {
+				uint64_t delayUs = std::chrono::duration_cast<std::chrono::microseconds>(now - frame.committed).count();
+				m_delayTotalUs += delayUs;
+				m_delayMaxUs = std::max(m_delayMaxUs, delayUs);
+				m_delayCount++;
+				m_frames.pop_front();
+			}
+		}
+
+		lock.unlock();
+		uint8_t empty = 0;
+		// only read
+		VideoSend(packet.sinkId, packet.header, packet.payload ? const_cast<uint8_t *>(packet.payload.get()) : &empty,
+			packet.len);
+		if (packet.sinkId == CLIENT_VIDEO_SINK && !packet.header.retransmitted) {
+			FrameTracer::Instance().OnPacketSent(packet.header);
+		}
+		lock.lock();
+	}
+}
+
+void VideoPacer::TakeDelayStats(uint64_t &averageUs, uint64_t &maxUs) {
+	std::unique_lock lock(m_mutex);
+	averageUs = m_delayCount > 0 ? m_delayTotalUs / m_delayCount : 0;
+	maxUs = m_delayMaxUs;
+	m_delayTotalUs = 0;
+	m_delayMaxUs = 0;
+	m_delayCount = 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+#include "ALVR-common/packet_types.h"
+#include "shared/threadtools.h"
+
+// Spreads the video packets of a frame over part of the frame interval. FEC gives all the packets
+// of a frame at once, a large frame sent in one burst overflows the access point queues and loses
+// the packets FEC then has to repair.
+// The packets of all the sinks go out in order through a token bucket. Its rate is the bitrate
+// target with some headroom, raised when the queued frames wouldn't be sent by their deadline:
+// the frame budget after they were queued. A frame which fits in the bucket (a small P-frame or
+// a repeat marker) is urgent, it goes out at once.
+class VideoPacer : public CThread
+{
+public:
+	// Bucket depth, and the largest frame sent in one burst.
+	static constexpr size_t BURST_BYTES = 8 * (sizeof(VideoFrame) + ALVR_MAX_VIDEO_BUFFER_SIZE);
+	// Drain faster than the encoder produces on average, a backlog only adds latency.
+	static constexpr double BITRATE_HEADROOM = 1.5;
+
+	VideoPacer();
+	~VideoPacer();
+
+	void Run() override;
+	void Shutdown();
+
+	// Queues a packet of the current frame, it isn't sent before CommitFrame(). Called by the
+	// encoder thread only. The payload isn't copied: it points into the frame or its parity, which
+	// it keeps until the packet is sent. Null for an empty packet.
+	void Queue(uint32_t sinkId, const VideoFrame &header, std::shared_ptr<const uint8_t> payload, int len);
+	// The current frame is complete, for every sink. bitrateMbs is the current bitrate target.
+	void CommitFrame(uint64_t bitrateMbs);
+	// Queues a packet sent again on a NACK, ahead of the queued frames: the rest of its frame is
+	// already sent and its deadline is close. It still takes its tokens. Called from any thread.
+	void QueueRetransmission(uint32_t sinkId, const VideoFrame &header, std::shared_ptr<const uint8_t> payload,
+		int len);
+
+	// Time from CommitFrame() to the last packet of the frame sent, in us, over the frames sent
+	// since the previous call.
+	void TakeDelayStats(uint64_t &averageUs, uint64_t &maxUs);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Packet {
+		uint32_t sinkId;
+		VideoFrame header;
+		std::shared_ptr<const uint8_t> payload;
+		int len;
+	};
+	struct Frame {
+		Clock::time_point committed;
+		Clock::time_point deadline;
+		size_t remainingBytes;
+		size_t remainingPackets;
+	};
+
+	// Bytes per us the queue has to be sent at, at now.
+	double GetRate(Clock::time_point now) const;
+
+	std::vector<Packet> m_staging;
+	size_t m_stagingBytes = 0;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_exit = false;
+	std::deque<Packet> m_packets;
+	std::deque<Packet> m_retransmissions;
+	std::deque<Frame> m_frames;
+	double m_bitrateBytesPerUs = 0;
+	double m_tokens = BURST_BYTES;
+
+	uint64_t m_delayTotalUs = 0;
+	uint64_t m_delayMaxUs = 0;
+	uint64_t m_delayCount = 0;
+};
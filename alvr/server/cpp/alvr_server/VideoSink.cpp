@@ -0,0 +1,342 @@
+#include "VideoSink.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#include "ALVR-common/packet_types.h"
+#include "ALVR-common/fec_cauchy16.h"
+#include "Statistics.h"
+#include "Logger.h"
+#include "bindings.h"
+#include "Utils.h"
+#include "Settings.h"
+#include "FecGroups.h"
+#include "VideoPacer.h"
+#include "FrameTracer.h"
+
+VideoSink::VideoSink(uint32_t id, std::shared_ptr<Statistics> statistics, std::shared_ptr<VideoPacer> pacer)
+	: m_id(id), m_statistics(std::move(statistics)), m_pacer(std::move(pacer)) {
+}
+
+void VideoSink::Send(const VideoFrame &header, std::shared_ptr<const uint8_t> payload, int len) {
+	if (m_pacer) {
+		m_pacer->Queue(m_id, header, std::move(payload), len);
+	} else {
+		// only read
+		uint8_t empty = 0;
+		VideoSend(m_id, header, payload ? const_cast<uint8_t *>(payload.get()) : &empty, len);
+		if (m_id == CLIENT_VIDEO_SINK) {
+			FrameTracer::Instance().OnPacketSent(header);
+		}
+	}
+	m_statistics->CountPacket(sizeof(VideoFrame) + len);
+}
+
+void VideoSink::CountRetransmissions() {
+	uint64_t packets = m_retransmittedPackets.exchange(0);
+	uint64_t bytes = m_retransmittedBytes.exchange(0);
+	if (packets > 0) {
+		m_statistics->CountPackets(packets, bytes);
+	}
+}
+
+namespace {
+
+struct FecPacket {
+	int fecIndex;
+	const uint8_t *payload;
+	int len;
+};
+
+// A FEC group of the frame with its parity, the packets in shard-major order: packet j of shard i
+// has fecIndex i * shardPackets + j. The client reconstructs each packet row j across the shards
+// separately, so consecutive packets already fall in different rows.
+struct EncodedFecGroup {
+	FecGroup group;
+	int shardPackets;
+	int dataShards;
+	int parityShards;
+	// Copy of the last data shard when the group doesn't fill it.
+	std::vector<uint8_t> paddedShard;
+	std::vector<uint8_t> parity;
+	std::vector<FecPacket> packets;
+};
+
+void EncodeFecGroup(uint8_t *frameBuf, const FecGroup &group, int codec, EncodedFecGroup &encoded) {
+	uint8_t *buf = frameBuf + group.offset;
+	int len = group.size;
+	int fecPercentage = group.fecPercentage;
+
+	int shardPackets = codec == ALVR_FEC_CODEC_CAUCHY_GF16 ? CalculateFECCauchyShardPackets(len, fecPercentage)
+		: CalculateFECShardPackets(len, fecPercentage);
+
+	int blockSize = shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+
+	int dataShards = (len + blockSize - 1) / blockSize;
+	int totalParityShards = CalculateParityShards(dataShards, fecPercentage);
+	int totalShards = dataShards + totalParityShards;
+
+	assert(totalShards <= (codec == ALVR_FEC_CODEC_CAUCHY_GF16 ? (int)fec_cauchy16::SHARDS_MAX : DATA_SHARDS_MAX));
+
+	encoded.group = group;
+	encoded.shardPackets = shardPackets;
+	encoded.dataShards = dataShards;
+	encoded.parityShards = totalParityShards;
+
+	std::vector<uint8_t *> shards(totalShards);
+
+	for (int i = 0; i < dataShards; i++) {
+		shards[i] = buf + i * blockSize;
+	}
+	if (len % blockSize != 0) {
+		// Padding
+		encoded.paddedShard.assign(blockSize, 0);
+		memcpy(encoded.paddedShard.data(), buf + (dataShards - 1) * blockSize, len % blockSize);
+		shards[dataShards - 1] = encoded.paddedShard.data();
+	}
+	encoded.parity.resize((size_t)totalParityShards * blockSize);
+	for (int i = 0; i < totalParityShards; i++) {
+		shards[dataShards + i] = encoded.parity.data() + i * blockSize;
+	}
+
+	if (codec == ALVR_FEC_CODEC_CAUCHY_GF16) {
+		// Packet row by packet row, as the client decodes
+		std::vector<uint8_t *> row(totalShards);
+		for (int j = 0; j < shardPackets; j++) {
+			for (int i = 0; i < totalShards; i++) {
+				row[i] = shards[i] + j * ALVR_MAX_VIDEO_BUFFER_SIZE;
+			}
+			fec_cauchy16::Encode(&row[0], dataShards, &row[dataShards], totalParityShards, ALVR_MAX_VIDEO_BUFFER_SIZE);
+		}
+	} else {
+		reed_solomon *rs = reed_solomon_new(dataShards, totalParityShards);
+		int ret = reed_solomon_encode(rs, &shards[0], totalShards, blockSize);
+		assert(ret == 0);
+		reed_solomon_release(rs);
+	}
+
+	// The padding at the end of the last data shard isn't sent.
+	int dataRemain = len;
+	for (int i = 0; i < dataShards; i++) {
+		for (int j = 0; j < shardPackets && dataRemain > 0; j++) {
+			int copyLength = std::min(ALVR_MAX_VIDEO_BUFFER_SIZE, dataRemain);
+			encoded.packets.push_back({ i * shardPackets + j, shards[i] + j * ALVR_MAX_VIDEO_BUFFER_SIZE, copyLength });
+			dataRemain -= ALVR_MAX_VIDEO_BUFFER_SIZE;
+		}
+	}
+	for (int i = dataShards; i < totalShards; i++) {
+		for (int j = 0; j < shardPackets; j++) {
+			encoded.packets.push_back({ i * shardPackets + j, shards[i] + j * ALVR_MAX_VIDEO_BUFFER_SIZE, ALVR_MAX_VIDEO_BUFFER_SIZE });
+		}
+	}
+}
+
+}
+
+// A frame with the FEC of this sink. The payloads point into the frame, or the padded shards and the
+// parity of the groups. The packets queued in the pacer hold it, and the history for the
+// retransmissions.
+struct VideoSink::SentFrame {
+	struct Packet {
+		VideoFrame header;
+		const uint8_t *payload;
+		int len;
+	};
+
+	uint64_t videoFrameIndex;
+	uint64_t sentTime;
+	std::shared_ptr<std::vector<uint8_t>> frame;
+	std::vector<EncodedFecGroup> groups;
+	std::vector<Packet> packets;
+};
+
+void VideoSink::FECSend(uint8_t *buf, int len, const VideoFrameStamp &stamp,
+	const std::shared_ptr<std::vector<uint8_t>> &frame) {
+	int codec = Settings::Instance().m_fecCodec;
+	std::vector<FecGroup> fecGroups = BuildFecGroups(buf, len, m_fecPercentage);
+	std::vector<EncodedFecGroup> groups(fecGroups.size());
+	for (size_t i = 0; i < fecGroups.size(); i++) {
+		EncodeFecGroup(buf, fecGroups[i], codec, groups[i]);
+		Debug("FEC encode. sink=%u codec=%d group=%d/%d dataShards=%d totalParityShards=%d shardPackets=%d\n"
+			, m_id, codec, (int)i, (int)groups.size(), groups[i].dataShards, groups[i].parityShards, groups[i].shardPackets);
+	}
+	if (m_id == CLIENT_VIDEO_SINK) {
+		FrameTracer::Instance().Stamp(stamp.targetTimestampNs, FrameTracer::STAGE_FEC_END);
+	}
+
+	std::vector<uint8_t> order;
+	if (Settings::Instance().m_uepInterleaveGroups && groups.size() > 1) {
+		std::vector<size_t> packetCounts;
+		for (auto &group : groups) {
+			packetCounts.push_back(group.packets.size());
+		}
+		order = InterleaveFecGroups(packetCounts);
+	} else {
+		for (size_t i = 0; i < groups.size(); i++) {
+			order.insert(order.end(), groups[i].packets.size(), (uint8_t)i);
+		}
+	}
+
+	VideoFrame header = {};
+	header.type = ALVR_PACKET_TYPE_VIDEO_FRAME;
+	header.trackingFrameIndex = stamp.targetTimestampNs;
+	header.videoFrameIndex = stamp.videoFrameIndex;
+	header.sentTime = GetTimestampUs();
+	header.frameByteSize = len;
+	header.frameWidth = stamp.width;
+	header.frameHeight = stamp.height;
+	header.fecGroupCount = (uint8_t)groups.size();
+	header.fecCodec = (uint8_t)codec;
+	header.framePacketCount = (uint32_t)order.size();
+
+	auto sentFrame = std::make_shared<SentFrame>();
+	sentFrame->videoFrameIndex = stamp.videoFrameIndex;
+	sentFrame->sentTime = header.sentTime;
+	sentFrame->frame = frame;
+	// Moving the groups keeps their buffers
+	sentFrame->groups = std::move(groups);
+	bool keep = frame && Settings::Instance().m_enableVideoNack;
+	if (keep) {
+		sentFrame->packets.reserve(order.size());
+	}
+
+	std::vector<size_t> sent(sentFrame->groups.size());
+	for (size_t slot = 0; slot < order.size(); slot++) {
+		uint8_t groupIndex = order[slot];
+		const EncodedFecGroup &group = sentFrame->groups[groupIndex];
+		const FecPacket &packet = group.packets[sent[groupIndex]++];
+
+		header.packetCounter = m_packetCounter;
+		m_packetCounter++;
+		header.fecIndex = packet.fecIndex;
+		header.fecPercentage = (uint16_t)group.group.fecPercentage;
+		header.fecGroupIndex = groupIndex;
+		header.fecGroupOffset = group.group.offset;
+		header.fecGroupByteSize = group.group.size;
+		header.framePacketIndex = (uint32_t)slot;
+
+		Send(header, std::shared_ptr<const uint8_t>(sentFrame, packet.payload), packet.len);
+		if (keep) {
+			sentFrame->packets.push_back({ header, packet.payload, packet.len });
+		}
+	}
+
+	if (keep) {
+		std::unique_lock lock(m_historyMutex);
+		m_history.push_back(std::move(sentFrame));
+		while (m_history.size() > std::max(Settings::Instance().m_videoNackHistoryFrames, 1u)) {
+			m_history.pop_front();
+		}
+	}
+}
+
+void VideoSink::SendVideo(uint8_t *buf, int len, const VideoFrameStamp &stamp,
+	const std::shared_ptr<std::vector<uint8_t>> &frame) {
+	CountRetransmissions();
+	if (Settings::Instance().m_enableFec) {
+		FECSend(buf, len, stamp, frame);
+	} else {
+		VideoFrame header = {};
+		header.packetCounter = m_packetCounter;
+		header.trackingFrameIndex = stamp.targetTimestampNs;
+		header.videoFrameIndex = stamp.videoFrameIndex;
+		header.sentTime = GetTimestampUs();
+		header.frameByteSize = len;
+		header.frameWidth = stamp.width;
+		header.frameHeight = stamp.height;
+		header.fecGroupCount = 1;
+		header.fecGroupByteSize = len;
+		header.framePacketCount = 1;
+
+		Send(header, std::shared_ptr<const uint8_t>(frame, buf), len);
+
+		m_packetCounter++;
+	}
+}
+
+void VideoSink::SendRepeatFrame(const VideoFrameStamp &stamp) {
+	CountRetransmissions();
+	// A frame without payload, it never goes through FEC and doesn't take a video frame index.
+	VideoFrame header = {};
+	header.type = ALVR_PACKET_TYPE_VIDEO_FRAME;
+	header.packetCounter = m_packetCounter;
+	header.trackingFrameIndex = stamp.targetTimestampNs;
+	header.videoFrameIndex = stamp.videoFrameIndex;
+	header.sentTime = GetTimestampUs();
+	header.frameByteSize = 0;
+	header.frameWidth = stamp.width;
+	header.frameHeight = stamp.height;
+	header.framePacketCount = 1;
+
+	Send(header, nullptr, 0);
+
+	m_packetCounter++;
+}
+
+void VideoSink::Retransmit(uint64_t videoFrameIndex, const VideoNackRange *ranges, int rangeCount) {
+	std::shared_ptr<SentFrame> frame;
+	{
+		std::unique_lock lock(m_historyMutex);
+		for (auto &sentFrame : m_history) {
+			if (sentFrame->videoFrameIndex == videoFrameIndex) {
+				frame = sentFrame;
+				break;
+			}
+		}
+	}
+	if (!frame) {
+		Debug("NACK of a frame out of the history. sink=%u videoFrame=%llu\n", m_id, videoFrameIndex);
+		return;
+	}
+
+	// The client gives the frame up when the first packet of the next frame comes, about a frame
+	// interval after this one was sent plus the one way delay. A retransmission takes the same
+	// delay: it arrives in time if it leaves before the deadline after the frame was sent,
+	// whatever the round trip.
+	uint64_t frameIntervalUs = 1000000 / std::max(Settings::Instance().m_refreshRate, 1);
+	uint64_t deadline = frame->sentTime + (uint64_t)(Settings::Instance().m_videoNackDeadline * frameIntervalUs);
+	uint64_t now = GetTimestampUs();
+	if (now > deadline) {
+		Debug("NACK too late. sink=%u videoFrame=%llu late=%lluus\n", m_id, videoFrameIndex, now - deadline);
+		return;
+	}
+
+	// Runs on the thread of the NACKs: the packets go through the pacer, and the statistics get
+	// them from the encoder thread.
+	int retransmitted = 0;
+	uint64_t retransmittedBytes = 0;
+	for (auto &packet : frame->packets) {
+		for (int i = 0; i < rangeCount; i++) {
+			const VideoNackRange &range = ranges[i];
+			if (packet.header.fecGroupIndex == range.fecGroupIndex && packet.header.fecIndex >= range.fecIndex
+				&& packet.header.fecIndex - range.fecIndex < range.count) {
+				VideoFrame header = packet.header;
+				header.retransmitted = 1;
+				if (m_pacer) {
+					m_pacer->QueueRetransmission(m_id, header, std::shared_ptr<const uint8_t>(frame, packet.payload),
+						packet.len);
+				} else {
+					// only read
+					VideoSend(m_id, header, const_cast<uint8_t *>(packet.payload), packet.len);
+				}
+				retransmitted++;
+				retransmittedBytes += sizeof(VideoFrame) + packet.len;
+				break;
+			}
+		}
+	}
+	m_retransmittedPackets += retransmitted;
+	m_retransmittedBytes += retransmittedBytes;
+	Debug("Retransmit. sink=%u videoFrame=%llu ranges=%d packets=%d\n", m_id, videoFrameIndex, rangeCount,
+		retransmitted);
+}
+
+void VideoSink::OnFecFailure() {
+	Debug("VideoSink::OnFecFailure() sink=%u\n", m_id);
+	if (GetTimestampUs() - m_lastFecFailure < CONTINUOUS_FEC_FAILURE) {
+		if (m_fecPercentage < MAX_FEC_PERCENTAGE) {
+			m_fecPercentage += 5;
+		}
+	}
+	m_lastFecFailure = GetTimestampUs();
+}
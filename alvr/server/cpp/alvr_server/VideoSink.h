@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+class Statistics;
+class VideoPacer;
+struct VideoFrame;
+struct VideoNackRange;
+
+// Values stamped in the video headers of a frame, the same for every sink.
+struct VideoFrameStamp {
+	uint64_t targetTimestampNs;
+	uint64_t videoFrameIndex;
+	uint16_t width;
+	uint16_t height;
+};
+
+// One receiver of the encoded video: the client, or a spectator. The frames are encoded once and
+// the same bitstream goes to every sink, each one packetizes it with its own packet counter and
+// FEC percentage since each one sees its own losses.
+class VideoSink
+{
+public:
+	// The client sink, id 0, shares the statistics of the connection. The bitrate adaptation reads
+	// them, so spectators get their own.
+	// Without a pacer the packets go out as soon as they are made.
+	VideoSink(uint32_t id, std::shared_ptr<Statistics> statistics, std::shared_ptr<VideoPacer> pacer);
+
+	uint32_t GetId() const { return m_id; }
+	int GetFecPercentage() const { return m_fecPercentage; }
+	std::shared_ptr<Statistics> GetStatistics() const { return m_statistics; }
+
+	// buf is only read, it is shared by all the sinks. frame, if not null, holds buf: the packets
+	// queued in the pacer and the FEC packets of the last frames, kept for the retransmissions,
+	// point into it and into their parity. It can only be null without a pacer.
+	void SendVideo(uint8_t *buf, int len, const VideoFrameStamp &stamp,
+		const std::shared_ptr<std::vector<uint8_t>> &frame);
+	void SendRepeatFrame(const VideoFrameStamp &stamp);
+	void OnFecFailure();
+	// Sends again the packets of a kept frame the client asks for, unless they would arrive after
+	// the frame deadline.
+	void Retransmit(uint64_t videoFrameIndex, const VideoNackRange *ranges, int rangeCount);
+
+	static const uint64_t CONTINUOUS_FEC_FAILURE = 60 * 1000 * 1000;
+	static const int INITIAL_FEC_PERCENTAGE = 5;
+	static const int MAX_FEC_PERCENTAGE = 10;
+
+private:
+	struct SentFrame;
+
+	// payload holds what it points to until the packet is sent, null for an empty packet.
+	void Send(const VideoFrame &header, std::shared_ptr<const uint8_t> payload, int len);
+	// Adds the retransmissions since the last call to the statistics. On the encoder thread: the
+	// statistics aren't thread safe.
+	void CountRetransmissions();
+	// Sends the FEC groups of the frame (see FecGroups.h), one after the other or interleaved.
+	void FECSend(uint8_t *buf, int len, const VideoFrameStamp &stamp,
+		const std::shared_ptr<std::vector<uint8_t>> &frame);
+
+	uint32_t m_id;
+	std::shared_ptr<Statistics> m_statistics;
+	std::shared_ptr<VideoPacer> m_pacer;
+	uint32_t m_packetCounter = 0;
+	int m_fecPercentage = INITIAL_FEC_PERCENTAGE;
+	uint64_t m_lastFecFailure = 0;
+
+	// Written by the encoder thread, read on the NACKs.
+	std::mutex m_historyMutex;
+	std::deque<std::shared_ptr<SentFrame>> m_history;
+	std::atomic<uint64_t> m_retransmittedPackets{0};
+	std::atomic<uint64_t> m_retransmittedBytes{0};
+};
@@ -7,6 +7,7 @@
 #include "platform/linux/CEncoder.h"
 #endif
 #include "ClientConnection.h"
+#include "FrameTracer.h"
 #include "Logger.h"
 #include "OvrController.h"
 #include "OvrHMD.h"
@@ -15,6 +16,7 @@
 #include "Statistics.h"
 #include "TrackedDevice.h"
 #include "bindings.h"
+#include "ALVR-common/tracking_codec.h"
 #include "driverlog.h"
 #include "openvr_driver.h"
 #include <cstring>
@@ -165,7 +167,7 @@ void (*LogWarn)(const char *stringPtr);
 void (*LogInfo)(const char *stringPtr);
 void (*LogDebug)(const char *stringPtr);
 void (*DriverReadyIdle)(bool setDefaultChaprone);
-void (*VideoSend)(VideoFrame header, unsigned char *buf, int len);
+void (*VideoSend)(unsigned int sinkId, VideoFrame header, unsigned char *buf, int len);
 void (*HapticsSend)(unsigned long long path, float duration_s, float frequency, float amplitude);
 void (*TimeSyncSend)(TimeSync packet);
 void (*ShutdownRuntime)();
@@ -188,12 +190,20 @@ void *CppEntryPoint(const char *interface_name, int *return_code) {
     }
 }
 
+static tracking_codec::Decoder<TrackingInfo> g_tracking_decoder;
+
 void InitializeStreaming() {
     // set correct client ip
     Settings::Instance().Load();
+    g_tracking_decoder.Reset();
+    FrameTracer::Instance().Reset();
 
     if (g_driver_provider.hmd) {
         g_driver_provider.hmd->StartStreaming();
+        // the client (and its clock) can be another one
+        if (g_driver_provider.hmd->m_Listener) {
+            g_driver_provider.hmd->m_Listener->m_gazeHistory.Reset();
+        }
     }
 }
 
@@ -201,15 +211,17 @@ void DeinitializeStreaming() {
     // nothing to do
 }
 
-void RequestIDR() {
-    if (g_driver_provider.hmd && g_driver_provider.hmd->m_encoder) {
+void RequestIDR(unsigned int sinkId) {
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_encoder &&
+        g_driver_provider.hmd->m_Listener &&
+        g_driver_provider.hmd->m_Listener->OnIDRRequest(sinkId)) {
         g_driver_provider.hmd->m_encoder->InsertIDR();
     }
 }
 //shn-
-void InputReceive(TrackingInfo data) {
+static void ProcessTrackingInfo(const TrackingInfo &data, size_t packetSize) {
     if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
-        g_driver_provider.hmd->m_Listener->m_Statistics->CountPacket(sizeof(TrackingInfo));
+        g_driver_provider.hmd->m_Listener->m_Statistics->CountPacket(packetSize);
 
         uint64_t Current = GetTimestampUs();
         TimeSync sendBuf = {};
@@ -218,20 +230,90 @@ void InputReceive(TrackingInfo data) {
         sendBuf.trackingRecvFrameIndex = data.targetTimestampNs;
         TimeSyncSend(sendBuf);
 
+        FrameTracer::Instance().OnPoseReceived(data.targetTimestampNs);
         g_driver_provider.hmd->OnPoseUpdated(data);
     }
 }
+void InputReceive(TrackingInfo data) {
+    ProcessTrackingInfo(data, sizeof(TrackingInfo));
+}
+void InputReceiveCompact(const unsigned char *data, unsigned int size) {
+    TrackingInfo info;
+    if (!g_tracking_decoder.Decode(data, size, info)) {
+        // Not acknowledged, the client keeps referencing older samples until it sends a full one.
+        return;
+    }
+    // Same as the INPUT stream: the hand pose is the bone root.
+    for (auto &controller : info.controller) {
+        if (controller.isHand) {
+            controller.orientation = controller.boneRootOrientation;
+            controller.position = controller.boneRootPosition;
+        } else {
+            controller.boneRootOrientation = controller.orientation;
+            controller.boneRootPosition = controller.position;
+        }
+    }
+    ProcessTrackingInfo(info, size);
+}
+void GazeReceive(const unsigned char *data, unsigned int size) {
+    GazeSample sample;
+    if (size != sizeof(GazeSample)) {
+        return;
+    }
+    memcpy(&sample, data, sizeof(GazeSample));
+    if (sample.type != ALVR_PACKET_TYPE_GAZE) {
+        return;
+    }
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
+        g_driver_provider.hmd->m_Listener->m_Statistics->CountPacket(size);
+        g_driver_provider.hmd->m_Listener->m_gazeHistory.OnGazeSample(sample);
+    }
+}
 void TimeSyncReceive(TimeSync data) {
     if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
         g_driver_provider.hmd->m_Listener->ProcessTimeSync(data);
+        if (data.mode == 0) {
+            g_driver_provider.hmd->OnClientIdleTime(data.idleTime);
+        }
     }
 }
-void VideoErrorReportReceive() {
+void VideoErrorReportReceive(unsigned int sinkId) {
     if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
-        g_driver_provider.hmd->m_Listener->OnFecFailure();
+        g_driver_provider.hmd->m_Listener->OnFecFailure(sinkId);
+        // IDRScheduler merges the losses of all the sinks into one pending IDR.
         g_driver_provider.hmd->m_encoder->OnPacketLoss();
     }
 }
+void VideoNackReceive(unsigned int sinkId,
+                      unsigned long long videoFrameIndex,
+                      const VideoNackRange *ranges,
+                      unsigned int rangeCount) {
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
+        g_driver_provider.hmd->m_Listener->OnVideoNack(sinkId, videoFrameIndex, ranges, (int)rangeCount);
+    }
+}
+void FrameTraceReceive(ClientFrameTrace trace) {
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener &&
+        g_driver_provider.hmd->m_Listener->m_clockSync.IsValid()) {
+        auto &clockSync = g_driver_provider.hmd->m_Listener->m_clockSync;
+        FrameTracer::Instance().OnClientTrace(
+            trace, clockSync.GetOffset(GetTimestampUs()), (uint64_t)clockSync.GetEstimate().error);
+    }
+}
+void AddVideoSink(unsigned int sinkId) {
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
+        g_driver_provider.hmd->m_Listener->AddVideoSink(sinkId);
+        // the spectator can't decode anything before the next IDR
+        if (g_driver_provider.hmd->m_encoder) {
+            g_driver_provider.hmd->m_encoder->InsertIDR();
+        }
+    }
+}
+void RemoveVideoSink(unsigned int sinkId) {
+    if (g_driver_provider.hmd && g_driver_provider.hmd->m_Listener) {
+        g_driver_provider.hmd->m_Listener->RemoveVideoSink(sinkId);
+    }
+}
 
 void ShutdownSteamvr() {
     if (g_driver_provider.hmd) {
@@ -1,5 +1,6 @@
 #include "CEncoder.h"
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <memory>
@@ -15,13 +16,16 @@
 
 #include "ALVR-common/packet_types.h"
 #include "alvr_server/ClientConnection.h"
+#include "alvr_server/FrameTracer.h"
 #include "alvr_server/Logger.h"
 #include "alvr_server/PoseHistory.h"
+#include "alvr_server/ResolutionController.h"
 #include "alvr_server/Settings.h"
 #include "alvr_server/Statistics.h"
 #include "protocol.h"
 #include "ffmpeg_helper.h"
 #include "EncodePipeline.h"
+#include "QualityProbe.h"
 
 extern "C" {
 #include <libavutil/avutil.h>
@@ -29,7 +33,9 @@ extern "C" {
 
 CEncoder::CEncoder(std::shared_ptr<ClientConnection> listener,
                    std::shared_ptr<PoseHistory> poseHistory)
-    : m_listener(listener), m_poseHistory(poseHistory) {}
+    : m_listener(listener), m_poseHistory(poseHistory) {
+    SetThreadPolicy("alvr-encoder", Settings::Instance().m_threadPolicy);
+}
 
 CEncoder::~CEncoder() { Stop(); }
 
@@ -215,17 +221,64 @@ void CEncoder::Run() {
             images.emplace_back(vk_ctx, init.image_create_info, init.mem_index, m_fds[2*i], m_fds[2*i+1]);
         }
 
-      auto encode_pipeline = alvr::EncodePipeline::Create(images, vk_frame_ctx);
+      // declared before the pipelines, which keep a pointer to it
+      std::unique_ptr<alvr::QualityProbe> quality_probe;
+
+      // One pipeline per resolution level, all created upfront so that switching level
+      // only costs an IDR frame. Level 0 is the full resolution and must succeed, it picks the
+      // backend. The other levels use the same one: falling back to another encoder (e.g. the
+      // software one) would make a smaller level slower. A level that can't be created, for
+      // example once the NVENC sessions run out, is dropped with the ones above it.
+      ResolutionController resolution;
+      std::vector<std::unique_ptr<alvr::EncodePipeline>> encode_pipelines;
+      alvr::EncodePipeline::Backend backend;
+      for (auto &level : resolution.GetLevels()) {
+        if (encode_pipelines.empty()) {
+          encode_pipelines.push_back(alvr::EncodePipeline::Create(images, vk_frame_ctx, level.width, level.height, backend));
+          continue;
+        }
+        try {
+          encode_pipelines.push_back(alvr::EncodePipeline::CreateBackend(images, vk_frame_ctx, level.width, level.height, backend));
+        } catch (std::exception &e) {
+          Warn("failed to create %ux%u encoder, dynamic resolution limited to %zu levels: %s", level.width, level.height, encode_pipelines.size(), e.what());
+          break;
+        }
+      }
+      resolution.LimitLevels(encode_pipelines.size());
+      size_t current_level = 0;
+
+      if (Settings::Instance().m_enableQualityProbe) {
+        try {
+          quality_probe = std::make_unique<alvr::QualityProbe>();
+          bool supported = false;
+          for (auto &encode_pipeline : encode_pipelines)
+            supported = encode_pipeline->SetQualityProbe(quality_probe.get()) or supported;
+          if (not supported) {
+            Warn("quality probe needs the software encoder, disabled");
+            quality_probe.reset();
+          }
+        } catch (std::exception &e) {
+          Warn("failed to create quality probe: %s", e.what());
+        }
+      }
+
+      // Unchanged frames are replaced by a repeat marker, but a real frame is still encoded
+      // every so often in case the sampled change detection missed something.
+      const bool skip_static_frames = Settings::Instance().m_skipStaticFrames;
+      const int max_repeated_frames = std::max(Settings::Instance().m_refreshRate / 2, 1);
+      int repeated_frames = 0;
 
       fprintf(stderr, "CEncoder starting to read present packets");
       present_packet frame_info;
-      std::vector<uint8_t> encoded_data;
+      // A new buffer every frame, the video sinks keep the previous ones for the retransmissions.
+      std::shared_ptr<std::vector<uint8_t>> encoded_data;
       double avg_real_encode_time_ms = 0;
       while (not m_exiting) {
         read_latest(client, (char *)&frame_info, sizeof(frame_info), m_exiting);
 
         if (m_listener->GetStatistics()->CheckBitrateUpdated()) {
-          encode_pipeline->SetBitrate(m_listener->GetStatistics()->GetBitrate() * 1000000L); // in bits;
+          for (auto &encode_pipeline : encode_pipelines)
+            encode_pipeline->SetBitrate(m_listener->GetStatistics()->GetBitrate() * 1000000L); // in bits;
         }
 
         auto pose = m_poseHistory->GetBestPoseMatch((const vr::HmdMatrix34_t&)frame_info.pose);
@@ -233,24 +286,57 @@ void CEncoder::Run() {
         {
           continue;
         }
+        FrameTracer::Instance().OnPresent(pose->info.targetTimestampNs);
+
+        bool idr = m_scheduler.CheckIDRInsertion();
+        if (resolution.GetCurrentLevel() != current_level) {
+          // the client decoder can only pick up the new size on a keyframe
+          current_level = resolution.GetCurrentLevel();
+          idr = true;
+        }
+        auto &encode_pipeline = encode_pipelines[current_level];
 
         auto encode_start = std::chrono::steady_clock::now();
-        encode_pipeline->PushFrame(frame_info.image, pose->info.targetTimestampNs, m_scheduler.CheckIDRInsertion());
+        FrameTracer::Instance().Stamp(pose->info.targetTimestampNs, FrameTracer::STAGE_ENCODE_START);
+        bool unchanged = skip_static_frames and encode_pipeline->IsFrameUnchanged(frame_info.image);
+        if (unchanged and not idr and repeated_frames < max_repeated_frames) {
+          repeated_frames++;
+          m_listener->SendRepeatFrame(pose->info.targetTimestampNs);
+          continue;
+        }
+        repeated_frames = 0;
+        encode_pipeline->PushFrame(frame_info.image, pose->info.targetTimestampNs, idr);
 
         static_assert(sizeof(frame_info.pose) == sizeof(vr::HmdMatrix34_t&));
 
-        encoded_data.clear();
+        encoded_data = std::make_shared<std::vector<uint8_t>>();
         uint64_t pts;
         // Encoders can req more then once frame, need to accumulate more data before sending it to the client
-        if (!encode_pipeline->GetEncoded(encoded_data, &pts)) {
+        // An empty frame would be taken as a repeat marker by the client
+        if (!encode_pipeline->GetEncoded(*encoded_data, &pts) or encoded_data->empty()) {
           continue;
         }
+        auto encode_done = std::chrono::steady_clock::now();
 
-        m_listener->SendVideo(encoded_data.data(), encoded_data.size(), pts);
+        auto &level = resolution.GetLevels()[current_level];
+        m_listener->SetVideoFrameSize(level.width, level.height);
+        m_listener->SendVideo(encoded_data, pts);
 
         auto encode_end = std::chrono::steady_clock::now();
 
         m_listener->GetStatistics()->EncodeOutput(std::chrono::duration_cast<std::chrono::microseconds>(encode_end - encode_start).count());
+        resolution.Update(std::chrono::duration_cast<std::chrono::microseconds>(encode_done - encode_start).count(),
+                          m_listener->GetStatistics()->GetBitrate());
+
+        if (quality_probe) {
+          // the gaze stream is fresher than the gaze sampled with the pose
+          auto gaze = m_listener->m_gazeHistory.GetGazeAt(pose->info.targetTimestampNs);
+          quality_probe->SubmitPacket(encoded_data->data(), encoded_data->size(), pts,
+                                      gaze ? gaze->direction : pose->info.EyeGaze_Direction);
+          alvr::QualityProbe::Result quality;
+          if (quality_probe->GetResult(quality))
+            m_listener->GetStatistics()->QualityOutput(quality.psnr, quality.foveated_psnr, quality.ssim, quality.foveated_ssim);
+        }
 
       }
     }
@@ -1,5 +1,6 @@
 #include "EncodePipeline.h"
 
+#include "ALVR-common/nal_scan.h"
 #include "alvr_server/Logger.h"
 #include "alvr_server/Settings.h"
 #include "EncodePipelineSW.h"
@@ -13,53 +14,17 @@ extern "C" {
 
 namespace {
 
-bool should_keep_nal_h264(const uint8_t * header_start)
-{
-  uint8_t nal_type = (header_start[2] == 0 ? header_start[4] : header_start[3]) & 0x1F;
-    switch (nal_type)
-    {
-      case 6: // supplemental enhancement information
-      case 9: // access unit delimiter
-        return false;
-      default:
-        return true;
-    }
-}
-
-bool should_keep_nal_h265(const uint8_t * header_start)
-{
-  uint8_t nal_type = ((header_start[2] == 0 ? header_start[4] : header_start[3]) >> 1) & 0x3F;
-  switch (nal_type)
-  {
-    case 35: // access unit delimiter
-    case 39: // supplemental enhancement information
-      return false;
-    default:
-      return true;
-  }
-}
-
 void filter_NAL(const uint8_t* input, size_t input_size, std::vector<uint8_t> &out)
 {
   if (input_size < 4)
     return;
-  auto codec = Settings::Instance().m_codec;
-  std::array<uint8_t, 3> header = {{0, 0, 1}};
-  auto end = input + input_size;
-  auto header_start = input;
-  while (header_start != end)
-  {
-    auto next_header = std::search(header_start + 3, end, header.begin(), header.end());
-    if (next_header != end and next_header[-1] == 0)
-    {
-      next_header--;
-    }
-    if (codec == ALVR_CODEC_H264 and should_keep_nal_h264(header_start))
-      out.insert(out.end(), header_start, next_header);
-    if (codec == ALVR_CODEC_H265 and should_keep_nal_h265(header_start))
-      out.insert(out.end(), header_start, next_header);
-    header_start = next_header;
-  }
+  // Reserve the worst case once and append the kept units, resize would zero fill first.
+  out.reserve(out.size() + input_size);
+  const ALVR_CODEC codec = ALVR_CODEC(Settings::Instance().m_codec);
+  ForEachNalUnit(input, input_size, [&](const uint8_t *nal_begin, const uint8_t *nal_end) {
+    if (!IsDroppableNalUnit(nal_begin, nal_end, codec))
+      out.insert(out.end(), nal_begin, nal_end);
+  });
 }
 
 }
@@ -68,29 +33,45 @@ void alvr::EncodePipeline::SetBitrate(int64_t bitrate) {
   encoder_ctx->bit_rate = bitrate;
 }
 
-std::unique_ptr<alvr::EncodePipeline> alvr::EncodePipeline::Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx)
+std::unique_ptr<alvr::EncodePipeline> alvr::EncodePipeline::Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx, uint32_t width, uint32_t height, Backend &backend)
 {
   try {
-    auto vaapi = std::make_unique<alvr::EncodePipelineVAAPI>(input_frames, vk_frame_ctx);
+    auto vaapi = CreateBackend(input_frames, vk_frame_ctx, width, height, Backend::VAAPI);
     Info("using VAAPI encoder");
+    backend = Backend::VAAPI;
     return vaapi;
   } catch (...)
   {
     Info("failed to create VAAPI encoder");
   }
   try {
-    auto nvenc = std::make_unique<alvr::EncodePipelineNvEnc>(input_frames, vk_frame_ctx);
+    auto nvenc = CreateBackend(input_frames, vk_frame_ctx, width, height, Backend::NvEnc);
     Info("using NvEnc encoder");
+    backend = Backend::NvEnc;
     return nvenc;
   } catch (...)
   {
     Info("failed to create NvEnc encoder");
   }
-  auto sw = std::make_unique<alvr::EncodePipelineSW>(input_frames, vk_frame_ctx);
+  auto sw = CreateBackend(input_frames, vk_frame_ctx, width, height, Backend::SW);
   Info("using SW encoder");
+  backend = Backend::SW;
   return sw;
 }
 
+std::unique_ptr<alvr::EncodePipeline> alvr::EncodePipeline::CreateBackend(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx, uint32_t width, uint32_t height, Backend backend)
+{
+  switch (backend) {
+  case Backend::VAAPI:
+    return std::make_unique<alvr::EncodePipelineVAAPI>(input_frames, vk_frame_ctx, width, height);
+  case Backend::NvEnc:
+    return std::make_unique<alvr::EncodePipelineNvEnc>(input_frames, vk_frame_ctx, width, height);
+  case Backend::SW:
+  default:
+    return std::make_unique<alvr::EncodePipelineSW>(input_frames, vk_frame_ctx, width, height);
+  }
+}
+
 alvr::EncodePipeline::~EncodePipeline()
 {
   AVCODEC.avcodec_free_context(&encoder_ctx);
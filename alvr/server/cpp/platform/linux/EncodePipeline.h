@@ -3,6 +3,8 @@
 #include <memory>
 #include <vector>
 
+#include "FrameChangeDetector.h"
+
 extern "C" struct AVCodecContext;
 
 namespace alvr
@@ -10,6 +12,7 @@ namespace alvr
 
 class VkFrame;
 class VkFrameCtx;
+class QualityProbe;
 
 class EncodePipeline
 {
@@ -17,12 +20,27 @@ public:
   virtual ~EncodePipeline();
 
   virtual void PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) = 0;
+  // Compare the input frame with the one given in the previous call. When called, it must be
+  // called for every frame so the reference stays current, and before PushFrame for the same
+  // frame (pipelines may keep the converted frame for it).
+  // Pipelines that can't read the frame back cheaply always report a change.
+  virtual bool IsFrameUnchanged(uint32_t frame_index) { return false; }
+  // Give the encoder input of each frame to the probe. Returns false if the pipeline can't,
+  // because the input never leaves the GPU.
+  virtual bool SetQualityProbe(QualityProbe *probe) { return false; }
   bool GetEncoded(std::vector<uint8_t> & out, uint64_t *pts);
 
   void SetBitrate(int64_t bitrate);
-  static std::unique_ptr<EncodePipeline> Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx);
+
+  enum class Backend { VAAPI, NvEnc, SW };
+  // width and height are the encoded size, the input frames are scaled to it if they differ.
+  // Tries VAAPI, then NvEnc, then the software encoder, backend is set to the one in use.
+  static std::unique_ptr<EncodePipeline> Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx, uint32_t width, uint32_t height, Backend &backend);
+  // Only the given backend, throws if it can't be created.
+  static std::unique_ptr<EncodePipeline> CreateBackend(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx, uint32_t width, uint32_t height, Backend backend);
 protected:
   AVCodecContext *encoder_ctx = nullptr; //shall be initialized by child class
+  FrameChangeDetector change_detector;
 };
 
 }
@@ -24,7 +24,9 @@ const char *encoder(ALVR_CODEC codec) {
 
 } // namespace
 alvr::EncodePipelineNvEnc::EncodePipelineNvEnc(std::vector<VkFrame> &input_frames,
-                                               VkFrameCtx &vk_frame_ctx) {
+                                               VkFrameCtx &vk_frame_ctx,
+                                               uint32_t width,
+                                               uint32_t height) {
     auto input_frame_ctx = (AVHWFramesContext *)vk_frame_ctx.ctx->data;
     assert(input_frame_ctx->sw_format == AV_PIX_FMT_BGRA);
 
@@ -69,8 +71,8 @@ alvr::EncodePipelineNvEnc::EncodePipelineNvEnc(std::vector<VkFrame> &input_frame
      * We just to ignore the alpha channel and it's done
      */
     encoder_ctx->pix_fmt = AV_PIX_FMT_BGR0;
-    encoder_ctx->width = settings.m_renderWidth;
-    encoder_ctx->height = settings.m_renderHeight;
+    encoder_ctx->width = width;
+    encoder_ctx->height = height;
     encoder_ctx->time_base = {1, (int)1e9};
     encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
     encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
@@ -84,25 +86,71 @@ alvr::EncodePipelineNvEnc::EncodePipelineNvEnc(std::vector<VkFrame> &input_frame
     }
 
     hw_frame = AVUTIL.av_frame_alloc();
+
+    if (width != (uint32_t)input_frame_ctx->width or height != (uint32_t)input_frame_ctx->height) {
+        scaled_frame = AVUTIL.av_frame_alloc();
+        scaled_frame->width = width;
+        scaled_frame->height = height;
+        scaled_frame->format = encoder_ctx->pix_fmt;
+        AVUTIL.av_frame_get_buffer(scaled_frame, 0);
+
+        scaler_ctx = SWSCALE.sws_getContext(
+            input_frame_ctx->width, input_frame_ctx->height, input_frame_ctx->sw_format,
+            width, height, encoder_ctx->pix_fmt,
+            SWS_BILINEAR,
+            NULL, NULL, NULL);
+        if (not scaler_ctx) {
+            throw std::runtime_error("failed to create NvEnc scaler");
+        }
+    }
 }
 
 alvr::EncodePipelineNvEnc::~EncodePipelineNvEnc() {
     AVUTIL.av_buffer_unref(&hw_ctx);
     AVUTIL.av_frame_free(&hw_frame);
+    AVUTIL.av_frame_free(&scaled_frame);
+    SWSCALE.sws_freeContext(scaler_ctx);
 }
 
-void alvr::EncodePipelineNvEnc::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) {
+bool alvr::EncodePipelineNvEnc::IsFrameUnchanged(uint32_t frame_index) {
     assert(frame_index < vk_frames.size());
 
     int err = AVUTIL.av_hwframe_transfer_data(hw_frame, vk_frames[frame_index].get(), 0);
     if (err) {
         throw alvr::AvException("av_hwframe_transfer_data", err);
     }
+    transferred_index = frame_index;
+
+    // BGRA, 4 bytes per pixel
+    return not change_detector.Changed(hw_frame->data[0], hw_frame->linesize[0], hw_frame->width * 4, hw_frame->height);
+}
+
+void alvr::EncodePipelineNvEnc::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) {
+    assert(frame_index < vk_frames.size());
+
+    int err;
+    if (transferred_index != frame_index) {
+        err = AVUTIL.av_hwframe_transfer_data(hw_frame, vk_frames[frame_index].get(), 0);
+        if (err) {
+            throw alvr::AvException("av_hwframe_transfer_data", err);
+        }
+    }
+    transferred_index = -1;
+
+    AVFrame *encoder_frame = hw_frame;
+    if (scaler_ctx) {
+        err = SWSCALE.sws_scale(scaler_ctx, hw_frame->data, hw_frame->linesize, 0, hw_frame->height,
+                                scaled_frame->data, scaled_frame->linesize);
+        if (err == 0) {
+            throw alvr::AvException("sws_scale failed:", err);
+        }
+        encoder_frame = scaled_frame;
+    }
 
-    hw_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
-    hw_frame->pts = targetTimestampNs;
+    encoder_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    encoder_frame->pts = targetTimestampNs;
 
-    if ((err = AVCODEC.avcodec_send_frame(encoder_ctx, hw_frame)) < 0) {
+    if ((err = AVCODEC.avcodec_send_frame(encoder_ctx, encoder_frame)) < 0) {
         throw alvr::AvException("avcodec_send_frame failed:", err);
     }
 }
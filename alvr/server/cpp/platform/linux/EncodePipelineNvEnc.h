@@ -6,6 +6,7 @@
 extern "C" struct AVBufferRef;
 extern "C" struct AVCodecContext;
 extern "C" struct AVFrame;
+extern "C" struct SwsContext;
 
 namespace alvr
 {
@@ -14,13 +15,19 @@ class EncodePipelineNvEnc: public EncodePipeline
 {
 public:
   ~EncodePipelineNvEnc();
-  EncodePipelineNvEnc(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx);
+  EncodePipelineNvEnc(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx, uint32_t width, uint32_t height);
 
   void PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) override;
+  bool IsFrameUnchanged(uint32_t frame_index) override;
 
 private:
   AVBufferRef *hw_ctx = nullptr;
   std::vector<std::unique_ptr<AVFrame, std::function<void(AVFrame*)>>> vk_frames;
   AVFrame * hw_frame = nullptr;
+  // index of the input frame already in hw_frame, -1 if none
+  int64_t transferred_index = -1;
+  // only used when encoding at a lower resolution than the input frames
+  AVFrame * scaled_frame = nullptr;
+  SwsContext *scaler_ctx = nullptr;
 };
 }
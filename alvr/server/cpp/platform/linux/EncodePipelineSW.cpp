@@ -5,6 +5,7 @@
 
 #include "alvr_server/Settings.h"
 #include "ffmpeg_helper.h"
+#include "QualityProbe.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -30,7 +31,7 @@ const char * encoder(ALVR_CODEC codec)
 
 }
 
-alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkFrameCtx& vk_frame_ctx)
+alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkFrameCtx& vk_frame_ctx, uint32_t width, uint32_t height)
 {
   for (auto& input_frame: input_frames)
   {
@@ -71,8 +72,8 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
   }
 
 
-  encoder_ctx->width = settings.m_renderWidth;
-  encoder_ctx->height = settings.m_renderHeight;
+  encoder_ctx->width = width;
+  encoder_ctx->height = height;
   encoder_ctx->time_base = {1, (int)1e9};
   encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
   encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
@@ -88,8 +89,8 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
 
   transferred_frame = AVUTIL.av_frame_alloc();
   encoder_frame = AVUTIL.av_frame_alloc();
-  encoder_frame->width = settings.m_renderWidth;
-  encoder_frame->height = settings.m_renderHeight;
+  encoder_frame->width = width;
+  encoder_frame->height = height;
   encoder_frame->format = encoder_ctx->pix_fmt;
   AVUTIL.av_frame_get_buffer(encoder_frame, 0);
 
@@ -106,19 +107,46 @@ alvr::EncodePipelineSW::~EncodePipelineSW()
     AVUTIL.av_frame_free(&vk_frame);
   AVUTIL.av_frame_free(&transferred_frame);
   AVUTIL.av_frame_free(&encoder_frame);
+  SWSCALE.sws_freeContext(scaler_ctx);
 }
 
-void alvr::EncodePipelineSW::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr)
+bool alvr::EncodePipelineSW::IsFrameUnchanged(uint32_t frame_index)
 {
   int err = AVUTIL.av_hwframe_transfer_data(transferred_frame, vk_frames[frame_index], 0);
   if (err)
     throw alvr::AvException("av_hwframe_transfer_data", err);
+  transferred_index = frame_index;
+
+  // packed 4 bytes per pixel format from the vulkan layer
+  return not change_detector.Changed(transferred_frame->data[0], transferred_frame->linesize[0],
+      transferred_frame->width * 4, transferred_frame->height);
+}
+
+bool alvr::EncodePipelineSW::SetQualityProbe(QualityProbe *probe)
+{
+  quality_probe = probe;
+  return true;
+}
+
+void alvr::EncodePipelineSW::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr)
+{
+  int err;
+  if (transferred_index != frame_index)
+  {
+    err = AVUTIL.av_hwframe_transfer_data(transferred_frame, vk_frames[frame_index], 0);
+    if (err)
+      throw alvr::AvException("av_hwframe_transfer_data", err);
+  }
+  transferred_index = -1;
 
   err = SWSCALE.sws_scale(scaler_ctx, transferred_frame->data, transferred_frame->linesize, 0, transferred_frame->height,
       encoder_frame->data, encoder_frame->linesize);
   if (err == 0)
     throw alvr::AvException("sws_scale failed:", err);
 
+  if (quality_probe)
+    quality_probe->SubmitSource(encoder_frame, targetTimestampNs);
+
   encoder_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
   encoder_frame->pts = targetTimestampNs;
 
@@ -12,14 +12,19 @@ class EncodePipelineSW: public EncodePipeline
 {
 public:
   ~EncodePipelineSW();
-  EncodePipelineSW(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx);
+  EncodePipelineSW(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx, uint32_t width, uint32_t height);
 
   void PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) override;
+  bool IsFrameUnchanged(uint32_t frame_index) override;
+  bool SetQualityProbe(QualityProbe *probe) override;
 
 private:
   std::vector<AVFrame *> vk_frames;
   AVFrame * transferred_frame = nullptr;
+  // index of the input frame already in transferred_frame, -1 if none
+  int64_t transferred_index = -1;
   AVFrame * encoder_frame = nullptr;
   SwsContext *scaler_ctx = nullptr;
+  QualityProbe *quality_probe = nullptr;
 };
 }
@@ -1,8 +1,10 @@
 #include "EncodePipelineVAAPI.h"
 #include "ALVR-common/packet_types.h"
 #include "ffmpeg_helper.h"
+#include "alvr_server/Logger.h"
 #include "alvr_server/Settings.h"
 #include <chrono>
+#include <string>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -93,7 +95,7 @@ std::vector<AVFrame*> map_frames(AVBufferRef *hw_device_ctx, std::vector<alvr::V
 
 }
 
-alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frames, VkFrameCtx& vk_frame_ctx)
+alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frames, VkFrameCtx& vk_frame_ctx, uint32_t width, uint32_t height)
 {
   /* VAAPI Encoding pipeline
    * The encoding pipeline has 3 frame types:
@@ -138,8 +140,8 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
       break;
   }
 
-  encoder_ctx->width = settings.m_renderWidth;
-  encoder_ctx->height = settings.m_renderHeight;
+  encoder_ctx->width = width;
+  encoder_ctx->height = height;
   encoder_ctx->time_base = {1, (int)1e9};
   encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
   encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
@@ -188,7 +190,12 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
   inputs->pad_idx = 0;
   inputs->next = NULL;
 
-  if ((err = AVFILTER.avfilter_graph_parse_ptr(filter_graph, "scale_vaapi=format=nv12", &inputs, &outputs, NULL)) < 0)
+  std::string filters = "scale_vaapi=format=nv12";
+  if (width != (uint32_t)mapped_frames[0]->width or height != (uint32_t)mapped_frames[0]->height)
+  {
+    filters += ":w=" + std::to_string(width) + ":h=" + std::to_string(height);
+  }
+  if ((err = AVFILTER.avfilter_graph_parse_ptr(filter_graph, filters.c_str(), &inputs, &outputs, NULL)) < 0)
   {
     throw alvr::AvException("avfilter_graph_parse_ptr failed:", err);
   }
@@ -205,11 +212,14 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
   {
     throw alvr::AvException("avfilter_graph_config failed:", err);
   }
+
+  encoder_frame = AVUTIL.av_frame_alloc();
 }
 
 alvr::EncodePipelineVAAPI::~EncodePipelineVAAPI()
 {
   AVFILTER.avfilter_graph_free(&filter_graph);
+  AVUTIL.av_frame_free(&encoder_frame);
   for (auto frame: mapped_frames)
   {
     AVUTIL.av_frame_free(&frame);
@@ -217,10 +227,10 @@ alvr::EncodePipelineVAAPI::~EncodePipelineVAAPI()
   AVUTIL.av_buffer_unref(&hw_ctx);
 }
 
-void alvr::EncodePipelineVAAPI::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr)
+void alvr::EncodePipelineVAAPI::ConvertFrame(uint32_t frame_index)
 {
   assert(frame_index < mapped_frames.size());
-  AVFrame *encoder_frame = AVUTIL.av_frame_alloc();
+  AVUTIL.av_frame_unref(encoder_frame);
   int err = AVFILTER.av_buffersrc_add_frame_flags(filter_in, mapped_frames[frame_index], AV_BUFFERSRC_FLAG_PUSH | AV_BUFFERSRC_FLAG_KEEP_REF);
   if (err != 0)
   {
@@ -231,6 +241,41 @@ void alvr::EncodePipelineVAAPI::PushFrame(uint32_t frame_index, uint64_t targetT
   {
     throw alvr::AvException("av_buffersink_get_frame failed", err);
   }
+  converted_index = frame_index;
+}
+
+bool alvr::EncodePipelineVAAPI::IsFrameUnchanged(uint32_t frame_index)
+{
+  if (not direct_map_supported)
+    return false;
+
+  ConvertFrame(frame_index);
+
+  // Only sample the luma plane of the converted surface, and only if it can be read in place:
+  // a full surface download would cost more than encoding the frame.
+  AVFrame *cpu_frame = AVUTIL.av_frame_alloc();
+  cpu_frame->format = AV_PIX_FMT_NV12;
+  int err = AVUTIL.av_hwframe_map(cpu_frame, encoder_frame, AV_HWFRAME_MAP_READ | AV_HWFRAME_MAP_DIRECT);
+  if (err < 0)
+  {
+    AVUTIL.av_frame_free(&cpu_frame);
+    Warn("VAAPI surfaces can't be mapped directly, static frame detection disabled");
+    direct_map_supported = false;
+    return false;
+  }
+  bool changed = change_detector.Changed(cpu_frame->data[0], cpu_frame->linesize[0], cpu_frame->width, cpu_frame->height);
+  AVUTIL.av_frame_free(&cpu_frame);
+  return not changed;
+}
+
+void alvr::EncodePipelineVAAPI::PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr)
+{
+  int err;
+  if (converted_index != frame_index)
+  {
+    ConvertFrame(frame_index);
+  }
+  converted_index = -1;
 
   encoder_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
   encoder_frame->pts = targetTimestampNs;
@@ -15,15 +15,23 @@ class EncodePipelineVAAPI: public EncodePipeline
 {
 public:
   ~EncodePipelineVAAPI();
-  EncodePipelineVAAPI(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx);
+  EncodePipelineVAAPI(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx, uint32_t width, uint32_t height);
 
   void PushFrame(uint32_t frame_index, uint64_t targetTimestampNs, bool idr) override;
+  bool IsFrameUnchanged(uint32_t frame_index) override;
 
 private:
+  void ConvertFrame(uint32_t frame_index);
+
   AVBufferRef *hw_ctx = nullptr;
   std::vector<AVFrame *> mapped_frames;
   AVFilterGraph *filter_graph = nullptr;
   AVFilterContext *filter_in = nullptr;
   AVFilterContext *filter_out = nullptr;
+  AVFrame *encoder_frame = nullptr;
+  // index of the input frame already converted in encoder_frame, -1 if none
+  int64_t converted_index = -1;
+  // cleared when the driver can't map surfaces without a copy
+  bool direct_map_supported = true;
 };
 }
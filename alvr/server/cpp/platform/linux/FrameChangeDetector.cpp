@@ -0,0 +1,69 @@
+#include "FrameChangeDetector.h"
+
+#include <cstring>
+
+namespace {
+
+// FNV-1a style mixing on 64 bit words, good enough to tell two frames apart.
+uint64_t hash_bytes(const uint8_t *data, size_t size, uint64_t hash)
+{
+  const uint64_t prime = 0x100000001b3ull;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < size; ++i)
+  {
+    hash = (hash ^ data[i]) * prime;
+  }
+  return hash;
+}
+
+}
+
+bool alvr::FrameChangeDetector::Changed(const uint8_t *data, int linesize, int width_bytes, int height)
+{
+  bool changed = false;
+  if (width_bytes != last_width_bytes or height != last_height or tile_hashes.empty())
+  {
+    tile_hashes.assign(TILES_X * TILES_Y, 0);
+    last_width_bytes = width_bytes;
+    last_height = height;
+    changed = true;
+  }
+
+  const int tile_width = width_bytes / TILES_X;
+  const int tile_height = height / TILES_Y;
+  if (tile_width == 0 or tile_height == 0)
+    return true;
+
+  for (int ty = 0; ty < TILES_Y; ++ty)
+  {
+    for (int tx = 0; tx < TILES_X; ++tx)
+    {
+      uint64_t hash = 0xcbf29ce484222325ull;
+      for (int r = 0; r < ROWS_PER_TILE; ++r)
+      {
+        // rows evenly spread in the tile, offset so that tile borders are not favoured
+        int y = ty * tile_height + (2 * r + 1) * tile_height / (2 * ROWS_PER_TILE);
+        const uint8_t *row = data + (size_t)y * linesize + (size_t)tx * tile_width;
+        hash = hash_bytes(row, tile_width, hash);
+      }
+      uint64_t &previous = tile_hashes[ty * TILES_X + tx];
+      if (previous != hash)
+      {
+        previous = hash;
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+void alvr::FrameChangeDetector::Reset()
+{
+  tile_hashes.clear();
+}
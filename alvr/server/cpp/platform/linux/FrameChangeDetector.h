@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace alvr
+{
+
+// Cheap detection of re-presented images (loading screens, paused content, compositor
+// re-submitting the same frame).
+// The image is split in a grid of tiles and only a fixed set of rows inside each tile is
+// hashed, so the cost is a small fraction of a full frame compare. Changes that only touch
+// rows which are never sampled go unnoticed, callers must refresh periodically.
+class FrameChangeDetector
+{
+public:
+  // Hashes the plane and compares it with the plane given in the previous call.
+  // width_bytes is the number of meaningful bytes per line (width * bytes per pixel).
+  // Returns false only when every sampled tile is identical.
+  bool Changed(const uint8_t *data, int linesize, int width_bytes, int height);
+
+  // Forget the previous frame, next call to Changed returns true.
+  void Reset();
+
+private:
+  static const int TILES_X = 16;
+  static const int TILES_Y = 16;
+  static const int ROWS_PER_TILE = 4;
+
+  std::vector<uint64_t> tile_hashes;
+  int last_width_bytes = 0;
+  int last_height = 0;
+};
+
+}
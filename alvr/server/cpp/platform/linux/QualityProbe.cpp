@@ -0,0 +1,326 @@
+#include "QualityProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ALVR-common/nal_scan.h"
+#include "alvr_server/Logger.h"
+#include "alvr_server/Settings.h"
+#include "ffmpeg_helper.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace {
+
+const int WINDOW_SIZE = 8;
+// Beyond this the decoder can't keep up, drop the backlog and restart on the next keyframe.
+const size_t MAX_QUEUED_PACKETS = 8;
+const size_t MAX_PENDING_SAMPLES = 4;
+// Weight of the far periphery relative to the gaze point, so it still counts in foveated scores.
+const float PERIPHERY_WEIGHT = 0.1f;
+
+AVCodecID decoder_id(ALVR_CODEC codec)
+{
+  switch (codec)
+  {
+    case ALVR_CODEC_H264:
+      return AV_CODEC_ID_H264;
+    case ALVR_CODEC_H265:
+      return AV_CODEC_ID_HEVC;
+  }
+  throw std::runtime_error("invalid codec " + std::to_string(codec));
+}
+
+int bytes_per_sample(int format)
+{
+  return format == AV_PIX_FMT_YUV420P10LE ? 2 : 1;
+}
+
+uint16_t read_sample(const uint8_t *row, int x, int bytes)
+{
+  if (bytes == 1)
+    return row[x];
+  uint16_t value;
+  memcpy(&value, row + 2 * x, 2);
+  return value;
+}
+
+bool has_config_nal(const uint8_t *data, size_t size, ALVR_CODEC codec)
+{
+  const int config_type = codec == ALVR_CODEC_H264 ? 7 : 32; // SPS / VPS
+  bool found = false;
+  ForEachNalUnit(data, size, [&](const uint8_t *nal_begin, const uint8_t *nal_end) {
+    found = found or GetNalUnitType(nal_begin, nal_end, codec) == config_type;
+  });
+  return found;
+}
+
+// Gaze point in the eye view, normalized from the top left corner.
+void project_gaze(const TrackingVector3 &direction, const EyeFov &fov, float out[2])
+{
+  const float deg = M_PI / 180;
+  float tan_left = tanf(fov.left * deg);
+  float tan_right = tanf(fov.right * deg);
+  float tan_top = tanf(fov.top * deg);
+  float tan_bottom = tanf(fov.bottom * deg);
+
+  // -z is forward, without eye tracking the direction is zero: use the view center
+  float tan_x = 0, tan_y = 0;
+  if (direction.z < -1e-3f)
+  {
+    tan_x = -direction.x / direction.z;
+    tan_y = direction.y / direction.z;
+  }
+  out[0] = std::clamp((tan_left + tan_x) / (tan_left + tan_right), 0.f, 1.f);
+  out[1] = std::clamp((tan_top + tan_y) / (tan_top + tan_bottom), 0.f, 1.f);
+}
+
+}
+
+alvr::QualityProbe::QualityProbe()
+{
+  const auto &settings = Settings::Instance();
+  codec = ALVR_CODEC(settings.m_codec);
+  frame_interval = std::max(settings.m_qualityProbeInterval, 1u);
+  window_stride = WINDOW_SIZE * std::max(settings.m_qualityProbeSampleStep, 1u);
+  gaze_radius = std::max(settings.m_qualityProbeGazeRadius, 0.01f);
+
+  const AVCodec *decoder = AVCODEC.avcodec_find_decoder(decoder_id(codec));
+  if (decoder == nullptr)
+    throw std::runtime_error("no decoder for the quality probe");
+  decoder_ctx = AVCODEC.avcodec_alloc_context3(decoder);
+  if (not decoder_ctx)
+    throw std::runtime_error("failed to allocate quality probe decoder");
+  decoder_ctx->thread_count = 2;
+
+  int err = AVCODEC.avcodec_open2(decoder_ctx, decoder, nullptr);
+  if (err < 0)
+  {
+    AVCODEC.avcodec_free_context(&decoder_ctx);
+    throw alvr::AvException("Cannot open quality probe decoder:", err);
+  }
+  decoded_frame = AVUTIL.av_frame_alloc();
+
+  thread = std::thread(&QualityProbe::Run, this);
+}
+
+alvr::QualityProbe::~QualityProbe()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    exiting = true;
+  }
+  cv.notify_all();
+  thread.join();
+
+  AVUTIL.av_frame_free(&decoded_frame);
+  AVCODEC.avcodec_free_context(&decoder_ctx);
+}
+
+void alvr::QualityProbe::SubmitSource(const AVFrame *frame, uint64_t pts)
+{
+  if (waiting_keyframe or ++frame_counter % frame_interval != 0)
+    return;
+
+  Sample sample;
+  sample.pts = pts;
+  sample.width = frame->width;
+  sample.height = frame->height;
+  sample.format = frame->format;
+  const int bytes = bytes_per_sample(frame->format);
+  for (int y0 = 0; y0 + WINDOW_SIZE <= frame->height; y0 += window_stride)
+  {
+    for (int x0 = 0; x0 + WINDOW_SIZE <= frame->width; x0 += window_stride)
+    {
+      for (int y = y0; y < y0 + WINDOW_SIZE; ++y)
+      {
+        const uint8_t *row = frame->data[0] + (size_t)y * frame->linesize[0];
+        for (int x = x0; x < x0 + WINDOW_SIZE; ++x)
+          sample.windows.push_back(read_sample(row, x, bytes));
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  samples.push_back(std::move(sample));
+  if (samples.size() > MAX_PENDING_SAMPLES)
+    samples.pop_front();
+}
+
+void alvr::QualityProbe::SubmitPacket(const uint8_t *data, size_t size, uint64_t pts, const TrackingVector3 &gaze_direction)
+{
+  if (waiting_keyframe)
+  {
+    if (not has_config_nal(data, size, codec))
+      return;
+    waiting_keyframe = false;
+  }
+
+  Packet packet;
+  packet.data.assign(data, data + size);
+  packet.pts = pts;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (packets.size() >= MAX_QUEUED_PACKETS)
+  {
+    Debug("quality probe decoder is late, waiting for the next keyframe");
+    packets.clear();
+    samples.clear();
+    waiting_keyframe = true;
+    return;
+  }
+  for (auto &sample : samples)
+  {
+    if (sample.pts == pts)
+    {
+      const auto &settings = Settings::Instance();
+      project_gaze(gaze_direction, settings.m_eyeFov[0], sample.gaze[0]);
+      project_gaze(gaze_direction, settings.m_eyeFov[1], sample.gaze[1]);
+    }
+  }
+  packets.push_back(std::move(packet));
+  cv.notify_one();
+}
+
+bool alvr::QualityProbe::GetResult(Result &out)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (not result_ready)
+    return false;
+  out = result;
+  result_ready = false;
+  return true;
+}
+
+void alvr::QualityProbe::Run()
+{
+  while (true)
+  {
+    Packet packet;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return exiting or not packets.empty(); });
+      if (exiting)
+        return;
+      packet = std::move(packets.front());
+      packets.pop_front();
+    }
+    Decode(packet);
+  }
+}
+
+void alvr::QualityProbe::Decode(const Packet &packet)
+{
+  AVPacket *pkt = AVCODEC.av_packet_alloc();
+  if (AVCODEC.av_new_packet(pkt, packet.data.size()) < 0)
+  {
+    AVCODEC.av_packet_free(&pkt);
+    return;
+  }
+  memcpy(pkt->data, packet.data.data(), packet.data.size());
+  pkt->pts = packet.pts;
+  int err = AVCODEC.avcodec_send_packet(decoder_ctx, pkt);
+  AVCODEC.av_packet_free(&pkt);
+  // corrupted references after a dropped backlog, the decoder recovers on the keyframe
+  if (err < 0)
+    return;
+
+  while (AVCODEC.avcodec_receive_frame(decoder_ctx, decoded_frame) == 0)
+  {
+    Sample sample;
+    bool found = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      while (not samples.empty() and samples.front().pts < (uint64_t)decoded_frame->pts)
+        samples.pop_front();
+      if (not samples.empty() and samples.front().pts == (uint64_t)decoded_frame->pts)
+      {
+        sample = std::move(samples.front());
+        samples.pop_front();
+        found = true;
+      }
+    }
+    if (found)
+      Measure(sample, decoded_frame);
+    AVUTIL.av_frame_unref(decoded_frame);
+  }
+}
+
+void alvr::QualityProbe::Measure(const Sample &sample, const AVFrame *frame)
+{
+  // the encoder was switched (resolution or bit depth) while the sample was in flight
+  if (frame->width != sample.width or frame->height != sample.height or frame->format != sample.format)
+    return;
+
+  const int bytes = bytes_per_sample(frame->format);
+  const double max_value = bytes == 2 ? 1023. : 255.;
+  const double c1 = (0.01 * max_value) * (0.01 * max_value);
+  const double c2 = (0.03 * max_value) * (0.03 * max_value);
+  const int n = WINDOW_SIZE * WINDOW_SIZE;
+  const float eye_width = sample.width / 2.f;
+
+  double mse_sum = 0, ssim_sum = 0;
+  double weighted_mse_sum = 0, weighted_ssim_sum = 0, weight_sum = 0;
+  size_t window_count = 0;
+  const uint16_t *source = sample.windows.data();
+  for (int y0 = 0; y0 + WINDOW_SIZE <= frame->height; y0 += window_stride)
+  {
+    for (int x0 = 0; x0 + WINDOW_SIZE <= frame->width; x0 += window_stride)
+    {
+      double sum_s = 0, sum_d = 0, sum_ss = 0, sum_dd = 0, sum_sd = 0, sum_err = 0;
+      for (int y = y0; y < y0 + WINDOW_SIZE; ++y)
+      {
+        const uint8_t *row = frame->data[0] + (size_t)y * frame->linesize[0];
+        for (int x = x0; x < x0 + WINDOW_SIZE; ++x)
+        {
+          double s = *source++;
+          double d = read_sample(row, x, bytes);
+          sum_s += s;
+          sum_d += d;
+          sum_ss += s * s;
+          sum_dd += d * d;
+          sum_sd += s * d;
+          sum_err += (s - d) * (s - d);
+        }
+      }
+      double mean_s = sum_s / n, mean_d = sum_d / n;
+      double var_s = sum_ss / n - mean_s * mean_s;
+      double var_d = sum_dd / n - mean_d * mean_d;
+      double cov = sum_sd / n - mean_s * mean_d;
+      double ssim = ((2 * mean_s * mean_d + c1) * (2 * cov + c2)) /
+                    ((mean_s * mean_s + mean_d * mean_d + c1) * (var_s + var_d + c2));
+      double mse = sum_err / n;
+
+      // distance to the gaze point, in the view of the eye this window belongs to
+      int eye = x0 + WINDOW_SIZE / 2 >= eye_width ? 1 : 0;
+      float u = (x0 + WINDOW_SIZE / 2 - eye * eye_width) / eye_width;
+      float v = (y0 + WINDOW_SIZE / 2) / (float)sample.height;
+      float du = u - sample.gaze[eye][0];
+      float dv = v - sample.gaze[eye][1];
+      double weight = PERIPHERY_WEIGHT + (1 - PERIPHERY_WEIGHT) *
+                      exp(-(du * du + dv * dv) / (2 * gaze_radius * gaze_radius));
+
+      mse_sum += mse;
+      ssim_sum += ssim;
+      weighted_mse_sum += weight * mse;
+      weighted_ssim_sum += weight * ssim;
+      weight_sum += weight;
+      window_count++;
+    }
+  }
+  if (window_count == 0)
+    return;
+
+  auto psnr = [&](double mse) {
+    return (float)std::min(10 * log10(max_value * max_value / std::max(mse, 1e-10)), 100.);
+  };
+  std::lock_guard<std::mutex> lock(mutex);
+  result.psnr = psnr(mse_sum / window_count);
+  result.foveated_psnr = psnr(weighted_mse_sum / weight_sum);
+  result.ssim = ssim_sum / window_count;
+  result.foveated_ssim = weighted_ssim_sum / weight_sum;
+  result_ready = true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ALVR-common/packet_types.h"
+
+extern "C" struct AVCodecContext;
+extern "C" struct AVFrame;
+
+namespace alvr
+{
+
+// Objective quality of the stream as the client decodes it.
+// Every encoded packet is decoded again on a side thread; every few frames the decoded luma is
+// compared to the encoder input on a sparse grid of 8x8 windows. Windows are weighted by their
+// distance to the gaze point of the frame, which gives the foveated scores.
+class QualityProbe
+{
+public:
+  struct Result
+  {
+    float psnr;
+    float foveated_psnr;
+    float ssim;
+    float foveated_ssim;
+  };
+
+  QualityProbe();
+  ~QualityProbe();
+
+  // Encoder input of a frame, before encoding. Only a few frames are kept, the call is cheap
+  // for the others.
+  void SubmitSource(const AVFrame *frame, uint64_t pts);
+  // Encoded frame as sent to the client, with the gaze direction of its pose.
+  void SubmitPacket(const uint8_t *data, size_t size, uint64_t pts, const TrackingVector3 &gaze_direction);
+  // Returns true and fills result when a frame was measured since the last call.
+  bool GetResult(Result &result);
+
+private:
+  struct Sample
+  {
+    uint64_t pts;
+    int width;
+    int height;
+    int format;
+    // gaze point in each eye view, normalized to [0, 1]
+    float gaze[2][2] = {{0.5f, 0.5f}, {0.5f, 0.5f}};
+    // luma of the sampled windows, one after the other
+    std::vector<uint16_t> windows;
+  };
+  struct Packet
+  {
+    std::vector<uint8_t> data;
+    uint64_t pts;
+  };
+
+  void Run();
+  void Decode(const Packet &packet);
+  void Measure(const Sample &sample, const AVFrame *frame);
+
+  ALVR_CODEC codec;
+  uint32_t frame_interval;
+  int window_stride;
+  float gaze_radius;
+
+  AVCodecContext *decoder_ctx = nullptr;
+  AVFrame *decoded_frame = nullptr;
+
+  // encoder thread only
+  uint32_t frame_counter = 0;
+  bool waiting_keyframe = true;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool exiting = false;
+  std::deque<Packet> packets;
+  std::deque<Sample> samples;
+  Result result = {};
+  bool result_ready = false;
+
+  std::thread thread;
+};
+
+}
@@ -37,6 +37,18 @@ bool avcodec::Load(const std::string& library_name) {
     return false;
   }
 
+#if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
+  avcodec_find_decoder =
+      reinterpret_cast<decltype(this->avcodec_find_decoder)>(
+          dlsym(library_, "avcodec_find_decoder"));
+#else
+  avcodec_find_decoder = &::avcodec_find_decoder;
+#endif
+  if (!avcodec_find_decoder) {
+    CleanUp(true);
+    return false;
+  }
+
 #if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
   avcodec_find_encoder_by_name =
       reinterpret_cast<decltype(this->avcodec_find_encoder_by_name)>(
@@ -73,6 +85,18 @@ bool avcodec::Load(const std::string& library_name) {
     return false;
   }
 
+#if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
+  avcodec_receive_frame =
+      reinterpret_cast<decltype(this->avcodec_receive_frame)>(
+          dlsym(library_, "avcodec_receive_frame"));
+#else
+  avcodec_receive_frame = &::avcodec_receive_frame;
+#endif
+  if (!avcodec_receive_frame) {
+    CleanUp(true);
+    return false;
+  }
+
 #if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
   avcodec_receive_packet =
       reinterpret_cast<decltype(this->avcodec_receive_packet)>(
@@ -97,6 +121,30 @@ bool avcodec::Load(const std::string& library_name) {
     return false;
   }
 
+#if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
+  avcodec_send_packet =
+      reinterpret_cast<decltype(this->avcodec_send_packet)>(
+          dlsym(library_, "avcodec_send_packet"));
+#else
+  avcodec_send_packet = &::avcodec_send_packet;
+#endif
+  if (!avcodec_send_packet) {
+    CleanUp(true);
+    return false;
+  }
+
+#if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
+  av_new_packet =
+      reinterpret_cast<decltype(this->av_new_packet)>(
+          dlsym(library_, "av_new_packet"));
+#else
+  av_new_packet = &::av_new_packet;
+#endif
+  if (!av_new_packet) {
+    CleanUp(true);
+    return false;
+  }
+
 #if defined(LIBRARY_LOADER_AVCODEC_LOADER_H_DLOPEN)
   av_packet_alloc =
       reinterpret_cast<decltype(this->av_packet_alloc)>(
@@ -137,11 +185,15 @@ void avcodec::CleanUp(bool unload) {
 #endif
   loaded_ = false;
   avcodec_alloc_context3 = NULL;
+  avcodec_find_decoder = NULL;
   avcodec_find_encoder_by_name = NULL;
   avcodec_free_context = NULL;
   avcodec_open2 = NULL;
+  avcodec_receive_frame = NULL;
   avcodec_receive_packet = NULL;
   avcodec_send_frame = NULL;
+  avcodec_send_packet = NULL;
+  av_new_packet = NULL;
   av_packet_alloc = NULL;
   av_packet_free = NULL;
 
@@ -1,4 +1,5 @@
 #include "CEncoder.h"
+#include "alvr_server/FrameTracer.h"
 
 
 		CEncoder::CEncoder()
@@ -6,6 +7,7 @@
 			, m_targetTimestampNs(0)
 		{
 			m_encodeFinished.Set();
+			SetThreadPolicy("alvr-encoder", Settings::Instance().m_threadPolicy);
 		}
 
 		
@@ -89,6 +91,7 @@
 
 				if (m_FrameRender->GetTexture())
 				{
+					FrameTracer::Instance().Stamp(m_targetTimestampNs, FrameTracer::STAGE_ENCODE_START);
 					m_videoEncoder->Transmit(m_FrameRender->GetTexture().Get(), m_presentationTime, m_targetTimestampNs, m_scheduler.CheckIDRInsertion());
 				}
 
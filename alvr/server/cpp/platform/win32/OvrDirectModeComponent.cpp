@@ -1,4 +1,5 @@
 #include "OvrDirectModeComponent.h"
+#include "alvr_server/FrameTracer.h"
 
 OvrDirectModeComponent::OvrDirectModeComponent(std::shared_ptr<CD3DRender> pD3DRender, std::shared_ptr<PoseHistory> poseHistory)
 	: m_pD3DRender(pD3DRender)
@@ -331,6 +332,7 @@ void OvrDirectModeComponent::CopyTexture(uint32_t layerCount) {
 		      ,m_frameGazeDirection.v[2]
 		);
 		}
+		FrameTracer::Instance().OnPresent(submitFrameIndex);
 		// Copy entire texture to staging so we can read the pixels to send to remote device.
 		m_pEncoder->CopyToStaging(pTexture, bounds,m_frameGazeDirection,layerCount,false, presentationTime, submitFrameIndex,"", debugText);
 
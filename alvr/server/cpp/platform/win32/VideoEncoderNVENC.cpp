@@ -136,7 +136,8 @@ void VideoEncoderNVENC::Transmit(ID3D11Texture2D *pTexture, uint64_t presentatio
 			fpOut.write(reinterpret_cast<char*>(packet.data()), packet.size());
 		}
 		if (m_Listener) {
-			m_Listener->SendVideo(packet.data(), (int)packet.size(), targetTimestampNs);
+			// vPacket is dropped after the call, the sinks can keep the packet
+			m_Listener->SendVideo(std::make_shared<std::vector<uint8_t>>(std::move(packet)), targetTimestampNs);
 		}
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "VideoEncoderSW.h"
 
+#include "ALVR-common/nal_scan.h"
 #include "alvr_server/Statistics.h"
 #include "alvr_server/Logger.h"
 #include "alvr_server/Settings.h"
@@ -103,46 +104,6 @@ void VideoEncoderSW::Shutdown() {
 	Debug("Successfully shutdown VideoEncoderSW.\n");
 }
 
-bool VideoEncoderSW::should_keep_nal_h264(const uint8_t *header_start) {
- 	uint8_t nal_type = (header_start[2] == 0 ? header_start[4] : header_start[3]) & 0x1F;
-    switch (nal_type) {
-		case 6: // supplemental enhancement information
-		case 9: // access unit delimiter
-			return false;
-		default:
-			return true;
-    }
-}
-
-bool VideoEncoderSW::should_keep_nal_h265(const uint8_t *header_start) {
-	uint8_t nal_type = ((header_start[2] == 0 ? header_start[4] : header_start[3]) >> 1) & 0x3F;
-	switch (nal_type) {
-		case 35: // access unit delimiter
-		case 39: // supplemental enhancement information
-		return false;
-		default:
-		return true;
-	}
-}
-
-void VideoEncoderSW::filter_NAL(const uint8_t *input, size_t input_size, std::vector<uint8_t> &out)
-{
-	if (input_size < 4) return;
-	ALVR_CODEC codec = m_codec;
-	std::array<uint8_t, 3> header = {{0, 0, 1}};
-	const uint8_t *end = input + input_size;
-	const uint8_t *header_start = input;
-	while (header_start != end) {
-		const uint8_t *next_header = std::search(header_start + 3, end, header.begin(), header.end());
-		if (next_header != end && next_header[-1] == 0) next_header--;
-		if (codec == ALVR_CODEC_H264 && should_keep_nal_h264(header_start))
-		out.insert(out.end(), header_start, next_header);
-		if (codec == ALVR_CODEC_H265 && should_keep_nal_h265(header_start))
-		out.insert(out.end(), header_start, next_header);
-		header_start = next_header;
-	}
-}
-
 void VideoEncoderSW::Transmit(ID3D11Texture2D *pTexture, uint64_t presentationTime, uint64_t targetTimestampNs, bool insertIDR) {
 	// Handle bitrate changes
 	if(m_Listener->GetStatistics()->CheckBitrateUpdated()) {
@@ -229,10 +190,10 @@ void VideoEncoderSW::Transmit(ID3D11Texture2D *pTexture, uint64_t presentationTi
 		}
 		//Debug("Received encoded packet");
 
-		// Send encoded frame to client
-		std::vector<uint8_t> encoded_data;
-		filter_NAL(packet->data, packet->size, encoded_data);
-		m_Listener->SendVideo(encoded_data.data(), encoded_data.size(), packet->pts);
+		// Send encoded frame to client, SEI and AUD units are dropped inside the packet buffer
+		size_t encodedSize = packet->size;
+		uint8_t *encodedData = FilterNalUnitsInPlace(packet->data, encodedSize, m_codec);
+		m_Listener->SendVideo(encodedData, encodedSize, packet->pts);
 		av_packet_free(&packet);
 		//Debug("Sent encoded packet to client");
 	}
@@ -1,5 +1,6 @@
 //===================== Copyright (c) Valve Corporation. All Rights Reserved. ======================
 #include "threadtools.h"
+#include "alvr_server/Logger.h"
 
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
@@ -20,10 +21,34 @@ void CThread::Start()
 {
 	if ( Init() )
 	{
-		m_pThread = new std::thread( &CThread::Run, this );
+		m_pThread = new std::thread( &CThread::ThreadMain, this );
 	}
 }
 
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+void CThread::SetThreadPolicy( const char *pName, const thread_policy::Policy &policy )
+{
+	m_name = pName;
+	m_policy = policy;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+void CThread::ThreadMain()
+{
+	if ( m_name.empty() )
+	{
+		Run();
+		return;
+	}
+	auto applied = thread_policy::ApplyToCurrentThread( m_name.c_str(), m_policy );
+	Info( "Thread %s: %s scheduling%s\n", m_name.c_str(), thread_policy::SchedulingName( applied.scheduling ),
+		applied.affinity ? ", pinned" : "" );
+	Run();
+	thread_policy::UnregisterCurrentThread();
+}
+
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
 void CThread::Join()
@@ -5,7 +5,9 @@
 //==================================================================================================
 #pragma once
 
+#include <string>
 #include <thread>
+#include "ALVR-common/thread_policy.h"
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -21,8 +23,14 @@ public:
 	virtual void Run() = 0;
 	void Start();
 	void Join();
+	// Applied by the thread itself before Run(), call it before Start().
+	void SetThreadPolicy( const char *pName, const thread_policy::Policy &policy );
 private:
+	void ThreadMain();
+
 	std::thread *m_pThread;
+	std::string m_name;
+	thread_policy::Policy m_policy;
 };
 
 #ifdef _WIN32
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <thread>
+#ifdef __linux__
+#include <errno.h>
+#include <time.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+// Windows 10 1803, missing from older SDKs
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+// Virtual vsync clock shared by the VSyncThread and the vulkan layer display thread.
+// Vsyncs are absolute deadlines on a fixed grid so the sleep error of a frame doesn't add up
+// into the next ones. The thread sleeps to shortly before the deadline (clock_nanosleep on
+// an absolute CLOCK_MONOTONIC time on linux, a high resolution waitable timer on windows) and
+// spins the rest.
+// The grid can be shifted and stretched from the client timing feedback, so server frames
+// complete right before the client's display deadline instead of drifting against it.
+class VSyncGenerator
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::chrono::microseconds SPIN_DURATION{ 200 };
+	// Without a precise sleep (windows before 10 1803, other systems) the sleep granularity is
+	// about a millisecond at best.
+	static constexpr std::chrono::microseconds LOW_RESOLUTION_SPIN_DURATION{ 2000 };
+	// Phase locked loop gains, per feedback sample (one per client frame).
+	static constexpr double PHASE_GAIN = 0.05;
+	static constexpr double PERIOD_GAIN = 0.0001;
+	static constexpr int64_t MAX_PHASE_STEP_NS = 100000;
+	// The client and server refresh rates only differ by the clock drift.
+	static constexpr double MAX_PERIOD_CORRECTION = 0.005;
+
+	explicit VSyncGenerator(double refreshRate) {
+		SetRefreshRate(refreshRate);
+	}
+
+	void SetRefreshRate(double refreshRate) {
+		m_nominalPeriodNs = (int64_t)(1e9 / refreshRate);
+		m_periodCorrectionNs = 0;
+		m_periodNs = m_nominalPeriodNs.load();
+	}
+
+	// Moves the next vsyncs later (positive) or earlier (negative).
+	void ShiftPhase(std::chrono::nanoseconds shift) {
+		m_pendingShiftNs += shift.count();
+	}
+
+	// Client feedback: how long decoded frames waited for their display deadline, against the
+	// wait the client should have as a safety margin. Frames ready too early move the vsync
+	// later, late frames move it earlier, a persistent error corrects the period.
+	void OnClientIdleTime(int64_t idleUs, int64_t targetIdleUs) {
+		const double errorNs = (double)(idleUs - targetIdleUs) * 1000;
+		ShiftPhase(std::chrono::nanoseconds(
+			std::clamp((int64_t)(errorNs * PHASE_GAIN), -MAX_PHASE_STEP_NS, MAX_PHASE_STEP_NS)));
+
+		const double maxCorrection = m_nominalPeriodNs * MAX_PERIOD_CORRECTION;
+		m_periodCorrectionNs = std::clamp(m_periodCorrectionNs + errorNs * PERIOD_GAIN,
+			-maxCorrection, maxCorrection);
+		m_periodNs = m_nominalPeriodNs + (int64_t)m_periodCorrectionNs;
+	}
+
+	// Sleeps until the next vsync and returns its time. Missed vsyncs are skipped, the
+	// following ones stay on the grid. Vsync thread only.
+	Clock::time_point WaitNextVSync() {
+		const auto now = Clock::now();
+		if (m_next == Clock::time_point()) {
+			m_next = now;
+			return m_next;
+		}
+		const auto period = std::chrono::nanoseconds(m_periodNs.load());
+		m_next += period + std::chrono::nanoseconds(m_pendingShiftNs.exchange(0));
+		if (m_next < now) {
+			m_next += (now - m_next) / period * period + period;
+		}
+		SleepUntil(m_next);
+		return m_next;
+	}
+
+	static void SleepUntil(Clock::time_point deadline) {
+#ifdef __linux__
+		const auto wakeup = deadline - SPIN_DURATION;
+		// steady_clock is CLOCK_MONOTONIC
+		const auto wakeupNs = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeup.time_since_epoch()).count();
+		if (wakeupNs > 0) {
+			timespec ts;
+			ts.tv_sec = wakeupNs / 1000000000;
+			ts.tv_nsec = wakeupNs % 1000000000;
+			while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+			}
+		}
+#elif defined(_WIN32)
+		if (HANDLE timer = HighResolutionTimer()) {
+			// Relative due time, negative, in 100 ns units
+			const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - SPIN_DURATION - Clock::now());
+			if (remaining.count() > 0) {
+				LARGE_INTEGER dueTime;
+				dueTime.QuadPart = -(remaining.count() / 100);
+				if (SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+					WaitForSingleObject(timer, INFINITE);
+				}
+			}
+		} else {
+			std::this_thread::sleep_until(deadline - LOW_RESOLUTION_SPIN_DURATION);
+		}
+#else
+		std::this_thread::sleep_until(deadline - LOW_RESOLUTION_SPIN_DURATION);
+#endif
+		while (Clock::now() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
+private:
+#ifdef _WIN32
+	// One per thread, closed when the thread exits. Null if the system has no high resolution
+	// timers.
+	static HANDLE HighResolutionTimer() {
+		struct Timer {
+			HANDLE handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+				TIMER_ALL_ACCESS);
+			~Timer() {
+				if (handle) {
+					CloseHandle(handle);
+				}
+			}
+		};
+		thread_local Timer timer;
+		return timer.handle;
+	}
+#endif
+
+	std::atomic<int64_t> m_nominalPeriodNs{ 0 };
+	std::atomic<int64_t> m_periodNs{ 0 };
+	std::atomic<int64_t> m_pendingShiftNs{ 0 };
+	// feedback thread only
+	double m_periodCorrectionNs = 0;
+	// vsync thread only
+	Clock::time_point m_next;
+};
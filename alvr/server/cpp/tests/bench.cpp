@@ -0,0 +1,518 @@
+// Micro-benchmarks of the CPU hot paths of the client side of the video pipeline, see
+// CMakeLists.txt and bench.h.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bindings.h"
+#include "concurrent_queue.h"
+#include "fec.h"
+#include "fec_frames.h"
+#include "latency_collector.h"
+#include "nal_scan.h"
+#include "reedsolomon/rs.h"
+#include "seqlock_ring.h"
+#include "tracking_codec.h"
+
+// foveation.h takes the OpenXR vector, the bench builds without the OpenXR headers.
+struct XrVector2f {
+	float x;
+	float y;
+};
+#include "foveation.h"
+
+// Baseline of the threaded queue benchmarks, see ALVR_BENCH_MOODYCAMEL in CMakeLists.txt.
+#ifdef BENCH_MOODYCAMEL
+#include <readerwritercircularbuffer.h>
+#endif
+
+namespace {
+	std::string Name(const char *benchmark, size_t frameBytes, int fecPercentage) {
+		return std::string(benchmark) + "/" + std::to_string(frameBytes) + "/" + std::to_string(fecPercentage);
+	}
+
+	const std::vector<size_t> FRAME_SIZES = { 16 * 1024, 128 * 1024, 1024 * 1024 };
+	const std::vector<int> FEC_PERCENTAGES = { 5, 20 };
+
+	// A frame cut in shards as VideoSink::FECSend does for one FEC group, with its parity.
+	struct FecShards {
+		size_t shardPackets;
+		size_t blockSize;
+		size_t dataShards;
+		size_t parityShards;
+		std::vector<std::vector<uint8_t>> shards;
+
+		FecShards(const std::vector<uint8_t> &frame, int fecPercentage, int codec) {
+			shardPackets = codec == ALVR_FEC_CODEC_CAUCHY_GF16
+				? CalculateFECCauchyShardPackets((int)frame.size(), fecPercentage)
+				: CalculateFECShardPackets((int)frame.size(), fecPercentage);
+			blockSize = shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+			dataShards = (frame.size() + blockSize - 1) / blockSize;
+			parityShards = CalculateParityShards((int)dataShards, fecPercentage);
+			shards.assign(dataShards + parityShards, std::vector<uint8_t>(blockSize));
+			for (size_t i = 0; i < dataShards; i++) {
+				size_t begin = i * blockSize;
+				size_t end = std::min(begin + blockSize, frame.size());
+				std::copy(frame.begin() + begin, frame.begin() + end, shards[i].begin());
+			}
+		}
+
+		// Pointers to packet row j of every shard, row 0 is also the start of the whole shards.
+		std::vector<uint8_t *> Pointers(size_t j = 0) {
+			std::vector<uint8_t *> pointers;
+			for (auto &shard : shards) {
+				pointers.push_back(shard.data() + j * ALVR_MAX_VIDEO_BUFFER_SIZE);
+			}
+			return pointers;
+		}
+	};
+
+	void BenchReedSolomon(Bench &bench, std::mt19937 &random) {
+		for (size_t frameSize : FRAME_SIZES) {
+			for (int fecPercentage : FEC_PERCENTAGES) {
+				auto frame = RandomFrame(frameSize, random);
+				FecShards fec(frame, fecPercentage, ALVR_FEC_CODEC_REED_SOLOMON);
+				auto shards = fec.Pointers();
+				int totalShards = (int)shards.size();
+
+				// As the server, the codec is made for every frame.
+				bench.Run(Name("rs_encode", frameSize, fecPercentage), frameSize, [&] {
+					reed_solomon *rs = reed_solomon_new((int)fec.dataShards, (int)fec.parityShards);
+					reed_solomon_encode(rs, shards.data(), totalShards, (int)fec.blockSize);
+					reed_solomon_release(rs);
+				});
+
+				// The first data shards are lost, as many as there are parity shards.
+				std::vector<uint8_t> lostMarks(totalShards, 0);
+				size_t lost = std::min(fec.parityShards, fec.dataShards);
+				std::fill(lostMarks.begin(), lostMarks.begin() + lost, 1);
+				std::vector<uint8_t> marks;
+				bool ran = bench.Run(Name("rs_reconstruct", frameSize, fecPercentage), frameSize, [&] {
+					marks = lostMarks;
+					reed_solomon *rs = reed_solomon_new((int)fec.dataShards, (int)fec.parityShards);
+					int ret = reed_solomon_reconstruct(rs, shards.data(), marks.data(), totalShards, (int)fec.blockSize);
+					reed_solomon_release(rs);
+					CHECK(ret == 0);
+				});
+				CHECK(!ran || memcmp(fec.shards[0].data(), frame.data(), std::min(fec.blockSize, frameSize)) == 0);
+			}
+		}
+	}
+
+	void BenchCauchy16(Bench &bench, std::mt19937 &random) {
+		for (size_t frameSize : FRAME_SIZES) {
+			for (int fecPercentage : FEC_PERCENTAGES) {
+				auto frame = RandomFrame(frameSize, random);
+				FecShards fec(frame, fecPercentage, ALVR_FEC_CODEC_CAUCHY_GF16);
+				std::vector<std::vector<uint8_t *>> rows;
+				for (size_t j = 0; j < fec.shardPackets; j++) {
+					rows.push_back(fec.Pointers(j));
+				}
+
+				bench.Run(Name("cauchy16_encode", frameSize, fecPercentage), frameSize, [&] {
+					for (auto &row : rows) {
+						fec_cauchy16::Encode(row.data(), fec.dataShards, row.data() + fec.dataShards,
+							fec.parityShards, ALVR_MAX_VIDEO_BUFFER_SIZE);
+					}
+				});
+
+				// In every packet row, the first data packets are lost, as many as there are
+				// parity shards.
+				std::vector<uint8_t> marks(fec.dataShards + fec.parityShards, 0);
+				std::fill(marks.begin(), marks.begin() + std::min(fec.parityShards, fec.dataShards), 1);
+				bool ran = bench.Run(Name("cauchy16_reconstruct", frameSize, fecPercentage), frameSize, [&] {
+					for (auto &row : rows) {
+						CHECK(fec_cauchy16::Reconstruct(row.data(), marks.data(), fec.dataShards, fec.parityShards,
+							ALVR_MAX_VIDEO_BUFFER_SIZE));
+					}
+				});
+				CHECK(!ran || memcmp(fec.shards[0].data(), frame.data(), ALVR_MAX_VIDEO_BUFFER_SIZE) == 0);
+			}
+		}
+	}
+
+	void BenchFecQueue(Bench &bench, std::mt19937 &random) {
+		const int fecPercentage = 20;
+		for (size_t frameSize : { (size_t)128 * 1024, (size_t)1024 * 1024 }) {
+			for (int lossPercentage : { 0, 5, 10 }) {
+				FrameBuilder builder;
+				builder.fecPercentage = fecPercentage;
+				auto frame = RandomFrame(frameSize, random);
+				// The same share of every packet row is lost, so the frame stays recoverable.
+				const size_t shardPackets = CalculateFECCauchyShardPackets((int)frameSize, fecPercentage);
+				std::vector<std::vector<Packet>> rows(shardPackets);
+				for (auto &packet : builder.Build(frame, { (uint32_t)frameSize })) {
+					rows[packet.header()->fecIndex % shardPackets].push_back(std::move(packet));
+				}
+				std::vector<Packet> packets;
+				for (auto &row : rows) {
+					std::shuffle(row.begin(), row.end(), random);
+					row.resize(row.size() - row.size() * lossPercentage / 100);
+					std::move(row.begin(), row.end(), std::back_inserter(packets));
+				}
+				std::sort(packets.begin(), packets.end(), [](const Packet &a, const Packet &b) {
+					return a.header()->framePacketIndex < b.header()->framePacketIndex;
+				});
+
+				// A new frame index every time, the queue starts a new frame.
+				FECQueue queue;
+				uint64_t videoFrameIndex = 0;
+				std::string name = "fec_queue/" + std::to_string(frameSize) + "/" + std::to_string(fecPercentage) + "/" +
+					std::to_string(lossPercentage);
+				bool ran = bench.Run(name, frameSize, [&] {
+					videoFrameIndex++;
+					bool fecFailure = false;
+					for (auto &packet : packets) {
+						((VideoFrame *)packet.bytes.data())->videoFrameIndex = videoFrameIndex;
+						queue.addVideoPacket(packet.header(), packet.size(), fecFailure);
+					}
+					CHECK(queue.reconstruct());
+				});
+				CHECK(!ran || memcmp(queue.getFrameBuffer(), frame.data(), frameSize) == 0);
+			}
+		}
+	}
+
+	// H.264 frame as NVENC makes it: AUD, SEI, then the slices.
+	std::vector<uint8_t> MakeH264Frame(size_t size, int slices, std::mt19937 &random) {
+		std::vector<uint8_t> frame = { 0, 0, 0, 1, 0x09, 0xF0 };
+		const uint8_t sei[] = { 0, 0, 0, 1, 0x06, 0x05, 0x10 };
+		frame.insert(frame.end(), sei, sei + sizeof(sei));
+		frame.resize(frame.size() + 32, 0x55);
+		size_t sliceSize = size / slices;
+		for (int i = 0; i < slices; i++) {
+			const uint8_t start[] = { 0, 0, 0, 1, 0x41 };
+			frame.insert(frame.end(), start, start + sizeof(start));
+			// Emulation prevention: the payload never holds two zero bytes in a row.
+			for (size_t j = 0; j < sliceSize; j++) {
+				uint8_t byte = (uint8_t)random();
+				frame.push_back(byte == 0 ? 0x80 : byte);
+			}
+		}
+		return frame;
+	}
+
+	void BenchNalScan(Bench &bench, std::mt19937 &random) {
+		for (size_t frameSize : FRAME_SIZES) {
+			auto frame = MakeH264Frame(frameSize, 8, random);
+			std::vector<uint8_t> out(frame.size());
+			std::string size = std::to_string(frameSize);
+
+			bench.Run("nal_for_each/" + size, frame.size(), [&] {
+				int units = 0;
+				ForEachNalUnit(frame.data(), frame.size(), [&](const uint8_t *, const uint8_t *) { units++; });
+				KeepAlive(units);
+			});
+			bench.Run("nal_filter/" + size, frame.size(), [&] {
+				size_t written = FilterNalUnits(frame.data(), frame.size(), out.data(), ALVR_CODEC_H264);
+				KeepAlive(written);
+			});
+			// The dropped units are in front, the frame is left as is.
+			bench.Run("nal_filter_in_place/" + size, frame.size(), [&] {
+				size_t filtered = frame.size();
+				uint8_t *begin = FilterNalUnitsInPlace(frame.data(), filtered, ALVR_CODEC_H264);
+				KeepAlive(begin);
+			});
+			size_t filtered = frame.size();
+			FilterNalUnitsInPlace(frame.data(), filtered, ALVR_CODEC_H264);
+			CHECK(filtered == FilterNalUnits(frame.data(), frame.size(), out.data(), ALVR_CODEC_H264));
+			CHECK(filtered < frame.size());
+		}
+	}
+
+	// Values a producer (the benchmark thread) hands to a consumer thread per operation, the
+	// queues hold them all.
+	const size_t TRANSFER_BATCH = 256;
+	const size_t QUEUE_CAPACITY = 1024;
+
+	// push(value) and pop() -> value, pop waits for a value. 0 stops the consumer.
+	template <typename Push, typename Pop>
+	void BenchTransfer(Bench &bench, const std::string &name, Push push, Pop pop) {
+		if (!bench.Enabled(name)) {
+			return;
+		}
+		std::atomic<uint64_t> received{ 0 };
+		std::thread consumer([&] {
+			while (uint64_t value = pop()) {
+				// The values are 1, 2, ..., the producer waits for the last one of the batch.
+				if (value % TRANSFER_BATCH == 0) {
+					received.store(value, std::memory_order_release);
+					received.notify_one();
+				}
+			}
+		});
+		uint64_t sent = 0;
+		bench.Run(name, TRANSFER_BATCH * sizeof(uint64_t), [&] {
+			for (size_t i = 0; i < TRANSFER_BATCH; i++) {
+				push(++sent);
+			}
+			for (uint64_t value; (value = received.load(std::memory_order_acquire)) != sent;) {
+				received.wait(value, std::memory_order_acquire);
+			}
+		});
+		push(0);
+		consumer.join();
+	}
+
+	// One producer and one consumer thread, as the decoder and render threads of the client.
+	void BenchThreadedQueues(Bench &bench) {
+		const std::string suffix = "/threaded_" + std::to_string(TRANSFER_BATCH);
+		{
+			auto ring = std::make_unique<xrconcurrency::spsc_ring<uint64_t, QUEUE_CAPACITY>>();
+			BenchTransfer(bench, "spsc_ring" + suffix, [&](uint64_t value) { ring->push(value); }, [&] {
+				uint64_t value;
+				ring->pop(value);
+				return value;
+			});
+		}
+		{
+			auto ring = std::make_unique<xrconcurrency::mpmc_ring<uint64_t, QUEUE_CAPACITY>>();
+			BenchTransfer(bench, "mpmc_ring" + suffix, [&](uint64_t value) { ring->push(value); }, [&] {
+				uint64_t value;
+				ring->pop(value);
+				return value;
+			});
+		}
+		{
+			// No blocking pop, its users poll.
+			xrconcurrency::concurrent_queue<uint64_t> queue;
+			BenchTransfer(bench, "concurrent_queue" + suffix, [&](uint64_t value) { queue.push(value); }, [&] {
+				uint64_t value;
+				while (!queue.try_pop(value)) {
+					std::this_thread::yield();
+				}
+				return value;
+			});
+		}
+#ifdef BENCH_MOODYCAMEL
+		{
+			moodycamel::BlockingReaderWriterCircularBuffer<uint64_t> buffer(QUEUE_CAPACITY);
+			BenchTransfer(bench, "moodycamel_rwcb" + suffix, [&](uint64_t value) { buffer.wait_enqueue(value); }, [&] {
+				uint64_t value;
+				buffer.wait_dequeue(value);
+				return value;
+			});
+		}
+#endif
+	}
+
+	void BenchRings(Bench &bench) {
+		// One push and one pop on the same thread, the cost without contention.
+		{
+			xrconcurrency::spsc_ring<uint64_t, 1024> ring;
+			uint64_t value = 0;
+			bench.Run("spsc_ring/push_pop", 0, [&] {
+				ring.try_push(value + 1);
+				ring.try_pop(value);
+			});
+		}
+		{
+			auto ring = std::make_unique<xrconcurrency::mpmc_ring<uint64_t, 1024>>();
+			uint64_t value = 0;
+			bench.Run("mpmc_ring/push_pop", 0, [&] {
+				ring->try_push(value + 1);
+				ring->try_pop(value);
+			});
+		}
+		{
+			xrconcurrency::concurrent_queue<uint64_t> queue;
+			uint64_t value = 0;
+			bench.Run("concurrent_queue/push_pop", 0, [&] {
+				queue.push(value + 1);
+				queue.try_pop(value);
+			});
+		}
+
+		BenchThreadedQueues(bench);
+
+		// Pose sized entries, as the tracking history.
+		struct Pose {
+			float values[16];
+		};
+		xrconcurrency::seqlock_ring<Pose, 64> ring;
+		Pose pose = {};
+		uint64_t timestamp = 0;
+		for (int i = 0; i < 64; i++) {
+			ring.push(timestamp += 1000, pose);
+		}
+		bench.Run("seqlock_ring/push", sizeof(Pose), [&] {
+			ring.push(timestamp += 1000, pose);
+		});
+		bench.Run("seqlock_ring/latest", sizeof(Pose), [&] {
+			CHECK(ring.latest(pose));
+		});
+		// A pose half way through the history
+		bench.Run("seqlock_ring/find_nearest", sizeof(Pose), [&] {
+			CHECK(ring.find_nearest(timestamp - 32 * 1000 + 300, pose));
+		});
+	}
+
+	TrackingInfo MakeTrackingInfo(bool hands, std::mt19937 &random) {
+		std::uniform_real_distribution<float> unit(-1, 1);
+		auto quat = [&] {
+			TrackingQuat q = { unit(random), unit(random), unit(random), unit(random) };
+			float norm = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+			return TrackingQuat{ q.x / norm, q.y / norm, q.z / norm, q.w / norm };
+		};
+		auto vector = [&] {
+			return TrackingVector3{ unit(random), unit(random), unit(random) };
+		};
+		TrackingInfo info = {};
+		info.targetTimestampNs = 1000000000000ull;
+		info.mounted = 1;
+		info.HeadPose_Pose_Orientation = quat();
+		info.HeadPose_Pose_Position = vector();
+		info.EyeGaze_Pose_Orientation = quat();
+		info.EyeGaze_Direction = vector();
+		for (auto &c : info.controller) {
+			c.enabled = true;
+			c.isHand = hands;
+			c.buttons = random();
+			c.triggerValue = unit(random);
+			c.orientation = quat();
+			c.position = vector();
+			c.angularVelocity = vector();
+			c.linearVelocity = vector();
+			if (hands) {
+				for (int b = 0; b < tracking_codec::BONE_COUNT; b++) {
+					c.boneRotations[b] = quat();
+					c.bonePositionsBase[b] = vector();
+				}
+				c.boneRootOrientation = quat();
+				c.boneRootPosition = vector();
+			}
+		}
+		return info;
+	}
+
+	// One sample per tick, bytes_per_op is the packet size. The delta packets are against the
+	// acknowledged sample with the head and both controllers moved, the fingers still.
+	void BenchTrackingCodec(Bench &bench, std::mt19937 &random) {
+		for (bool hands : { false, true }) {
+			const std::string input = hands ? "hands" : "controllers";
+			const TrackingInfo info = MakeTrackingInfo(hands, random);
+			TrackingInfo moved = info;
+			moved.targetTimestampNs += 11111111;
+			moved.HeadPose_Pose_Orientation = MakeTrackingInfo(false, random).HeadPose_Pose_Orientation;
+			moved.HeadPose_Pose_Position.x += 0.01f;
+			for (auto &c : moved.controller) {
+				c.position.y -= 0.02f;
+				c.linearVelocity.z += 0.1f;
+			}
+
+			tracking_codec::Encoder<TrackingInfo> encoder;
+			std::vector<uint8_t> full;
+			encoder.Encode(info, full);
+			encoder.Acknowledge(info.targetTimestampNs);
+			std::vector<uint8_t> delta;
+			encoder.Encode(moved, delta);
+			CHECK(!(full[1] & tracking_codec::FLAG_DELTA) && (delta[1] & tracking_codec::FLAG_DELTA));
+
+			std::vector<uint8_t> packet;
+			encoder.SetUseDelta(false);
+			bench.Run("tracking_codec/encode_full/" + input, full.size(), [&] {
+				packet.clear();
+				encoder.Encode(moved, packet);
+			});
+			encoder.SetUseDelta(true);
+			// Every encoded sample goes to the history, the reference is encoded again before it
+			// leaves it: one full packet every ENCODER_HISTORY / 2 delta packets.
+			size_t encodedDeltas = 0;
+			bench.Run("tracking_codec/encode_delta/" + input, delta.size(), [&] {
+				if (encodedDeltas++ % (tracking_codec::ENCODER_HISTORY / 2) == 0) {
+					packet.clear();
+					encoder.Encode(info, packet);
+				}
+				packet.clear();
+				encoder.Encode(moved, packet);
+				CHECK(packet[1] & tracking_codec::FLAG_DELTA);
+			});
+
+			tracking_codec::Decoder<TrackingInfo> decoder;
+			TrackingInfo decoded;
+			bench.Run("tracking_codec/decode_full/" + input, full.size(), [&] {
+				CHECK(decoder.Decode(full.data(), full.size(), decoded));
+			});
+			// Same for the decoder history.
+			size_t decodedDeltas = 0;
+			bench.Run("tracking_codec/decode_delta/" + input, delta.size(), [&] {
+				if (decodedDeltas++ % (tracking_codec::DECODER_HISTORY / 2) == 0) {
+					CHECK(decoder.Decode(full.data(), full.size(), decoded));
+				}
+				CHECK(decoder.Decode(delta.data(), delta.size(), decoded));
+			});
+		}
+	}
+
+	// Once per stream start (alxr_set_stream_config). The eye width changes on every call.
+	void BenchFoveation(Bench &bench) {
+		ALXRRenderConfig config = {};
+		config.eyeWidth = 1832;
+		config.eyeHeight = 1920;
+		config.foveationCenterSizeX = 0.4f;
+		config.foveationCenterSizeY = 0.35f;
+		config.foveationCenterShiftX = 0.4f;
+		config.foveationCenterShiftY = 0.1f;
+		config.foveationEdgeRatioX = 4;
+		config.foveationEdgeRatioY = 5;
+		config.enableFoveation = true;
+		bench.Run("foveation/make_decode_params", 0, [&] {
+			config.eyeWidth ^= 32;
+			auto params = ALXR::MakeFoveatedDecodeParams(config);
+			KeepAlive(params);
+		});
+	}
+
+	void FrameTraceStub(const ClientFrameTrace *trace) {
+		KeepAlive(trace->submitted);
+	}
+
+	void BenchLatencyCollector(Bench &bench) {
+		auto &collector = LatencyCollector::Instance();
+		collector.setFrameTraceSend(FrameTraceStub);
+		uint64_t frameIndex = 0;
+		// The stamps of one frame from the pose to the submit.
+		bench.Run("latency_collector/frame", 0, [&] {
+			frameIndex += 11111111;
+			collector.tracking(frameIndex);
+			collector.estimatedSent(frameIndex, 0);
+			collector.receivedFirst(frameIndex);
+			collector.lastPacketReceived(frameIndex);
+			collector.receivedLast(frameIndex);
+			collector.decoderInput(frameIndex);
+			collector.decoderOutput(frameIndex);
+			collector.uploaded(frameIndex);
+			collector.rendered1(frameIndex);
+			collector.rendered2(frameIndex);
+			collector.submit(frameIndex);
+		});
+		collector.setFrameTraceSend(nullptr);
+	}
+}
+
+int main(int argc, char **argv) {
+	Bench bench(argc, argv);
+
+	reed_solomon_init();
+	std::mt19937 random(1);
+	BenchReedSolomon(bench, random);
+	BenchCauchy16(bench, random);
+	BenchFecQueue(bench, random);
+	BenchNalScan(bench, random);
+	BenchRings(bench);
+	BenchTrackingCodec(bench, random);
+	BenchFoveation(bench);
+	BenchLatencyCollector(bench);
+	return 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Harness of the micro-benchmarks, see CMakeLists.txt:
+//   alvr_bench|alvr_server_bench [--min-time=SECONDS] [FILTER]
+// Prints one JSON object per benchmark and line, FILTER keeps the benchmarks whose name contains it.
+
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+template <typename T>
+inline void KeepAlive(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void *sink;
+	sink = &value;
+#endif
+}
+
+class Bench {
+public:
+	double minTimeS = 0.2;
+	std::string filter;
+
+	Bench(int argc, char **argv) {
+		for (int i = 1; i < argc; i++) {
+			if (strncmp(argv[i], "--min-time=", 11) == 0) {
+				minTimeS = atof(argv[i] + 11);
+			} else {
+				filter = argv[i];
+			}
+		}
+	}
+
+	bool Enabled(const std::string &name) const {
+		return filter.empty() || name.find(filter) != std::string::npos;
+	}
+
+	// op is one operation, bytesPerOp the bytes it processes (0 if it doesn't make sense).
+	// Returns false if the benchmark is filtered out.
+	template <typename F>
+	bool Run(const std::string &name, size_t bytesPerOp, F &&op) {
+		if (!Enabled(name)) {
+			return false;
+		}
+		op();
+		uint64_t iterations = 1;
+		while (true) {
+			auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < iterations; i++) {
+				op();
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (seconds >= minTimeS) {
+				double nsPerOp = seconds * 1e9 / iterations;
+				printf("{\"benchmark\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,\"bytes_per_op\":%zu,"
+					"\"mb_per_s\":%.1f}\n", name.c_str(), (unsigned long long)iterations, nsPerOp, bytesPerOp,
+					bytesPerOp * iterations / seconds / 1e6);
+				fflush(stdout);
+				return true;
+			}
+			// Aim a bit over the minimum time with the rate measured so far.
+			double target = seconds > 0 ? iterations * minTimeS * 1.2 / seconds : iterations * 10.;
+			iterations = (uint64_t)std::min(std::max(target, iterations * 2.), iterations * 100.);
+		}
+	}
+};
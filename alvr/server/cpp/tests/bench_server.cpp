@@ -0,0 +1,108 @@
+// Micro-benchmarks of the CPU hot paths of the driver side of the video pipeline, see
+// CMakeLists.txt and bench.h.
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ALVR-common/reedsolomon/rs.h"
+#include "alvr_server/PoseHistory.h"
+#include "alvr_server/Settings.h"
+#include "alvr_server/Statistics.h"
+#include "alvr_server/VideoSink.h"
+#include "alvr_server/bindings.h"
+#include "bench.h"
+#include "check.h"
+
+namespace {
+	uint64_t g_sentBytes = 0;
+
+	void VideoSendStub(unsigned int, VideoFrame, unsigned char *buf, int len) {
+		KeepAlive(buf);
+		g_sentBytes += len;
+	}
+
+	// The sink packetizes and encodes the FEC of every frame, VideoSink::FECSend, and keeps it
+	// for the retransmissions. Without a pacer the packets go straight to VideoSend.
+	void BenchFecSend(Bench &bench, std::mt19937 &random) {
+		auto &settings = Settings::Instance();
+		settings.m_enableFec = true;
+		settings.m_enableUnequalErrorProtection = false;
+		settings.m_uepInterleaveGroups = false;
+		settings.m_enableVideoNack = true;
+		settings.m_videoNackHistoryFrames = 2;
+		settings.m_enableFrameTrace = false;
+		VideoSend = VideoSendStub;
+
+		for (int codec : { ALVR_FEC_CODEC_REED_SOLOMON, ALVR_FEC_CODEC_CAUCHY_GF16 }) {
+			settings.m_fecCodec = codec;
+			for (size_t frameSize : { 16 * 1024, 128 * 1024, 1024 * 1024 }) {
+				auto frame = std::make_shared<std::vector<uint8_t>>(frameSize);
+				for (auto &byte : *frame) {
+					byte = (uint8_t)random();
+				}
+				VideoSink sink(CLIENT_VIDEO_SINK, std::make_shared<Statistics>(), nullptr);
+				VideoFrameStamp stamp = { 0, 0, 1832, 1920 };
+				const std::string name = std::string(codec == ALVR_FEC_CODEC_CAUCHY_GF16 ? "fec_send_cauchy16/" : "fec_send_rs/") +
+					std::to_string(frameSize) + "/" + std::to_string(sink.GetFecPercentage());
+				g_sentBytes = 0;
+				bool ran = bench.Run(name, frameSize, [&] {
+					stamp.targetTimestampNs += 11111111;
+					stamp.videoFrameIndex++;
+					sink.SendVideo(frame->data(), (int)frame->size(), stamp, frame);
+				});
+				// Every frame went out with its parity.
+				CHECK(!ran || g_sentBytes > stamp.videoFrameIndex * frameSize);
+			}
+		}
+	}
+
+	// The encoder threads look up the pose of every frame in the history the pose updates
+	// fill, 360 of them.
+	void BenchPoseHistory(Bench &bench, std::mt19937 &random) {
+		std::normal_distribution<float> normal;
+		auto info = [&](uint64_t timestamp) {
+			TrackingInfo info = {};
+			info.targetTimestampNs = timestamp;
+			auto &q = info.HeadPose_Pose_Orientation;
+			q = { normal(random), normal(random), normal(random), normal(random) };
+			float norm = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+			q = { q.x / norm, q.y / norm, q.z / norm, q.w / norm };
+			return info;
+		};
+
+		PoseHistory history;
+		uint64_t timestamp = 0;
+		for (int i = 0; i < 360; i++) {
+			history.OnPoseUpdated(info(timestamp += 11111111));
+		}
+		TrackingInfo next = info(0);
+		bench.Run("pose_history/on_pose_updated", sizeof(TrackingInfo), [&] {
+			next.targetTimestampNs = timestamp += 11111111;
+			history.OnPoseUpdated(next);
+		});
+
+		// A pose half way through the history
+		const uint64_t middle = timestamp - 180 * 11111111;
+		auto frame = history.GetPoseAt(middle);
+		CHECK(frame);
+		bench.Run("pose_history/get_pose_at", sizeof(TrackingInfo), [&] {
+			KeepAlive(history.GetPoseAt(middle));
+		});
+		const vr::HmdMatrix34_t pose = frame->rotationMatrix;
+		bench.Run("pose_history/get_best_pose_match", sizeof(TrackingInfo), [&] {
+			KeepAlive(history.GetBestPoseMatch(pose));
+		});
+	}
+}
+
+int main(int argc, char **argv) {
+	Bench bench(argc, argv);
+	reed_solomon_init();
+	std::mt19937 random(1);
+	BenchFecSend(bench, random);
+	BenchPoseHistory(bench, random);
+	return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// The tests are plain executables, a failed check ends them with a non zero status.
+#define CHECK(condition)                                                               \
+	do {                                                                               \
+		if (!(condition)) {                                                            \
+			fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+			exit(1);                                                                   \
+		}                                                                              \
+	} while (0)
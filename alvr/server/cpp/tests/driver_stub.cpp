@@ -0,0 +1,11 @@
+#include "alvr_server/Logger.h"
+#include "alvr_server/bindings.h"
+
+// The driver gets these from the Rust side and SteamVR, the benchmarks drop the logs and set the
+// callbacks they use.
+void (*VideoSend)(unsigned int sinkId, VideoFrame header, unsigned char *buf, int len) = nullptr;
+
+void Error(const char *, ...) {}
+void Warn(const char *, ...) {}
+void Info(const char *, ...) {}
+void Debug(const char *, ...) {}
@@ -0,0 +1,140 @@
+#pragma once
+
+// Encoded frames as the server sends them, for the FECQueue test and the benchmarks.
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string.h>
+#include <vector>
+
+#include "packet_types.h"
+#include "fec_cauchy16.h"
+#include "check.h"
+
+inline std::vector<uint8_t> RandomFrame(size_t size, std::mt19937 &random) {
+	std::vector<uint8_t> frame(size);
+	for (auto &byte : frame) {
+		byte = (uint8_t)random();
+	}
+	return frame;
+}
+
+struct Packet {
+	std::vector<uint8_t> bytes;
+
+	const VideoFrame *header() const {
+		return (const VideoFrame *)bytes.data();
+	}
+	int size() const {
+		return (int)bytes.size();
+	}
+};
+
+// Packets of a frame as the server sends them with ALVR_FEC_CODEC_CAUCHY_GF16, by default the groups
+// one after the other, each one data then parity in fecIndex order.
+class FrameBuilder {
+public:
+	int fecPercentage = 50;
+	// Per group, unequal error protection. fecPercentage for every group when empty.
+	std::vector<int> groupFecPercentages;
+	// Group index of each packet in send order from the packet counts of the groups, as
+	// InterleaveFecGroups. The groups one after the other when empty.
+	std::function<std::vector<uint8_t>(const std::vector<size_t> &)> sendOrder;
+	uint32_t packetCounter = 1;
+	uint64_t videoFrameIndex = 0;
+
+	std::vector<Packet> Build(const std::vector<uint8_t> &frame, const std::vector<uint32_t> &groupSizes) {
+		videoFrameIndex++;
+		std::vector<std::vector<Packet>> groupPackets(groupSizes.size());
+		uint32_t offset = 0;
+		for (size_t groupIndex = 0; groupIndex < groupSizes.size(); groupIndex++) {
+			const uint32_t size = groupSizes[groupIndex];
+			const int groupFecPercentage =
+				groupFecPercentages.empty() ? fecPercentage : groupFecPercentages[groupIndex];
+			const size_t shardPackets = CalculateFECCauchyShardPackets(size, groupFecPercentage);
+			const size_t blockSize = shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
+			const size_t dataShards = (size + blockSize - 1) / blockSize;
+			const size_t parityShards = CalculateParityShards(dataShards, groupFecPercentage);
+
+			std::vector<std::vector<uint8_t>> shards(dataShards + parityShards, std::vector<uint8_t>(blockSize));
+			for (size_t i = 0; i < dataShards; i++) {
+				const size_t begin = offset + i * blockSize;
+				const size_t end = std::min<size_t>(begin + blockSize, offset + size);
+				std::copy(frame.begin() + begin, frame.begin() + end, shards[i].begin());
+			}
+			// Packet row by packet row, as the client decodes
+			for (size_t j = 0; j < shardPackets; j++) {
+				std::vector<const uint8_t *> data;
+				std::vector<uint8_t *> parity;
+				for (size_t i = 0; i < shards.size(); i++) {
+					if (i < dataShards) {
+						data.push_back(shards[i].data() + j * ALVR_MAX_VIDEO_BUFFER_SIZE);
+					} else {
+						parity.push_back(shards[i].data() + j * ALVR_MAX_VIDEO_BUFFER_SIZE);
+					}
+				}
+				fec_cauchy16::Encode(data.data(), dataShards, parity.data(), parityShards,
+					ALVR_MAX_VIDEO_BUFFER_SIZE);
+			}
+
+			for (size_t fecIndex = 0; fecIndex < shards.size() * shardPackets; fecIndex++) {
+				// The padding at the end of the last data shard isn't sent.
+				const size_t begin = fecIndex * ALVR_MAX_VIDEO_BUFFER_SIZE;
+				size_t payloadSize = ALVR_MAX_VIDEO_BUFFER_SIZE;
+				if (fecIndex < dataShards * shardPackets) {
+					if (begin >= size) {
+						continue;
+					}
+					payloadSize = std::min<size_t>(payloadSize, size - begin);
+				}
+				VideoFrame header = {};
+				header.type = ALVR_PACKET_TYPE_VIDEO_FRAME;
+				header.videoFrameIndex = videoFrameIndex;
+				header.trackingFrameIndex = videoFrameIndex;
+				header.frameByteSize = (uint32_t)frame.size();
+				header.fecIndex = (uint32_t)fecIndex;
+				header.fecPercentage = groupFecPercentage;
+				header.fecGroupIndex = (uint8_t)groupIndex;
+				header.fecGroupCount = (uint8_t)groupSizes.size();
+				header.fecGroupOffset = offset;
+				header.fecGroupByteSize = size;
+				header.fecCodec = ALVR_FEC_CODEC_CAUCHY_GF16;
+				Packet packet;
+				packet.bytes.resize(sizeof(VideoFrame) + payloadSize);
+				memcpy(packet.bytes.data(), &header, sizeof(header));
+				memcpy(packet.bytes.data() + sizeof(header),
+					&shards[fecIndex / shardPackets][(fecIndex % shardPackets) * ALVR_MAX_VIDEO_BUFFER_SIZE],
+					payloadSize);
+				groupPackets[groupIndex].push_back(std::move(packet));
+			}
+			offset += size;
+		}
+		CHECK(offset == frame.size());
+
+		std::vector<Packet> packets;
+		if (sendOrder) {
+			std::vector<size_t> packetCounts;
+			for (const auto &group : groupPackets) {
+				packetCounts.push_back(group.size());
+			}
+			std::vector<size_t> sent(groupPackets.size());
+			for (uint8_t groupIndex : sendOrder(packetCounts)) {
+				packets.push_back(std::move(groupPackets[groupIndex][sent[groupIndex]++]));
+			}
+		} else {
+			for (auto &group : groupPackets) {
+				for (auto &packet : group) {
+					packets.push_back(std::move(packet));
+				}
+			}
+		}
+		for (size_t i = 0; i < packets.size(); i++) {
+			auto header = (VideoFrame *)packets[i].bytes.data();
+			header->packetCounter = packetCounter++;
+			header->framePacketIndex = (uint32_t)i;
+			header->framePacketCount = (uint32_t)packets.size();
+		}
+		return packets;
+	}
+};
@@ -0,0 +1,18 @@
+#include "alvr_server/Settings.h"
+
+// The driver loads the settings from the session, the tests set the fields they use.
+Settings Settings::m_Instance;
+
+Settings::Settings()
+	: m_loaded(false), m_EnableOffsetPos(false)
+{
+}
+
+Settings::~Settings()
+{
+}
+
+void Settings::Load()
+{
+	m_loaded = true;
+}
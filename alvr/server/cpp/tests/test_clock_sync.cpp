@@ -0,0 +1,122 @@
+#include <cmath>
+#include <random>
+
+#include "ALVR-common/clock_sync.h"
+#include "check.h"
+
+namespace {
+	// Round trips every frame between a local clock and a remote one offset by offsetUs and
+	// running faster by drift, as the TimeSync packets go.
+	struct Link {
+		double offsetUs;
+		double drift;
+		// one way delays without queuing
+		double upUs;
+		double downUs;
+		// mean of the exponential queuing delay in each direction
+		double jitterUs;
+		// probability of a packet delayed by spikeUs more
+		double spikeProbability;
+		double spikeUs;
+	};
+
+	const uint64_t START_US = 1000000000;
+	const uint64_t FRAME_US = 11111;
+
+	double RemoteMinusLocal(const Link &link, double localUs) {
+		return link.offsetUs + link.drift * (localUs - START_US);
+	}
+
+	double Delay(const Link &link, double baseUs, std::mt19937 &random) {
+		std::exponential_distribution<double> queuing(1. / link.jitterUs);
+		std::uniform_real_distribution<double> uniform;
+		double delay = baseUs + queuing(random);
+		if (uniform(random) < link.spikeProbability) {
+			delay += link.spikeUs;
+		}
+		return delay;
+	}
+
+	// Runs the round trips for durationUs, returns the local time at the end. worstSampleUs is
+	// the largest error of a single round trip.
+	uint64_t Simulate(ClockSyncEstimator &estimator, const Link &link, uint64_t startUs, uint64_t durationUs,
+		std::mt19937 &random, double &worstSampleUs) {
+		uint64_t localUs = startUs;
+		for (; localUs < startUs + durationUs; localUs += FRAME_US) {
+			double up = Delay(link, link.upUs, random);
+			double down = Delay(link, link.downUs, random);
+			double remoteUs = localUs + up + RemoteMinusLocal(link, localUs + up);
+			double rtt = up + down;
+			uint64_t receivedUs = localUs + (uint64_t)llround(rtt);
+			// offset = remote + RTT / 2 - local
+			double offset = remoteUs + rtt / 2 - receivedUs;
+			worstSampleUs = std::max(worstSampleUs, std::abs(offset - RemoteMinusLocal(link, (double)receivedUs)));
+			estimator.AddSample(receivedUs, (int64_t)llround(offset), (uint64_t)llround(rtt));
+		}
+		return localUs;
+	}
+
+	double Error(const ClockSyncEstimator &estimator, const Link &link, uint64_t localUs) {
+		return std::abs((double)estimator.GetOffset(localUs) - RemoteMinusLocal(link, (double)localUs));
+	}
+
+	void TestAsymmetricJitter() {
+		std::mt19937 random(1);
+		// Wi-Fi uplink slower than the downlink, queuing of a few ms and a delayed packet every
+		// fifty.
+		Link link = { -3.2e9, 0, 9000, 2000, 3000, 0.02, 40000 };
+		ClockSyncEstimator estimator;
+		double worstSample = 0;
+		uint64_t now = Simulate(estimator, link, START_US, 30000000, random, worstSample);
+
+		const auto &estimate = estimator.GetEstimate();
+		CHECK(estimator.IsValid());
+		// The asymmetry can't be seen from the round trips, it stays within the error bound.
+		const double asymmetry = (link.upUs - link.downUs) / 2;
+		CHECK(Error(estimator, link, now) <= estimate.error);
+		CHECK(Error(estimator, link, now) < std::abs(asymmetry) + 1000);
+		CHECK(estimate.error < (link.upUs + link.downUs) / 2 + 2000);
+		// Single round trips are off by the queuing delays.
+		CHECK(worstSample > std::abs(asymmetry) + 10000);
+		CHECK(std::abs(estimate.drift) < 10e-6);
+		CHECK(estimate.usedSamples > 1);
+	}
+
+	void TestDrift() {
+		std::mt19937 random(2);
+		// 40 ppm apart, symmetric so the offset itself is exact.
+		Link link = { 5e6, 40e-6, 4000, 4000, 2000, 0.01, 30000 };
+		ClockSyncEstimator estimator;
+		double worstSample = 0;
+		uint64_t now = Simulate(estimator, link, START_US, 30000000, random, worstSample);
+
+		const auto &estimate = estimator.GetEstimate();
+		CHECK(std::abs(estimate.drift - link.drift) < 10e-6);
+		CHECK(Error(estimator, link, now) <= estimate.error);
+		CHECK(Error(estimator, link, now) < 1000);
+		// The drift carries the offset a little past the last sample.
+		CHECK(Error(estimator, link, now + 1000000) < 1500);
+	}
+
+	void TestJump() {
+		std::mt19937 random(3);
+		Link link = { 1e6, 0, 3000, 3000, 1000, 0, 0 };
+		ClockSyncEstimator estimator;
+		double worstSample = 0;
+		uint64_t now = Simulate(estimator, link, START_US, 10000000, random, worstSample);
+		CHECK(Error(estimator, link, now) < 1000);
+
+		// Reconnection to a client with another clock, the old samples are dropped.
+		link.offsetUs = -7e6;
+		now = Simulate(estimator, link, now, 2000000, random, worstSample);
+		CHECK(Error(estimator, link, now) <= estimator.GetEstimate().error);
+		CHECK(Error(estimator, link, now) < 1000);
+	}
+}
+
+int main() {
+	TestAsymmetricJitter();
+	TestDrift();
+	TestJump();
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "alvr_server/FecGroups.h"
+#include "fec.h"
+#include "fec_frames.h"
+
+// Frames of unequal error protection groups through a channel with burst losses, sent the groups
+// one after the other and interleaved by InterleaveFecGroups.
+
+namespace {
+	// Two-state Gilbert-Elliott channel: every packet is lost in the bad state.
+	class BurstChannel {
+	public:
+		BurstChannel(double lossRate, double meanBurst, uint32_t seed)
+			: m_random(seed), m_leaveBad(1 / meanBurst), m_enterBad(lossRate * m_leaveBad / (1 - lossRate)) {}
+
+		bool Lost() {
+			// Not a std distribution, their output differs between the standard libraries.
+			const double uniform = (double)m_random() / ((double)std::mt19937::max() + 1);
+			m_bad = uniform < (m_bad ? 1 - m_leaveBad : m_enterBad);
+			return m_bad;
+		}
+
+	private:
+		std::mt19937 m_random;
+		double m_leaveBad;
+		double m_enterBad;
+		bool m_bad = false;
+	};
+
+	const double LOSS_RATE = 0.02;
+	const int FRAMES = 2000;
+
+	// A P-frame with the critical parameter sets, the peripheral slices around the foveal ones.
+	const std::vector<uint32_t> GROUP_SIZES = { 2000, 30000, 55000, 30000 };
+	const std::vector<int> GROUP_FEC_PERCENTAGES = { 20, 2, 5, 2 };
+
+	// Share of the frames recovered, the channel and the frame contents are the same for both
+	// orders.
+	double RecoveredFrames(double meanBurst, bool interleave) {
+		std::mt19937 random(1);
+		const auto frame = RandomFrame(117000, random);
+		FECQueue queue;
+		FrameBuilder builder;
+		builder.groupFecPercentages = GROUP_FEC_PERCENTAGES;
+		if (interleave) {
+			builder.sendOrder = InterleaveFecGroups;
+		}
+		BurstChannel channel(LOSS_RATE, meanBurst, 2);
+
+		int recovered = 0;
+		for (int i = 0; i < FRAMES; i++) {
+			for (const auto &packet : builder.Build(frame, GROUP_SIZES)) {
+				if (!channel.Lost()) {
+					bool fecFailure = false;
+					queue.addVideoPacket(packet.header(), packet.size(), fecFailure);
+				}
+			}
+			if (queue.reconstruct() && memcmp(queue.getFrameBuffer(), frame.data(), frame.size()) == 0) {
+				recovered++;
+			}
+			queue.clearFecFailure();
+		}
+		return (double)recovered / FRAMES;
+	}
+}
+
+int main() {
+	for (double meanBurst : { 1.0, 4.0, 8.0 }) {
+		const double sequential = RecoveredFrames(meanBurst, false);
+		const double interleaved = RecoveredFrames(meanBurst, true);
+		printf("mean burst %.0f: %.1f%% of the frames recovered sequential, %.1f%% interleaved\n", meanBurst,
+			sequential * 100, interleaved * 100);
+		if (meanBurst == 1) {
+			// Independent losses don't care about the order, within the sampling noise.
+			CHECK(interleaved > sequential - 0.03);
+		} else {
+			CHECK(interleaved > sequential + 0.02);
+		}
+	}
+	return 0;
+}
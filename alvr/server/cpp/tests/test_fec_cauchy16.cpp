@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ALVR-common/fec_cauchy16.h"
+#include "check.h"
+
+namespace {
+	// ALVR_MAX_VIDEO_BUFFER_SIZE, a packet is a symbol.
+	const size_t PACKET_BYTES = 1400;
+
+	// dst += c * src with Mul on the element pairing of the header: bytes i and 16 + i of each
+	// 32 byte block, bytes i and h + i of a 2h byte tail.
+	void MulAddReference(uint8_t *dst, const uint8_t *src, uint16_t c, size_t bytes) {
+		for (size_t offset = 0; offset < bytes;) {
+			size_t half = bytes - offset >= 32 ? 16 : (bytes - offset) / 2;
+			for (size_t i = 0; i < half; i++) {
+				uint16_t x = src[offset + i] | (src[offset + half + i] << 8);
+				uint16_t y = fec_cauchy16::Mul(c, x);
+				dst[offset + i] ^= (uint8_t)y;
+				dst[offset + half + i] ^= (uint8_t)(y >> 8);
+			}
+			offset += 2 * half;
+		}
+	}
+
+	void TestField() {
+		std::mt19937 random(1);
+		for (int i = 0; i < 10000; i++) {
+			uint16_t a = (uint16_t)random(), b = (uint16_t)random(), c = (uint16_t)random();
+			CHECK(fec_cauchy16::Mul(a, b) == fec_cauchy16::Mul(b, a));
+			CHECK(fec_cauchy16::Mul(a, b ^ c) == (fec_cauchy16::Mul(a, b) ^ fec_cauchy16::Mul(a, c)));
+			CHECK(fec_cauchy16::Mul(a, 1) == a && fec_cauchy16::Mul(a, 0) == 0);
+			if (a != 0) {
+				CHECK(fec_cauchy16::Mul(a, fec_cauchy16::Inv(a)) == 1);
+			}
+		}
+	}
+
+	// The SIMD paths against the scalar definition, at every length and alignment around the
+	// block sizes.
+	void TestMulAddRegion() {
+		std::mt19937 random(2);
+		std::vector<uint8_t> src(300), dst(300), expected(300);
+		for (size_t bytes = 0; bytes <= 260; bytes += 2) {
+			for (size_t misalign : { 0, 1, 7 }) {
+				for (uint16_t c : { (uint16_t)0, (uint16_t)1, (uint16_t)2, (uint16_t)0x8000, (uint16_t)random(), (uint16_t)random() }) {
+					for (size_t i = 0; i < src.size(); i++) {
+						src[i] = (uint8_t)random();
+						dst[i] = expected[i] = (uint8_t)random();
+					}
+					fec_cauchy16::MulAddRegion(dst.data() + misalign, src.data() + misalign, c, bytes);
+					MulAddReference(expected.data() + misalign, src.data() + misalign, c, bytes);
+					CHECK(dst == expected);
+				}
+			}
+		}
+	}
+
+	struct Codeword {
+		std::vector<std::vector<uint8_t>> shards;
+		std::vector<uint8_t *> pointers;
+
+		Codeword(size_t count, size_t symbolBytes) : shards(count, std::vector<uint8_t>(symbolBytes)) {
+			for (auto &shard : shards) {
+				pointers.push_back(shard.data());
+			}
+		}
+	};
+
+	// Encodes random data, erases up to erasures shards anywhere and rebuilds.
+	bool RoundTrip(size_t dataShards, size_t parityShards, size_t symbolBytes, size_t erasures, std::mt19937 &random) {
+		Codeword codeword(dataShards + parityShards, symbolBytes);
+		for (size_t i = 0; i < dataShards; i++) {
+			for (auto &byte : codeword.shards[i]) {
+				byte = (uint8_t)random();
+			}
+		}
+		std::vector<const uint8_t *> data(codeword.pointers.begin(), codeword.pointers.begin() + dataShards);
+		fec_cauchy16::Encode(data.data(), dataShards, codeword.pointers.data() + dataShards, parityShards, symbolBytes);
+		const auto original = codeword.shards;
+
+		std::vector<size_t> indices(dataShards + parityShards);
+		for (size_t i = 0; i < indices.size(); i++) {
+			indices[i] = i;
+		}
+		std::shuffle(indices.begin(), indices.end(), random);
+		std::vector<uint8_t> marks(indices.size());
+		for (size_t i = 0; i < erasures; i++) {
+			marks[indices[i]] = 1;
+			std::fill(codeword.shards[indices[i]].begin(), codeword.shards[indices[i]].end(), 0xCD);
+		}
+
+		if (!fec_cauchy16::Reconstruct(codeword.pointers.data(), marks.data(), dataShards, parityShards, symbolBytes)) {
+			return false;
+		}
+		for (size_t i = 0; i < dataShards; i++) {
+			CHECK(codeword.shards[i] == original[i]);
+		}
+		return true;
+	}
+
+	void TestRandomErasures() {
+		std::mt19937 random(3);
+		for (int round = 0; round < 400; round++) {
+			size_t dataShards = 1 + random() % 64;
+			size_t parityShards = random() % 33;
+			size_t symbolBytes = round % 4 == 0 ? PACKET_BYTES : 2 * (1 + random() % 100);
+			size_t erasures = random() % (parityShards + 1);
+			// Any dataShards of the shards rebuild the data.
+			CHECK(RoundTrip(dataShards, parityShards, symbolBytes, erasures, random));
+			// One more is too many.
+			if (parityShards < dataShards) {
+				CHECK(!RoundTrip(dataShards, parityShards, symbolBytes, parityShards + 1, random));
+			}
+		}
+		// A group of the size of a large frame
+		CHECK(RoundTrip(1000, 32, PACKET_BYTES, 32, random));
+	}
+
+	// The first parity row is all ones, one parity shard is the XOR of the data.
+	void TestSingleParity() {
+		std::mt19937 random(4);
+		Codeword codeword(6, 64);
+		std::vector<uint8_t> expected(64);
+		for (size_t i = 0; i < 5; i++) {
+			for (size_t b = 0; b < 64; b++) {
+				codeword.shards[i][b] = (uint8_t)random();
+				expected[b] ^= codeword.shards[i][b];
+			}
+		}
+		std::vector<const uint8_t *> data(codeword.pointers.begin(), codeword.pointers.begin() + 5);
+		fec_cauchy16::Encode(data.data(), 5, codeword.pointers.data() + 5, 1, 64);
+		CHECK(codeword.shards[5] == expected);
+	}
+}
+
+int main() {
+	TestField();
+	TestMulAddRegion();
+	TestSingleParity();
+	TestRandomErasures();
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <vector>
+
+#include "alvr_server/FecGroups.h"
+#include "alvr_server/Settings.h"
+#include "check.h"
+
+namespace {
+	const int BASE_FEC_PERCENTAGE = 5;
+	const int CRITICAL_FEC_PERCENTAGE = 20;
+	const int PERIPHERAL_FEC_PERCENTAGE = 2;
+
+	// Returns the offset of the unit.
+	size_t AppendNal(std::vector<uint8_t> &frame, bool longStartCode, std::vector<uint8_t> header,
+		size_t payloadSize) {
+		size_t offset = frame.size();
+		if (longStartCode) {
+			frame.push_back(0);
+		}
+		frame.insert(frame.end(), { 0, 0, 1 });
+		frame.insert(frame.end(), header.begin(), header.end());
+		frame.insert(frame.end(), payloadSize, 0xAA);
+		return offset;
+	}
+
+	void SetUp(ALVR_CODEC codec) {
+		auto &settings = Settings::Instance();
+		settings.m_codec = codec;
+		settings.m_enableUnequalErrorProtection = true;
+		settings.m_uepCriticalFecPercentage = CRITICAL_FEC_PERCENTAGE;
+		settings.m_uepPeripheralFecPercentage = PERIPHERAL_FEC_PERCENTAGE;
+		settings.m_uepFovealBand = 0.5f;
+	}
+
+	void TestH264() {
+		SetUp(ALVR_CODEC_H264);
+		std::vector<uint8_t> frame;
+		AppendNal(frame, true, { 0x67 }, 20); // SPS
+		AppendNal(frame, true, { 0x68 }, 4); // PPS
+		// Four reference slices, nal_ref_idc 2, with both start code lengths: the outer ones are
+		// out of the foveal band.
+		size_t slice0 = AppendNal(frame, true, { 0x41 }, 1000);
+		size_t slice1 = AppendNal(frame, false, { 0x41 }, 1000);
+		AppendNal(frame, true, { 0x41 }, 1000);
+		size_t slice3 = AppendNal(frame, false, { 0x41 }, 1000);
+		// A non-reference slice, nal_ref_idc 0
+		AppendNal(frame, false, { 0x01 }, 1000);
+
+		auto groups = BuildFecGroups(frame.data(), (int)frame.size(), BASE_FEC_PERCENTAGE);
+		CHECK(groups.size() == 4);
+		CHECK(groups[0].offset == 0 && groups[0].size == (int)slice0);
+		CHECK(groups[0].fecPercentage == CRITICAL_FEC_PERCENTAGE);
+		CHECK(groups[1].offset == (int)slice0 && groups[1].size == (int)(slice1 - slice0));
+		CHECK(groups[1].fecPercentage == PERIPHERAL_FEC_PERCENTAGE);
+		CHECK(groups[2].offset == (int)slice1 && groups[2].size == (int)(slice3 - slice1));
+		CHECK(groups[2].fecPercentage == BASE_FEC_PERCENTAGE);
+		// the last reference slice and the non-reference one
+		CHECK(groups[3].offset == (int)slice3 && groups[3].offset + groups[3].size == (int)frame.size());
+		CHECK(groups[3].fecPercentage == PERIPHERAL_FEC_PERCENTAGE);
+	}
+
+	void TestHevc() {
+		SetUp(ALVR_CODEC_H265);
+		std::vector<uint8_t> frame;
+		AppendNal(frame, true, { 32 << 1, 1 }, 20); // VPS
+		// Reserved VCL type 22 (RSV_IRAP_VCL22) is not a slice the groups know about, it stays
+		// critical.
+		AppendNal(frame, true, { 22 << 1, 1 }, 30);
+		size_t slice = AppendNal(frame, true, { 1 << 1, 1 }, 1000); // TRAIL_R
+		size_t nonReference = AppendNal(frame, true, { 0 << 1, 1 }, 1000); // TRAIL_N
+
+		auto groups = BuildFecGroups(frame.data(), (int)frame.size(), BASE_FEC_PERCENTAGE);
+		CHECK(groups.size() == 3);
+		CHECK(groups[0].size == (int)slice);
+		CHECK(groups[0].fecPercentage == CRITICAL_FEC_PERCENTAGE);
+		// the only positional slice covers the whole height
+		CHECK(groups[1].offset == (int)slice && groups[1].size == (int)(nonReference - slice));
+		CHECK(groups[1].fecPercentage == BASE_FEC_PERCENTAGE);
+		CHECK(groups[2].fecPercentage == PERIPHERAL_FEC_PERCENTAGE);
+	}
+
+	void TestDisabled() {
+		SetUp(ALVR_CODEC_H264);
+		Settings::Instance().m_enableUnequalErrorProtection = false;
+		std::vector<uint8_t> frame;
+		AppendNal(frame, true, { 0x41 }, 100);
+		auto groups = BuildFecGroups(frame.data(), (int)frame.size(), BASE_FEC_PERCENTAGE);
+		CHECK(groups.size() == 1);
+		CHECK(groups[0].offset == 0 && groups[0].size == (int)frame.size());
+		CHECK(groups[0].fecPercentage == BASE_FEC_PERCENTAGE);
+	}
+
+	void TestInterleave() {
+		// A single group keeps its order.
+		CHECK(InterleaveFecGroups({ 5 }) == std::vector<uint8_t>(5, 0));
+		// Same sizes alternate.
+		CHECK(InterleaveFecGroups({ 3, 3 }) == std::vector<uint8_t>({ 0, 1, 0, 1, 0, 1 }));
+
+		const std::vector<std::vector<size_t>> cases = {
+			{ 2, 40 }, { 40, 2, 7 }, { 1, 1, 1, 1 }, { 13, 29, 5, 64, 3 }, { 100, 1 } };
+		for (const auto &counts : cases) {
+			size_t total = 0;
+			for (size_t count : counts) {
+				total += count;
+			}
+			auto order = InterleaveFecGroups(counts);
+			CHECK(order.size() == total);
+			// The packets go in the order of their due times (k + 0.5) / count, so every prefix
+			// of the send order holds each group in proportion: within half a packet of its own
+			// due times, and the other groups' rounding moves the prefix by half a packet each.
+			std::vector<size_t> sent(counts.size());
+			for (size_t n = 1; n <= total; n++) {
+				CHECK(order[n - 1] < counts.size());
+				sent[order[n - 1]]++;
+				for (size_t g = 0; g < counts.size(); g++) {
+					double share = (double)n * counts[g] / total;
+					double bound = 0.5 + 0.5 * counts.size() * counts[g] / total + 1e-9;
+					CHECK(std::abs((double)sent[g] - share) <= bound);
+				}
+			}
+			CHECK(sent == counts);
+
+			// So a burst of losses takes about its share of every group.
+			for (size_t burst = 1; burst <= total; burst++) {
+				for (size_t begin = 0; begin + burst <= total; begin++) {
+					std::vector<size_t> lost(counts.size());
+					for (size_t i = begin; i < begin + burst; i++) {
+						lost[order[i]]++;
+					}
+					for (size_t g = 0; g < counts.size(); g++) {
+						double share = (double)burst * counts[g] / total;
+						CHECK(lost[g] <= share + 1 + (double)counts.size() * counts[g] / total + 1e-9);
+					}
+				}
+			}
+		}
+	}
+}
+
+int main() {
+	TestH264();
+	TestHevc();
+	TestDisabled();
+	TestInterleave();
+	return 0;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "fec.h"
+#include "fec_frames.h"
+
+namespace {
+	bool Add(FECQueue &queue, const Packet &packet, FECQueue::Clock::time_point now = FECQueue::Clock::now()) {
+		bool fecFailure = false;
+		queue.addVideoPacket(packet.header(), packet.size(), fecFailure, now);
+		return fecFailure;
+	}
+
+	bool HasRange(const std::vector<VideoNackRange> &ranges, int groupIndex, uint32_t fecIndex, uint32_t count) {
+		for (const auto &range : ranges) {
+			if (range.fecGroupIndex == groupIndex && range.fecIndex == fecIndex && range.count == count) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Matches(const FECQueue &queue, const std::vector<uint8_t> &frame) {
+		return queue.getFrameByteSize() == (int)frame.size() &&
+			memcmp(queue.getFrameBuffer(), frame.data(), frame.size()) == 0;
+	}
+
+	// Group sizes of the frames: 2 data + 1 parity packets, then 4 + 2.
+	const std::vector<uint32_t> GROUPS = { 2000, 5000 };
+	const size_t GROUP0_PACKETS = 3;
+
+	void TestLosses() {
+		std::mt19937 random(1);
+		FECQueue queue;
+		FrameBuilder builder;
+
+		// Every packet
+		auto frame = RandomFrame(7000, random);
+		for (const auto &packet : builder.Build(frame, GROUPS)) {
+			CHECK(!Add(queue, packet));
+		}
+		CHECK(queue.reconstruct());
+		CHECK(Matches(queue, frame));
+
+		// As many packets lost in each group as there are parity packets.
+		frame = RandomFrame(7000, random);
+		auto packets = builder.Build(frame, GROUPS);
+		for (size_t i = 0; i < packets.size(); i++) {
+			if (i != 0 && i != 3 && i != 7) {
+				CHECK(!Add(queue, packets[i]));
+			}
+		}
+		CHECK(queue.reconstruct());
+		CHECK(Matches(queue, frame));
+		CHECK(!queue.fecFailure());
+	}
+
+	void TestFrameLoss() {
+		std::mt19937 random(2);
+		FECQueue queue;
+		FrameBuilder builder;
+		auto frame = RandomFrame(7000, random);
+		for (const auto &packet : builder.Build(frame, GROUPS)) {
+			Add(queue, packet);
+		}
+		CHECK(queue.reconstruct());
+
+		// The last group of the frame never arrives, the next frame still knows where it starts.
+		frame = RandomFrame(7000, random);
+		auto packets = builder.Build(frame, GROUPS);
+		for (size_t i = 0; i < GROUP0_PACKETS; i++) {
+			Add(queue, packets[i]);
+		}
+		CHECK(!queue.reconstruct());
+		frame = RandomFrame(7000, random);
+		packets = builder.Build(frame, GROUPS);
+		// The frame before can't be recovered.
+		CHECK(Add(queue, packets[0]));
+		queue.clearFecFailure();
+		for (size_t i = 1; i < packets.size(); i++) {
+			CHECK(!Add(queue, packets[i]));
+		}
+		CHECK(queue.reconstruct());
+		CHECK(Matches(queue, frame));
+
+		// A whole frame is lost, then the first group of the next one: its second group finds the
+		// gap.
+		builder.Build(RandomFrame(7000, random), GROUPS);
+		packets = builder.Build(RandomFrame(7000, random), GROUPS);
+		CHECK(Add(queue, packets[GROUP0_PACKETS]));
+	}
+
+	void TestNackGroups() {
+		std::mt19937 random(3);
+		FECQueue queue;
+		FrameBuilder builder;
+		uint64_t videoFrameIndex = 0;
+		std::vector<VideoNackRange> ranges;
+
+		// Group 0 never arrives, group 1 recovers: group 0 is asked whole.
+		auto packets = builder.Build(RandomFrame(7000, random), GROUPS);
+		for (size_t i = GROUP0_PACKETS + 1; i < packets.size(); i++) {
+			Add(queue, packets[i]);
+		}
+		CHECK(!queue.reconstruct());
+		CHECK(queue.takeNack(videoFrameIndex, ranges));
+		CHECK(videoFrameIndex == builder.videoFrameIndex);
+		CHECK(ranges.size() == 1);
+		CHECK(HasRange(ranges, 0, 0, UINT32_MAX));
+		// Once per frame
+		CHECK(!queue.takeNack(videoFrameIndex, ranges));
+
+		// Both groups short: only their missing data packets, and only once the last packet came.
+		packets = builder.Build(RandomFrame(7000, random), GROUPS);
+		const std::vector<size_t> lost = { 0, 2, GROUP0_PACKETS + 1, GROUP0_PACKETS + 2, GROUP0_PACKETS + 4 };
+		const auto start = FECQueue::Clock::now();
+		for (size_t i = 0; i + 1 < packets.size(); i++) {
+			if (std::find(lost.begin(), lost.end(), i) == lost.end()) {
+				Add(queue, packets[i], start);
+			}
+		}
+		CHECK(!queue.takeNack(videoFrameIndex, ranges, start));
+		Add(queue, packets.back(), start);
+		CHECK(!queue.reconstruct());
+		CHECK(queue.takeNack(videoFrameIndex, ranges, start));
+		CHECK(ranges.size() == 2);
+		CHECK(HasRange(ranges, 0, 0, 1));
+		CHECK(HasRange(ranges, 1, 1, 2));
+
+		// The retransmissions complete the frame.
+		for (size_t i : { (size_t)0, GROUP0_PACKETS + 1, GROUP0_PACKETS + 2 }) {
+			Packet packet = packets[i];
+			((VideoFrame *)packet.bytes.data())->retransmitted = 1;
+			Add(queue, packet);
+		}
+		CHECK(queue.reconstruct());
+		CHECK(!queue.nackDeadline());
+	}
+
+	void TestNackRows() {
+		std::mt19937 random(4);
+		FECQueue queue;
+		FrameBuilder builder;
+
+		// One group of 50 data shards of 2 packets, 25 parity shards: 25 packets of a row can be
+		// lost.
+		const uint32_t size = 100 * ALVR_MAX_VIDEO_BUFFER_SIZE - 500;
+		CHECK(CalculateFECCauchyShardPackets(size, builder.fecPercentage) == 2);
+		auto packets = builder.Build(RandomFrame(size, random), { size });
+		CHECK(packets.size() == 150);
+
+		// Row 0 misses 26 data packets, row 1 misses one it can repair.
+		for (size_t i = 0; i < packets.size(); i++) {
+			const uint32_t fecIndex = packets[i].header()->fecIndex;
+			const bool row0Lost = fecIndex % 2 == 0 && fecIndex / 2 < 26;
+			if (!row0Lost && fecIndex != 61) {
+				Add(queue, packets[i]);
+			}
+		}
+		CHECK(!queue.reconstruct());
+		uint64_t videoFrameIndex = 0;
+		std::vector<VideoNackRange> ranges;
+		CHECK(queue.takeNack(videoFrameIndex, ranges));
+		CHECK(ranges.size() == 26);
+		for (uint32_t shard = 0; shard < 26; shard++) {
+			CHECK(HasRange(ranges, 0, shard * 2, 1));
+		}
+	}
+
+	void TestNackTimer() {
+		std::mt19937 random(5);
+		FECQueue queue;
+		FrameBuilder builder;
+		const auto interval = std::chrono::microseconds(100);
+
+		// A data packet of group 1 and its last two packets, its parity, are lost: without the
+		// last packet the gap is only found at the expected end of the frame.
+		auto packets = builder.Build(RandomFrame(7000, random), GROUPS);
+		CHECK(packets.size() == 9);
+		const auto start = FECQueue::Clock::now();
+		for (size_t i = 0; i < 7; i++) {
+			if (i != GROUP0_PACKETS + 1) {
+				Add(queue, packets[i], start + (int64_t)i * interval);
+			}
+		}
+		CHECK(!queue.reconstruct());
+		// The packet 6 came at 6 intervals, 2 are left, plus the margins.
+		const auto deadline = start + 6 * interval + (2 + FECQueue::NACK_MARGIN_PACKETS) * interval +
+			FECQueue::NACK_MARGIN;
+		CHECK(queue.nackDeadline() == deadline);
+
+		uint64_t videoFrameIndex = 0;
+		std::vector<VideoNackRange> ranges;
+		CHECK(!queue.takeNack(videoFrameIndex, ranges, deadline - std::chrono::microseconds(1)));
+		CHECK(queue.takeNack(videoFrameIndex, ranges, deadline));
+		CHECK(ranges.size() == 1);
+		CHECK(HasRange(ranges, 1, 1, 1));
+		CHECK(!queue.nackDeadline());
+	}
+}
+
+int main() {
+	TestLosses();
+	TestFrameLoss();
+	TestNackGroups();
+	TestNackRows();
+	TestNackTimer();
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "alvr_server/FramePacer.h"
+#include "alvr_server/Settings.h"
+#include "shared/vsync_generator.h"
+#include "check.h"
+
+// Closed loop of the frame pacing: the server renders on the virtual vsync, the frame goes
+// through the pipeline latencies of a timing trace and waits for the client display deadline.
+// The client idle time goes back to FramePacer and steers the vsync phase with the gains of
+// VSyncGenerator::OnClientIdleTime.
+// A trace recorded from a session (encode, transport and decode latency in us per frame, comma
+// separated, one frame per line) can be replayed with: test_frame_pacer trace.csv
+namespace {
+	const int REFRESH_RATE = 90;
+	const double FRAME_US = 1e6 / REFRESH_RATE;
+	const size_t WARMUP_FRAMES = 1000;
+	const size_t RECENT_FRAMES = 50;
+
+	struct FrameTiming {
+		double encodeUs;
+		double transportUs;
+		double decodeUs;
+	};
+
+	struct Result {
+		double idleAverageUs = 0;
+		double missRate = 0;
+		uint64_t targetIdleUs = 0;
+		float poseTimeOffset = 0;
+		double totalAverageUs = 0;
+		// The pose offset follows the last frames.
+		double recentTotalUs = 0;
+	};
+
+	// A steady link, and Wi-Fi with a burst of retries every couple of seconds.
+	std::vector<FrameTiming> GenerateTrace(bool bursty, size_t frames, std::mt19937 &random) {
+		std::normal_distribution<double> encode(4000, 300);
+		std::normal_distribution<double> decode(3000, 200);
+		std::exponential_distribution<double> queuing(1. / 500);
+		std::vector<FrameTiming> trace;
+		for (size_t i = 0; i < frames; i++) {
+			double transport = 3000 + queuing(random);
+			if (bursty && i % 200 < 20) {
+				transport += 3000 + queuing(random) * 4;
+			}
+			trace.push_back({ std::max(encode(random), 0.), transport, std::max(decode(random), 0.) });
+		}
+		return trace;
+	}
+
+	std::vector<FrameTiming> LoadTrace(const char *path) {
+		std::vector<FrameTiming> trace;
+		std::ifstream file(path);
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream fields(line);
+			FrameTiming timing;
+			char comma;
+			if (fields >> timing.encodeUs >> comma >> timing.transportUs >> comma >> timing.decodeUs) {
+				trace.push_back(timing);
+			}
+		}
+		return trace;
+	}
+
+	Result Replay(const std::vector<FrameTiming> &trace, bool phaseControlled) {
+		FramePacer pacer;
+		pacer.SetPhaseControlled(phaseControlled);
+
+		// Render start of frame k is k * FRAME_US + phase, it's displayed on the client at
+		// (k + slotOffset) * FRAME_US. The first frames wait a whole frame in the client queue.
+		double phaseUs = 0;
+		const double firstLatency = trace[0].encodeUs + trace[0].transportUs + trace[0].decodeUs;
+		const int64_t slotOffset = (int64_t)(firstLatency / FRAME_US) + 1;
+
+		Result result;
+		size_t measured = 0;
+		size_t missed = 0;
+		for (size_t k = 0; k < trace.size(); k++) {
+			const auto &timing = trace[k];
+			const double pipeline = timing.encodeUs + timing.transportUs + timing.decodeUs;
+			const double readyUs = k * FRAME_US + phaseUs + pipeline;
+			const double deadlineUs = (k + slotOffset) * FRAME_US;
+			// A late frame goes out on the next display, the client reports no wait.
+			const bool late = readyUs > deadlineUs;
+			const double idleUs = late ? 0 : deadlineUs - readyUs;
+			const double totalUs = deadlineUs + (late ? FRAME_US : 0) - (k * FRAME_US + phaseUs);
+
+			pacer.OnClientTiming((uint64_t)timing.encodeUs, (uint64_t)timing.transportUs,
+				(uint64_t)timing.decodeUs, (uint64_t)idleUs, (uint64_t)totalUs);
+			if (phaseControlled) {
+				const double errorUs = idleUs - (double)pacer.GetTargetIdleTime();
+				const double maxStepUs = VSyncGenerator::MAX_PHASE_STEP_NS / 1000.;
+				phaseUs += std::clamp(errorUs * VSyncGenerator::PHASE_GAIN, -maxStepUs, maxStepUs);
+			}
+
+			if (k + RECENT_FRAMES >= trace.size()) {
+				result.recentTotalUs += totalUs / RECENT_FRAMES;
+			}
+			if (k >= WARMUP_FRAMES) {
+				measured++;
+				missed += late ? 1 : 0;
+				result.idleAverageUs += idleUs;
+				result.totalAverageUs += totalUs;
+			}
+		}
+		result.idleAverageUs /= measured;
+		result.totalAverageUs /= measured;
+		result.missRate = (double)missed / measured;
+		result.targetIdleUs = pacer.GetTargetIdleTime();
+		result.poseTimeOffset = pacer.GetPoseTimeOffset();
+		return result;
+	}
+
+	void Check(const std::vector<FrameTiming> &trace, double maxMissRate) {
+		Result free = Replay(trace, false);
+		Result paced = Replay(trace, true);
+		printf("idle %.0f us -> %.0f us (target %llu us), missed %.2f%% -> %.2f%%, pose offset %.1f ms\n",
+			free.idleAverageUs, paced.idleAverageUs, (unsigned long long)paced.targetIdleUs,
+			free.missRate * 100, paced.missRate * 100, paced.poseTimeOffset * 1000);
+
+		CHECK(paced.targetIdleUs >= FramePacer::MIN_TARGET_IDLE_US);
+		CHECK(paced.targetIdleUs <= FRAME_US / 2);
+		// The frames don't wait a frame on the client anymore.
+		CHECK(paced.idleAverageUs < free.idleAverageUs - FRAME_US / 2);
+		CHECK(paced.idleAverageUs < paced.targetIdleUs + 1500);
+		CHECK(paced.missRate <= maxMissRate);
+		// The pose is predicted for the latency the frames actually have.
+		CHECK(std::abs(-paced.poseTimeOffset * 1e6 - paced.recentTotalUs) < 1500);
+		CHECK(std::abs(-free.poseTimeOffset * 1e6 - free.recentTotalUs) < 1500);
+	}
+}
+
+int main(int argc, char **argv) {
+	Settings::Instance().m_refreshRate = REFRESH_RATE;
+	if (argc > 1) {
+		auto trace = LoadTrace(argv[1]);
+		CHECK(trace.size() > WARMUP_FRAMES);
+		Check(trace, 0.05);
+		return 0;
+	}
+	std::mt19937 random(1);
+	Check(GenerateTrace(false, 20000, random), 0.03);
+	Check(GenerateTrace(true, 20000, random), 0.04);
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <random>
+#include <vector>
+
+#include "ALVR-common/nal_scan.h"
+#include "check.h"
+
+namespace {
+	// Byte by byte reference of FindStartCode.
+	const uint8_t *FindStartCodeNaive(const uint8_t *begin, const uint8_t *end) {
+		for (const uint8_t *p = begin; end - p >= 3; p++) {
+			if (p[0] == 0 && p[1] == 0 && p[2] == 1) {
+				return p;
+			}
+		}
+		return end;
+	}
+
+	void AppendNal(std::vector<uint8_t> &frame, bool longStartCode, uint8_t header, size_t payloadSize,
+		std::mt19937 &random) {
+		if (longStartCode) {
+			frame.push_back(0);
+		}
+		frame.insert(frame.end(), { 0, 0, 1, header });
+		for (size_t i = 0; i < payloadSize; i++) {
+			// no emulated start code in the payload
+			frame.push_back((uint8_t)(random() % 255 + 1));
+		}
+	}
+
+	void TestFindStartCode() {
+		std::mt19937 random(1);
+		// Sparse zeros and ones so every SIMD lane position and the tail get matches.
+		for (int round = 0; round < 2000; round++) {
+			std::vector<uint8_t> data(random() % 200);
+			for (auto &byte : data) {
+				int r = random() % 8;
+				byte = r < 4 ? 0 : r == 4 ? 1 : (uint8_t)random();
+			}
+			const uint8_t *begin = data.data();
+			const uint8_t *end = begin + data.size();
+			for (const uint8_t *p = begin; p <= end; p++) {
+				CHECK(FindStartCode(p, end) == FindStartCodeNaive(p, end));
+			}
+		}
+	}
+
+	void TestForEachNalUnit() {
+		std::mt19937 random(2);
+		std::vector<uint8_t> frame = { 0xAB, 0xCD }; // garbage before the first start code
+		AppendNal(frame, true, 0x67, 10, random);
+		AppendNal(frame, false, 0x68, 3, random);
+		AppendNal(frame, true, 0x65, 100, random);
+
+		std::vector<std::pair<size_t, size_t>> units;
+		ForEachNalUnit(frame.data(), frame.size(), [&](const uint8_t *begin, const uint8_t *end) {
+			units.push_back({ (size_t)(begin - frame.data()), (size_t)(end - begin) });
+		});
+		CHECK(units.size() == 4);
+		CHECK(units[0].first == 0 && units[0].second == 2);
+		CHECK(units[1].first == 2 && units[1].second == 4 + 1 + 10);
+		CHECK(units[2].second == 3 + 1 + 3);
+		CHECK(units[3].first + units[3].second == frame.size());
+
+		// The units start at the start code, the header follows it.
+		const uint8_t *unit = frame.data() + units[1].first;
+		CHECK(GetNalUnitHeader(unit, unit + units[1].second) == unit + 4);
+		CHECK(GetNalUnitType(unit, unit + units[1].second, ALVR_CODEC_H264) == 7);
+		unit = frame.data() + units[2].first;
+		CHECK(GetNalUnitHeader(unit, unit + units[2].second) == unit + 3);
+		CHECK(GetNalUnitType(unit, unit + units[2].second, ALVR_CODEC_H264) == 8);
+		CHECK(GetNalUnitType(frame.data(), frame.data() + 2, ALVR_CODEC_H264) == -1);
+	}
+
+	void TestFilterInPlace(ALVR_CODEC codec, uint8_t sei, uint8_t aud, uint8_t slice) {
+		std::mt19937 random(3);
+		for (int round = 0; round < 200; round++) {
+			std::vector<uint8_t> frame;
+			int units = random() % 8;
+			for (int i = 0; i < units; i++) {
+				uint8_t types[] = { sei, aud, slice };
+				AppendNal(frame, random() % 2, types[random() % 3], random() % 64, random);
+			}
+
+			std::vector<uint8_t> copied(frame.size());
+			copied.resize(FilterNalUnits(frame.data(), frame.size(), copied.data(), codec));
+
+			size_t size = frame.size();
+			uint8_t *begin = FilterNalUnitsInPlace(frame.data(), size, codec);
+			CHECK(size == copied.size());
+			CHECK(std::vector<uint8_t>(begin, begin + size) == copied);
+			ForEachNalUnit(begin, size, [&](const uint8_t *nalBegin, const uint8_t *nalEnd) {
+				CHECK(!IsDroppableNalUnit(nalBegin, nalEnd, codec));
+			});
+		}
+	}
+
+	void TestFindConfigNalUnitsEnd() {
+		std::mt19937 random(4);
+		std::vector<uint8_t> frame;
+		AppendNal(frame, true, 0x40, 20, random); // VPS
+		AppendNal(frame, true, 0x42, 30, random); // SPS
+		AppendNal(frame, false, 0x44, 5, random); // PPS
+		size_t configEnd = frame.size();
+		AppendNal(frame, true, 0x26, 200, random); // IDR slice
+		CHECK(FindConfigNalUnitsEnd(frame.data(), frame.size(), ALVR_CODEC_H265) == (int)configEnd);
+		CHECK(FindConfigNalUnitsEnd(frame.data(), configEnd, ALVR_CODEC_H265) == -1);
+	}
+}
+
+int main() {
+	TestFindStartCode();
+	TestForEachNalUnit();
+	TestFilterInPlace(ALVR_CODEC_H264, 0x06, 0x09, 0x41);
+	TestFilterInPlace(ALVR_CODEC_H265, 35 << 1, 39 << 1, 1 << 1);
+	TestFindConfigNalUnitsEnd();
+	return 0;
+}
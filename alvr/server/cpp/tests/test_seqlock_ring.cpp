@@ -0,0 +1,116 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "seqlock_ring.h"
+#include "check.h"
+
+namespace {
+	// Larger than a word so a torn read shows up as fields that don't agree.
+	struct Pose {
+		uint64_t timestamp;
+		uint64_t words[6];
+	};
+
+	Pose MakePose(uint64_t timestamp) {
+		Pose pose;
+		pose.timestamp = timestamp;
+		for (int i = 0; i < 6; i++) {
+			pose.words[i] = timestamp * (i + 3);
+		}
+		return pose;
+	}
+
+	bool Consistent(const Pose &pose) {
+		for (int i = 0; i < 6; i++) {
+			if (pose.words[i] != pose.timestamp * (i + 3)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void TestLookup() {
+		xrconcurrency::seqlock_ring<Pose, 8> ring;
+		Pose pose;
+		uint64_t found;
+		CHECK(!ring.latest(pose));
+		CHECK(!ring.find_nearest(100, pose));
+
+		// Timestamps 100, 110 ... 300, the ring keeps the last 8 (230 to 300).
+		for (uint64_t t = 100; t <= 300; t += 10) {
+			ring.push(t, MakePose(t));
+		}
+		CHECK(ring.latest(pose, &found));
+		CHECK(found == 300 && pose.timestamp == 300 && Consistent(pose));
+
+		CHECK(ring.find_nearest(250, pose, &found));
+		CHECK(found == 250 && pose.timestamp == 250);
+		// Between two entries
+		CHECK(ring.find_nearest(263, pose, &found));
+		CHECK(found == 260);
+		CHECK(ring.find_nearest(267, pose, &found));
+		CHECK(found == 270);
+		// Evicted: the oldest one left, not the newest.
+		CHECK(ring.find_nearest(120, pose, &found));
+		CHECK(found == 230 && pose.timestamp == 230 && Consistent(pose));
+		// From the future
+		CHECK(ring.find_nearest(1000, pose, &found));
+		CHECK(found == 300);
+	}
+
+	// One writer at full speed against readers doing lookups, every value read has to be one
+	// that was pushed, whole.
+	void TestConcurrent() {
+		xrconcurrency::seqlock_ring<Pose, 16> ring;
+		// Until the readers did enough lookups, however the threads get scheduled.
+		const uint64_t LOOKUPS = 300000;
+		std::atomic<uint64_t> lookups{ 0 };
+		std::atomic<bool> done{ false };
+		std::atomic<bool> failed{ false };
+
+		std::vector<std::thread> readers;
+		for (int r = 0; r < 3; r++) {
+			readers.emplace_back([&, r] {
+				uint64_t lastLatest = 0;
+				uint64_t query = 0;
+				while (!done.load(std::memory_order_acquire)) {
+					Pose pose;
+					uint64_t found;
+					if (ring.latest(pose, &found)) {
+						if (!Consistent(pose) || pose.timestamp != found || found < lastLatest) {
+							failed = true;
+						}
+						lastLatest = found;
+						lookups.fetch_add(1, std::memory_order_relaxed);
+						// Somewhere in the last entries, exact or not.
+						query = found - (query % 40) + r;
+						if (!ring.find_nearest(query, pose, &found) || !Consistent(pose) ||
+							pose.timestamp != found) {
+							failed = true;
+						}
+					}
+				}
+			});
+		}
+		uint64_t pushes = 0;
+		while (lookups.load(std::memory_order_relaxed) < LOOKUPS) {
+			// Every other timestamp, so the odd queries fall between entries.
+			pushes++;
+			ring.push(pushes * 2, MakePose(pushes * 2));
+		}
+		done.store(true, std::memory_order_release);
+		for (auto &reader : readers) {
+			reader.join();
+		}
+		CHECK(!failed);
+		Pose pose;
+		CHECK(ring.latest(pose) && pose.timestamp == pushes * 2);
+	}
+}
+
+int main() {
+	TestLookup();
+	TestConcurrent();
+	return 0;
+}
@@ -0,0 +1,214 @@
+#include <random>
+#include <vector>
+
+#include "alvr_server/bindings.h"
+#include "ALVR-common/tracking_codec.h"
+#include "check.h"
+
+namespace {
+	// Rotation angle between two unit quaternions, q and -q are the same rotation. From the
+	// chord rather than acos of the dot product, which loses the small angles to rounding.
+	double Angle(const TrackingQuat &a, const TrackingQuat &b) {
+		double dot = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z + (double)a.w * b.w;
+		double sign = dot < 0 ? -1 : 1;
+		double dx = a.x - sign * b.x, dy = a.y - sign * b.y, dz = a.z - sign * b.z, dw = a.w - sign * b.w;
+		return 4 * std::asin(std::min(std::sqrt(dx * dx + dy * dy + dz * dz + dw * dw) / 2, 1.));
+	}
+
+	double Distance(const TrackingVector3 &a, const TrackingVector3 &b) {
+		return std::max({ std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z) });
+	}
+
+	TrackingQuat RandomQuat(std::mt19937 &random) {
+		std::normal_distribution<float> normal;
+		TrackingQuat q = { normal(random), normal(random), normal(random), normal(random) };
+		float norm = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		return { q.x / norm, q.y / norm, q.z / norm, q.w / norm };
+	}
+
+	TrackingVector3 RandomVector(float range, std::mt19937 &random) {
+		std::uniform_real_distribution<float> uniform(-range, range);
+		return { uniform(random), uniform(random), uniform(random) };
+	}
+
+	TrackingInfo RandomInfo(bool gaze, bool hand, std::mt19937 &random) {
+		std::uniform_real_distribution<float> unit(0, 1);
+		TrackingInfo info = {};
+		info.targetTimestampNs = 1000000000000ull + random();
+		info.mounted = 1;
+		info.HeadPose_Pose_Orientation = RandomQuat(random);
+		info.HeadPose_Pose_Position = RandomVector(3, random);
+		if (gaze) {
+			info.EyeGaze_Pose_Orientation = RandomQuat(random);
+			auto direction = RandomVector(1, random);
+			float norm = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+			info.EyeGaze_Direction = { direction.x / norm, direction.y / norm, direction.z / norm };
+		}
+		// The second controller is off.
+		auto &c = info.controller[0];
+		c.enabled = true;
+		c.isHand = hand;
+		c.buttons = ((uint64_t)random() << 32) | random();
+		c.trackpadPosition.x = unit(random) * 2 - 1;
+		c.trackpadPosition.y = unit(random) * 2 - 1;
+		c.triggerValue = unit(random);
+		c.gripValue = unit(random);
+		c.orientation = RandomQuat(random);
+		c.position = RandomVector(3, random);
+		c.angularVelocity = RandomVector(20, random);
+		c.linearVelocity = RandomVector(5, random);
+		if (hand) {
+			for (int b = 0; b < tracking_codec::BONE_COUNT; b++) {
+				c.boneRotations[b] = RandomQuat(random);
+				c.bonePositionsBase[b] = RandomVector(0.2f, random);
+			}
+			c.boneRootOrientation = RandomQuat(random);
+			c.boneRootPosition = RandomVector(3, random);
+			c.handFingerConfidences = random();
+		}
+		return info;
+	}
+
+	// Errors of the quantization steps, with some room for the float rounding.
+	const double HIGH_QUAT_ANGLE = 2e-4;
+	const double LOW_QUAT_ANGLE = 5e-3;
+	const double POSITION_ERROR = 0.5 / tracking_codec::POSITION_SCALE + 1e-6;
+	const double VELOCITY_ERROR = 0.5 / tracking_codec::VELOCITY_SCALE + 1e-5;
+	const double UNIT_ERROR = 0.5 / tracking_codec::UNIT_SCALE + 1e-6;
+
+	void CheckClose(const TrackingInfo &a, const TrackingInfo &b) {
+		CHECK(a.targetTimestampNs == b.targetTimestampNs);
+		CHECK(a.mounted == b.mounted);
+		CHECK(Angle(a.HeadPose_Pose_Orientation, b.HeadPose_Pose_Orientation) < HIGH_QUAT_ANGLE);
+		CHECK(Distance(a.HeadPose_Pose_Position, b.HeadPose_Pose_Position) < POSITION_ERROR);
+		const auto &gaze = a.EyeGaze_Pose_Orientation;
+		if (gaze.x != 0 || gaze.y != 0 || gaze.z != 0 || gaze.w != 0) {
+			CHECK(Angle(gaze, b.EyeGaze_Pose_Orientation) < HIGH_QUAT_ANGLE);
+		} else {
+			CHECK(b.EyeGaze_Pose_Orientation.w == 0);
+		}
+		CHECK(Distance(a.EyeGaze_Direction, b.EyeGaze_Direction) < UNIT_ERROR);
+		for (int i = 0; i < 2; i++) {
+			const auto &ca = a.controller[i];
+			const auto &cb = b.controller[i];
+			CHECK(ca.enabled == cb.enabled);
+			if (!ca.enabled) {
+				// absent, zeroed
+				CHECK(cb.buttons == 0 && cb.position.x == 0 && cb.orientation.w == 0);
+				continue;
+			}
+			CHECK(ca.isHand == cb.isHand);
+			CHECK(ca.buttons == cb.buttons);
+			CHECK(std::abs(ca.trackpadPosition.x - cb.trackpadPosition.x) < UNIT_ERROR);
+			CHECK(std::abs(ca.trackpadPosition.y - cb.trackpadPosition.y) < UNIT_ERROR);
+			CHECK(std::abs(ca.triggerValue - cb.triggerValue) < UNIT_ERROR);
+			CHECK(std::abs(ca.gripValue - cb.gripValue) < UNIT_ERROR);
+			CHECK(Angle(ca.orientation, cb.orientation) < HIGH_QUAT_ANGLE);
+			CHECK(Distance(ca.position, cb.position) < POSITION_ERROR);
+			CHECK(Distance(ca.angularVelocity, cb.angularVelocity) < VELOCITY_ERROR);
+			CHECK(Distance(ca.linearVelocity, cb.linearVelocity) < VELOCITY_ERROR);
+			if (!ca.isHand) {
+				continue;
+			}
+			for (int bone = 0; bone < tracking_codec::BONE_COUNT; bone++) {
+				CHECK(Angle(ca.boneRotations[bone], cb.boneRotations[bone]) < LOW_QUAT_ANGLE);
+				CHECK(Distance(ca.bonePositionsBase[bone], cb.bonePositionsBase[bone]) < POSITION_ERROR);
+			}
+			CHECK(Angle(ca.boneRootOrientation, cb.boneRootOrientation) < HIGH_QUAT_ANGLE);
+			CHECK(Distance(ca.boneRootPosition, cb.boneRootPosition) < POSITION_ERROR);
+			CHECK(ca.handFingerConfidences == cb.handFingerConfidences);
+		}
+	}
+
+	void TestRoundTrip() {
+		std::mt19937 random(1);
+		tracking_codec::Encoder<TrackingInfo> encoder;
+		tracking_codec::Decoder<TrackingInfo> decoder;
+		for (int round = 0; round < 1000; round++) {
+			TrackingInfo info = RandomInfo(round % 2 == 0, round % 3 == 0, random);
+			std::vector<uint8_t> packet;
+			encoder.Encode(info, packet);
+			// Nothing acknowledged, full packets.
+			CHECK(!(packet[1] & tracking_codec::FLAG_DELTA));
+			CHECK(packet.size() < sizeof(TrackingInfo) / 2);
+			TrackingInfo decoded;
+			CHECK(decoder.Decode(packet.data(), packet.size(), decoded));
+			CheckClose(info, decoded);
+			// Truncated packets are rejected.
+			CHECK(!decoder.Decode(packet.data(), packet.size() / 2, decoded));
+		}
+	}
+
+	void TestDelta() {
+		std::mt19937 random(2);
+		tracking_codec::Encoder<TrackingInfo> encoder;
+		tracking_codec::Decoder<TrackingInfo> decoder;
+		TrackingInfo info = RandomInfo(true, true, random);
+		std::vector<uint8_t> full;
+		encoder.Encode(info, full);
+		TrackingInfo decoded;
+		CHECK(decoder.Decode(full.data(), full.size(), decoded));
+		encoder.Acknowledge(info.targetTimestampNs);
+
+		for (int frame = 1; frame <= 20; frame++) {
+			// The head moves, the hand stays still.
+			TrackingInfo next = info;
+			next.targetTimestampNs += frame * 11111111ull;
+			next.HeadPose_Pose_Orientation = RandomQuat(random);
+			next.HeadPose_Pose_Position.x += 0.001f * frame;
+			next.controller[0].position.y -= 0.002f * frame;
+
+			std::vector<uint8_t> delta;
+			encoder.Encode(next, delta);
+			CHECK(delta[1] & tracking_codec::FLAG_DELTA);
+			CHECK(delta.size() * 4 < full.size());
+			TrackingInfo decodedDelta;
+			CHECK(decoder.Decode(delta.data(), delta.size(), decodedDelta));
+			CheckClose(next, decodedDelta);
+
+			// Same result as a full packet of the sample.
+			tracking_codec::Decoder<TrackingInfo> fullDecoder;
+			std::vector<uint8_t> packet;
+			tracking_codec::Encoder<TrackingInfo>().Encode(next, packet);
+			TrackingInfo decodedFull;
+			CHECK(fullDecoder.Decode(packet.data(), packet.size(), decodedFull));
+			CHECK(memcmp(&decodedFull, &decodedDelta, sizeof(TrackingInfo)) == 0);
+		}
+
+		// A decoder which doesn't know the reference rejects the delta packets.
+		TrackingInfo next = info;
+		next.targetTimestampNs += 1000;
+		std::vector<uint8_t> delta;
+		encoder.Encode(next, delta);
+		tracking_codec::Decoder<TrackingInfo> other;
+		CHECK(!other.Decode(delta.data(), delta.size(), decoded));
+		// Another presence can't be coded against the reference.
+		next.controller[1] = next.controller[0];
+		std::vector<uint8_t> packet;
+		encoder.Encode(next, packet);
+		CHECK(!(packet[1] & tracking_codec::FLAG_DELTA));
+		CHECK(other.Decode(packet.data(), packet.size(), decoded));
+		CheckClose(next, decoded);
+
+		// With the gaze and both hands every element is present, the last changed bit is in the
+		// last byte.
+		auto sample = tracking_codec::Quantize(next);
+		size_t count = 0;
+		tracking_codec::ForEachElement(sample, [&](tracking_codec::ElementType, void *) { count++; });
+		CHECK(count == tracking_codec::MAX_ELEMENTS);
+		encoder.Acknowledge(next.targetTimestampNs);
+		next.targetTimestampNs += 1000;
+		next.controller[1].handFingerConfidences ^= 1;
+		delta.clear();
+		encoder.Encode(next, delta);
+		CHECK(delta[1] & tracking_codec::FLAG_DELTA);
+		CHECK(other.Decode(delta.data(), delta.size(), decoded));
+		CheckClose(next, decoded);
+	}
+}
+
+int main() {
+	TestRoundTrip();
+	TestDelta();
+	return 0;
+}
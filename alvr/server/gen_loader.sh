@@ -23,7 +23,7 @@ mkdir -p cpp/platform/linux/generated
 	--output-h cpp/platform/linux/generated/avcodec_loader.h \
 	--header '<libavcodec/avcodec.h>' \
 	--use-extern-c \
-	avcodec_alloc_context3 avcodec_find_encoder_by_name avcodec_free_context avcodec_open2 avcodec_receive_packet avcodec_send_frame av_packet_alloc av_packet_free
+	avcodec_alloc_context3 avcodec_find_decoder avcodec_find_encoder_by_name avcodec_free_context avcodec_open2 avcodec_receive_frame avcodec_receive_packet avcodec_send_frame avcodec_send_packet av_new_packet av_packet_alloc av_packet_free
 
 ./generate_library_loader.py \
 	--name avfilter \
@@ -42,4 +42,4 @@ mkdir -p cpp/platform/linux/generated
 	--output-h cpp/platform/linux/generated/swscale_loader.h \
 	--header '<libswscale/swscale.h>' \
 	--use-extern-c \
-	sws_getContext sws_scale
+	sws_freeContext sws_getContext sws_scale
@@ -1,7 +1,8 @@
 use crate::{
     connection_utils, ClientListAction, EyeFov, TimeSync, TrackingInfo, TrackingInfo_Controller,
     TrackingInfo_Controller__bindgen_ty_1, TrackingQuat, TrackingVector3, CLIENTS_UPDATED_NOTIFIER,
-    HAPTICS_SENDER, RESTART_NOTIFIER, SESSION_MANAGER, TIME_SYNC_SENDER, VIDEO_SENDER,
+    FILESYSTEM_LAYOUT, HAPTICS_SENDER, RESTART_NOTIFIER, SESSION_MANAGER, STREAM_CLOSED_NOTIFIER,
+    TIME_SYNC_SENDER, VIDEO_SENDERS,
 };
 use alvr_audio::{AudioDevice, AudioDeviceType};
 use alvr_common::{
@@ -12,12 +13,15 @@ use alvr_common::{
     HEAD_ID, EYE_GAZE_ID,LEFT_HAND_ID, RIGHT_HAND_ID,
 };
 use alvr_session::{
-    CodecType, FrameSize, OpenvrConfig, OpenvrPropValue, OpenvrPropertyKey, ServerEvent,
+    CodecType, FecCodec, FrameSize, OpenvrConfig, OpenvrPropValue, OpenvrPropertyKey, ServerEvent,
+    SocketProtocol,
 };
 use alvr_sockets::{
     spawn_cancelable, ClientConfigPacket, ClientControlPacket, ControlSocketReceiver,
     ControlSocketSender, HeadsetInfoPacket, Input, PeerType, ProtoControlSocket,
-    ServerControlPacket, StreamSocketBuilder, AUDIO, HAPTICS, INPUT, VIDEO,
+    ServerControlPacket, StreamSender, StreamSocketBuilder, VideoFrameHeaderPacket,
+    VideoNackPacket, AUDIO, CLIENT_FEATURE_DYNAMIC_RESOLUTION, COMPACT_INPUT, GAZE, HAPTICS, INPUT,
+    VIDEO,
 };
 use futures::future::{BoxFuture, Either};
 use settings_schema::Switch;
@@ -26,7 +30,10 @@ use std::{
     net::IpAddr,
     process::Command,
     str::FromStr,
-    sync::{mpsc as smpsc, Arc},
+    sync::{
+        atomic::{AtomicBool, AtomicU32, Ordering},
+        mpsc as smpsc, Arc,
+    },
     thread,
     time::Duration,
 };
@@ -40,6 +47,11 @@ const RETRY_CONNECT_MIN_INTERVAL: Duration = Duration::from_secs(1);
 const NETWORK_KEEPALIVE_INTERVAL: Duration = Duration::from_secs(1);
 const CLEANUP_PAUSE: Duration = Duration::from_millis(500);
 
+// Spectators can join only while the client streams
+static CLIENT_STREAMING: AtomicBool = AtomicBool::new(false);
+static SPECTATOR_COUNT: AtomicU32 = AtomicU32::new(0);
+static NEXT_SPECTATOR_SINK: AtomicU32 = AtomicU32::new(crate::CLIENT_VIDEO_SINK + 1);
+
 fn align32(value: f32) -> u32 {
     ((value / 32.).floor() * 32.) as u32
 }
@@ -90,21 +102,18 @@ struct ConnectionInfo {
     control_receiver: ControlSocketReceiver<ClientControlPacket>,
 }
 
-async fn client_handshake(
-    trusted_discovered_client_id: Option<ClientId>,
-) -> StrResult<ConnectionInfo> {
-    let client_ips = if let Some(id) = trusted_discovered_client_id {
-        vec![id.ip]
-    } else {
-        SESSION_MANAGER.lock().get().client_connections.iter().fold(
-            Vec::new(),
-            |mut clients_info, (_, client)| {
-                clients_info.extend(client.manual_ips.clone());
-                clients_info
-            },
-        )
-    };
+fn manual_client_ips() -> Vec<IpAddr> {
+    SESSION_MANAGER.lock().get().client_connections.iter().fold(
+        Vec::new(),
+        |mut clients_info, (_, client)| {
+            clients_info.extend(client.manual_ips.clone());
+            clients_info
+        },
+    )
+}
 
+// A spectator gets the stream the client set up: no driver restart and no audio
+async fn client_handshake(client_ips: Vec<IpAddr>, spectator: bool) -> StrResult<ConnectionInfo> {
     let (mut proto_socket, client_ip) = loop {
         if let Ok(pair) =
             ProtoControlSocket::connect_to(PeerType::AnyClient(client_ips.clone())).await
@@ -119,6 +128,14 @@ async fn client_handshake(
     let (headset_info, server_ip) =
         trace_err!(proto_socket.recv::<(HeadsetInfoPacket, IpAddr)>().await)?;
 
+    let mut reserved = headset_info.reserved.split_whitespace();
+    let version = reserved
+        .next()
+        .and_then(|version| Version::from_str(version).ok());
+    let client_features = reserved.collect::<Vec<_>>();
+    // The Android client keeps a fixed size decoder surface
+    let dynamic_resolution_supported = client_features.contains(&CLIENT_FEATURE_DYNAMIC_RESOLUTION);
+
     let settings = SESSION_MANAGER.lock().get().to_settings();
 
     let (eye_width, eye_height) = match settings.video.render_resolution {
@@ -154,20 +171,38 @@ async fn client_handshake(
         best_match
     };
 
-    if !headset_info
-        .available_refresh_rates
-        .contains(&settings.video.preferred_fps)
+    if !spectator
+        && !headset_info
+            .available_refresh_rates
+            .contains(&settings.video.preferred_fps)
     {
         warn!("Chosen refresh rate not supported. Using {fps}Hz");
     }
 
+    let (video_eye_width, video_eye_height, fps) = if spectator {
+        let session_manager = SESSION_MANAGER.lock();
+        let config = &session_manager.get().openvr_config;
+        if config.enable_dynamic_resolution && !dynamic_resolution_supported {
+            // Its decoder would break on the first level change
+            return fmt_e!("The spectator doesn't support the dynamic resolution of the stream");
+        }
+        (
+            config.eye_resolution_width,
+            config.eye_resolution_height,
+            config.refresh_rate as f32,
+        )
+    } else {
+        (video_eye_width, video_eye_height, fps)
+    };
+
     let dashboard_url = format!(
         "http://{server_ip}:{}/",
         settings.connection.web_server_port
     );
 
-    let game_audio_sample_rate = if let Switch::Enabled(game_audio_desc) = settings.audio.game_audio
-    {
+    let game_audio_sample_rate = if spectator {
+        0
+    } else if let Switch::Enabled(game_audio_desc) = settings.audio.game_audio {
         let game_audio_device = AudioDevice::new(
             settings.audio.linux_backend,
             game_audio_desc.device_id,
@@ -191,8 +226,6 @@ async fn client_handshake(
         0
     };
 
-    let version = Version::from_str(&headset_info.reserved).ok();
-
     let client_config = ClientConfigPacket {
         session_desc: {
             let mut session = SESSION_MANAGER.lock().get().clone();
@@ -216,6 +249,10 @@ async fn client_handshake(
 
     let session_settings = SESSION_MANAGER.lock().get().session_settings.clone();
 
+    if session_settings.video.dynamic_resolution.enabled && !dynamic_resolution_supported {
+        warn!("The client doesn't support dynamic resolution, the video stays at full resolution");
+    }
+
     let controller_pose_offset = match settings.headset.controllers {
         Switch::Enabled(content) => {
             if content.clientside_prediction {
@@ -250,6 +287,7 @@ async fn client_handshake(
         refresh_rate: fps as _,
         use_10bit_encoder: settings.video.use_10bit_encoder,
         sw_thread_count: settings.video.sw_thread_count,
+        skip_static_frames: settings.video.skip_static_frames,
         encode_bitrate_mbs: settings.video.encode_bitrate_mbs,
         enable_adaptive_bitrate: session_settings.video.adaptive_bitrate.enabled,
         bitrate_maximum: session_settings
@@ -302,6 +340,59 @@ async fn client_handshake(
             .adaptive_bitrate
             .content
             .bitrate_light_load_threshold,
+        enable_dynamic_resolution: session_settings.video.dynamic_resolution.enabled
+            && dynamic_resolution_supported,
+        dynamic_resolution_levels: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .level_count,
+        dynamic_resolution_min_scale: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .minimum_scale,
+        dynamic_resolution_load_high: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .encode_load_high_threshold,
+        dynamic_resolution_load_low: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .encode_load_low_threshold,
+        dynamic_resolution_bitrate_low: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .bitrate_low_threshold,
+        dynamic_resolution_interval_ms: session_settings
+            .video
+            .dynamic_resolution
+            .content
+            .switch_interval_ms,
+        enable_quality_probe: session_settings.video.quality_probe.enabled,
+        quality_probe_interval: session_settings.video.quality_probe.content.frame_interval,
+        quality_probe_sample_step: session_settings.video.quality_probe.content.sample_step,
+        quality_probe_gaze_radius: session_settings.video.quality_probe.content.gaze_radius,
+        enable_thread_policy: session_settings.video.thread_policy.enabled,
+        thread_realtime_priority: session_settings
+            .video
+            .thread_policy
+            .content
+            .realtime_priority,
+        thread_deadline_scheduler: session_settings
+            .video
+            .thread_policy
+            .content
+            .deadline_scheduler,
+        thread_cpu_affinity: session_settings
+            .video
+            .thread_policy
+            .content
+            .cpu_affinity
+            .clone(),
         controllers_tracking_system_name: session_settings
             .headset
             .controllers
@@ -460,10 +551,53 @@ async fn client_handshake(
         gamma: session_settings.video.color_correction.content.gamma,
         sharpening: session_settings.video.color_correction.content.sharpening,
         enable_fec: session_settings.connection.enable_fec,
+        fec_codec: matches!(session_settings.connection.fec_codec, FecCodec::CauchyGf16) as _,
+        enable_unequal_error_protection: session_settings
+            .connection
+            .unequal_error_protection
+            .enabled,
+        uep_critical_fec_percentage: session_settings
+            .connection
+            .unequal_error_protection
+            .content
+            .critical_fec_percentage,
+        uep_peripheral_fec_percentage: session_settings
+            .connection
+            .unequal_error_protection
+            .content
+            .peripheral_fec_percentage,
+        uep_foveal_band: session_settings
+            .connection
+            .unequal_error_protection
+            .content
+            .foveal_band,
+        uep_interleave_groups: session_settings
+            .connection
+            .unequal_error_protection
+            .content
+            .interleave_groups,
+        enable_video_pacing: session_settings.connection.video_pacing.enabled,
+        video_pacing_frame_budget: session_settings
+            .connection
+            .video_pacing
+            .content
+            .frame_budget,
+        enable_video_nack: session_settings.connection.video_nack.enabled,
+        video_nack_history_frames: session_settings
+            .connection
+            .video_nack
+            .content
+            .history_frames,
+        video_nack_deadline: session_settings.connection.video_nack.content.deadline,
+        enable_frame_trace: session_settings.connection.frame_trace,
+        frame_trace_path: FILESYSTEM_LAYOUT
+            .frame_trace()
+            .to_string_lossy()
+            .to_string(),
         linux_async_reprojection: session_settings.extra.patches.linux_async_reprojection,
     };
 
-    if SESSION_MANAGER.lock().get().openvr_config != new_openvr_config {
+    if !spectator && SESSION_MANAGER.lock().get().openvr_config != new_openvr_config {
         SESSION_MANAGER.lock().get_mut().openvr_config = new_openvr_config;
 
         control_sender
@@ -490,6 +624,9 @@ struct StreamCloseGuard;
 
 impl Drop for StreamCloseGuard {
     fn drop(&mut self) {
+        CLIENT_STREAMING.store(false, Ordering::Relaxed);
+        STREAM_CLOSED_NOTIFIER.notify_waiters();
+
         unsafe { crate::DeinitializeStreaming() };
 
         let settings = SESSION_MANAGER.lock().get().to_settings();
@@ -507,6 +644,47 @@ impl Drop for StreamCloseGuard {
     }
 }
 
+// The sink is registered right away, before the loop is polled: the frames sent by C++ in between
+// are queued instead of lost
+fn video_send_loop(
+    mut socket_sender: StreamSender<VideoFrameHeaderPacket>,
+    sink_id: u32,
+) -> impl future::Future<Output = StrResult> {
+    let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
+    VIDEO_SENDERS
+        .lock()
+        .insert(sink_id, (socket_sender.buffer_factory(), data_sender));
+
+    async move {
+        while let Some(buffer) = data_receiver.recv().await {
+            socket_sender.send_buffer(buffer).await.ok();
+        }
+
+        Ok(())
+    }
+}
+
+fn video_nack_receive(sink_id: u32, nack: VideoNackPacket) {
+    let ranges = nack
+        .ranges
+        .iter()
+        .map(|range| crate::VideoNackRange {
+            fecGroupIndex: range.fec_group_index,
+            fecIndex: range.fec_index,
+            count: range.count,
+        })
+        .collect::<Vec<_>>();
+
+    unsafe {
+        crate::VideoNackReceive(
+            sink_id,
+            nack.video_frame_index,
+            ranges.as_ptr(),
+            ranges.len() as _,
+        )
+    };
+}
+
 async fn connection_pipeline() -> StrResult {
     let mut trusted_discovered_client_id = None;
     let connection_info = loop {
@@ -524,7 +702,7 @@ async fn connection_pipeline() -> StrResult {
                 Box::pin(async move {
                     let either = futures::future::select(
                         Box::pin(client_discovery(config.auto_trust_clients)),
-                        Box::pin(client_handshake(None)),
+                        Box::pin(client_handshake(manual_client_ips(), false)),
                     )
                     .await;
 
@@ -535,7 +713,12 @@ async fn connection_pipeline() -> StrResult {
                 })
             } else {
                 Box::pin(async {
-                    Either::Right(client_handshake(trusted_discovered_client_id.clone()).await)
+                    let client_ips = if let Some(id) = &trusted_discovered_client_id {
+                        vec![id.ip]
+                    } else {
+                        manual_client_ips()
+                    };
+                    Either::Right(client_handshake(client_ips, false).await)
                 })
             };
 
@@ -622,6 +805,7 @@ async fn connection_pipeline() -> StrResult {
 
     unsafe { crate::InitializeStreaming() };
     let _stream_guard = StreamCloseGuard;
+    CLIENT_STREAMING.store(true, Ordering::Relaxed);
 
     let game_audio_loop: BoxFuture<_> = if let Switch::Enabled(desc) = settings.audio.game_audio {
         let device = AudioDevice::new(
@@ -715,21 +899,10 @@ async fn connection_pipeline() -> StrResult {
         Box::pin(future::pending())
     };
 
-    let video_send_loop = {
-        let mut socket_sender = stream_socket.request_stream(VIDEO).await?;
-        async move {
-            let (data_sender, mut data_receiver) = tmpsc::unbounded_channel();
-            *VIDEO_SENDER.lock() = Some(data_sender);
-
-            while let Some((header, data)) = data_receiver.recv().await {
-                let mut buffer = socket_sender.new_buffer(&header, data.len())?;
-                buffer.get_mut().extend(data);
-                socket_sender.send_buffer(buffer).await.ok();
-            }
-
-            Ok(())
-        }
-    };
+    let video_send_loop = video_send_loop(
+        stream_socket.request_stream(VIDEO).await?,
+        crate::CLIENT_VIDEO_SINK,
+    );
 
     let time_sync_send_loop = {
         let control_sender = Arc::clone(&control_sender);
@@ -934,6 +1107,31 @@ async fn connection_pipeline() -> StrResult {
         }
     };
 
+    // Clients sending the compact tracking format, decoded on the C++ side
+    let compact_input_receive_loop = {
+        let mut receiver = stream_socket
+            .subscribe_to_stream::<()>(COMPACT_INPUT)
+            .await?;
+        async move {
+            loop {
+                let packet = receiver.recv().await?;
+                unsafe {
+                    crate::InputReceiveCompact(packet.buffer.as_ptr(), packet.buffer.len() as _)
+                };
+            }
+        }
+    };
+
+    let gaze_receive_loop = {
+        let mut receiver = stream_socket.subscribe_to_stream::<()>(GAZE).await?;
+        async move {
+            loop {
+                let packet = receiver.recv().await?;
+                unsafe { crate::GazeReceive(packet.buffer.as_ptr(), packet.buffer.len() as _) };
+            }
+        }
+    };
+
     let (playspace_sync_sender, playspace_sync_receiver) = smpsc::channel::<Vec2>();
 
     let is_tracking_ref_only = settings.headset.tracking_ref_only;
@@ -975,7 +1173,9 @@ async fn connection_pipeline() -> StrResult {
                         playspace_sync_sender.send(packet).ok();
                     }
                 }
-                Ok(ClientControlPacket::RequestIdr) => unsafe { crate::RequestIDR() },
+                Ok(ClientControlPacket::RequestIdr) => unsafe {
+                    crate::RequestIDR(crate::CLIENT_VIDEO_SINK)
+                },
                 Ok(ClientControlPacket::TimeSync(data)) => {
                     let time_sync = TimeSync {
                         mode: data.mode,
@@ -1000,8 +1200,11 @@ async fn connection_pipeline() -> StrResult {
                     unsafe { crate::TimeSyncReceive(time_sync) };
                 }
                 Ok(ClientControlPacket::VideoErrorReport) => unsafe {
-                    crate::VideoErrorReportReceive()
+                    crate::VideoErrorReportReceive(crate::CLIENT_VIDEO_SINK)
                 },
+                Ok(ClientControlPacket::VideoNack(nack)) => {
+                    video_nack_receive(crate::CLIENT_VIDEO_SINK, nack)
+                }
                 Ok(ClientControlPacket::ViewsConfig(config)) => unsafe {
                     crate::SetViewsConfig(crate::ViewsConfigData {
                         fov: [
@@ -1024,6 +1227,21 @@ async fn connection_pipeline() -> StrResult {
                 Ok(ClientControlPacket::Battery(packet)) => unsafe {
                     crate::SetBattery(packet.device_id, packet.gauge_value, packet.is_plugged);
                 },
+                Ok(ClientControlPacket::FrameTrace(trace)) => unsafe {
+                    crate::FrameTraceReceive(crate::ClientFrameTrace {
+                        trackingFrameIndex: trace.tracking_frame_index,
+                        poseSent: trace.pose_sent,
+                        firstPacketReceived: trace.first_packet_received,
+                        lastPacketReceived: trace.last_packet_received,
+                        reconstructed: trace.reconstructed,
+                        decoderInput: trace.decoder_input,
+                        decoderOutput: trace.decoder_output,
+                        uploaded: trace.uploaded,
+                        renderStart: trace.render_start,
+                        renderEnd: trace.render_end,
+                        submitted: trace.submitted,
+                    });
+                },
                 Ok(_) => (),
                 Err(e) => {
                     alvr_session::log_event(ServerEvent::ClientDisconnected);
@@ -1054,6 +1272,8 @@ async fn connection_pipeline() -> StrResult {
         res = spawn_cancelable(time_sync_send_loop) => res,
         res = spawn_cancelable(haptics_send_loop) => res,
         res = spawn_cancelable(input_receive_loop) => res,
+        res = spawn_cancelable(compact_input_receive_loop) => res,
+        res = spawn_cancelable(gaze_receive_loop) => res,
 
         // Leave these loops on the current task
         res = keepalive_loop => res,
@@ -1072,6 +1292,170 @@ async fn connection_pipeline() -> StrResult {
     }
 }
 
+// remove the spectator video sink on Drop (disconnection or execution canceling)
+struct SpectatorSinkGuard(u32);
+
+impl Drop for SpectatorSinkGuard {
+    fn drop(&mut self) {
+        unsafe { crate::RemoveVideoSink(self.0) };
+        VIDEO_SENDERS.lock().remove(&self.0);
+    }
+}
+
+async fn spectator_handshake() -> StrResult<ConnectionInfo> {
+    let client_discovery_config = SESSION_MANAGER
+        .lock()
+        .get()
+        .to_settings()
+        .connection
+        .client_discovery;
+
+    if let Switch::Enabled(config) = client_discovery_config {
+        let either = futures::future::select(
+            Box::pin(client_discovery(config.auto_trust_clients)),
+            Box::pin(client_handshake(manual_client_ips(), true)),
+        )
+        .await;
+
+        match either {
+            Either::Left((client_id, _)) => client_handshake(vec![client_id?.ip], true).await,
+            Either::Right((res, _)) => res,
+        }
+    } else {
+        client_handshake(manual_client_ips(), true).await
+    }
+}
+
+// A spectator gets the video encoded for the client, packetized with its own FEC. It can ask for
+// IDRs and report losses, anything else it sends is ignored.
+async fn spectator_pipeline(connection_info: ConnectionInfo) -> StrResult {
+    let ConnectionInfo {
+        client_ip,
+        version: _,
+        mut control_sender,
+        mut control_receiver,
+    } = connection_info;
+
+    control_sender
+        .send(&ServerControlPacket::StartStream)
+        .await?;
+
+    match control_receiver.recv().await {
+        Ok(ClientControlPacket::StreamReady) => {}
+        Ok(_) => {
+            return fmt_e!("Got unexpected packet waiting for spectator stream ack");
+        }
+        Err(e) => {
+            return fmt_e!("Error while waiting for spectator stream ack: {e}");
+        }
+    }
+
+    let settings = SESSION_MANAGER.lock().get().to_settings();
+
+    let stream_socket = tokio::select! {
+        res = StreamSocketBuilder::connect_to_client(
+            client_ip,
+            settings.connection.stream_port,
+            settings.connection.stream_protocol,
+            mbits_to_bytes(settings.video.encode_bitrate_mbs)
+        ) => res?,
+        _ = time::sleep(Duration::from_secs(5)) => {
+            return fmt_e!("Timeout while setting up spectator streams");
+        }
+    };
+    let stream_socket = Arc::new(stream_socket);
+
+    let sink_id = NEXT_SPECTATOR_SINK.fetch_add(1, Ordering::Relaxed);
+    let video_send_loop = video_send_loop(stream_socket.request_stream(VIDEO).await?, sink_id);
+    unsafe { crate::AddVideoSink(sink_id) };
+    let _sink_guard = SpectatorSinkGuard(sink_id);
+
+    info!("Spectator {client_ip} connected");
+
+    let keepalive_loop = async move {
+        while CLIENT_STREAMING.load(Ordering::Relaxed) {
+            if let Err(e) = control_sender.send(&ServerControlPacket::KeepAlive).await {
+                info!("Spectator {client_ip} disconnected. Cause: {e}");
+                break;
+            }
+            time::sleep(NETWORK_KEEPALIVE_INTERVAL).await;
+        }
+
+        Ok(())
+    };
+
+    let control_loop = async move {
+        loop {
+            match control_receiver.recv().await {
+                Ok(ClientControlPacket::RequestIdr) => unsafe { crate::RequestIDR(sink_id) },
+                Ok(ClientControlPacket::VideoErrorReport) => unsafe {
+                    crate::VideoErrorReportReceive(sink_id)
+                },
+                Ok(ClientControlPacket::VideoNack(nack)) => video_nack_receive(sink_id, nack),
+                Ok(_) => (),
+                Err(e) => {
+                    info!("Spectator {client_ip} disconnected. Cause: {e}");
+                    break;
+                }
+            }
+        }
+
+        Ok(())
+    };
+
+    let receive_loop = async move { stream_socket.receive_loop().await };
+
+    tokio::select! {
+        res = spawn_cancelable(receive_loop) => res,
+        res = spawn_cancelable(video_send_loop) => res,
+        res = keepalive_loop => res,
+        res = control_loop => res,
+    }
+}
+
+pub async fn spectator_lifecycle_loop() {
+    let mut protocol_warned = false;
+    loop {
+        let connection = SESSION_MANAGER.lock().get().to_settings().connection;
+
+        if let Switch::Enabled(desc) = connection.spectators {
+            if !matches!(connection.stream_protocol, SocketProtocol::Tcp) {
+                // the UDP stream port is bound by the client stream
+                if !protocol_warned {
+                    warn!("Spectators need the TCP stream protocol");
+                    protocol_warned = true;
+                }
+            } else if CLIENT_STREAMING.load(Ordering::Relaxed)
+                && SPECTATOR_COUNT.load(Ordering::Relaxed) < desc.max_spectators
+            {
+                let res = tokio::select! {
+                    res = spectator_handshake() => Some(res),
+                    _ = STREAM_CLOSED_NOTIFIER.notified() => None,
+                };
+
+                match res {
+                    Some(Ok(connection_info)) => {
+                        SPECTATOR_COUNT.fetch_add(1, Ordering::Relaxed);
+                        tokio::spawn(async move {
+                            tokio::select! {
+                                res = spectator_pipeline(connection_info) => {
+                                    alvr_common::show_err(res);
+                                }
+                                _ = STREAM_CLOSED_NOTIFIER.notified() => (),
+                            }
+                            SPECTATOR_COUNT.fetch_sub(1, Ordering::Relaxed);
+                        });
+                    }
+                    Some(Err(e)) => warn!("Spectator handshake: {e}"),
+                    None => (),
+                }
+            }
+        }
+
+        time::sleep(RETRY_CONNECT_MIN_INTERVAL).await;
+    }
+}
+
 pub async fn connection_lifecycle_loop() {
     loop {
         tokio::join!(
@@ -21,15 +21,17 @@ use alvr_filesystem::{self as afs, Layout};
 use alvr_session::{
     ClientConnectionDesc, OpenvrPropValue, OpenvrPropertyKey, ServerEvent, SessionManager,
 };
-use alvr_sockets::{Haptics, TimeSyncPacket, VideoFrameHeaderPacket};
+use alvr_sockets::{
+    Haptics, SenderBuffer, SenderBufferFactory, TimeSyncPacket, VideoFrameHeaderPacket,
+};
 use graphics_info::GpuVendor;
 use parking_lot::Mutex;
 use std::{
-    collections::{hash_map::Entry, HashSet},
+    collections::{hash_map::Entry, HashMap, HashSet},
     ffi::{c_void, CStr, CString},
     net::IpAddr,
     os::raw::c_char,
-    ptr,
+    ptr, slice,
     sync::{
         atomic::{AtomicUsize, Ordering},
         Arc, Once,
@@ -51,8 +53,12 @@ lazy_static! {
     static ref RUNTIME: Mutex<Option<Runtime>> = Mutex::new(Runtime::new().ok());
     static ref MAYBE_WINDOW: Mutex<Option<Arc<alcro::UI>>> = Mutex::new(None);
 
-    static ref VIDEO_SENDER: Mutex<Option<mpsc::UnboundedSender<(VideoFrameHeaderPacket, Vec<u8>)>>> =
-        Mutex::new(None);
+    // By video sink, CLIENT_VIDEO_SINK and the spectators. The packets are built on the C++ thread,
+    // the send loop of the sink only sends them.
+    static ref VIDEO_SENDERS: Mutex<HashMap<u32, (
+        SenderBufferFactory<VideoFrameHeaderPacket>,
+        mpsc::UnboundedSender<SenderBuffer<VideoFrameHeaderPacket>>,
+    )>> = Mutex::new(HashMap::new());
     static ref HAPTICS_SENDER: Mutex<Option<mpsc::UnboundedSender<Haptics>>> =
         Mutex::new(None);
     static ref TIME_SYNC_SENDER: Mutex<Option<mpsc::UnboundedSender<TimeSyncPacket>>> =
@@ -60,6 +66,7 @@ lazy_static! {
 
     static ref CLIENTS_UPDATED_NOTIFIER: Notify = Notify::new();
     static ref RESTART_NOTIFIER: Notify = Notify::new();
+    static ref STREAM_CLOSED_NOTIFIER: Notify = Notify::new();
     static ref SHUTDOWN_NOTIFIER: Notify = Notify::new();
 
     static ref FRAME_RENDER_VS_CSO: Vec<u8> =
@@ -319,8 +326,8 @@ pub unsafe extern "C" fn HmdDriverFactory(
         log(log::Level::Debug, string_ptr);
     }
 
-    extern "C" fn video_send(header: VideoFrame, buffer_ptr: *mut u8, len: i32) {
-        if let Some(sender) = &*VIDEO_SENDER.lock() {
+    extern "C" fn video_send(sink_id: u32, header: VideoFrame, buffer_ptr: *mut u8, len: i32) {
+        if let Some((buffer_factory, sender)) = VIDEO_SENDERS.lock().get(&sink_id) {
             let header = VideoFrameHeaderPacket {
                 packet_counter: header.packetCounter,
                 tracking_frame_index: header.trackingFrameIndex,
@@ -329,16 +336,27 @@ pub unsafe extern "C" fn HmdDriverFactory(
                 frame_byte_size: header.frameByteSize,
                 fec_index: header.fecIndex,
                 fec_percentage: header.fecPercentage,
+                frame_width: header.frameWidth,
+                frame_height: header.frameHeight,
+                fec_group_index: header.fecGroupIndex,
+                fec_group_count: header.fecGroupCount,
+                fec_group_offset: header.fecGroupOffset,
+                fec_group_byte_size: header.fecGroupByteSize,
+                frame_packet_index: header.framePacketIndex,
+                frame_packet_count: header.framePacketCount,
+                fec_codec: header.fecCodec,
+                retransmitted: header.retransmitted,
             };
 
-            let mut vec_buffer = vec![0; len as _];
+            // The payload is only borrowed from C++ for the call. It is copied once, right after the
+            // header in the datagram buffer.
+            let payload = unsafe { slice::from_raw_parts(buffer_ptr, len as _) };
 
-            // use copy_nonoverlapping (aka memcpy) to avoid freeing memory allocated by C++
-            unsafe {
-                ptr::copy_nonoverlapping(buffer_ptr, vec_buffer.as_mut_ptr(), len as _);
+            // new_buffer() logs its errors
+            if let Ok(mut buffer) = buffer_factory.new_buffer(&header, payload.len()) {
+                buffer.get_mut().extend_from_slice(payload);
+                sender.send(buffer).ok();
             }
-
-            sender.send((header, vec_buffer)).ok();
         }
     }
 
@@ -393,6 +411,7 @@ pub unsafe extern "C" fn HmdDriverFactory(
                 }
                 tokio::select! {
                     _ = connection::connection_lifecycle_loop() => (),
+                    _ = connection::spectator_lifecycle_loop() => (),
                     _ = SHUTDOWN_NOTIFIER.notified() => (),
                 }
             });
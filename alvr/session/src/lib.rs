@@ -63,6 +63,7 @@ pub struct OpenvrConfig {
     pub refresh_rate: u32,
     pub use_10bit_encoder: bool,
     pub sw_thread_count: u32,
+    pub skip_static_frames: bool,
     pub encode_bitrate_mbs: u64,
     pub enable_adaptive_bitrate: bool,
     pub bitrate_maximum: u64,
@@ -74,6 +75,21 @@ pub struct OpenvrConfig {
     pub bitrate_up_rate: u64,
     pub bitrate_down_rate: u64,
     pub bitrate_light_load_threshold: f32,
+    pub enable_dynamic_resolution: bool,
+    pub dynamic_resolution_levels: u32,
+    pub dynamic_resolution_min_scale: f32,
+    pub dynamic_resolution_load_high: f32,
+    pub dynamic_resolution_load_low: f32,
+    pub dynamic_resolution_bitrate_low: f32,
+    pub dynamic_resolution_interval_ms: u64,
+    pub enable_quality_probe: bool,
+    pub quality_probe_interval: u32,
+    pub quality_probe_sample_step: u32,
+    pub quality_probe_gaze_radius: f32,
+    pub enable_thread_policy: bool,
+    pub thread_realtime_priority: u32,
+    pub thread_deadline_scheduler: bool,
+    pub thread_cpu_affinity: String,
     pub controllers_tracking_system_name: String,
     pub controllers_manufacturer_name: String,
     pub controllers_model_number: String,
@@ -114,6 +130,19 @@ pub struct OpenvrConfig {
     pub gamma: f32,
     pub sharpening: f32,
     pub enable_fec: bool,
+    pub fec_codec: u32,
+    pub enable_unequal_error_protection: bool,
+    pub uep_critical_fec_percentage: u32,
+    pub uep_peripheral_fec_percentage: u32,
+    pub uep_foveal_band: f32,
+    pub uep_interleave_groups: bool,
+    pub enable_video_pacing: bool,
+    pub video_pacing_frame_budget: f32,
+    pub enable_video_nack: bool,
+    pub video_nack_history_frames: u32,
+    pub video_nack_deadline: f32,
+    pub enable_frame_trace: bool,
+    pub frame_trace_path: String,
     pub linux_async_reprojection: bool,
 }
 
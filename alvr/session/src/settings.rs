@@ -85,6 +85,52 @@ pub struct AdaptiveBitrateDesc {
     pub bitrate_light_load_threshold: f32,
 }
 
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct DynamicResolutionDesc {
+    #[schema(min = 2, max = 4, step = 1)]
+    pub level_count: u32,
+
+    #[schema(min = 0.25, max = 0.9, step = 0.05)]
+    pub minimum_scale: f32,
+
+    #[schema(advanced, min = 0.5, max = 1., step = 0.01)]
+    pub encode_load_high_threshold: f32,
+
+    #[schema(advanced, min = 0.1, max = 0.9, step = 0.01)]
+    pub encode_load_low_threshold: f32,
+
+    #[schema(advanced, min = 0., max = 1., step = 0.01)]
+    pub bitrate_low_threshold: f32,
+
+    #[schema(advanced, min = 500, max = 10000, step = 100)]
+    pub switch_interval_ms: u64,
+}
+
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct QualityProbeDesc {
+    #[schema(min = 1, max = 120, step = 1)]
+    pub frame_interval: u32,
+
+    #[schema(min = 1, max = 16, step = 1)]
+    pub sample_step: u32,
+
+    #[schema(min = 0.02, max = 1., step = 0.01)]
+    pub gaze_radius: f32,
+}
+
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct ThreadPolicyDesc {
+    #[schema(min = 1, max = 99, step = 1)]
+    pub realtime_priority: u32,
+
+    pub deadline_scheduler: bool,
+
+    pub cpu_affinity: String,
+}
+
 #[derive(SettingsSchema, Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 pub struct FoveatedRenderingDesc {
@@ -174,11 +220,22 @@ pub struct VideoDesc {
     #[schema(advanced)]
     pub sw_thread_count: u32,
 
+    #[schema(advanced)]
+    pub skip_static_frames: bool,
+
     #[schema(min = 1, max = 500)]
     pub encode_bitrate_mbs: u64,
 
     pub adaptive_bitrate: Switch<AdaptiveBitrateDesc>,
 
+    pub dynamic_resolution: Switch<DynamicResolutionDesc>,
+
+    #[schema(advanced)]
+    pub quality_probe: Switch<QualityProbeDesc>,
+
+    #[schema(advanced)]
+    pub thread_policy: Switch<ThreadPolicyDesc>,
+
     #[schema(advanced)]
     pub seconds_from_vsync_to_photons: f32,
 
@@ -430,6 +487,15 @@ pub enum SocketProtocol {
     Tcp,
 }
 
+// CauchyGf16 caps the encoding cost of a FEC group at ALVR_FEC_CAUCHY_ENCODE_BUDGET
+// (packet_types.h, about 2 ms on one core): groups over 256 KB get fewer parity shards per row.
+#[derive(SettingsSchema, Serialize, Deserialize, Clone, Copy)]
+#[serde(rename_all = "camelCase", tag = "type", content = "content")]
+pub enum FecCodec {
+    ReedSolomon,
+    CauchyGf16,
+}
+
 #[derive(SettingsSchema, Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 pub struct DiscoveryConfig {
@@ -437,6 +503,45 @@ pub struct DiscoveryConfig {
     pub auto_trust_clients: bool,
 }
 
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct UnequalErrorProtectionDesc {
+    #[schema(min = 1, max = 100, step = 1)]
+    pub critical_fec_percentage: u32,
+
+    #[schema(min = 1, max = 100, step = 1)]
+    pub peripheral_fec_percentage: u32,
+
+    #[schema(min = 0.1, max = 1., step = 0.05)]
+    pub foveal_band: f32,
+
+    pub interleave_groups: bool,
+}
+
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct VideoPacingDesc {
+    #[schema(min = 0.1, max = 1., step = 0.05)]
+    pub frame_budget: f32,
+}
+
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct VideoNackDesc {
+    #[schema(min = 1, max = 8, step = 1)]
+    pub history_frames: u32,
+
+    #[schema(min = 0.1, max = 2., step = 0.05)]
+    pub deadline: f32,
+}
+
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct SpectatorsDesc {
+    #[schema(min = 1, max = 8, step = 1)]
+    pub max_spectators: u32,
+}
+
 #[derive(SettingsSchema, Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 pub struct ConnectionDesc {
@@ -461,6 +566,24 @@ pub struct ConnectionDesc {
 
     #[schema(advanced)]
     pub enable_fec: bool,
+
+    #[schema(advanced)]
+    pub fec_codec: FecCodec,
+
+    #[schema(advanced)]
+    pub unequal_error_protection: Switch<UnequalErrorProtectionDesc>,
+
+    #[schema(advanced)]
+    pub video_pacing: Switch<VideoPacingDesc>,
+
+    #[schema(advanced)]
+    pub video_nack: Switch<VideoNackDesc>,
+
+    #[schema(advanced)]
+    pub spectators: Switch<SpectatorsDesc>,
+
+    #[schema(advanced)]
+    pub frame_trace: bool,
 }
 
 #[derive(SettingsSchema, Serialize, Deserialize, Clone, Copy, PartialEq, Eq)]
@@ -569,6 +692,7 @@ pub fn session_settings_default() -> SettingsDefault {
             client_request_realtime_decoder: true,
             use_10bit_encoder: false,
             sw_thread_count: 0,
+            skip_static_frames: true,
             encode_bitrate_mbs: 30,
             adaptive_bitrate: SwitchDefault {
                 enabled: true,
@@ -588,6 +712,33 @@ pub fn session_settings_default() -> SettingsDefault {
                     bitrate_light_load_threshold: 0.7,
                 },
             },
+            dynamic_resolution: SwitchDefault {
+                enabled: false,
+                content: DynamicResolutionDescDefault {
+                    level_count: 3,
+                    minimum_scale: 0.6,
+                    encode_load_high_threshold: 0.85,
+                    encode_load_low_threshold: 0.5,
+                    bitrate_low_threshold: 0.35,
+                    switch_interval_ms: 2000,
+                },
+            },
+            quality_probe: SwitchDefault {
+                enabled: false,
+                content: QualityProbeDescDefault {
+                    frame_interval: 15,
+                    sample_step: 4,
+                    gaze_radius: 0.15,
+                },
+            },
+            thread_policy: SwitchDefault {
+                enabled: true,
+                content: ThreadPolicyDescDefault {
+                    realtime_priority: 10,
+                    deadline_scheduler: false,
+                    cpu_affinity: "".into(),
+                },
+            },
             seconds_from_vsync_to_photons: 0.005,
             foveated_rendering: SwitchDefault {
                 enabled: !cfg!(target_os = "linux"),
@@ -721,6 +872,34 @@ pub fn session_settings_default() -> SettingsDefault {
             on_connect_script: "".into(),
             on_disconnect_script: "".into(),
             enable_fec: true,
+            fec_codec: FecCodecDefault {
+                variant: FecCodecDefaultVariant::ReedSolomon,
+            },
+            unequal_error_protection: SwitchDefault {
+                enabled: false,
+                content: UnequalErrorProtectionDescDefault {
+                    critical_fec_percentage: 20,
+                    peripheral_fec_percentage: 2,
+                    foveal_band: 0.5,
+                    interleave_groups: true,
+                },
+            },
+            video_pacing: SwitchDefault {
+                enabled: true,
+                content: VideoPacingDescDefault { frame_budget: 0.5 },
+            },
+            video_nack: SwitchDefault {
+                enabled: false,
+                content: VideoNackDescDefault {
+                    history_frames: 4,
+                    deadline: 1.,
+                },
+            },
+            spectators: SwitchDefault {
+                enabled: false,
+                content: SpectatorsDescDefault { max_spectators: 2 },
+            },
+            frame_trace: false,
         },
         extra: ExtraDescDefault {
             theme: ThemeDefault {
@@ -12,6 +12,15 @@ pub const INPUT: StreamId = 0; // tracking and buttons
 pub const HAPTICS: StreamId = 1;
 pub const AUDIO: StreamId = 2;
 pub const VIDEO: StreamId = 3;
+// tracking and buttons in the compact format of ALVR-common/tracking_codec.h, header is ()
+pub const COMPACT_INPUT: StreamId = 4;
+// eye gaze at the eye tracker rate, a GazeSample (bindings.h) as is, header is ()
+pub const GAZE: StreamId = 5;
+
+// Optional client features, listed after the version in HeadsetInfoPacket::reserved and separated
+// by spaces. The server keeps them off for clients which don't list them.
+// The client decoder follows the frame size of VideoFrameHeaderPacket (dynamic resolution).
+pub const CLIENT_FEATURE_DYNAMIC_RESOLUTION: &str = "dynamic_resolution";
 
 #[derive(Serialize, Deserialize, Clone)]
 pub struct ClientHandshakePacket {
@@ -99,6 +108,38 @@ pub enum ClientControlPacket {
     VideoErrorReport,         // legacy
     Reserved(String),
     ReservedBuffer(Vec<u8>),
+    VideoNack(VideoNackPacket),
+    FrameTrace(FrameTracePacket),
+}
+
+#[derive(Serialize, Deserialize, Clone)]
+pub struct VideoNackRange {
+    pub fec_group_index: u8,
+    pub fec_index: u32,
+    pub count: u32,
+}
+
+// Packets of a frame FEC can't recover without
+#[derive(Serialize, Deserialize, Clone)]
+pub struct VideoNackPacket {
+    pub video_frame_index: u64,
+    pub ranges: Vec<VideoNackRange>,
+}
+
+// Client stages of a submitted frame, in the TimeSync clock of the client (us), 0 if skipped
+#[derive(Serialize, Deserialize, Clone)]
+pub struct FrameTracePacket {
+    pub tracking_frame_index: u64,
+    pub pose_sent: u64,
+    pub first_packet_received: u64,
+    pub last_packet_received: u64,
+    pub reconstructed: u64,
+    pub decoder_input: u64,
+    pub decoder_output: u64,
+    pub uploaded: u64,
+    pub render_start: u64,
+    pub render_end: u64,
+    pub submitted: u64,
 }
 
 // legacy video packet
@@ -111,6 +152,16 @@ pub struct VideoFrameHeaderPacket {
     pub frame_byte_size: u32,
     pub fec_index: u32,
     pub fec_percentage: u16,
+    pub frame_width: u16,
+    pub frame_height: u16,
+    pub fec_group_index: u8,
+    pub fec_group_count: u8,
+    pub fec_group_offset: u32,
+    pub fec_group_byte_size: u32,
+    pub frame_packet_index: u32,
+    pub frame_packet_count: u32,
+    pub fec_codec: u8,
+    pub retransmitted: u8,
 }
 
 // legacy time sync packet
@@ -86,6 +86,51 @@ impl<T> SenderBuffer<T> {
     }
 }
 
+// Makes the buffers of a StreamSender away from it, on a thread which can't await it. The buffers
+// are then sent through the StreamSender as usual.
+pub struct SenderBufferFactory<T> {
+    stream_id: StreamId,
+    _phantom: PhantomData<T>,
+}
+
+impl<T> Clone for SenderBufferFactory<T> {
+    fn clone(&self) -> Self {
+        Self {
+            stream_id: self.stream_id,
+            _phantom: PhantomData,
+        }
+    }
+}
+
+impl<T: Serialize> SenderBufferFactory<T> {
+    pub fn new_buffer(
+        &self,
+        header: &T,
+        preferred_max_buffer_size: usize,
+    ) -> StrResult<SenderBuffer<T>> {
+        let header_size = trace_err!(bincode::serialized_size(header))?;
+        // the first two bytes are for the stream ID
+        let offset = 2 + 4 + header_size as usize;
+
+        let mut buffer = BytesMut::with_capacity(offset + preferred_max_buffer_size);
+
+        buffer.put_u16(self.stream_id);
+
+        // make space for the packet index
+        buffer.put_u32(0);
+
+        let mut buffer_writer = buffer.writer();
+        trace_err!(bincode::serialize_into(&mut buffer_writer, header))?;
+        let buffer = buffer_writer.into_inner();
+
+        Ok(SenderBuffer {
+            inner: buffer,
+            offset,
+            _phantom: PhantomData,
+        })
+    }
+}
+
 pub struct StreamSender<T> {
     stream_id: StreamId,
     socket: StreamSendSocket,
@@ -121,31 +166,20 @@ impl<T> StreamSender<T> {
 }
 
 impl<T: Serialize> StreamSender<T> {
+    pub fn buffer_factory(&self) -> SenderBufferFactory<T> {
+        SenderBufferFactory {
+            stream_id: self.stream_id,
+            _phantom: PhantomData,
+        }
+    }
+
     pub fn new_buffer(
         &self,
         header: &T,
         preferred_max_buffer_size: usize,
     ) -> StrResult<SenderBuffer<T>> {
-        let header_size = trace_err!(bincode::serialized_size(header))?;
-        // the first two bytes are for the stream ID
-        let offset = 2 + 4 + header_size as usize;
-
-        let mut buffer = BytesMut::with_capacity(offset + preferred_max_buffer_size);
-
-        buffer.put_u16(self.stream_id);
-
-        // make space for the packet index
-        buffer.put_u32(0);
-
-        let mut buffer_writer = buffer.writer();
-        trace_err!(bincode::serialize_into(&mut buffer_writer, header))?;
-        let buffer = buffer_writer.into_inner();
-
-        Ok(SenderBuffer {
-            inner: buffer,
-            offset,
-            _phantom: PhantomData,
-        })
+        self.buffer_factory()
+            .new_buffer(header, preferred_max_buffer_size)
     }
 
     pub async fn send(&mut self, packet: &T) -> StrResult {
@@ -48,6 +48,11 @@ void Settings::Load()
 		m_renderHeight = config.get("eye_resolution_height").get<int64_t>();
 
 		m_refreshRate = (int)config.get("refresh_rate").get<int64_t>();
+
+		m_threadPolicy.realtime = config.get("enable_thread_policy").get<bool>();
+		m_threadPolicy.realtimePriority = (int)config.get("thread_realtime_priority").get<int64_t>();
+		m_threadPolicy.deadline = config.get("thread_deadline_scheduler").get<bool>();
+		m_threadPolicy.cpuMask = thread_policy::ParseCpuList(config.get("thread_cpu_affinity").get<std::string>());
 		
 		Debug("Config JSON: %hs\n", json.c_str());
 		Info("Render Target: %d %d\n", m_renderWidth, m_renderHeight);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include "ALVR-common/thread_policy.h"
 
 class Settings
 {
@@ -23,4 +24,6 @@ public:
 	int m_refreshRate;
 	uint32_t m_renderWidth;
 	uint32_t m_renderHeight;
+	// vsync and page flip threads
+	thread_policy::Policy m_threadPolicy;
 };
@@ -2,8 +2,8 @@
 #include "layer/private_data.hpp"
 
 #include"layer/settings.h"
-
-#include <chrono>
+#include "shared/vsync_generator.h"
+#include "util/logger.h"
 
 wsi::display::display(layer::device_private_data& device_data, uint32_t queue_family_index, uint32_t queue_index):
   m_queue_family_index(queue_family_index),
@@ -23,19 +23,37 @@ VkFence wsi::display::get_vsync_fence()
   m_device_data.SetDeviceLoaderData(m_device_data.device, queue);
   m_vsync_thread = std::thread([this, queue]()
       {
-      auto refresh = Settings::Instance().m_refreshRate;
-      auto next_frame = std::chrono::steady_clock::now();
-      auto frame_time = std::chrono::duration_cast<decltype(next_frame)::duration>(std::chrono::duration<double>(1. / refresh));
+      const int refreshRate = Settings::Instance().m_refreshRate;
+      auto policy = Settings::Instance().m_threadPolicy;
+      policy.realtimePriority += 1;
+      policy.deadlineRuntimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(VSyncGenerator::SPIN_DURATION).count() + 200000;
+      policy.deadlinePeriodNs = 1000000000 / std::max(refreshRate, 1);
+      auto applied = thread_policy::ApplyToCurrentThread("alvr-vk-vsync", policy);
+      Info("Thread alvr-vk-vsync: %s scheduling%s\n", thread_policy::SchedulingName(applied.scheduling),
+          applied.affinity ? ", pinned" : "");
+
+      // The threads of the layer live in the compositor process, they are reported from here.
+      thread_policy::Reporter reporter;
+      const uint64_t reportInterval = (uint64_t)std::max(refreshRate, 1) * 10;
+
+      VSyncGenerator vsync(refreshRate);
       while (not m_exiting) {
         if (m_device_data.disp.GetFenceStatus(m_device_data.device, vsync_fence) == VK_NOT_READY)
         {
           m_device_data.disp.QueueSubmit(queue, 0, nullptr, vsync_fence);
         }
         m_device_data.disp.QueueWaitIdle(queue);
-        std::this_thread::sleep_until(next_frame);
+        vsync.WaitNextVSync();
         m_vsync_count += 1;
-        next_frame += frame_time;
+        if (m_vsync_count % reportInterval == 0) {
+          auto nowUs = std::chrono::duration_cast<std::chrono::microseconds>(VSyncGenerator::Clock::now().time_since_epoch()).count();
+          reporter.Report(nowUs, [](const std::string &name, double cpuUsage, double involuntarySwitches) {
+            Info("Thread %s: %.1f%% CPU, %.0f involuntary context switches/s\n",
+                name.c_str(), cpuUsage * 100, involuntarySwitches);
+          });
+        }
       }
+      thread_policy::UnregisterCurrentThread();
       m_device_data.disp.DestroyFence(m_device_data.device, vsync_fence, nullptr);
       });
   }
@@ -42,6 +42,8 @@
 
 #include "display.hpp"
 #include "swapchain_base.hpp"
+#include "layer/settings.h"
+#include "util/logger.h"
 
 #if VULKAN_WSI_DEBUG > 0
 #define WSI_PRINT_ERROR(...) fprintf(stderr, ##__VA_ARGS__)
@@ -57,6 +59,10 @@ void swapchain_base::page_flip_thread() {
     uint64_t timeout = UINT64_MAX;
     constexpr uint64_t SEMAPHORE_TIMEOUT = 250000000; /* 250 ms. */
 
+    auto applied = thread_policy::ApplyToCurrentThread("alvr-page-flip", Settings::Instance().m_threadPolicy);
+    Info("Thread alvr-page-flip: %s scheduling%s\n", thread_policy::SchedulingName(applied.scheduling),
+         applied.affinity ? ", pinned" : "");
+
     /* No mutex is needed for the accesses to m_page_flip_thread_run variable as after the variable
      * is initialized it is only ever changed to false. The while loop will make the thread read the
      * value repeatedly, and the combination of semaphores and thread joins will force any changes
@@ -112,6 +118,8 @@ void swapchain_base::page_flip_thread() {
             present_image(pending_index);
         }
     }
+
+    thread_policy::UnregisterCurrentThread();
 }
 
 void swapchain_base::unpresent_image(uint32_t presented_index) {